@@ -1,6 +1,8 @@
 TEMPLATE = subdirs
-SUBDIRS += qcProxy qcCommon qcGUI qcPlot
+SUBDIRS += qcProxy qcCommon qcGUI qcPlot qcApiGen qcBench
 
 qcProxy.depends = qcCommon
 qcGUI.depends = qcCommon
 qcPlot.depends = qcCommon
+qcApiGen.depends = qcCommon
+qcBench.depends = qcCommon
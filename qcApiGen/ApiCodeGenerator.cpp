@@ -0,0 +1,272 @@
+#include "ApiCodeGenerator.h"
+#include "DeviceAPIParser.h"
+#include <QFile>
+#include <QDir>
+#include <QTextStream>
+
+using namespace QtuC;
+
+const char *ApiCodeGenerator::FirmwareHeaderName = "DeviceAPI_Schema.hpp";
+const char *ApiCodeGenerator::QtHeaderName = "DeviceApiSchema.h";
+
+ApiCodeGenerator::ApiCodeGenerator( QObject *parent ) : ErrorHandlerBase(parent)
+{}
+
+bool ApiCodeGenerator::parseAPI( const QByteArray &deviceAPIString )
+{
+	mHwInterfaceList.clear();
+	mVarList.clear();
+
+	DeviceAPIParser parser;
+	connect( &parser, SIGNAL(newHardwareInterface(QString,QString)), this, SLOT(addHardwareInterface(QString,QString)) );
+	connect( &parser, SIGNAL(newStateVariable(QHash<QString,QString>)), this, SLOT(addStateVariable(QHash<QString,QString>)) );
+	if( !parser.parseAPI( deviceAPIString ) )
+	{
+		error( QtCriticalMsg, "Failed to parse deviceAPI", "parseAPI()" );
+		return false;
+	}
+	mApiHash = QString( parser.getHash().toHex() );
+	debug( debugLevelVerbose, QString("deviceAPI parsed, %1 variables").arg(QString::number(mVarList.size())), "parseAPI()" );
+	return true;
+}
+
+void ApiCodeGenerator::addHardwareInterface( QString hwiName, QString hwiInfo )
+{
+	Q_UNUSED(hwiInfo);
+	mHwInterfaceList.append( hwiName );
+}
+
+void ApiCodeGenerator::addStateVariable( QHash<QString,QString> params )
+{
+	// skip the variables qcProxy wouldn't create, so the ids match its variable list
+	static const QStringList validTypes = QStringList() << "string" << "int" << "uint" << "double" << "bool" << "boolean";
+
+	variable_t var;
+	var.hwInterface = params.value("hwInterface");
+	var.name = params.value("name");
+	QString userType = params.contains("type") ? params.value("type") : params.value("userType");
+	var.deviceType = params.contains("type") ? params.value("type") : params.value("deviceType");
+	if( var.deviceType == "boolean" )
+		{ var.deviceType = "bool"; }
+
+	if( var.name.isEmpty() || !mHwInterfaceList.contains(var.hwInterface) || !validTypes.contains(userType) || !validTypes.contains(var.deviceType) )
+	{
+		error( QtWarningMsg, QString("Invalid variable %1 in interface %2, skipped (it gets no id)").arg(var.name,var.hwInterface), "addStateVariable()" );
+		return;
+	}
+	mVarList.append( var );
+}
+
+QString ApiCodeGenerator::identifier( const QString &name )
+{
+	QString id;
+	for( int i=0; i<name.size(); ++i )
+		{ id.append( ( name.at(i).isLetterOrNumber() && name.at(i).unicode() < 128 ) ? name.at(i) : QChar('_') ); }
+	if( id.isEmpty() || id.at(0).isDigit() )
+		{ id.prepend('_'); }
+	return id;
+}
+
+QStringList ApiCodeGenerator::getInterfaceList() const
+{
+	QStringList hwiList;
+	for( int i=0; i<mVarList.size(); ++i )
+	{
+		if( !hwiList.contains( mVarList.at(i).hwInterface ) )
+			{ hwiList.append( mVarList.at(i).hwInterface ); }
+	}
+	return hwiList;
+}
+
+QString ApiCodeGenerator::getFirmwareHeader() const
+{
+	QString str;
+	QTextStream out( &str );
+
+	out << "// Generated by qcApiGen from the deviceAPI, don't edit.\n"
+		<< "#ifndef DEVICEAPI_SCHEMA_H\n"
+		<< "#define DEVICEAPI_SCHEMA_H\n\n"
+		<< "#include \"QtuC_Tools.hpp\"\n"
+		<< "#include <stdlib.h>\n\n"
+		<< "/** The variables of the deviceAPI.\n"
+		<< " *\tThe id of a variable is its index in the deviceAPI, the same as in qcProxy, and the same as the binary id qcProxy assigns to it (see QtuC::Binary).\n"
+		<< " *\tEvery variable has a namespace in the namespace of its interface, with the id, the name, the type of the value,\n"
+		<< " *\tsend() to send the value to qcProxy, and parse() to parse a value received from qcProxy.*/\n"
+		<< "namespace DeviceAPI\n{\n\n"
+		<< "char const ApiHash[] = {\"" << mApiHash << "\"};\t///< MD5 hash of the deviceAPI, as in qcProxy.\n\n"
+		<< "/// Ids of the variables.\n"
+		<< "enum varId_t\n{\n";
+	for( int i=0; i<mVarList.size(); ++i )
+		{ out << "\t" << identifier(mVarList.at(i).hwInterface) << "_" << identifier(mVarList.at(i).name) << " = " << i << ",\n"; }
+	out << "\tVarCount\n};\n";
+
+	QStringList hwiList = getInterfaceList();
+	for( int h=0; h<hwiList.size(); ++h )
+	{
+		out << "\nnamespace " << identifier(hwiList.at(h)) << "\n{\n"
+			<< "\tchar const InterfaceName[] = {\"" << hwiList.at(h) << "\"};\n";
+		for( int i=0; i<mVarList.size(); ++i )
+		{
+			variable_t const &var = mVarList.at(i);
+			if( var.hwInterface != hwiList.at(h) )
+				{ continue; }
+
+			out << "\n\tnamespace " << identifier(var.name) << "\n\t{\n"
+				<< "\t\tvarId_t const Id = " << identifier(var.hwInterface) << "_" << identifier(var.name) << ";\n"
+				<< "\t\tchar const Name[] = {\"" << var.name << "\"};\n";
+			if( var.deviceType == "int" )
+			{
+				out << "\t\ttypedef int32_t type_t;\n"
+					<< "\t\tinline bool send( type_t const value )\n\t\t\t{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ); }\n"
+					<< "\t\tinline bool parse( char const *arg, type_t &value )\n\t\t\t{ char *end; value = strtol( arg, &end, 16 ); return end != arg && !*end; }\n";
+			}
+			else if( var.deviceType == "uint" )
+			{
+				out << "\t\ttypedef uint32_t type_t;\n"
+					<< "\t\tinline bool send( type_t const value )\n\t\t\t{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ); }\n"
+					<< "\t\tinline bool parse( char const *arg, type_t &value )\n\t\t\t{ char *end; value = strtoul( arg, &end, 16 ); return end != arg && !*end; }\n";
+			}
+			else if( var.deviceType == "bool" )
+			{
+				out << "\t\ttypedef bool type_t;\n"
+					<< "\t\tinline bool send( type_t const value )\n\t\t\t{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ? \"1\" : \"0\" ); }\n"
+					<< "\t\tinline bool parse( char const *arg, type_t &value )\n\t\t\t{ value = QtuC::isTrue( arg ); return *arg; }\n";
+			}
+			else	// double and string values are passed as text
+			{
+				out << "\t\ttypedef char const *type_t;\t///< " << var.deviceType << ", as text\n"
+					<< "\t\tinline bool send( type_t const value )\n\t\t\t{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ); }\n"
+					<< "\t\tinline bool parse( char const *arg, type_t &value )\n\t\t\t{ value = arg; return true; }\n";
+			}
+			out << "\t}\n";
+		}
+		out << "}\n";
+	}
+
+	out << "\n}\t//DeviceAPI::\n"
+		<< "#endif // DEVICEAPI_SCHEMA_H\n";
+	return str;
+}
+
+QString ApiCodeGenerator::getQtHeader() const
+{
+	QString str;
+	QTextStream out( &str );
+
+	out << "// Generated by qcApiGen from the deviceAPI, don't edit.\n"
+		<< "#ifndef DEVICEAPISCHEMA_H\n"
+		<< "#define DEVICEAPISCHEMA_H\n\n"
+		<< "#include <QString>\n"
+		<< "#include <QVariant>\n\n"
+		<< "namespace QtuC\n{\n\n"
+		<< "/** The variables of the deviceAPI.\n"
+		<< "  *\tThe id of a variable is its index in the deviceAPI, use it with StateManagerBase::getVar(int).\n"
+		<< "  *\tEvery variable has a namespace in the namespace of its interface, with the id, the type of the device value,\n"
+		<< "  *\ttoDevice() to build the value string of a device command, and fromDevice() to parse one.\n"
+		<< "  *\tCompare ApiHash to DeviceAPIParser::getHash().toHex() to check that the schema matches the loaded deviceAPI.*/\n"
+		<< "namespace DeviceApiSchema\n{\n\n"
+		<< "static const char ApiHash[] = \"" << mApiHash << "\";\t///< MD5 hash of the deviceAPI.\n\n"
+		<< "/// Ids of the variables.\n"
+		<< "enum varId_t\n{\n";
+	for( int i=0; i<mVarList.size(); ++i )
+		{ out << "\t" << identifier(mVarList.at(i).hwInterface) << "_" << identifier(mVarList.at(i).name) << " = " << i << ",\n"; }
+	out << "\tVarCount\n};\n\n";
+
+	out << "/// A variable of the schema.\n"
+		<< "struct varInfo_t\n{\n"
+		<< "\tconst char *hwInterface;\n"
+		<< "\tconst char *name;\n"
+		<< "\tQVariant::Type deviceType;\n"
+		<< "};\n\n"
+		<< "/// The variables, indexed by the id. Terminated with an empty item.\n"
+		<< "static const varInfo_t VarList[] =\n{\n";
+	for( int i=0; i<mVarList.size(); ++i )
+	{
+		QString type = mVarList.at(i).deviceType;
+		QString qType = ( type == "int" ) ? "Int" : ( type == "uint" ) ? "UInt" : ( type == "double" ) ? "Double" : ( type == "bool" ) ? "Bool" : "String";
+		out << "\t{ \"" << mVarList.at(i).hwInterface << "\", \"" << mVarList.at(i).name << "\", QVariant::" << qType << " },\n";
+	}
+	out << "\t{ 0, 0, QVariant::Invalid }\n};\n";
+
+	QStringList hwiList = getInterfaceList();
+	for( int h=0; h<hwiList.size(); ++h )
+	{
+		out << "\nnamespace " << identifier(hwiList.at(h)) << "\n{\n";
+		for( int i=0; i<mVarList.size(); ++i )
+		{
+			variable_t const &var = mVarList.at(i);
+			if( var.hwInterface != hwiList.at(h) )
+				{ continue; }
+
+			out << "\tnamespace " << identifier(var.name) << "\n\t{\n"
+				<< "\t\tconst varId_t Id = " << identifier(var.hwInterface) << "_" << identifier(var.name) << ";\n";
+			if( var.deviceType == "int" )
+			{
+				out << "\t\ttypedef qint32 type_t;\n"
+					<< "\t\tinline QString toDevice( type_t value )\n\t\t\t{ return QString::number( value, 16 ); }\n"
+					<< "\t\tinline bool fromDevice( const QString &str, type_t &value )\n\t\t\t{ bool ok; value = str.toInt( &ok, 16 ); return ok; }\n";
+			}
+			else if( var.deviceType == "uint" )
+			{
+				out << "\t\ttypedef quint32 type_t;\n"
+					<< "\t\tinline QString toDevice( type_t value )\n\t\t\t{ return QString::number( value, 16 ); }\n"
+					<< "\t\tinline bool fromDevice( const QString &str, type_t &value )\n\t\t\t{ bool ok; value = str.toUInt( &ok, 16 ); return ok; }\n";
+			}
+			else if( var.deviceType == "double" )
+			{
+				out << "\t\ttypedef double type_t;\n"
+					<< "\t\tinline QString toDevice( type_t value )\n\t\t\t{ return QString::number( value ); }\n"
+					<< "\t\tinline bool fromDevice( const QString &str, type_t &value )\n\t\t\t{ bool ok; value = str.toDouble( &ok ); return ok; }\n";
+			}
+			else if( var.deviceType == "bool" )
+			{
+				out << "\t\ttypedef bool type_t;\n"
+					<< "\t\tinline QString toDevice( type_t value )\n\t\t\t{ return value ? \"1\" : \"0\"; }\n"
+					<< "\t\tinline bool fromDevice( const QString &str, type_t &value )\n\t\t\t{ value = !( str == \"false\" || str == \"off\" || str == \"low\" || str == \"0\" ); return !str.isEmpty(); }\n";
+			}
+			else
+			{
+				out << "\t\ttypedef QString type_t;\n"
+					<< "\t\tinline QString toDevice( const type_t &value )\n\t\t\t{ return value; }\n"
+					<< "\t\tinline bool fromDevice( const QString &str, type_t &value )\n\t\t\t{ value = str; return true; }\n";
+			}
+			out << "\t}\n";
+		}
+		out << "}\n";
+	}
+
+	out << "\n}\t//QtuC::DeviceApiSchema::\n"
+		<< "}\t//QtuC::\n"
+		<< "#endif //DEVICEAPISCHEMA_H\n";
+	return str;
+}
+
+bool ApiCodeGenerator::writeHeaders( const QString &dirPath, int headers ) const
+{
+	QDir dir( dirPath );
+	if( !dir.exists() )
+	{
+		error( QtCriticalMsg, QString("Output directory %1 doesn't exist").arg(dirPath), "writeHeaders()" );
+		return false;
+	}
+	if( ( headers & headerFirmware ) && !writeFile( dir.filePath(FirmwareHeaderName), getFirmwareHeader() ) )
+		{ return false; }
+	if( ( headers & headerQt ) && !writeFile( dir.filePath(QtHeaderName), getQtHeader() ) )
+		{ return false; }
+	return true;
+}
+
+bool ApiCodeGenerator::writeFile( const QString &filePath, const QString &content ) const
+{
+	QFile file( filePath );
+	if( !file.open( QIODevice::WriteOnly | QIODevice::Text ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "error", file.errorString() );
+		error( QtCriticalMsg, QString("Failed to open %1 for writing").arg(filePath), "writeFile()", errDet );
+		return false;
+	}
+	file.write( content.toUtf8() );
+	debug( debugLevelInfo, QString("%1 written").arg(filePath), "writeFile()" );
+	return true;
+}
@@ -0,0 +1,105 @@
+#ifndef APICODEGENERATOR_H
+#define APICODEGENERATOR_H
+
+#include <QStringList>
+#include <QHash>
+#include "ErrorHandlerBase.h"
+
+namespace QtuC
+{
+
+/** ApiCodeGenerator class.
+ *	Generate the variable schema of a deviceAPI as C++ headers, so the firmware and device specific Qt code can refer to the variables by numeric ids and typed values instead of names.
+ *	The deviceAPI is parsed with DeviceAPIParser, the same way qcProxy and the clients parse it.
+ *	The id of a variable is its index in the deviceAPI, counting only the valid variables: the same as the index in StateManagerBase::getVarList(),
+ *	and the same as the binary id qcProxy assigns to the variable on the binary device protocol.
+ *	Two headers are generated:
+ *	  * a firmware header (C++03, no Qt), with the ids, interface and variable names, and a typed send() and parse() for every variable, built on QtuC::Tools
+ *	  * a Qt header for Qt code written for a particular device, with the ids, the variable list, and a typed toDevice() and fromDevice() for every variable.
+ *	qcProxy and the clients load the deviceAPI at runtime instead, they only share the ids.*/
+class ApiCodeGenerator : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Create an empty generator.*/
+	ApiCodeGenerator( QObject *parent = 0 );
+
+	/** Parse a deviceAPI.
+	  *	@param deviceAPIString The content of the deviceAPI.xml.
+	  *	@return True on success, false otherwise.*/
+	bool parseAPI( const QByteArray &deviceAPIString );
+
+	/** Get the firmware header.
+	  *	@return The content of the header.*/
+	QString getFirmwareHeader() const;
+
+	/** Get the Qt header.
+	  *	@return The content of the header.*/
+	QString getQtHeader() const;
+
+	/// The generated headers, can be combined.
+	enum header_t
+	{
+		headerFirmware = 0x01,
+		headerQt = 0x02,
+		headerAll = headerFirmware | headerQt
+	};
+
+	/** Write the headers to a directory.
+	  *	@param dirPath The output directory.
+	  *	@param headers The headers to write, a combination of header_t flags.
+	  *	@return True on success, false otherwise.*/
+	bool writeHeaders( const QString &dirPath, int headers = headerAll ) const;
+
+	/// Name of the generated firmware header.
+	static const char *FirmwareHeaderName;
+
+	/// Name of the generated Qt header.
+	static const char *QtHeaderName;
+
+private slots:
+
+	/** Add a parsed hardware interface.
+	  *	Connected to DeviceAPIParser::newHardwareInterface().
+	  *	@param hwiName Name of the interface.
+	  *	@param hwiInfo Description of the interface, not used.*/
+	void addHardwareInterface( QString hwiName, QString hwiInfo );
+
+	/** Add a parsed state variable.
+	  *	Connected to DeviceAPIParser::newStateVariable().
+	  *	@param params The variable parameters.*/
+	void addStateVariable( QHash<QString,QString> params );
+
+private:
+
+	/// A variable of the schema.
+	struct variable_t
+	{
+		QString hwInterface;
+		QString name;
+		QString deviceType;	///< Type of the value on the device link (int, uint, double, bool, string).
+	};
+
+	/** Make a C++ identifier from a name.
+	  *	@param name The name.
+	  *	@return The name, with every invalid character replaced with an underscore.*/
+	static QString identifier( const QString &name );
+
+	/** Get the list of the interfaces, in the order of their first variable.
+	  *	@return The interface names.*/
+	QStringList getInterfaceList() const;
+
+	/** Write a file.
+	  *	@param filePath Path of the file.
+	  *	@param content The content.
+	  *	@return True on success, false otherwise.*/
+	bool writeFile( const QString &filePath, const QString &content ) const;
+
+	QStringList mHwInterfaceList;	///< The declared interfaces, variables of other interfaces are skipped as in qcProxy.
+	QList<variable_t> mVarList;	///< The variables, the index is the id.
+	QString mApiHash;	///< Hex MD5 hash of the deviceAPI, see DeviceAPIParser::getHash().
+};
+
+}	//QtuC::
+#endif //APICODEGENERATOR_H
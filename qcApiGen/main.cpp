@@ -0,0 +1,54 @@
+#include <QCoreApplication>
+#include <QFile>
+#include <QStringList>
+#include "ErrorHandlerBase.h"
+#include "ApiCodeGenerator.h"
+
+using namespace QtuC;
+
+/** Generate the variable schema headers of a deviceAPI (see ApiCodeGenerator).
+  *	Usage: qcApiGen [-v] [--firmware|--qt] <deviceAPI.xml> [outputDir]
+  *	The headers are written to outputDir, or the current directory. With --firmware or --qt, only the firmware or the Qt header is written.*/
+int main(int argc, char *argv[])
+{
+	QCoreApplication qcApiGenApp(argc, argv);
+
+	qcApiGenApp.setApplicationName( "qcApiGen" );
+	qcApiGenApp.setOrganizationName( "QtuC" );
+	qcApiGenApp.setOrganizationDomain( "QtuC" );
+	qcApiGenApp.setApplicationVersion( "0.1.0" );
+
+	// Install a custom mesage handler
+	qInstallMsgHandler( ErrorHandlerBase::customMessageHandler );
+
+	QStringList appArgs = qcApiGenApp.arguments();
+	appArgs.removeFirst();	// the command that started this application
+	if( !appArgs.isEmpty() && appArgs.first() == "-v" )
+	{
+		ErrorHandlerBase::setDebugLevel( debugLevelVerbose );
+		appArgs.removeFirst();
+	}
+	int headers = ApiCodeGenerator::headerAll;
+	if( !appArgs.isEmpty() && ( appArgs.first() == "--firmware" || appArgs.first() == "--qt" ) )
+	{
+		headers = ( appArgs.first() == "--firmware" ) ? ApiCodeGenerator::headerFirmware : ApiCodeGenerator::headerQt;
+		appArgs.removeFirst();
+	}
+	if( appArgs.isEmpty() || appArgs.size() > 2 )
+	{
+		qCritical( "Usage: qcApiGen [-v] [--firmware|--qt] <deviceAPI.xml> [outputDir]" );
+		return -1;
+	}
+
+	QFile apiFile( appArgs.at(0) );
+	if( !apiFile.open( QIODevice::ReadOnly | QIODevice::Text ) )
+	{
+		qCritical( "Failed to open %s", qPrintable(appArgs.at(0)) );
+		return 1;
+	}
+
+	ApiCodeGenerator generator;
+	if( !generator.parseAPI( apiFile.readAll() ) || !generator.writeHeaders( appArgs.size() > 1 ? appArgs.at(1) : QString("."), headers ) )
+		{ return 1; }
+	return 0;
+}
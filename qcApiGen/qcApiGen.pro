@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Code generator of the deviceAPI variable schema.
+# Reads a deviceAPI.xml, and writes the variable ids and typed
+# accessors as headers for the device firmware and the Qt applications.
+#
+#-------------------------------------------------
+
+QT       += core xml script network
+
+QT       -= gui
+
+TARGET = qcApiGen
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += main.cpp \
+    ApiCodeGenerator.cpp
+
+HEADERS += \
+    ApiCodeGenerator.h
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/release -lqcCommon
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/debug -lqcCommon
+else:unix: LIBS += -L$$OUT_PWD/../qcCommon/ -lqcCommon
+
+INCLUDEPATH += $$PWD/../qcCommon
+DEPENDPATH += $$PWD/../qcCommon
+
+win32:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../qcCommon/release/qcCommon.lib
+else:win32:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../qcCommon/debug/qcCommon.lib
+else:unix:!symbian: PRE_TARGETDEPS += $$OUT_PWD/../qcCommon/libqcCommon.a
@@ -0,0 +1,153 @@
+#include "LinkBenchmark.h"
+#include "ClientConnectionManagerBase.h"
+#include "ClientCommandReqDeviceInfo.h"
+#include "LatencyTrace.h"
+#include <QTcpSocket>
+#include <QLocalSocket>
+
+using namespace QtuC;
+
+LinkBenchmark::LinkBenchmark( const QString &host, quint16 port, const QString &localName, int roundTrips, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mHost(host),
+	mPort(port),
+	mLocalName(localName),
+	mRoundTrips(roundTrips),
+	mTransport(-1),
+	mLink(0),
+	mSent(0),
+	mSentUs(0),
+	mOk(true)
+{
+	for( int t=0; t<transportCount; ++t )
+		{ mSumUs[t] = 0; }
+}
+
+void LinkBenchmark::start()
+{
+	startNextTransport();
+}
+
+QStringList LinkBenchmark::getReport() const
+{
+	QStringList report;
+	for( int t=0; t<transportCount; ++t )
+	{
+		const LatencyHistogram &rtt = mRtt[t];
+		if( !rtt.getCount() )
+			{ continue; }
+		report.append( QString("%1: %2 round trips, mean %3us, p50 %4us, p99 %5us, max %6us").arg(
+						   transportToString( (transport_t)t ),
+						   QString::number( rtt.getCount() ),
+						   QString::number( mSumUs[t] / rtt.getCount() ),
+						   QString::number( rtt.getPercentile(50) ),
+						   QString::number( rtt.getPercentile(99) ),
+						   QString::number( rtt.getMax() ) ) );
+	}
+	return report;
+}
+
+void LinkBenchmark::startNextTransport()
+{
+	if( mLink )
+	{
+		mLink->disconnect( this );
+		mLink->deleteLater();
+		mLink = 0;
+	}
+
+	++mTransport;
+	if( mTransport == transportLocal && mLocalName.isEmpty() )
+		{ ++mTransport; }
+	if( mTransport >= transportCount )
+	{
+		emit finished( mOk );
+		return;
+	}
+
+	mSent = 0;
+	debug( debugLevelInfo, QString("Benchmark %1...").arg( transportToString( (transport_t)mTransport ) ), "startNextTransport()" );
+	if( mTransport == transportTcp )
+	{
+		QTcpSocket *socket = new QTcpSocket(this);
+		connect( socket, SIGNAL(connected()), this, SLOT(handleConnected()) );
+		connect( socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(handleConnectError()) );
+		socket->connectToHost( mHost, mPort );
+	}
+	else
+	{
+		QLocalSocket *socket = new QLocalSocket(this);
+		connect( socket, SIGNAL(connected()), this, SLOT(handleConnected()) );
+		connect( socket, SIGNAL(error(QLocalSocket::LocalSocketError)), this, SLOT(handleConnectError()) );
+		socket->connectToServer( mLocalName );
+	}
+}
+
+void LinkBenchmark::handleConnected()
+{
+	QIODevice *socket = (QIODevice*)sender();
+	disconnect( socket, 0, this, 0 );
+
+	mLink = new ClientConnectionManagerBase( socket, false, this );
+	socket->setParent( mLink );
+	connect( mLink, SIGNAL(connectionStateReady()), this, SLOT(handleReady()) );
+	connect( mLink, SIGNAL(commandReceived(ClientCommandBase*)), this, SLOT(handleCommand(ClientCommandBase*)) );
+	mLink->sendHandShake();
+}
+
+void LinkBenchmark::handleConnectError()
+{
+	QIODevice *socket = (QIODevice*)sender();
+	errorDetails_t errDet;
+	errDet.insert( "error", socket->errorString() );
+	error( QtWarningMsg, QString("Failed to connect to proxy on %1").arg( transportToString( (transport_t)mTransport ) ), "handleConnectError()", errDet );
+	socket->deleteLater();
+	mOk = false;
+	startNextTransport();
+}
+
+void LinkBenchmark::handleReady()
+{
+	sendRequest();
+}
+
+void LinkBenchmark::handleCommand( ClientCommandBase *cmd )
+{
+	if( cmd->getName() == "deviceInfo" )
+	{
+		quint64 rttUs = LatencyTrace::now() - mSentUs;
+		if( mSent > MWarmUpCount )
+		{
+			mRtt[mTransport].add( rttUs );
+			mSumUs[mTransport] += rttUs;
+		}
+
+		if( mSent < mRoundTrips + MWarmUpCount )
+			{ sendRequest(); }
+		else
+			{ startNextTransport(); }
+	}
+	cmd->deleteLater();
+}
+
+void LinkBenchmark::sendRequest()
+{
+	++mSent;
+	mSentUs = LatencyTrace::now();
+	if( !mLink->sendCommand( new ClientCommandReqDeviceInfo() ) )
+	{
+		error( QtWarningMsg, "Failed to send request", "sendRequest()" );
+		mOk = false;
+		startNextTransport();
+	}
+}
+
+QString LinkBenchmark::transportToString( transport_t transport )
+{
+	switch( transport )
+	{
+		case transportTcp: return "tcp";
+		case transportLocal: return "local";
+		default: return "unknown";
+	}
+}
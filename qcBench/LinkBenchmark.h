@@ -0,0 +1,93 @@
+#ifndef LINKBENCHMARK_H
+#define LINKBENCHMARK_H
+
+#include "ErrorHandlerBase.h"
+#include "LatencyHistogram.h"
+#include <QStringList>
+
+namespace QtuC
+{
+
+class ClientConnectionManagerBase;
+class ClientCommandBase;
+
+/** Compare the round-trip latency of the proxy on TCP and on its local socket.
+  *	For each transport, connect to the proxy, make the handshake, then send reqDeviceInfo commands one after the other, each after the reply to the previous one.
+  *	The round-trip times go to a LatencyHistogram, and are printed when all transports are done. The first MWarmUpCount round trips are not counted.
+  *	The proxy answers reqDeviceInfo from memory, so the times are the client link and the packet handling, the device is not involved.*/
+class LinkBenchmark : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/// Transports to benchmark.
+	enum transport_t
+	{
+		transportTcp,
+		transportLocal,
+		transportCount
+	};
+
+	/** Create.
+	  *	@param host Host of the proxy, for TCP.
+	  *	@param port Port of the proxy, for TCP.
+	  *	@param localName Local socket name of the proxy (its serverSocket/localName setting), empty to benchmark TCP only.
+	  *	@param roundTrips Number of round trips per transport.
+	  *	@param parent Parent object.*/
+	LinkBenchmark( const QString &host, quint16 port, const QString &localName, int roundTrips, QObject *parent = 0 );
+
+	/// Start the benchmark, finished() is emitted at the end.
+	void start();
+
+	/** Get the report of the benchmark.
+	  *	@return A line for each transport: the count, the mean, p50, p99 and max of the round-trip times in microseconds.*/
+	QStringList getReport() const;
+
+signals:
+
+	/** Emitted when all transports are done.
+	  *	@param ok True if all transports were benchmarked, false if one failed.*/
+	void finished( bool ok );
+
+private slots:
+
+	/// Handle the socket connected, make the handshake.
+	void handleConnected();
+
+	/// Handle a failed connection, skip to the next transport.
+	void handleConnectError();
+
+	/// Handle the handshake done, send the first request.
+	void handleReady();
+
+	/** Handle a reply, measure it and send the next request.
+	  *	@param cmd The command received.*/
+	void handleCommand( ClientCommandBase *cmd );
+
+private:
+
+	/// Connect with the next transport, or emit finished() if all are done.
+	void startNextTransport();
+
+	/// Send a request and start measuring.
+	void sendRequest();
+
+	static QString transportToString( transport_t transport );
+
+	static const int MWarmUpCount = 20;
+
+	QString mHost;
+	quint16 mPort;
+	QString mLocalName;
+	int mRoundTrips;
+	int mTransport;		///< The transport being benchmarked, a transport_t.
+	ClientConnectionManagerBase *mLink;
+	int mSent;			///< Requests sent on the current transport.
+	quint64 mSentUs;	///< Time of the last request.
+	quint64 mSumUs[transportCount];	///< Sum of the counted round-trip times, for the mean.
+	LatencyHistogram mRtt[transportCount];
+	bool mOk;
+};
+
+}	//QtuC::
+#endif // LINKBENCHMARK_H
@@ -0,0 +1,58 @@
+#include <QCoreApplication>
+#include <QStringList>
+#include "ErrorHandlerBase.h"
+#include "ClientConnectionManagerBase.h"
+#include "LinkBenchmark.h"
+
+using namespace QtuC;
+
+/** Compare the round-trip latency of a running qcProxy on TCP and on its local socket (see LinkBenchmark).
+  *	Usage: qcBench [-v] [-n roundTrips] [host [port [localName]]]
+  *	The defaults are localhost, 24563 and qcProxy, the defaults of the proxy settings. An empty localName benchmarks TCP only.*/
+int main(int argc, char *argv[])
+{
+	QCoreApplication qcBenchApp(argc, argv);
+
+	qcBenchApp.setApplicationName( "qcBench" );
+	qcBenchApp.setOrganizationName( "QtuC" );
+	qcBenchApp.setOrganizationDomain( "QtuC" );
+	qcBenchApp.setApplicationVersion( "0.1.0" );
+
+	// Install a custom mesage handler
+	qInstallMsgHandler( ErrorHandlerBase::customMessageHandler );
+
+	QStringList appArgs = qcBenchApp.arguments();
+	appArgs.removeFirst();	// the command that started this application
+	int roundTrips = 1000;
+	while( !appArgs.isEmpty() && appArgs.first().startsWith('-') )
+	{
+		QString option = appArgs.takeFirst();
+		if( option == "-v" )
+			{ ErrorHandlerBase::setDebugLevel( debugLevelVerbose ); }
+		else if( option == "-n" && !appArgs.isEmpty() )
+			{ roundTrips = appArgs.takeFirst().toInt(); }
+		else
+			{ roundTrips = 0; }
+	}
+	if( roundTrips <= 0 || appArgs.size() > 3 )
+	{
+		qCritical( "Usage: qcBench [-v] [-n roundTrips] [host [port [localName]]]" );
+		return -1;
+	}
+
+	QHash<QString,QString> selfInfo;
+	selfInfo.insert( "id", "qcBench" );
+	selfInfo.insert( "name", "QtuC link benchmark" );
+	selfInfo.insert( "version", qcBenchApp.applicationVersion() );
+	ClientConnectionManagerBase::setSelfInfo( selfInfo );
+
+	LinkBenchmark benchmark( appArgs.value( 0, "localhost" ), appArgs.value( 1, "24563" ).toUShort(), appArgs.value( 2, "qcProxy" ), roundTrips );
+	QObject::connect( &benchmark, SIGNAL(finished(bool)), &qcBenchApp, SLOT(quit()) );
+	benchmark.start();
+	qcBenchApp.exec();
+
+	QStringList report = benchmark.getReport();
+	for( int i=0; i<report.size(); ++i )
+		{ qWarning( "%s", qPrintable(report.at(i)) ); }
+	return report.isEmpty() ? 1 : 0;
+}
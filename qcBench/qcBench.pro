@@ -0,0 +1,38 @@
+#-------------------------------------------------
+#
+# Latency benchmark of the client links of qcProxy.
+# Measures the round-trip time of the proxy on TCP and on
+# its local socket, see LinkBenchmark.
+#
+#-------------------------------------------------
+
+QT       += core xml script network
+
+QT       -= gui
+
+TARGET = qcBench
+CONFIG   += console
+CONFIG   -= app_bundle
+
+TEMPLATE = app
+
+
+SOURCES += main.cpp \
+    LinkBenchmark.cpp
+
+HEADERS += \
+    LinkBenchmark.h
+
+win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/release -lqcCommon
+else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/debug -lqcCommon
+else:unix: LIBS += -L$$OUT_PWD/../qcCommon/ -lqcCommon
+# setsockopt() of ClientConnectionManagerBase
+win32: LIBS += -lws2_32
+
+INCLUDEPATH += $$PWD/../qcCommon
+INCLUDEPATH += $$PWD/../qcCommon/clientCommands
+DEPENDPATH += $$PWD/../qcCommon
+
+win32:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../qcCommon/release/qcCommon.lib
+else:win32:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../qcCommon/debug/qcCommon.lib
+else:unix:!symbian: PRE_TARGETDEPS += $$OUT_PWD/../qcCommon/libqcCommon.a
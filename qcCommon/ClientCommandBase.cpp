@@ -22,7 +22,10 @@ ClientCommandBase *ClientCommandBase::cloneWithDomElement(const QDomElement &cmd
 		return 0;
 	}
 	else
-		{ return cmd; }
+	{
+		cmd->setDevice( cmdElement.attribute("device") );
+		return cmd;
+	}
 }
 
 bool ClientCommandBase::isValid() const
@@ -88,6 +88,17 @@ public:
 	virtual const QString getName() const
 		{ return mName; }
 
+	/** Get the id of the device the command is addressed to (or sent from), on a proxy serving more devices.
+	  *	The id is the optional `device` attribute of the command element, set and parsed by ClientPacket for every command.
+	  *	@return The device id, empty for the default device of the proxy.*/
+	const QString getDevice() const
+		{ return mDevice; }
+
+	/** Set the id of the device the command is addressed to (or sent from).
+	  *	@param deviceId The device id, empty for the default device of the proxy.*/
+	void setDevice( const QString &deviceId )
+		{ mDevice = deviceId; }
+
 	///** @todo slkdjfsdlfjsdlkfjsdlfk*/
 	//bool operator==( ClientCommandBase *otherCommand );
 
@@ -100,6 +111,7 @@ protected:
 
 	QString mName;	///< Name of the command. Also tag name in the markup.
 	commandClass_t mClass;	///< The class of the command,
+	QString mDevice;	///< Id of the addressed device, empty for the default one.
 
 };
 
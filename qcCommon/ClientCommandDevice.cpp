@@ -64,6 +64,9 @@ bool ClientCommandDevice::applyDomElement(const QDomElement &cmdElement)
 		mHasTimestamp = ok;
 	}
 
+	if( cmdElement.hasAttribute( "trace" ) )
+		{ mTrace = LatencyTrace::fromString( cmdElement.attribute( "trace" ) ); }
+
 	setInterface( cmdElement.attribute( "hwi" ) );
 
 	if( mType == deviceCmdCall )
@@ -121,6 +124,8 @@ QDomElement ClientCommandDevice::getDomElement() const
 
 	if( mType == deviceCmdSet && mHasTimestamp )
 		{ cmdElement.setAttribute( "time", QString::number( mTimestamp, 16 ) ); }
+	if( mType == deviceCmdSet && hasTrace() )
+		{ cmdElement.setAttribute( "trace", mTrace.toString() ); }
 
 	if( !mHwInterface.isEmpty() )
 		{ cmdElement.setAttribute( "hwi", mHwInterface ); }
@@ -12,8 +12,14 @@ ClientCommandFactory::ClientCommandFactory( QObject *parent ) : ErrorHandlerBase
 	registerCommand( new ClientCommandReqDeviceApi() );
 	registerCommand( new ClientCommandSubscribe() );
 	registerCommand( new ClientCommandUnSubscribe() );
+	registerCommand( new ClientCommandSubscribeList(false) );
+	registerCommand( new ClientCommandSubscribeList(true) );
 	registerCommand( new ClientCommandReqDeviceInfo() );
 	registerCommand( new ClientCommandDeviceInfo() );
+	registerCommand( new ClientCommandReqMetrics() );
+	registerCommand( new ClientCommandMetrics() );
+	registerCommand( new ClientCommandReqSnapshot() );
+	registerCommand( new ClientCommandSnapshot() );
 
 	// Hah! How tricky I am! The deviceCommands with one class.
 	registerCommand( new ClientCommandDevice(deviceCmdGet) );
@@ -1,6 +1,16 @@
 #include "ClientConnectionManagerBase.h"
 #include "ClientCommandBase.h"
+#include "LatencyMonitor.h"
+#include "ClientConnectionWorker.h"
 #include <QCoreApplication>
+#include <QThread>
+#include <QAbstractSocket>
+#ifdef Q_OS_WIN
+#include <winsock2.h>
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#endif
 
 using namespace QtuC;
 
@@ -8,12 +18,20 @@ int ClientConnectionManagerBase::mInstanceCount = 0;
 QHash<QString,QString> ClientConnectionManagerBase::mSelfInfo = QHash<QString,QString>();
 ClientCommandFactory *ClientConnectionManagerBase::mCommandFactory = 0;
 
-ClientConnectionManagerBase::ClientConnectionManagerBase( QTcpSocket *socket, bool isServerRole, QObject *parent ) :
+ClientConnectionManagerBase::ClientConnectionManagerBase( QIODevice *socket, bool isServerRole, QObject *parent ) :
 	ErrorHandlerBase(parent),
 	mServerRole(isServerRole),
 	mState(connectionUnInitialized),
 	mHeartBeatCount(0),
-	mClientSocket(socket)
+	mClientSocket(socket),
+	mWorker(0),
+	mWorkerThread(0),
+	mDrainTimer(0),
+	mDrainInterval(0),
+	mSentPacketCount(0),
+	mSentByteCount(0),
+	mReceivedPacketCount(0),
+	mReceivedByteCount(0)
 {
 	++mInstanceCount;
 	if( mClientSocket->isOpen() )
@@ -41,7 +59,10 @@ ClientConnectionManagerBase::ClientConnectionManagerBase( QTcpSocket *socket, bo
 
 		// set some socket params, fine-tune connection...
 		setState( connectionConnected );
-		mClientSocket->setSocketOption( QAbstractSocket::LowDelayOption, 1 );
+		// no Nagle delay on the small packets of the feeds
+		QAbstractSocket *tcpSocket = qobject_cast<QAbstractSocket*>( mClientSocket );
+		if( tcpSocket )
+			{ tcpSocket->setSocketOption( QAbstractSocket::LowDelayOption, 1 ); }
 		//mClientSocket->setReadBufferSize(80);	//~one Command
 
 		connect( mClientSocket, SIGNAL(readyRead()), this, SLOT(receiveClientData()) );
@@ -60,7 +81,14 @@ ClientConnectionManagerBase::ClientConnectionManagerBase( QTcpSocket *socket, bo
 ClientConnectionManagerBase::~ClientConnectionManagerBase()
 {
 	debug( debugLevelVerbose, "Disconnect client before closing...", "~ClientConnectionManagerBase()" );
-	if( mClientSocket )
+	if( mWorker )
+	{
+		QMetaObject::invokeMethod( mWorker, "close", Qt::BlockingQueuedConnection );
+		mWorkerThread->quit();
+		mWorkerThread->wait();
+		delete mWorker;
+	}
+	else if( mClientSocket )
 		{ mClientSocket->close(); }
 	if( --mInstanceCount == 0 )
 	{
@@ -90,11 +118,47 @@ connectionState_t ClientConnectionManagerBase::getState() const
 	return mState;
 }
 
+qint64 ClientConnectionManagerBase::getPendingByteCount() const
+{
+	if( mWorker )
+		{ return mWorker->getPendingByteCount(); }
+	if( !mClientSocket )
+		{ return 0; }
+	return mClientSocket->bytesToWrite();
+}
+
+bool ClientConnectionManagerBase::setSocketBufferSizes( int sendBytes, int receiveBytes )
+{
+	QAbstractSocket *tcpSocket = qobject_cast<QAbstractSocket*>( mClientSocket );
+	if( !tcpSocket || tcpSocket->socketDescriptor() == -1 )
+		{ return true; }
+
+	bool ok = true;
+	if( sendBytes > 0 && setsockopt( tcpSocket->socketDescriptor(), SOL_SOCKET, SO_SNDBUF, (const char*)&sendBytes, sizeof(sendBytes) ) != 0 )
+	{
+		error( QtWarningMsg, QString("Failed to set send buffer size to %1").arg(sendBytes), "setSocketBufferSizes()" );
+		ok = false;
+	}
+	if( receiveBytes > 0 && setsockopt( tcpSocket->socketDescriptor(), SOL_SOCKET, SO_RCVBUF, (const char*)&receiveBytes, sizeof(receiveBytes) ) != 0 )
+	{
+		error( QtWarningMsg, QString("Failed to set receive buffer size to %1").arg(receiveBytes), "setSocketBufferSizes()" );
+		ok = false;
+	}
+	return ok;
+}
+
 const QHash<QString,QString> ClientConnectionManagerBase::getClientInfo() const
 {
 	return mClientInfo;
 }
 
+bool ClientConnectionManagerBase::isDefaultDevice( const QString &deviceId ) const
+{
+	if( deviceId.isEmpty() || !mClientInfo.contains("devices") )
+		{ return true; }
+	return ( deviceId == mClientInfo.value("devices").section( ',', 0, 0 ) );
+}
+
 const QHash<QString,QString> ClientConnectionManagerBase::getSelfInfo()
 {
 	return mSelfInfo;
@@ -162,7 +226,17 @@ bool ClientConnectionManagerBase::sendPacket(ClientPacket *packet)
 			packet->deleteLater();
 			return false;
 		}
-		if( mClientSocket->write( packet->getPacketData() ) < 0 )
+		stampTrace( packet, LatencyTrace::traceStageSend );
+		QByteArray packetData = packet->getPacketData();
+		bool written;
+		if( mWorker )
+		{
+			mWorker->addQueuedBytes( packetData.size() );
+			written = QMetaObject::invokeMethod( mWorker, "write", Qt::QueuedConnection, Q_ARG(QByteArray, packetData) );
+		}
+		else
+			{ written = ( mClientSocket->write( packetData ) >= 0 ); }
+		if( !written )
 		{
 			error( QtWarningMsg, "Error during sending client packet", "sendPacket()" );
 			packet->deleteLater();
@@ -170,6 +244,8 @@ bool ClientConnectionManagerBase::sendPacket(ClientPacket *packet)
 		}
 		else
 		{
+			++mSentPacketCount;
+			mSentByteCount += packetData.size();
 			packet->deleteLater();
 			return true;
 		}
@@ -221,6 +297,8 @@ void ClientConnectionManagerBase::receiveClientData()
 			{ return; }
 
 		ClientPacket *packet = ClientPacket::fromPacketData( mClientSocket->read( packetSize+sizeof(quint16) ) );
+		++mReceivedPacketCount;
+		mReceivedByteCount += packetSize+sizeof(quint16);
 		if( !packet )
 		{
 			error( QtWarningMsg, "Failed to create ClientPacket from data", "receiveClientData()" );
@@ -228,7 +306,10 @@ void ClientConnectionManagerBase::receiveClientData()
 		}
 
 		if( packet->isValid() )
-			{ emit handleReceivedPacket( packet ); }
+		{
+			stampTrace( packet, LatencyTrace::traceStageDecode );
+			emit handleReceivedPacket( packet );
+		}
 		else
 		{
 			error( QtWarningMsg, "Received packet is invalid", "receiveClientData()" );
@@ -331,8 +412,81 @@ void ClientConnectionManagerBase::handleDisconnected()
 	emit clientDisconnected();
 }
 
+bool ClientConnectionManagerBase::startWorkerThread( int drainIntervalMs )
+{
+	if( mWorker )
+		{ return true; }
+	if( !checkSocket() || !isConnected() )
+	{
+		error( QtWarningMsg, "Client socket is not connected, can't start worker thread", "startWorkerThread()" );
+		return false;
+	}
+
+	// the worker reads the socket from now on, the disconnect is still handled here
+	disconnect( mClientSocket, SIGNAL(readyRead()), this, SLOT(receiveClientData()) );
+	mWorker = new ClientConnectionWorker( mClientSocket, thread() );
+	mClientSocket = 0;
+	connect( mWorker, SIGNAL(packetsAvailable()), this, SLOT(scheduleDrain()) );
+
+	mDrainInterval = drainIntervalMs;
+	mDrainTimer = new QTimer(this);
+	mDrainTimer->setSingleShot( true );
+	connect( mDrainTimer, SIGNAL(timeout()), this, SLOT(drainWorker()) );
+	mLastDrain.start();
+
+	mWorkerThread = new QThread(this);
+	mWorker->moveToThread( mWorkerThread );
+	mWorkerThread->start();
+	QMetaObject::invokeMethod( mWorker, "start", Qt::QueuedConnection );
+
+	debug( debugLevelVerbose, QString("Client socket moved to worker thread, received packets handled at most every %1ms").arg(QString::number(mDrainInterval)), "startWorkerThread()" );
+	return true;
+}
+
+void ClientConnectionManagerBase::scheduleDrain()
+{
+	if( mDrainTimer->isActive() )
+		{ return; }
+	qint64 wait = mDrainInterval - mLastDrain.elapsed();
+	mDrainTimer->start( wait > 0 ? (int)wait : 0 );
+}
+
+void ClientConnectionManagerBase::drainWorker()
+{
+	mLastDrain.restart();
+	mWorker->clearWakeUp();
+	ClientConnectionWorker::receivedPacket_t received;
+	while( mWorker->takePacket( received ) )
+	{
+		++mReceivedPacketCount;
+		mReceivedByteCount += received.size;
+		handleReceivedPacket( received.packet );
+	}
+}
+
+void ClientConnectionManagerBase::stampTrace( ClientPacket *packet, LatencyTrace::traceStage_t stage )
+{
+	const QList<ClientCommandBase*> packetCommands = packet->getCommands();
+	for( int i=0; i<packetCommands.size(); ++i )
+	{
+		if( packetCommands.at(i)->getClass() != ClientCommandBase::clientCommandDevice )
+			{ continue; }
+		ClientCommandDevice *deviceCmd = (ClientCommandDevice*)packetCommands.at(i);
+		if( !deviceCmd->hasTrace() )
+			{ continue; }
+
+		deviceCmd->stampTrace( stage );
+		// the sender has seen all hops of the trace up to now
+		if( stage == LatencyTrace::traceStageSend )
+			{ LatencyMonitor::instance()->record( deviceCmd->getTrace() ); }
+	}
+}
+
 bool ClientConnectionManagerBase::checkSocket()
 {
+	// the socket belongs to the worker thread, its state is followed by the connection state
+	if( mWorker )
+		{ return isConnected(); }
 	return ( mClientSocket &&
 			mClientSocket->isOpen() &&
 			mClientSocket->isReadable() &&
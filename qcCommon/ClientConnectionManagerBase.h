@@ -2,13 +2,19 @@
 #define CLIENTCONNECTIONMANAGERBASE_H
 
 #include "ErrorHandlerBase.h"
-#include <QTcpSocket>
+#include <QIODevice>
 #include "ClientCommandFactory.h"
 #include "ClientPacket.h"
+#include <QTimer>
+#include <QElapsedTimer>
+
+class QThread;
 
 namespace QtuC
 {
 
+class ClientConnectionWorker;
+
 /** Connection states.
   *  * <b>connectionUndefined</b>: State is undefined.
   *  * <b>connectionUnInitialized</b>: Socket is not opened yet.
@@ -32,9 +38,11 @@ enum connectionState_t
 
 /** ClientConnectionManagerBase class.
  *	Provides a basic interface to communicate with a client.
- *	This class expects an open socket to operate on. It's your responsibility, to create and open a QTcpSocket socket,and then to pass it to the constructor. From that on, ClientConnectionManagerBase takes control of the socket and destroys it if disconnected.
+ *	This class expects an open socket to operate on. It's your responsibility, to create and open a socket,and then to pass it to the constructor. From that on, ClientConnectionManagerBase takes control of the socket and destroys it if disconnected.
+ *	The socket can be any stream QIODevice with a disconnected() signal, e.g. a QTcpSocket or a QLocalSocket. The TCP sockets are set to low delay (TCP_NODELAY), see also setSocketBufferSizes().
  *	Before creating a new instance, ClientConnectionManagerBase needs the selfInfo hash to provide valid client information about itself. To give ClientConnectionManagerBase the self-info, call the static function ClientConnectionManagerBase::setSelfInfo().
  *	Otherwise only an automatic id will be generated from the application name.
+ *	By default the socket is read and the packets are decoded in the thread of the connection manager. Call startWorkerThread() to move this work to a worker thread (see ClientConnectionWorker).
  *	@todo more detailed doc, howto use, and about deleting packets and commands,,, (responsibility of higher level code, ClientConnectionManagerBase won't delete them)
  *	Specific client connection manager classes should inherit this.*/
 class ClientConnectionManagerBase : public ErrorHandlerBase
@@ -43,9 +51,9 @@ class ClientConnectionManagerBase : public ErrorHandlerBase
 public:
 
 	/** Constructor.
-	 *	@param socket The TCP socket of the client.
+	 *	@param socket The socket of the client, a QTcpSocket or a QLocalSocket.
 	 *	@param isServerRole Set this to true if this client instance behaves as a server. When implementing a client to connect to proxy, this must be false, so you don't have to worry about it.*/
-	ClientConnectionManagerBase( QTcpSocket *socket, bool isServerRole = false, QObject *parent = 0 );
+	ClientConnectionManagerBase( QIODevice *socket, bool isServerRole = false, QObject *parent = 0 );
 
 	virtual ~ClientConnectionManagerBase();
 
@@ -72,6 +80,12 @@ public:
 	 *	@return Client information as a QHash.*/
 	const QHash<QString,QString> getClientInfo() const;
 
+	/** Get whether a command of the peer is for its default device.
+	 *	A proxy serving more devices advertises their ids in the `devices` handshake info, the first one is the default.
+	 *	@param deviceId The device of the command (see ClientCommandBase::getDevice()).
+	 *	@return True if the id is empty, the default device, or the peer doesn't advertise its devices, false otherwise.*/
+	bool isDefaultDevice( const QString &deviceId ) const;
+
 	/** Get self info list.
 	 *	Return server information list, to be sent to the client during handShake.
 	 *	@return Server information list as a QHash.*/
@@ -122,6 +136,52 @@ public:
 	  *	@return True on success, false otherwise.*/
 	bool sendHandShake();
 
+	/// Get the number of packets sent to the client.
+	quint64 getSentPacketCount() const
+		{ return mSentPacketCount; }
+
+	/// Get the number of bytes sent to the client.
+	quint64 getSentByteCount() const
+		{ return mSentByteCount; }
+
+	/// Get the number of packets received from the client.
+	quint64 getReceivedPacketCount() const
+		{ return mReceivedPacketCount; }
+
+	/// Get the number of bytes received from the client.
+	quint64 getReceivedByteCount() const
+		{ return mReceivedByteCount; }
+
+	/** Get the number of bytes waiting in the outgoing buffer of the socket.
+	  *	@return The number of bytes not yet written to the client.*/
+	qint64 getPendingByteCount() const;
+
+	/** Set the size of the kernel buffers of a TCP socket.
+	  *	Does nothing for other sockets. Call before startWorkerThread().
+	  *	@param sendBytes Size of the send buffer (SO_SNDBUF) in bytes, 0 to leave the system default.
+	  *	@param receiveBytes Size of the receive buffer (SO_RCVBUF) in bytes, 0 to leave the system default.
+	  *	@return True on success, false if setting a buffer size failed.*/
+	bool setSocketBufferSizes( int sendBytes, int receiveBytes );
+
+	/** Move the socket to a worker thread, which reads it and decodes the received packets.
+	  *	The decoded packets are handled in the thread of the connection manager as before (see commandReceived()), but in bursts:
+	  *	the packets arrived since the last burst are taken from the queue of the worker at most once in drainIntervalMs milliseconds.
+	  *	The sent packets are still built in the thread of the caller, only written to the socket in the worker thread.
+	  *	After this call the socket belongs to the worker, don't use it directly.
+	  *	@param drainIntervalMs Minimum time between two bursts of received packets in milliseconds, e.g. the frame interval of a GUI.
+	  *	@return True on success, false if the socket is not connected.*/
+	bool startWorkerThread( int drainIntervalMs );
+
+	/// Get whether the socket is handled in a worker thread, see startWorkerThread().
+	bool hasWorkerThread() const
+		{ return mWorker != 0; }
+
+	/** Stamp the latency trace of the traced device commands in a packet.
+	  *	On traceStageSend, the traces are recorded in LatencyMonitor as well.
+	  *	@param packet The packet.
+	  *	@param stage The stage to stamp.*/
+	static void stampTrace( ClientPacket *packet, LatencyTrace::traceStage_t stage );
+
 signals:
 
 	/* Emitted when a packet is received from the client.
@@ -159,7 +219,7 @@ signals:
 protected slots:
 
 	/** Handle new Client data.
-	  *	This slot is connected to QTcpSocket::readyRead().*/
+	  *	This slot is connected to QIODevice::readyRead() of the socket.*/
 	void receiveClientData();
 
 	/** Handle received ClientPacket.
@@ -185,6 +245,13 @@ protected slots:
 	/** Handle if client closes the connection.*/
 	void handleDisconnected();
 
+	/** Schedule the next burst of received packets from the worker thread.
+	  *	Connected to ClientConnectionWorker::packetsAvailable().*/
+	void scheduleDrain();
+
+	/// Take and handle all the packets decoded by the worker thread.
+	void drainWorker();
+
 protected:
 
 	/** Check client socket.
@@ -206,9 +273,18 @@ protected:
 	qint64 mHeartBeatCount;		///< heartBeat count.
 	static QHash<QString,QString> mSelfInfo;	///< Self-information to send to the client during handShake.
 	QHash<QString,QString> mClientInfo;		///< Client information sent by the client during handShake.
-	QTcpSocket* mClientSocket;	///< TCP socket for the client connection.
+	QIODevice* mClientSocket;	///< Socket for the client connection, null if it belongs to the worker thread.
+	ClientConnectionWorker *mWorker;	///< Socket side of the connection in the worker thread, null if there is no worker thread.
+	QThread *mWorkerThread;
+	QTimer *mDrainTimer;			///< Schedules drainWorker().
+	QElapsedTimer mLastDrain;		///< Measures the time since the last drainWorker().
+	int mDrainInterval;				///< Minimum time between two drainWorker() in milliseconds.
 	static ClientCommandFactory *mCommandFactory;	///< A ClientCommandFactory instance to build and initialize client commands. @todo Can this be only in ClientPcket as static? Who destroys it?
 	static int mInstanceCount;	///< Number of ClientConnectionManagerBase instances.
+	quint64 mSentPacketCount;		///< Number of packets sent.
+	quint64 mSentByteCount;			///< Number of bytes sent.
+	quint64 mReceivedPacketCount;	///< Number of packets received.
+	quint64 mReceivedByteCount;		///< Number of bytes received.
 };
 
 }	//QtuC::
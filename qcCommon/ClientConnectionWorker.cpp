@@ -0,0 +1,130 @@
+#include "ClientConnectionWorker.h"
+#include "ClientConnectionManagerBase.h"
+#include "ClientPacket.h"
+#include "ClientCommandBase.h"
+#include <QThread>
+#include <QTimer>
+#include <QAbstractSocket>
+#include <QLocalSocket>
+
+using namespace QtuC;
+
+ClientConnectionWorker::ClientConnectionWorker( QIODevice *socket, QThread *consumerThread ) :
+	ErrorHandlerBase(0),
+	mSocket(socket),
+	mConsumerThread(consumerThread),
+	mWakeUpPending(0),
+	mQueuedBytes(0),
+	mSocketPendingBytes(0)
+{
+	mSocket->setParent(this);
+
+	// an unlimited read buffer would take everything the client sends while the queue is full, bound it so the kernel buffer fills and the sender is slowed down
+	if( QAbstractSocket *tcpSocket = qobject_cast<QAbstractSocket*>(mSocket) )
+		{ tcpSocket->setReadBufferSize( MReadBufferSize ); }
+	else if( QLocalSocket *localSocket = qobject_cast<QLocalSocket*>(mSocket) )
+		{ localSocket->setReadBufferSize( MReadBufferSize ); }
+
+	connect( mSocket, SIGNAL(readyRead()), this, SLOT(readData()) );
+	connect( mSocket, SIGNAL(bytesWritten(qint64)), this, SLOT(updatePendingBytes()) );
+}
+
+ClientConnectionWorker::~ClientConnectionWorker()
+{
+	delete mOverflow.packet;
+	receivedPacket_t received;
+	while( mQueue.dequeue( received ) )
+		{ delete received.packet; }
+}
+
+void ClientConnectionWorker::start()
+{
+	readData();
+}
+
+void ClientConnectionWorker::write( const QByteArray &data )
+{
+	mQueuedBytes.fetchAndAddOrdered( -data.size() );
+	if( !mSocket->isOpen() || !mSocket->isWritable() )
+	{
+		error( QtWarningMsg, "Client socket is not writable, data dropped", "write()" );
+		return;
+	}
+	if( mSocket->write( data ) < 0 )
+		{ error( QtWarningMsg, "Error during sending client packet", "write()" ); }
+	updatePendingBytes();
+}
+
+void ClientConnectionWorker::close()
+{
+	mSocket->close();
+}
+
+void ClientConnectionWorker::readData()
+{
+	// the queue was full, the last packet goes first
+	if( mOverflow.packet )
+	{
+		if( !queuePacket( mOverflow ) )
+		{
+			QTimer::singleShot( MRetryInterval, this, SLOT(readData()) );
+			return;
+		}
+		mOverflow = receivedPacket_t();
+	}
+
+	while( mSocket->isOpen() && mSocket->isReadable() )
+	{
+		quint16 minPackeSize = sizeof(quint16)+1;
+		if( mSocket->peek(minPackeSize).size() < minPackeSize )	//2bytes of packetSize + 1 is the minimum size
+			{ return; }
+
+		quint16 packetSize = ClientPacket::readPacketSize( mSocket->peek(sizeof(quint16)) );
+		if( mSocket->peek(packetSize+sizeof(quint16)).size() < packetSize+sizeof(quint16) )
+			{ return; }
+
+		receivedPacket_t received;
+		received.size = packetSize+sizeof(quint16);
+		received.packet = ClientPacket::fromPacketData( mSocket->read( received.size ) );
+		if( !received.packet )
+		{
+			error( QtWarningMsg, "Failed to create ClientPacket from data", "readData()" );
+			continue;
+		}
+		if( !received.packet->isValid() )
+		{
+			error( QtWarningMsg, "Received packet is invalid", "readData()" );
+			delete received.packet;
+			continue;
+		}
+
+		ClientConnectionManagerBase::stampTrace( received.packet, LatencyTrace::traceStageDecode );
+
+		// the commands are not children of the packet, each is moved on its own
+		const QList<ClientCommandBase*> packetCommands = received.packet->getCommands();
+		for( int i=0; i<packetCommands.size(); ++i )
+			{ packetCommands.at(i)->moveToThread( mConsumerThread ); }
+		received.packet->moveToThread( mConsumerThread );
+
+		if( !queuePacket( received ) )
+		{
+			mOverflow = received;
+			QTimer::singleShot( MRetryInterval, this, SLOT(readData()) );
+			return;
+		}
+	}
+}
+
+void ClientConnectionWorker::updatePendingBytes()
+{
+	mSocketPendingBytes.fetchAndStoreOrdered( (int)mSocket->bytesToWrite() );
+}
+
+bool ClientConnectionWorker::queuePacket( const receivedPacket_t &received )
+{
+	if( !mQueue.enqueue( received ) )
+		{ return false; }
+	if( mWakeUpPending.testAndSetOrdered( 0, 1 ) )
+		{ emit packetsAvailable(); }
+	return true;
+}
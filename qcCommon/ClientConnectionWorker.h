@@ -0,0 +1,113 @@
+#ifndef CLIENTCONNECTIONWORKER_H
+#define CLIENTCONNECTIONWORKER_H
+
+#include "ErrorHandlerBase.h"
+#include "SpscQueue.h"
+#include <QIODevice>
+
+class QThread;
+
+namespace QtuC
+{
+
+class ClientPacket;
+
+/** The socket side of a client connection, running in a worker thread.
+  *	Created by ClientConnectionManagerBase::startWorkerThread(), which moves it to the worker thread together with the socket.
+  *	The worker reads the socket and decodes the packets, and writes the data the connection manager sends.
+  *	The decoded packets are moved to the thread of the connection manager, and passed to it in a lock-free queue.
+  *	The worker emits packetsAvailable() only for the first packet after the manager cleared the wake-up (see clearWakeUp()), so a burst of packets costs one signal.
+  *	If the queue is full, the worker stops reading the socket until the manager takes some packets.
+  *	The read buffer of the socket is limited to a few packets (MReadBufferSize), so then the kernel buffer fills, and TCP flow control slows down the sender.*/
+class ClientConnectionWorker : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/// A decoded packet in the queue.
+	struct receivedPacket_t
+	{
+		receivedPacket_t() : packet(0), size(0) {}
+		ClientPacket *packet;	///< The packet, owned by the receiver of the queue.
+		int size;				///< Size of the packet data in bytes.
+	};
+
+	/** Create.
+	  *	Call from the thread of the socket, before moving the worker to the worker thread.
+	  *	@param socket The open socket, the worker takes ownership.
+	  *	@param consumerThread The thread of the connection manager, the decoded packets are moved to this thread.*/
+	ClientConnectionWorker( QIODevice *socket, QThread *consumerThread );
+
+	/// Destroy, and delete the packets left in the queue. Call from the consumer thread, after the worker thread finished.
+	~ClientConnectionWorker();
+
+	/** Take the oldest decoded packet, call only from the consumer thread.
+	  *	@param received The packet and its size are copied here.
+	  *	@return True on success, false if no packet is waiting.*/
+	bool takePacket( receivedPacket_t &received )
+		{ return mQueue.dequeue( received ); }
+
+	/** Let the next decoded packet emit packetsAvailable() again.
+	  *	Call from the consumer thread before taking the packets, so no packet is left without a signal.*/
+	void clearWakeUp()
+		{ mWakeUpPending.fetchAndStoreOrdered(0); }
+
+	/** Count data sent to write() but not written yet, call from the consumer thread before invoking write().
+	  *	@param bytes Size of the data.*/
+	void addQueuedBytes( int bytes )
+		{ mQueuedBytes.fetchAndAddOrdered( bytes ); }
+
+	/** Get the number of bytes not yet written to the client.
+	  *	The data waiting for write() and the outgoing buffer of the socket. Can be called from any thread.
+	  *	@return The number of bytes.*/
+	qint64 getPendingByteCount() const
+		{ return (qint64)(int)mQueuedBytes + (qint64)(int)mSocketPendingBytes; }
+
+signals:
+
+	/// Emitted when a packet is queued and the consumer cleared the wake-up since the last signal.
+	void packetsAvailable();
+
+public slots:
+
+	/// Read the data that arrived before the worker thread started.
+	void start();
+
+	/** Write data to the socket.
+	  *	@param data The packet data.*/
+	void write( const QByteArray &data );
+
+	/// Close the socket.
+	void close();
+
+private slots:
+
+	/** Read and decode the whole packets from the socket, and queue them.
+	  *	Connected to QIODevice::readyRead() of the socket.*/
+	void readData();
+
+	/// Update the number of bytes in the outgoing buffer of the socket.
+	void updatePendingBytes();
+
+private:
+
+	/** Queue a decoded packet, and wake up the consumer if needed.
+	  *	@param received The packet.
+	  *	@return True on success, false if the queue is full.*/
+	bool queuePacket( const receivedPacket_t &received );
+
+	static const int MQueueSize = 1024;		///< Slots of the packet queue.
+	static const int MRetryInterval = 2;	///< Time in milliseconds to try again, while the queue is full.
+	static const qint64 MReadBufferSize = 4 * ( 0xffff + sizeof(quint16) );	///< Read buffer of the socket, a few packets of the maximum size (a packet must fit).
+
+	QIODevice *mSocket;
+	QThread *mConsumerThread;
+	SpscQueue<receivedPacket_t,MQueueSize> mQueue;
+	receivedPacket_t mOverflow;		///< A decoded packet not yet queued because the queue was full.
+	QAtomicInt mWakeUpPending;		///< 1 if packetsAvailable() is emitted and the consumer hasn't cleared it yet.
+	QAtomicInt mQueuedBytes;		///< Bytes sent to write() and not yet written.
+	QAtomicInt mSocketPendingBytes;	///< Bytes in the outgoing buffer of the socket.
+};
+
+}	//QtuC::
+#endif // CLIENTCONNECTIONWORKER_H
@@ -7,11 +7,11 @@ using namespace QtuC;
 
 ClientCommandFactory *ClientPacket::mCommandFactoryPtr = 0;
 QString ClientPacket::mSelfId = QString("qcProxy");
-quint64 ClientPacket::mPacketCount = 0;
+QAtomicInt ClientPacket::mPacketCount( 0 );
 
 ClientPacket::ClientPacket( const QDomElement &packetElement, QObject *parent ) : ErrorHandlerBase(parent)//, mClass(packetUndefined)
 {
-	mIdNum = ++mPacketCount;
+	mIdNum = nextIdNum();
 
 	if( mCommandFactoryPtr == 0 )
 	{
@@ -40,7 +40,7 @@ ClientPacket::ClientPacket( const QDomElement &packetElement, QObject *parent )
 
 ClientPacket::ClientPacket() : ErrorHandlerBase(0)//, mClass(packetUndefined)
 {
-	mIdNum = ++mPacketCount;
+	mIdNum = nextIdNum();
 	if( mCommandFactoryPtr == 0 )
 	{
 		error( QtWarningMsg, "mCommandFactoryPtr is null, can't create ClientPacket, you must set it before creating a packet", "ClientPacket()" );
@@ -50,7 +50,7 @@ ClientPacket::ClientPacket() : ErrorHandlerBase(0)//, mClass(packetUndefined)
 
 ClientPacket::ClientPacket( ClientCommandBase *clientCommand, QObject *parent ) : ErrorHandlerBase(parent)//, mClass(packetUndefined)
 {
-	mIdNum = ++mPacketCount;
+	mIdNum = nextIdNum();
 
 	if( mCommandFactoryPtr == 0 )
 	{
@@ -194,7 +194,12 @@ QDomDocument *ClientPacket::buildMarkup() const
 		{ packetElement.setAttribute( "re", mReplyTo ); }
 
 	for( int i=0; i<mCmdList.size(); ++i )
-		{ packetElement.appendChild( mCmdList.at(i)->getDomElement() ); }
+	{
+		QDomElement cmdElement = mCmdList.at(i)->getDomElement();
+		if( !mCmdList.at(i)->getDevice().isEmpty() )
+			{ cmdElement.setAttribute( "device", mCmdList.at(i)->getDevice() ); }
+		packetElement.appendChild( cmdElement );
+	}
 
 	packetMarkup->appendChild(packetElement);
 	return packetMarkup;
@@ -3,6 +3,7 @@
 
 #include "ErrorHandlerBase.h"
 #include <QDomElement>
+#include <QAtomicInt>
 #include "ClientCommandFactory.h"
 
 namespace QtuC
@@ -38,7 +39,7 @@ public:
 	  *	Count of all the packet that was instantiated from this class.
 	  *	@return Packet count.*/
 	static quint64 getPacketCount()
-		{ return mPacketCount; }
+		{ return (quint32)(int)mPacketCount; }
 
 	/** Get the ID number of the packet.
 	  *	@return The sequential number of the packet.*/
@@ -140,7 +141,12 @@ private:
 	  *	@return Pointer to the removed command object.*/
 	ClientCommandBase *removeCommand( int index );
 
-	static quint64 mPacketCount;	///< Packet count, used for generating packet id.
+	/** Get the ID number of a new packet.
+	  *	Packets are created in the connection worker threads too, so the count is atomic. It wraps at 32 bits.*/
+	static quint64 nextIdNum()
+		{ return (quint32)( mPacketCount.fetchAndAddOrdered(1) + 1 ); }
+
+	static QAtomicInt mPacketCount;	///< Packet count, used for generating packet id.
 	quint64 mIdNum;		///< Packet ID number. Initialized from packet count.
 	QString mReplyTo;	///< Reply-to packet id.
 	//packetClass_t mClass;		///< Class of the packet.
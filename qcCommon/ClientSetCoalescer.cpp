@@ -0,0 +1,101 @@
+#include "ClientSetCoalescer.h"
+#include "DeviceStateVariableBase.h"
+
+using namespace QtuC;
+
+ClientSetCoalescer::ClientSetCoalescer( int flushIntervalMs, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mLink(0),
+	mCoalescedCount(0)
+{
+	mFlushTimer = new QTimer(this);
+	connect( mFlushTimer, SIGNAL(timeout()), this, SLOT(handleFlushTimeout()) );
+	setFlushInterval( flushIntervalMs );
+}
+
+ClientSetCoalescer::~ClientSetCoalescer()
+{
+	clearPending();
+}
+
+void ClientSetCoalescer::setConnection( ClientConnectionManagerBase *link )
+{
+	if( link == mLink )
+		{ return; }
+	clearPending();
+	mFlushTimer->stop();
+	mLink = link;
+}
+
+void ClientSetCoalescer::setFlushInterval( int flushIntervalMs )
+{
+	if( flushIntervalMs < 0 )
+		{ flushIntervalMs = 0; }
+	mFlushTimer->setInterval( flushIntervalMs );
+	if( flushIntervalMs == 0 )
+		{ flush(); }
+}
+
+void ClientSetCoalescer::queueSet( DeviceStateVariableBase *stateVar )
+{
+	if( !mLink )
+	{
+		error( QtWarningMsg, QString("No proxy connection, set of %1 is dropped").arg(stateVar->getName()), "queueSet()" );
+		return;
+	}
+
+	QString key = stateVar->getHwInterface() + '/' + stateVar->getName();
+	ClientCommandDevice *cmd = new ClientCommandDevice( deviceCmdSet, stateVar );
+	ClientCommandDevice *held = mPending.value( key, 0 );
+	if( held )
+	{
+		delete held;
+		++mCoalescedCount;
+	}
+	else
+		{ mPendingOrder.append( key ); }
+	mPending.insert( key, cmd );
+
+	// the first set after a quiet period goes at once, the timer holds back the rest
+	if( !mFlushTimer->isActive() )
+	{
+		sendPending();
+		if( mFlushTimer->interval() > 0 )
+			{ mFlushTimer->start(); }
+	}
+}
+
+void ClientSetCoalescer::flush()
+{
+	sendPending();
+}
+
+void ClientSetCoalescer::handleFlushTimeout()
+{
+	if( mPending.isEmpty() )
+		{ mFlushTimer->stop(); }
+	else
+		{ sendPending(); }
+}
+
+void ClientSetCoalescer::sendPending()
+{
+	if( mPending.isEmpty() || !mLink )
+		{ return; }
+
+	QList<ClientCommandBase*> cmdList;
+	for( int i=0; i<mPendingOrder.size(); ++i )
+		{ cmdList.append( mPending.value( mPendingOrder.at(i) ) ); }
+	mPending.clear();
+	mPendingOrder.clear();
+
+	if( !mLink->sendCommands( cmdList ) )
+		{ error( QtWarningMsg, QString("Failed to send %1 set command(s)").arg(QString::number(cmdList.size())), "sendPending()" ); }
+}
+
+void ClientSetCoalescer::clearPending()
+{
+	qDeleteAll( mPending );
+	mPending.clear();
+	mPendingOrder.clear();
+}
@@ -0,0 +1,77 @@
+#ifndef CLIENTSETCOALESCER_H
+#define CLIENTSETCOALESCER_H
+
+#include "ErrorHandlerBase.h"
+#include "ClientConnectionManagerBase.h"
+#include "ClientCommandDevice.h"
+#include <QHash>
+#include <QStringList>
+#include <QTimer>
+
+namespace QtuC
+{
+
+class DeviceStateVariableBase;
+
+/** Coalesce the set commands a client sends to the proxy.
+ *	An interactive widget (e.g. a dragged slider) can change a variable hundreds of times a second, which would be a packet and a device command for every value.
+ *	The first set after a quiet period is sent at once, the following ones are held back until the flush interval elapses.
+ *	Only the latest value of a variable is kept, and all the held sets are sent in one packet, in the order their variables were first queued.
+ *	A flush interval of 0 sends every set at once, as without the coalescer.*/
+class ClientSetCoalescer : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Create.
+	  *	@param flushIntervalMs Minimum time between two packets of sets, in milliseconds.
+	  *	@param parent Parent object.*/
+	ClientSetCoalescer( int flushIntervalMs, QObject *parent = 0 );
+
+	~ClientSetCoalescer();
+
+	/** Set the connection to send the commands on.
+	  *	The held sets are dropped if the connection changes.
+	  *	@param link The connection, can be 0.*/
+	void setConnection( ClientConnectionManagerBase *link );
+
+	/** Set the minimum time between two packets of sets.
+	  *	@param flushIntervalMs Interval in milliseconds, 0 sends every set at once.*/
+	void setFlushInterval( int flushIntervalMs );
+
+	/// Get the number of sets replaced by a newer value before sending.
+	quint64 getCoalescedCount() const
+		{ return mCoalescedCount; }
+
+public slots:
+
+	/** Queue a set of the current value of a variable.
+	  *	@param stateVar The variable.*/
+	void queueSet( DeviceStateVariableBase *stateVar );
+
+	/** Send the held sets now.
+	  *	Call this before sending another device command, to keep the order.*/
+	void flush();
+
+private slots:
+
+	/// Send the held sets, or stop the timer if there are none.
+	void handleFlushTimeout();
+
+private:
+
+	/// Send the held sets and clear them.
+	void sendPending();
+
+	/// Delete the held sets without sending.
+	void clearPending();
+
+	ClientConnectionManagerBase *mLink;
+	QTimer *mFlushTimer;
+	QHash<QString,ClientCommandDevice*> mPending;	///< The held sets by `hwInterface/variable`.
+	QStringList mPendingOrder;	///< The keys of mPending in the order of queueing.
+	quint64 mCoalescedCount;
+};
+
+}	//QtuC::
+#endif //CLIENTSETCOALESCER_H
@@ -292,7 +292,17 @@ bool DeviceAPIParser::parseNodeStateVariable( const QDomElement &stateVariableEl
 		if( side == "device" || side == "user" )
 		{
 			if( !autoUpdateElement.text().isEmpty() )
-				{ params.insert( QString("autoUpdate-%1").arg(side), autoUpdateElement.text() ); }
+			{
+				params.insert( QString("autoUpdate-%1").arg(side), autoUpdateElement.text() );
+				if( side == "device" && autoUpdateElement.hasAttribute("mode") )
+				{
+					QString mode = autoUpdateElement.attribute("mode");
+					if( mode == "poll" || mode == "push" )
+						{ params.insert( "autoUpdate-device-mode", mode ); }
+					else
+						{ error( QtWarningMsg, QString("mode attribute is invalid on line %2 for variable %1, fallback to poll").arg(params.value("name"),QString::number(autoUpdateElement.lineNumber())), "parseNodeStateVariable()" ); }
+				}
+			}
 			else
 				{ error( QtWarningMsg, QString("autoUpdate is empty on line %2, for variable %1").arg(params.value("name"),QString::number(autoUpdateElement.lineNumber())), "parseNodeStateVariable()" ); }
 		}
@@ -17,6 +17,7 @@ DeviceCommandBase::DeviceCommandBase( const DeviceCommandBase &deviceCommand )
 	mHwInterface = deviceCommand.getHwInterface();
 	mVariable = deviceCommand.getVariable();
 	mArgs = QStringList( deviceCommand.getArgList() );
+	mTrace = deviceCommand.getTrace();
 }
 
 bool DeviceCommandBase::isValid() const
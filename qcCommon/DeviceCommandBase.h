@@ -2,6 +2,7 @@
 #define DEVICECOMMANDBASE_H
 
 #include <QStringList>
+#include "LatencyTrace.h"
 
 namespace QtuC
 {
@@ -47,6 +48,16 @@ public:
 	bool hasTimestamp() const
 		{ return mHasTimestamp; }
 
+	/** Get the latency trace of the command.
+	  *	@return The trace, empty if the command is not traced.*/
+	const LatencyTrace &getTrace() const
+		{ return mTrace; }
+
+	/** Get if the command is traced.
+	  *	@return True if the command has a non-empty latency trace, false otherwise.*/
+	bool hasTrace() const
+		{ return !mTrace.isEmpty(); }
+
 	/** Get the hardware interface of the command.
 	  *	@return Hardware interface name.*/
 	const QString getHwInterface() const
@@ -85,9 +96,28 @@ public:
 		{ mType = type; }
 
 	/** Set timestamp.
+	 *	hasTimestamp() will return true after this call.
 	 *	@param timestamp New value for the timestamp.*/
 	 void setTimestamp( quint64 const &timestamp )
-		{ mTimestamp = timestamp; }
+	 {
+		mTimestamp = timestamp;
+		mHasTimestamp = true;
+	 }
+
+	/** Set the latency trace.
+	  *	@param trace The trace, pass an empty trace to stop tracing the command.*/
+	void setTrace( const LatencyTrace &trace )
+		{ mTrace = trace; }
+
+	/** Stamp a stage in the latency trace.
+	  *	Does nothing if the command is not traced, so this can be called on any command.
+	  *	@param stage The stage to stamp.
+	  *	@param timeUs The stamp, see LatencyTrace::stamp().*/
+	void stampTrace( LatencyTrace::traceStage_t stage, quint64 timeUs = 0 )
+	{
+		if( hasTrace() )
+			{ mTrace.stamp( stage, timeUs ); }
+	}
 
 	/** Set hardware interface.
 	 *	You can only set a valid hardware interface.
@@ -150,6 +180,7 @@ protected:
 	QString mHwInterface;		///< Hardware interface name
 	QString mVariable;			///< Command variable.
 	QStringList mArgs;			///< Command arguments
+	LatencyTrace mTrace;		///< Latency trace, empty if the command is not traced.
 };
 
 }	//QtuC::
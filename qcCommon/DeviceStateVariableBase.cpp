@@ -163,7 +163,12 @@ bool DeviceStateVariableBase::setValue( bool newValue )
 	return true;
 }
 
-void DeviceStateVariableBase::updateFromSource(const QString &newValue)
+void DeviceStateVariableBase::updateFromSource( const QString &newValue, const qint64 &timestamp )
+{
+	updateFromSource( QVariant(newValue), timestamp );
+}
+
+void DeviceStateVariableBase::updateFromSource( const QVariant &newValue, const qint64 &timestamp )
 {
 	QVariant castNewRawVal( newValue );
 
@@ -171,7 +176,7 @@ void DeviceStateVariableBase::updateFromSource(const QString &newValue)
 	{
 		errorDetails_t errDetails;
 		errDetails.insert( "name", mName );
-		errDetails.insert( "newValue", newValue );
+		errDetails.insert( "newValue", newValue.toString() );
 		errDetails.insert( "to type",  QString(QVariant::typeToName(mType)) );
 		error( QtWarningMsg, "Failed to convert new value from source!", "updateFromSource()", errDetails );
 		return;
@@ -180,7 +185,7 @@ void DeviceStateVariableBase::updateFromSource(const QString &newValue)
 	if( mValue != castNewRawVal )
 	{
 		mValue = castNewRawVal;
-		mLastUpdate = QDateTime::currentMSecsSinceEpoch();
+		timestamp? mLastUpdate = timestamp : mLastUpdate = QDateTime::currentMSecsSinceEpoch();
 		emit updated();
 		emitValueChanged();
 	}
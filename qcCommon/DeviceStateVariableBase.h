@@ -131,8 +131,16 @@ public slots:
 	/** Updates the value of the variable received from the *source*.
 	 *	Call or connect this slot when you receive a set command from the *source*.
 	 *	This function updates the value, emits updated() and all valueChanged signals
-	 *	@param newValue The new value (string).*/
-	virtual void updateFromSource( const QString& newValue );
+	 *	@param newValue The new value (string).
+	 *	@param timestamp The UNIX timestamp of the update in milliseconds. If 0 or omitted, the current time is used.*/
+	virtual void updateFromSource( const QString& newValue, qint64 const &timestamp = 0 );
+
+	/** Updates the value of the variable received from the *source*, from a typed value.
+	 *	Same as updateFromSource( const QString& ), for sources that don't serialize the value (see SharedStateTable).
+	 *	The string version calls this, so it's enough to reimplement this one.
+	 *	@param newValue The new value, converted to the type of the variable.
+	 *	@param timestamp The UNIX timestamp of the update in milliseconds. If 0 or omitted, the current time is used.*/
+	virtual void updateFromSource( const QVariant& newValue, qint64 const &timestamp = 0 );
 
 protected slots:
 
@@ -0,0 +1,75 @@
+#include "LatencyHistogram.h"
+
+using namespace QtuC;
+
+LatencyHistogram::LatencyHistogram()
+{
+	clear();
+}
+
+void LatencyHistogram::add( quint64 valueUs )
+{
+	++mBuckets[ bucketOf(valueUs) ];
+	++mCount;
+	if( valueUs > mMax )
+		{ mMax = valueUs; }
+}
+
+void LatencyHistogram::clear()
+{
+	for( int i=0; i<mBucketCount; ++i )
+		{ mBuckets[i] = 0; }
+	mCount = 0;
+	mMax = 0;
+}
+
+quint64 LatencyHistogram::getPercentile( double percent ) const
+{
+	if( mCount == 0 )
+		{ return 0; }
+
+	quint64 rank = (quint64)( percent / 100.0 * mCount + 0.5 );
+	if( rank < 1 )
+		{ rank = 1; }
+
+	quint64 cumulative = 0;
+	for( int i=0; i<mBucketCount; ++i )
+	{
+		cumulative += mBuckets[i];
+		if( cumulative >= rank )
+		{
+			// the bucket of the maximum is known better than its lower bound
+			quint64 lowerBound = bucketLowerBound(i);
+			return ( bucketOf(mMax) == i ) ? mMax : lowerBound;
+		}
+	}
+	return mMax;
+}
+
+int LatencyHistogram::bucketOf( quint64 valueUs )
+{
+	const quint64 subBucketCount = 1 << mSubBucketBits;
+	if( valueUs < subBucketCount )
+		{ return (int)valueUs; }
+
+	// position of the most significant bit
+	int exponent = mSubBucketBits;
+	while( exponent < 63 && (valueUs >> (exponent+1)) )
+		{ ++exponent; }
+	if( exponent > mMaxExponent )
+		{ return mBucketCount-1; }
+
+	int subBucket = (int)( (valueUs >> (exponent-mSubBucketBits)) - subBucketCount );
+	return (int)subBucketCount * (exponent-mSubBucketBits+1) + subBucket;
+}
+
+quint64 LatencyHistogram::bucketLowerBound( int bucket )
+{
+	const int subBucketCount = 1 << mSubBucketBits;
+	if( bucket < subBucketCount )
+		{ return bucket; }
+
+	int exponent = bucket / subBucketCount + mSubBucketBits - 1;
+	quint64 subBucket = bucket % subBucketCount;
+	return ( subBucketCount + subBucket ) << (exponent-mSubBucketBits);
+}
@@ -0,0 +1,62 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QtGlobal>
+
+namespace QtuC
+{
+
+/** Histogram of latencies, in microseconds.
+ *	Values are counted in logarithmic buckets: below 16us every value has its own bucket, above that every power of two is split into 16 buckets,
+ *	so a percentile is accurate within 1/16 of its value. Adding a value is a few shifts and an increment, memory is fixed, so it is cheap enough to be always on.
+ *	The maximum is tracked exactly.*/
+class LatencyHistogram
+{
+public:
+
+	/** Create an empty histogram.*/
+	LatencyHistogram();
+
+	/** Add a value.
+	  *	@param valueUs The value in microseconds. Values over ~12 days fall in the last bucket.*/
+	void add( quint64 valueUs );
+
+	/** Clear all values.*/
+	void clear();
+
+	/// Get the number of values added.
+	quint64 getCount() const
+		{ return mCount; }
+
+	/// Get the maximum value, 0 if empty.
+	quint64 getMax() const
+		{ return mMax; }
+
+	/** Get a percentile.
+	  *	@param percent The percentile, between 0 and 100.
+	  *	@return The lower bound of the bucket containing the percentile, in microseconds, 0 if empty.*/
+	quint64 getPercentile( double percent ) const;
+
+private:
+
+	/** Get the bucket of a value.
+	  *	@param valueUs The value.
+	  *	@return The bucket index.*/
+	static int bucketOf( quint64 valueUs );
+
+	/** Get the smallest value of a bucket.
+	  *	@param bucket The bucket index.
+	  *	@return The lower bound of the bucket.*/
+	static quint64 bucketLowerBound( int bucket );
+
+	static const int mSubBucketBits = 4;	///< The power of two ranges are split into 2^mSubBucketBits buckets.
+	static const int mMaxExponent = 40;		///< Values of 2^mMaxExponent us and more fall in the last bucket.
+	static const int mBucketCount = (1<<mSubBucketBits) * (mMaxExponent-mSubBucketBits+2);
+
+	quint32 mBuckets[mBucketCount];
+	quint64 mCount;
+	quint64 mMax;
+};
+
+}	//QtuC::
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,123 @@
+#include "LatencyMonitor.h"
+#include <QStringList>
+
+using namespace QtuC;
+
+LatencyMonitor *LatencyMonitor::mInstance = 0;
+
+LatencyMonitor::LatencyMonitor( QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mSampleInterval(0),
+	mSampleCounter(0),
+	mTraceCount(0),
+	mReportedTraceCount(0)
+{
+	mReportTimer = new QTimer(this);
+	connect( mReportTimer, SIGNAL(timeout()), this, SLOT(printReport()) );
+}
+
+LatencyMonitor::~LatencyMonitor()
+{
+	if( mInstance == this )
+		{ mInstance = 0; }
+}
+
+LatencyMonitor *LatencyMonitor::instance( QObject *parent )
+{
+	if( !mInstance )
+		{ mInstance = new LatencyMonitor(parent); }
+	return mInstance;
+}
+
+void LatencyMonitor::setSampleInterval( quint32 interval )
+{
+	mSampleInterval = interval;
+	mSampleCounter = 0;
+	if( mSampleInterval )
+		{ debug( debugLevelVerbose, QString("Tracing latency of every %1. device command").arg(QString::number(mSampleInterval)), "setSampleInterval()" ); }
+}
+
+void LatencyMonitor::setReportInterval( int intervalMs )
+{
+	if( intervalMs > 0 )
+		{ mReportTimer->start( intervalMs ); }
+	else
+		{ mReportTimer->stop(); }
+}
+
+void LatencyMonitor::record( const LatencyTrace &trace )
+{
+	if( trace.isEmpty() )
+		{ return; }
+
+	quint64 first = 0;
+	quint64 last = 0;
+	for( int i=0; i<LatencyTrace::traceStageCount; ++i )
+	{
+		quint64 stamp = trace.getStamp( (LatencyTrace::traceStage_t)i );
+		if( !stamp )
+			{ continue; }
+
+		if( i > 0 )
+		{
+			quint64 prevStamp = trace.getStamp( (LatencyTrace::traceStage_t)(i-1) );
+			if( prevStamp )
+				{ mHops[i].add( stamp > prevStamp ? stamp - prevStamp : 0 ); }
+		}
+		if( !first )
+			{ first = stamp; }
+		last = stamp;
+	}
+	mEndToEnd.add( last > first ? last - first : 0 );
+	++mTraceCount;
+}
+
+const LatencyHistogram &LatencyMonitor::getHop( LatencyTrace::traceStage_t toStage ) const
+{
+	if( toStage <= 0 || toStage >= LatencyTrace::traceStageCount )
+		{ return mHops[0]; }
+	return mHops[toStage];
+}
+
+const QString LatencyMonitor::getReport() const
+{
+	if( !mTraceCount )
+		{ return QString(); }
+
+	QStringList lines;
+	for( int i=1; i<LatencyTrace::traceStageCount; ++i )
+	{
+		if( !mHops[i].getCount() )
+			{ continue; }
+		lines.append( QString("%1->%2: n=%3 p50=%4us p99=%5us max=%6us").arg(
+						  LatencyTrace::stageToString( (LatencyTrace::traceStage_t)(i-1) ),
+						  LatencyTrace::stageToString( (LatencyTrace::traceStage_t)i ),
+						  QString::number( mHops[i].getCount() ),
+						  QString::number( mHops[i].getPercentile(50) ),
+						  QString::number( mHops[i].getPercentile(99) ),
+						  QString::number( mHops[i].getMax() ) ) );
+	}
+	lines.append( QString("total: n=%1 p50=%2us p99=%3us max=%4us").arg(
+					  QString::number( mEndToEnd.getCount() ),
+					  QString::number( mEndToEnd.getPercentile(50) ),
+					  QString::number( mEndToEnd.getPercentile(99) ),
+					  QString::number( mEndToEnd.getMax() ) ) );
+	return lines.join("\n");
+}
+
+void LatencyMonitor::clear()
+{
+	for( int i=0; i<LatencyTrace::traceStageCount; ++i )
+		{ mHops[i].clear(); }
+	mEndToEnd.clear();
+	mTraceCount = 0;
+	mReportedTraceCount = 0;
+}
+
+void LatencyMonitor::printReport()
+{
+	if( mTraceCount == mReportedTraceCount )
+		{ return; }
+	mReportedTraceCount = mTraceCount;
+	debug( debugLevelInfo, QString("Latency of %1 traced commands:\n%2").arg( QString::number(mTraceCount), getReport() ), "printReport()" );
+}
@@ -0,0 +1,94 @@
+#ifndef LATENCYMONITOR_H
+#define LATENCYMONITOR_H
+
+#include "ErrorHandlerBase.h"
+#include "LatencyTrace.h"
+#include "LatencyHistogram.h"
+#include <QTimer>
+
+namespace QtuC
+{
+
+/** Collect latency traces and keep a histogram for each hop of the device -> client path.
+ *	A hop is the time between two consecutive stages of LatencyTrace, it is only counted if both stages are stamped.
+ *	The end-to-end latency (first to last stamp of the trace) is kept as well.
+ *	The proxy records the traces when they are sent to the clients, the clients record them when the value is rendered, so each side reports the hops it has seen.
+ *	Hops between processes (send -> decode, and device -> rx) rely on synchronized wall clocks, negative values are counted as 0.
+ *
+ *	This is a singleton, use instance() to get it.
+ *	The proxy decides which device commands to trace, see setSampleInterval() and sample().
+ *	If a report interval is set, the report is printed periodically (as info debug message), when there are new samples.*/
+class LatencyMonitor : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Get the instance.
+	  *	@param parent On first call, the object will be created, so a parent argument should be passed. On subsequent calls, you can omit it.
+	  *	@return The LatencyMonitor instance.*/
+	static LatencyMonitor *instance( QObject *parent = 0 );
+
+	~LatencyMonitor();
+
+	/** Set how often to trace commands.
+	  *	@param interval Trace every interval-th command, 0 disables tracing.*/
+	void setSampleInterval( quint32 interval );
+
+	/// Get the sample interval, 0 if tracing is disabled.
+	quint32 getSampleInterval() const
+		{ return mSampleInterval; }
+
+	/** Decide whether to trace the next command.
+	  *	Call once for every command that may be traced.
+	  *	@return True if the command should be traced, false otherwise.*/
+	bool sample()
+		{ return mSampleInterval && ( ++mSampleCounter % mSampleInterval == 0 ); }
+
+	/** Set the interval of the periodic report.
+	  *	@param intervalMs Report interval in milliseconds, 0 disables the periodic report.*/
+	void setReportInterval( int intervalMs );
+
+	/** Add the hops of a trace to the histograms.
+	  *	Empty traces are ignored.
+	  *	@param trace The trace.*/
+	void record( const LatencyTrace &trace );
+
+	/// Get the number of recorded traces.
+	quint64 getTraceCount() const
+		{ return mTraceCount; }
+
+	/** Get the histogram of a hop.
+	  *	@param toStage The stage at the end of the hop, the hop starts at the previous stage.
+	  *	@return The histogram of the hop.*/
+	const LatencyHistogram &getHop( LatencyTrace::traceStage_t toStage ) const;
+
+	/** Get the report of all hops.
+	  *	One line for each hop that has samples, and the end-to-end line: sample count, p50, p99 and max in microseconds.
+	  *	@return The report, empty if nothing has been recorded.*/
+	const QString getReport() const;
+
+	/** Clear all histograms.*/
+	void clear();
+
+private slots:
+
+	/// Print the report, if there are new samples.
+	void printReport();
+
+private:
+
+	/** Private constructor, use instance().*/
+	explicit LatencyMonitor( QObject *parent = 0 );
+
+	static LatencyMonitor *mInstance;
+	LatencyHistogram mHops[LatencyTrace::traceStageCount];	///< Histogram of the hops, indexed by the end stage. Index 0 is unused.
+	LatencyHistogram mEndToEnd;
+	quint32 mSampleInterval;
+	quint32 mSampleCounter;
+	quint64 mTraceCount;
+	quint64 mReportedTraceCount;	///< mTraceCount at the last periodic report.
+	QTimer *mReportTimer;
+};
+
+}	//QtuC::
+#endif // LATENCYMONITOR_H
@@ -0,0 +1,97 @@
+#include "LatencyTrace.h"
+#include <QStringList>
+#include <QDateTime>
+
+using namespace QtuC;
+
+LatencyTrace::traceClock_t LatencyTrace::mClock;
+
+LatencyTrace::traceClock_t::traceClock_t() :
+	baseUs( (quint64)QDateTime::currentMSecsSinceEpoch() * 1000 )
+{
+	timer.start();
+}
+
+LatencyTrace::LatencyTrace()
+{
+	clear();
+}
+
+bool LatencyTrace::isEmpty() const
+{
+	for( int i=0; i<traceStageCount; ++i )
+	{
+		if( mStamps[i] )
+			{ return false; }
+	}
+	return true;
+}
+
+quint64 LatencyTrace::getStamp( traceStage_t stage ) const
+{
+	if( stage < 0 || stage >= traceStageCount )
+		{ return 0; }
+	return mStamps[stage];
+}
+
+void LatencyTrace::stamp( traceStage_t stage, quint64 timeUs )
+{
+	if( stage < 0 || stage >= traceStageCount )
+		{ return; }
+	mStamps[stage] = timeUs ? timeUs : now();
+}
+
+void LatencyTrace::clear()
+{
+	for( int i=0; i<traceStageCount; ++i )
+		{ mStamps[i] = 0; }
+}
+
+const QString LatencyTrace::toString() const
+{
+	if( isEmpty() )
+		{ return QString(); }
+
+	QStringList stampList;
+	for( int i=0; i<traceStageCount; ++i )
+		{ stampList.append( mStamps[i] ? QString::number( mStamps[i], 16 ) : QString() ); }
+	return stampList.join(",");
+}
+
+LatencyTrace LatencyTrace::fromString( const QString &traceStr )
+{
+	LatencyTrace trace;
+	QStringList stampList = traceStr.split(',');
+	// stages may be added later, parse the known ones
+	for( int i=0; i<stampList.size() && i<traceStageCount; ++i )
+	{
+		if( stampList.at(i).isEmpty() )
+			{ continue; }
+		bool ok;
+		quint64 stampUs = stampList.at(i).toULongLong( &ok, 16 );
+		if( !ok )
+			{ return LatencyTrace(); }
+		trace.mStamps[i] = stampUs;
+	}
+	return trace;
+}
+
+quint64 LatencyTrace::now()
+{
+	return mClock.baseUs + mClock.timer.nsecsElapsed() / 1000;
+}
+
+const QString LatencyTrace::stageToString( traceStage_t stage )
+{
+	switch( stage )
+	{
+		case traceStageDevice: return QString("device");
+		case traceStageRx: return QString("rx");
+		case traceStageApi: return QString("api");
+		case traceStageFeed: return QString("feed");
+		case traceStageSend: return QString("send");
+		case traceStageDecode: return QString("decode");
+		case traceStageRender: return QString("render");
+		default: return QString("unknown");
+	}
+}
@@ -0,0 +1,95 @@
+#ifndef LATENCYTRACE_H
+#define LATENCYTRACE_H
+
+#include <QString>
+#include <QElapsedTimer>
+
+namespace QtuC
+{
+
+/** Latency trace of a device command.
+ *	A trace holds a time stamp for each stage a value passes on its way from the device to the screen of a client.
+ *	Stamps are microseconds since the UNIX epoch (see now()), 0 means the stage has not been stamped.
+ *	An empty trace (no stamps at all) means the command is not traced, which is the normal case: the proxy only traces a sample of the device commands.
+ *	Traces are carried in the `trace` attribute of device client commands, see toString().*/
+class LatencyTrace
+{
+public:
+
+	/** Stages of the device -> client path, in order.
+	  *	* `traceStageDevice`: Creation on the device, from the device timestamp (millisecond resolution, relative to the estimated device startup time).
+	  *	* `traceStageRx`: A complete command line was received by the device connector of the proxy.
+	  *	* `traceStageApi`: DeviceAPI has processed the command (state variable updated).
+	  *	* `traceStageFeed`: The value was put in a client command by the proxy (subscription feed or passthrough).
+	  *	* `traceStageSend`: The packet was written to the client socket.
+	  *	* `traceStageDecode`: The client has decoded the packet.
+	  *	* `traceStageRender`: The client has updated its widget or plot data with the value.*/
+	enum traceStage_t
+	{
+		traceStageDevice,
+		traceStageRx,
+		traceStageApi,
+		traceStageFeed,
+		traceStageSend,
+		traceStageDecode,
+		traceStageRender,
+		traceStageCount		///< Number of stages, not a stage.
+	};
+
+	/** Create an empty trace.*/
+	LatencyTrace();
+
+	/** Get whether the trace has no stamps.
+	  *	@return True if no stage has been stamped, false otherwise.*/
+	bool isEmpty() const;
+
+	/** Get the stamp of a stage.
+	  *	@param stage The stage.
+	  *	@return The stamp in microseconds since the UNIX epoch, 0 if the stage has not been stamped.*/
+	quint64 getStamp( traceStage_t stage ) const;
+
+	/** Stamp a stage.
+	  *	@param stage The stage to stamp.
+	  *	@param timeUs The stamp, microseconds since the UNIX epoch. If 0 or omitted, now() is used.*/
+	void stamp( traceStage_t stage, quint64 timeUs = 0 );
+
+	/** Remove all stamps.*/
+	void clear();
+
+	/** Get the wire format of the trace.
+	  *	The stamps of all stages in order, as hexadecimal numbers without prefix, separated by commas. Stages not stamped are left empty.
+	  *	@return The trace string, empty if the trace is empty.*/
+	const QString toString() const;
+
+	/** Parse a trace string.
+	  *	@param traceStr The string, as built by toString().
+	  *	@return The parsed trace, an empty trace if the string is invalid.*/
+	static LatencyTrace fromString( const QString &traceStr );
+
+	/** Get the current time for trace stamps.
+	  *	Microseconds since the UNIX epoch, measured with a monotonic clock from the start of the process. This keeps the stages within one process precise,
+	  *	while stamps of different processes on synchronized hosts are comparable within the millisecond resolution of the wall clock.
+	  *	@return The current time in microseconds since the UNIX epoch.*/
+	static quint64 now();
+
+	/** Get the name of a stage.
+	  *	@param stage The stage.
+	  *	@return The name of the stage.*/
+	static const QString stageToString( traceStage_t stage );
+
+private:
+	/** The clock of now().
+	  *	The static instance is started during static initialization, before any thread can call now().*/
+	struct traceClock_t
+	{
+		traceClock_t();
+		quint64 baseUs;			///< Wall clock at the start, microseconds since the UNIX epoch.
+		QElapsedTimer timer;	///< Monotonic time since the start.
+	};
+
+	static traceClock_t mClock;
+	quint64 mStamps[traceStageCount];	///< Stamps of the stages, microseconds since the UNIX epoch.
+};
+
+}	//QtuC::
+#endif // LATENCYTRACE_H
@@ -0,0 +1,101 @@
+#include "SharedStateClient.h"
+#include "StateManagerBase.h"
+#include "DeviceStateVariableBase.h"
+#include <QLocalSocket>
+#include <QHostAddress>
+
+using namespace QtuC;
+
+SharedStateClient::SharedStateClient( StateManagerBase *stateManager, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mStateManager(stateManager),
+	mTable(0),
+	mCursor(0)
+{
+	mNotifySocket = new QLocalSocket(this);
+	connect( mNotifySocket, SIGNAL(readyRead()), this, SLOT(readUpdates()) );
+	connect( mNotifySocket, SIGNAL(disconnected()), this, SLOT(handleDisconnected()) );
+}
+
+bool SharedStateClient::attach( const QString &key, const QString &apiString )
+{
+	detach();
+	if( key.isEmpty() )
+		{ return false; }
+
+	mTable = new SharedStateTable( key, this );
+	if( !mTable->attach( mStateManager->getVarList().size(), SharedStateTable::apiHash( apiString ) ) )
+	{
+		detach();
+		return false;
+	}
+
+	mNotifySocket->connectToServer( key );
+	if( !mNotifySocket->waitForConnected( 1000 ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "error", mNotifySocket->errorString() );
+		error( QtWarningMsg, QString("Failed to connect to the shared state notifications of the proxy (%1)").arg(key), "attach()", errDet );
+		detach();
+		return false;
+	}
+
+	// the updates are read from here on, the values written so far are read at once
+	mCursor = mTable->getWriteIndex();
+	int varCount = mStateManager->getVarList().size();
+	for( int id=0; id<varCount; ++id )
+		{ updateVariable( id ); }
+
+	debug( debugLevelInfo, QString("Reading %1 variables from the shared memory of the proxy").arg(varCount), "attach()" );
+	return true;
+}
+
+void SharedStateClient::detach()
+{
+	mNotifySocket->blockSignals( true );
+	mNotifySocket->abort();
+	mNotifySocket->blockSignals( false );
+	if( mTable )
+	{
+		mTable->detach();
+		mTable->deleteLater();
+		mTable = 0;
+	}
+}
+
+bool SharedStateClient::isLocalHost( const QString &host )
+{
+	if( host.compare( "localhost", Qt::CaseInsensitive ) == 0 )
+		{ return true; }
+	QHostAddress address( host );
+	return ( address == QHostAddress::LocalHost || address == QHostAddress::LocalHostIPv6 );
+}
+
+void SharedStateClient::readUpdates()
+{
+	// one byte per notification, the content doesn't matter
+	mNotifySocket->readAll();
+	if( !isAttached() )
+		{ return; }
+
+	QList<int> idList = mTable->takeUpdates( mCursor );
+	for( int i=0; i<idList.size(); ++i )
+		{ updateVariable( idList.at(i) ); }
+}
+
+void SharedStateClient::handleDisconnected()
+{
+	debug( debugLevelInfo, "Proxy closed the shared state notifications", "handleDisconnected()" );
+	detach();
+	emit detached();
+}
+
+void SharedStateClient::updateVariable( int id )
+{
+	DeviceStateVariableBase *var = mStateManager->getVar( id );
+	QVariant value;
+	if( !var || !mTable->read( id, value ) )
+		{ return; }
+	if( value.isValid() )
+		{ var->updateFromSource( value ); }
+}
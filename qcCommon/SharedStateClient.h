@@ -0,0 +1,72 @@
+#ifndef SHAREDSTATECLIENT_H
+#define SHAREDSTATECLIENT_H
+
+#include "ErrorHandlerBase.h"
+#include "SharedStateTable.h"
+
+class QLocalSocket;
+
+namespace QtuC
+{
+
+class StateManagerBase;
+
+/** Read the values of the state variables from the shared memory of a proxy on the same host.
+  *	The client side of SharedStateServer: attach() to the table advertised by the proxy in the handshake (`sharedState` info),
+  *	then the variables of the state manager are updated from the table on every notification of the proxy, without subscriptions and without decoding packets.
+  *	The TCP connection is still used for the deviceAPI, the sets and the calls.*/
+class SharedStateClient : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Create, without attaching.
+	  *	@param stateManager The variables to update, its ids must be the ids of the proxy (the order of the deviceAPI).
+	  *	@param parent Parent object.*/
+	SharedStateClient( StateManagerBase *stateManager, QObject *parent = 0 );
+
+	/** Attach to the shared memory of the proxy, and read all the values.
+	  *	@param key The key advertised by the proxy.
+	  *	@param apiString The deviceAPI string received from the proxy, the variables of the state manager must be registered from it.
+	  *	@return True on success, false if the proxy is not on this host, or shares an other deviceAPI.*/
+	bool attach( const QString &key, const QString &apiString );
+
+	/// Detach from the shared memory, e.g. before the variables are destroyed.
+	void detach();
+
+	/// Get whether the values are read from the shared memory.
+	bool isAttached() const
+		{ return mTable && mTable->isAttached(); }
+
+	/** Check whether a host is this host, only then the proxy can share memory with the client.
+	  *	@param host The host name or address of the proxy.
+	  *	@return True if the host is the loopback address or localhost.*/
+	static bool isLocalHost( const QString &host );
+
+signals:
+
+	/// Emitted when the proxy closed the notification socket, the client is detached.
+	void detached();
+
+private slots:
+
+	/// Update the variables changed since the last notification.
+	void readUpdates();
+
+	/// Handle the proxy closing the notification socket.
+	void handleDisconnected();
+
+private:
+
+	/** Update a variable from the table.
+	  *	@param id Id of the variable.*/
+	void updateVariable( int id );
+
+	StateManagerBase *mStateManager;
+	SharedStateTable *mTable;
+	QLocalSocket *mNotifySocket;
+	quint32 mCursor;	///< Position in the ring of updates of the table.
+};
+
+}	//QtuC::
+#endif // SHAREDSTATECLIENT_H
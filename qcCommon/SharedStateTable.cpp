@@ -0,0 +1,206 @@
+#include "SharedStateTable.h"
+#include <QSet>
+#include <cstring>
+
+using namespace QtuC;
+
+SharedStateTable::SharedStateTable( const QString &key, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mVarCount(0),
+	mOverrunCount(0)
+{
+	mMemory = new QSharedMemory( key, this );
+}
+
+SharedStateTable::~SharedStateTable()
+{
+	detach();
+}
+
+bool SharedStateTable::create( int varCount, quint32 apiHash )
+{
+	detach();
+	if( !mMemory->create( memorySize( varCount ) ) )
+	{
+		// left by a crashed writer: on Unix, the segment is released when the last process detaches
+		if( mMemory->error() == QSharedMemory::AlreadyExists && mMemory->attach() )
+		{
+			mMemory->detach();
+			mMemory->create( memorySize( varCount ) );
+		}
+		if( !mMemory->isAttached() )
+		{
+			errorDetails_t errDet;
+			errDet.insert( "key", mMemory->key() );
+			errDet.insert( "error", mMemory->errorString() );
+			error( QtWarningMsg, "Failed to create shared memory", "create()", errDet );
+			return false;
+		}
+	}
+
+	mVarCount = varCount;
+	memset( mMemory->data(), 0, mMemory->size() );
+	header_t *head = header();
+	head->magic = MMagic;
+	head->version = MVersion;
+	head->apiHash = apiHash;
+	head->varCount = varCount;
+	head->ringSize = MRingSize;
+	for( int id=0; id<varCount; ++id )
+		{ slot(id)->type = QVariant::Invalid; }
+	return true;
+}
+
+bool SharedStateTable::attach( int varCount, quint32 apiHash )
+{
+	detach();
+	// the atomic reads of the sequence numbers need write access
+	if( !mMemory->attach( QSharedMemory::ReadWrite ) )
+	{
+		debug( debugLevelVerbose, QString("No shared memory to attach (%1)").arg(mMemory->errorString()), "attach()" );
+		return false;
+	}
+
+	header_t *head = header();
+	if( mMemory->size() < (int)sizeof(header_t) || head->magic != MMagic || head->version != MVersion || head->ringSize != MRingSize )
+	{
+		error( QtWarningMsg, "Shared memory has an unknown layout", "attach()" );
+		detach();
+		return false;
+	}
+	if( head->apiHash != apiHash || head->varCount != varCount || mMemory->size() < memorySize( varCount ) )
+	{
+		error( QtWarningMsg, "Shared memory is for an other deviceAPI", "attach()" );
+		detach();
+		return false;
+	}
+	mVarCount = varCount;
+	return true;
+}
+
+void SharedStateTable::detach()
+{
+	if( mMemory->isAttached() )
+		{ mMemory->detach(); }
+	mVarCount = 0;
+}
+
+void SharedStateTable::write( int id, const QVariant &value, qint64 updateTime )
+{
+	if( id < 0 || id >= mVarCount )
+		{ return; }
+
+	slot_t *varSlot = slot(id);
+	int seq = varSlot->seq;
+	varSlot->seq.fetchAndStoreOrdered( seq + 1 );
+
+	varSlot->updateTime = updateTime;
+	varSlot->textLength = 0;
+	varSlot->type = value.type();
+	switch( value.type() )
+	{
+		case QVariant::Bool: varSlot->number.i = value.toBool(); break;
+		case QVariant::Int:
+		case QVariant::LongLong: varSlot->number.i = value.toLongLong(); break;
+		case QVariant::UInt:
+		case QVariant::ULongLong: varSlot->number.u = value.toULongLong(); break;
+		case QVariant::Double: varSlot->number.d = value.toDouble(); break;
+		case QVariant::Invalid: break;
+		default:
+		{
+			QByteArray text = value.toString().toUtf8().left( MTextSize );
+			memcpy( varSlot->text, text.constData(), text.size() );
+			varSlot->textLength = text.size();
+			varSlot->type = QVariant::String;
+		}
+	}
+
+	varSlot->seq.fetchAndStoreRelease( seq + 2 );
+
+	header_t *head = header();
+	int writeIndex = head->ringWriteIndex;
+	ring()[ writeIndex & (MRingSize-1) ] = id;
+	head->ringWriteIndex.fetchAndStoreRelease( writeIndex + 1 );
+}
+
+bool SharedStateTable::read( int id, QVariant &value, qint64 *updateTime )
+{
+	if( id < 0 || id >= mVarCount )
+		{ return false; }
+
+	slot_t *varSlot = slot(id);
+	for( int i=0; i<MReadRetries; ++i )
+	{
+		int seqBefore = varSlot->seq.fetchAndAddOrdered(0);
+		if( seqBefore & 1 )
+			{ continue; }
+
+		qint32 type = varSlot->type;
+		qint64 time = varSlot->updateTime;
+		qint64 number = varSlot->number.i;
+		qint32 textLength = qBound( 0, (int)varSlot->textLength, MTextSize );
+		QByteArray text( varSlot->text, textLength );
+
+		if( varSlot->seq.fetchAndAddOrdered(0) != seqBefore )
+			{ continue; }
+
+		switch( type )
+		{
+			case QVariant::Bool: value = QVariant( number != 0 ); break;
+			case QVariant::Int: value = QVariant( (int)number ); break;
+			case QVariant::LongLong: value = QVariant( number ); break;
+			case QVariant::UInt: value = QVariant( (uint)number ); break;
+			case QVariant::ULongLong: value = QVariant( (quint64)number ); break;
+			case QVariant::Double:
+			{
+				double d;
+				memcpy( &d, &number, sizeof(d) );
+				value = QVariant( d );
+			}
+				break;
+			case QVariant::Invalid: value = QVariant(); break;
+			default: value = QVariant( QString::fromUtf8( text ) );
+		}
+		if( updateTime )
+			{ *updateTime = time; }
+		return true;
+	}
+	return false;
+}
+
+quint32 SharedStateTable::getWriteIndex()
+{
+	return (quint32)header()->ringWriteIndex.fetchAndAddOrdered(0);
+}
+
+QList<int> SharedStateTable::takeUpdates( quint32 &cursor )
+{
+	QList<int> idList;
+	quint32 writeIndex = getWriteIndex();
+	bool overrun = ( writeIndex - cursor > (quint32)MRingSize );
+	if( !overrun )
+	{
+		QSet<int> seen;
+		for( quint32 i=cursor; i!=writeIndex; ++i )
+		{
+			int id = ring()[ i & (MRingSize-1) ];
+			if( !seen.contains( id ) )
+			{
+				seen.insert( id );
+				idList.append( id );
+			}
+		}
+		// the writer may have overwritten the entries while they were read
+		overrun = ( getWriteIndex() - cursor > (quint32)MRingSize );
+	}
+	cursor = writeIndex;
+
+	if( overrun )
+	{
+		++mOverrunCount;
+		idList.clear();
+		for( int id=0; id<mVarCount; ++id )
+			{ idList.append( id ); }
+	}
+	return idList;
+}
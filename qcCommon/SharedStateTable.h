@@ -0,0 +1,150 @@
+#ifndef SHAREDSTATETABLE_H
+#define SHAREDSTATETABLE_H
+
+#include "ErrorHandlerBase.h"
+#include <QSharedMemory>
+#include <QVariant>
+#include <QAtomicInt>
+#include <QHash>
+
+namespace QtuC
+{
+
+/** The latest values of the state variables in shared memory, for the clients running on the same host as the proxy.
+  *	The proxy creates the table (create()) and writes the values (write()), the clients attach to it (attach()) and read the values (read()) without any serialization.
+  *	The memory holds a header, a slot for each variable, and a ring of updates:
+  *	  * The slots are indexed by the id of the variable (see StateManagerBase::getVar(int)), which is the same in the proxy and the clients as both take the order of the deviceAPI.
+  *	    A slot holds the value as a number, or as UTF-8 text of at most MTextSize bytes (longer strings are truncated), and the time of the update.
+  *	  * The ring holds the ids of the updated variables, so a client only reads the slots updated since its last read (see takeUpdates()).
+  *	    If a client falls behind more than the size of the ring, it reads all slots.
+  *
+  *	There is a single writer and no lock: every slot has a sequence number, odd while the writer updates the slot. A reader copies the slot, and retries if the sequence changed meanwhile.
+  *	The header has a hash of the deviceAPI string (see apiHash()), a client only attaches if its deviceAPI is the same.*/
+class SharedStateTable : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Create, without creating or attaching the shared memory.
+	  *	@param key The key of the shared memory, the same in the proxy and the clients.
+	  *	@param parent Parent object.*/
+	SharedStateTable( const QString &key, QObject *parent = 0 );
+
+	~SharedStateTable();
+
+	/** Create the shared memory, as the writer.
+	  *	A segment left by a crashed writer is released first (on Unix).
+	  *	@param varCount The number of variables.
+	  *	@param apiHash Hash of the deviceAPI string, see apiHash().
+	  *	@return True on success, false otherwise.*/
+	bool create( int varCount, quint32 apiHash );
+
+	/** Attach to the shared memory, as a reader.
+	  *	@param varCount The number of variables of the reader, must be the same as in the table.
+	  *	@param apiHash Hash of the deviceAPI string of the reader, must be the same as in the table.
+	  *	@return True on success, false if there is no table or it is for an other deviceAPI.*/
+	bool attach( int varCount, quint32 apiHash );
+
+	/// Detach from the shared memory, the writer destroys it if no reader is attached.
+	void detach();
+
+	/// Get whether the shared memory is created or attached.
+	bool isAttached() const
+		{ return mMemory->isAttached(); }
+
+	/// Get the key of the shared memory.
+	QString getKey() const
+		{ return mMemory->key(); }
+
+	/** Write the value of a variable, as the writer.
+	  *	@param id Id of the variable.
+	  *	@param value The value, must be a bool, an integer, a double or a string.
+	  *	@param updateTime Time of the update in milliseconds since the epoch.*/
+	void write( int id, const QVariant &value, qint64 updateTime );
+
+	/** Read the value of a variable, as a reader.
+	  *	@param id Id of the variable.
+	  *	@param value The value is copied here, an invalid QVariant if the variable has no value yet.
+	  *	@param updateTime If not null, the time of the update is copied here.
+	  *	@return True on success, false if the id is invalid or the writer was updating the slot at every try.*/
+	bool read( int id, QVariant &value, qint64 *updateTime = 0 );
+
+	/** Get the position of the writer in the ring of updates, as a reader.
+	  *	Use this as the first cursor for takeUpdates().
+	  *	@return The number of updates written since the table was created.*/
+	quint32 getWriteIndex();
+
+	/** Get the ids of the variables updated since the last call, as a reader.
+	  *	@param cursor The position of the reader in the ring, updated to the position of the writer.
+	  *	@return The ids, each once. All ids if the reader fell behind more than the size of the ring.*/
+	QList<int> takeUpdates( quint32 &cursor );
+
+	/// Get the number of times a reader fell behind and read all the slots.
+	quint64 getOverrunCount() const
+		{ return mOverrunCount; }
+
+	/** Get the hash of a deviceAPI string.
+	  *	@param apiString The deviceAPI string, as sent to the clients.
+	  *	@return The hash.*/
+	static quint32 apiHash( const QString &apiString )
+		{ return qHash( apiString ); }
+
+	static const int MTextSize = 60;	///< Maximum length of a string value in bytes (UTF-8).
+	static const int MRingSize = 4096;	///< Number of updates in the ring, a power of 2.
+
+private:
+
+	/// Header of the shared memory.
+	struct header_t
+	{
+		quint32 magic;
+		quint32 version;
+		quint32 apiHash;
+		qint32 varCount;
+		qint32 ringSize;
+		QBasicAtomicInt ringWriteIndex;	///< Number of updates written, the ring position is this modulo ringSize.
+		qint32 reserved[2];
+	};
+
+	/// The value of a variable.
+	struct slot_t
+	{
+		QBasicAtomicInt seq;	///< Odd while the writer updates the slot.
+		qint32 type;			///< QVariant::Type of the value, QVariant::Invalid if no value yet.
+		qint64 updateTime;
+		union
+		{
+			qint64 i;
+			quint64 u;
+			double d;
+		} number;
+		qint32 textLength;
+		char text[MTextSize];
+	};
+
+	header_t *header()
+		{ return (header_t*)mMemory->data(); }
+
+	slot_t *slot( int id )
+		{ return (slot_t*)( (char*)mMemory->data() + sizeof(header_t) ) + id; }
+
+	qint32 *ring()
+		{ return (qint32*)( (char*)mMemory->data() + sizeof(header_t) + mVarCount*sizeof(slot_t) ); }
+
+	/** Get the size of the shared memory.
+	  *	@param varCount The number of variables.
+	  *	@return The size in bytes.*/
+	static int memorySize( int varCount )
+		{ return sizeof(header_t) + varCount*sizeof(slot_t) + MRingSize*sizeof(qint32); }
+
+	static const quint32 MMagic = 0x51745553;	///< "QtuS"
+	static const quint32 MVersion = 1;
+	static const int MReadRetries = 16;	///< Tries of read() while the writer updates the slot.
+
+	QSharedMemory *mMemory;
+	int mVarCount;
+	quint64 mOverrunCount;
+};
+
+}	//QtuC::
+#endif // SHAREDSTATETABLE_H
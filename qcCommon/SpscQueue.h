@@ -0,0 +1,62 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QAtomicInt>
+
+namespace QtuC
+{
+
+/** A lock-free queue between one producer and one consumer thread.
+  *	A ring of fixed size: enqueue() is only called from the producer thread, dequeue() only from the consumer thread, neither blocks.
+  *	The producer publishes an item with a release store of the tail, the consumer frees its slot with a release store of the head.
+  *	@param T Type of the items, copied in and out of the ring.
+  *	@param Size Number of slots, must be a power of 2. One slot is always left empty, the queue holds Size-1 items.*/
+template<typename T, int Size>
+class SpscQueue
+{
+public:
+	SpscQueue() :
+		mHead(0),
+		mTail(0)
+	{
+		Q_ASSERT( Size > 1 && ( Size & (Size-1) ) == 0 );
+	}
+
+	/** Add an item, call only from the producer thread.
+	  *	@param item The item.
+	  *	@return True on success, false if the queue is full.*/
+	bool enqueue( const T &item )
+	{
+		int tail = mTail;	// only the producer writes the tail
+		int next = ( tail + 1 ) & ( Size - 1 );
+		if( next == mHead.fetchAndAddAcquire(0) )
+			{ return false; }
+		mBuffer[tail] = item;
+		mTail.fetchAndStoreRelease( next );
+		return true;
+	}
+
+	/** Take the oldest item, call only from the consumer thread.
+	  *	@param item The item is copied here.
+	  *	@return True on success, false if the queue is empty.*/
+	bool dequeue( T &item )
+	{
+		int head = mHead;	// only the consumer writes the head
+		if( head == mTail.fetchAndAddAcquire(0) )
+			{ return false; }
+		item = mBuffer[head];
+		mBuffer[head] = T();
+		mHead.fetchAndStoreRelease( ( head + 1 ) & ( Size - 1 ) );
+		return true;
+	}
+
+private:
+	Q_DISABLE_COPY(SpscQueue)
+
+	T mBuffer[Size];
+	QAtomicInt mHead;	///< Index of the oldest item, written by the consumer.
+	QAtomicInt mTail;	///< Index of the next free slot, written by the producer.
+};
+
+}	//QtuC::
+#endif // SPSCQUEUE_H
@@ -20,17 +20,13 @@ StateManagerBase::~StateManagerBase()
 //		}
 //	}
 	mStateVars->clear();
+	mVarIndex.clear();
 	delete mStateVars;
 }
 
 DeviceStateVariableBase* StateManagerBase::getVar( const QString& hardwareInterface, const QString& varName )
 {
-	for( int i = 0; i < mStateVars->size(); ++i )
-	{
-		if( mStateVars->at(i)->getHwInterface() == hardwareInterface && mStateVars->at(i)->getName() == varName )
-			{ return mStateVars->value(i); }
-	}
-	return 0;
+	return mVarIndex.value( qMakePair( hardwareInterface, varName ), 0 );
 }
 
 QList<DeviceStateVariableBase *> StateManagerBase::getVarList(const QString &hardwareInterface)
@@ -53,6 +49,9 @@ void StateManagerBase::registerStateVariable( DeviceStateVariableBase *stateVar
 	connect( stateVar, SIGNAL(updateMe()), this, SLOT(onUpdateRequest()) );
 	connect( stateVar, SIGNAL(sendMe()), this, SLOT(onSendRequest()) );
 	mStateVars->append(stateVar);
+	// on duplicates the first registered variable is found
+	if( !mVarIndex.contains( qMakePair( stateVar->getHwInterface(), stateVar->getName() ) ) )
+		{ mVarIndex.insert( qMakePair( stateVar->getHwInterface(), stateVar->getName() ), stateVar ); }
 }
 
 bool StateManagerBase::registerNewStateVariable(QHash<QString,QString> params)
@@ -4,6 +4,7 @@
 #include <QObject>
 #include <QString>
 #include <QHash>
+#include <QPair>
 #include "ErrorHandlerBase.h"
 
 namespace QtuC
@@ -29,6 +30,14 @@ public:
 	  *	@return Pointer to the requested variable.*/
 	DeviceStateVariableBase* getVar( const QString& hardwareInterface, const QString& varName );
 
+	/** Get a variable by its id.
+	  *	The id of a variable is its index in the order of registration, which is the order of the deviceAPI.
+	  *	This is the id in the schema generated by qcApiGen (DeviceApiSchema::varId_t).
+	  *	@param id The id of the variable.
+	  *	@return Pointer to the variable, or 0 if there is no variable with the id.*/
+	DeviceStateVariableBase* getVar( int id )
+		{ return mStateVars->value( id, 0 ); }
+
 	/** Get all variables in a specified hadware interface, or all interfaces.
 	  *	@param hardwareInterface Get all vars in this interface. If omitted or empty, all variables in all interfaces will be returned.
 	  * @return List of variable pointers.*/
@@ -69,6 +78,7 @@ private slots:
 
 private:
 	QList<DeviceStateVariableBase*>* mStateVars;	///< List of state variables to manage.
+	QHash< QPair<QString,QString>, DeviceStateVariableBase* > mVarIndex;	///< The variables by hardware interface and name, for getVar().
 
 };
 
@@ -0,0 +1,58 @@
+#include "ClientCommandMetrics.h"
+
+using namespace QtuC;
+
+ClientCommandMetrics::ClientCommandMetrics() :
+	ClientCommandBase()
+{
+	mName = "metrics";
+	mClass = clientCommandControl;
+}
+
+bool ClientCommandMetrics::applyDomElement(const QDomElement &cmdElement)
+{
+	if( !checkTagName(cmdElement) )
+		{ return false; }
+
+	QDomElement metricElement = cmdElement.firstChildElement( "metric" );
+	while( !metricElement.isNull() )
+	{
+		if( metricElement.attribute("name").isEmpty() )
+			{ error( QtWarningMsg, QString("metric name attribute is empty (value: %1)").arg(metricElement.text()), "applyDomElement()" ); }
+		else
+			{ mMetrics.insert( metricElement.attribute("name"), metricElement.text() ); }
+		metricElement = metricElement.nextSiblingElement( "metric" );
+	}
+
+	return true;
+}
+
+ClientCommandBase *ClientCommandMetrics::clone()
+{
+	return new ClientCommandMetrics();
+}
+
+ClientCommandBase *ClientCommandMetrics::exactClone()
+{
+	ClientCommandMetrics *clone = new ClientCommandMetrics();
+	clone->mMetrics = mMetrics;
+	return clone;
+}
+
+QDomElement ClientCommandMetrics::getDomElement() const
+{
+	QDomDocument dom;
+	QDomElement cmdElement = dom.createElement(mName);
+
+	QHash<QString,QString>::const_iterator i = mMetrics.constBegin();
+	while( i != mMetrics.constEnd() )
+	{
+		QDomElement metricElement = dom.createElement("metric");
+		metricElement.setAttribute( "name", i.key() );
+		metricElement.appendChild( dom.createTextNode(i.value()) );
+		cmdElement.appendChild( metricElement );
+		++i;
+	}
+
+	return cmdElement;
+}
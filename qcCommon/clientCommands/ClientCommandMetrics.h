@@ -0,0 +1,43 @@
+#ifndef CLIENTCOMMANDMETRICS_H
+#define CLIENTCOMMANDMETRICS_H
+
+#include "ClientCommandBase.h"
+#include <QHash>
+
+namespace QtuC
+{
+
+/** Metrics command.
+  *	The reply to reqMetrics, includes the runtime metrics of the proxy as name-value pairs.*/
+class ClientCommandMetrics : public ClientCommandBase
+{
+	Q_OBJECT
+public:
+	explicit ClientCommandMetrics();
+
+	/** Set the metrics to include in the command.
+	  *	@param metrics List of name-value pairs of metrics.*/
+	inline void setMetrics( QHash<QString,QString> const &metrics )
+		{ mMetrics = metrics; }
+
+	/** Get the metrics included in the command.
+	  *	@return The list of metrics.*/
+	inline QHash<QString,QString> getMetrics() const
+		{ return mMetrics; }
+
+	/// @name Inherited methods from ClientCommandBase.
+	/// @{
+	bool applyDomElement( const QDomElement &cmdElement );
+	ClientCommandBase *clone();
+	ClientCommandBase *exactClone();
+	QDomElement getDomElement() const;
+	inline bool isValid() const
+		{ return ClientCommandBase::isValid(); }
+	/// @}
+
+private:
+	QHash<QString,QString> mMetrics;	///< List of metrics.
+};
+
+}	//QtuC::
+#endif // CLIENTCOMMANDMETRICS_H
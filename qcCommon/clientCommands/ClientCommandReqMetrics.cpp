@@ -0,0 +1,33 @@
+#include "ClientCommandReqMetrics.h"
+
+using namespace QtuC;
+
+ClientCommandReqMetrics::ClientCommandReqMetrics() :
+	ClientCommandBase()
+{
+	mName = "reqMetrics";
+	mClass = clientCommandControl;
+}
+
+bool ClientCommandReqMetrics::applyDomElement(const QDomElement &cmdElement)
+{
+	if( !checkTagName(cmdElement) )
+		{ return false; }
+	return true;
+}
+
+ClientCommandBase *ClientCommandReqMetrics::clone()
+{
+	return new ClientCommandReqMetrics();
+}
+
+ClientCommandBase *ClientCommandReqMetrics::exactClone()
+{
+	return new ClientCommandReqMetrics();
+}
+
+QDomElement ClientCommandReqMetrics::getDomElement() const
+{
+	QDomDocument dom;
+	return dom.createElement(mName);
+}
@@ -0,0 +1,35 @@
+#ifndef CLIENTCOMMANDREQMETRICS_H
+#define CLIENTCOMMANDREQMETRICS_H
+
+#include "ClientCommandBase.h"
+
+namespace QtuC
+{
+
+/** reqMetrics command.
+  *	Request the runtime metrics of the proxy, the reply is a metrics command.*/
+class ClientCommandReqMetrics : public ClientCommandBase
+{
+	Q_OBJECT
+public:
+	explicit ClientCommandReqMetrics();
+
+	/// @name Inherited methods from ClientCommandBase.
+	/// @{
+
+	bool applyDomElement( const QDomElement &cmdElement );
+
+	ClientCommandBase *clone();
+
+	ClientCommandBase *exactClone();
+
+	QDomElement getDomElement() const;
+
+	inline bool isValid() const
+		{ return ClientCommandBase::isValid(); }
+
+	/// @}
+};
+
+}	//QtuC::
+#endif // CLIENTCOMMANDREQMETRICS_H
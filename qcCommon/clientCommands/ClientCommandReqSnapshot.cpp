@@ -0,0 +1,51 @@
+#include "ClientCommandReqSnapshot.h"
+
+using namespace QtuC;
+
+ClientCommandReqSnapshot::ClientCommandReqSnapshot( const QString &hwInterface, const QString &varName ) :
+	ClientCommandBase(),
+	mHwInterface(hwInterface),
+	mVariable(varName)
+{
+	mName = "reqSnapshot";
+	mClass = clientCommandControl;
+}
+
+bool ClientCommandReqSnapshot::applyDomElement( const QDomElement &cmdElement )
+{
+	if( !checkTagName(cmdElement) )
+		{ return false; }
+
+	mHwInterface = cmdElement.attribute("hwInterface");
+	mVariable = cmdElement.attribute("variable");
+	return isValid();
+}
+
+ClientCommandBase *ClientCommandReqSnapshot::clone()
+{
+	return new ClientCommandReqSnapshot();
+}
+
+ClientCommandBase *ClientCommandReqSnapshot::exactClone()
+{
+	return new ClientCommandReqSnapshot( mHwInterface, mVariable );
+}
+
+QDomElement ClientCommandReqSnapshot::getDomElement() const
+{
+	QDomDocument dom;
+	QDomElement cmdElement = dom.createElement(mName);
+
+	if( !mHwInterface.isEmpty() )
+		{ cmdElement.setAttribute( "hwInterface", mHwInterface ); }
+	if( !mVariable.isEmpty() )
+		{ cmdElement.setAttribute( "variable", mVariable ); }
+
+	return cmdElement;
+}
+
+bool ClientCommandReqSnapshot::isValid() const
+{
+	// a variable is only valid in a hardware interface
+	return !( mHwInterface.isEmpty() && !mVariable.isEmpty() ) && ClientCommandBase::isValid();
+}
@@ -0,0 +1,45 @@
+#ifndef CLIENTCOMMANDREQSNAPSHOT_H
+#define CLIENTCOMMANDREQSNAPSHOT_H
+
+#include "ClientCommandBase.h"
+
+namespace QtuC
+{
+
+/** reqSnapshot command.
+  *	Request the current values of the state variables, the reply is one or more snapshot commands (see ClientCommandSnapshot).
+  *	The variables are selected the same way as in a subscribe command: all of them, the ones in a hardware interface, or a single variable.*/
+class ClientCommandReqSnapshot : public ClientCommandBase
+{
+	Q_OBJECT
+public:
+
+	/** Create a reqSnapshot command.
+	  *	@param hwInterface Hardware interface. If omitted, all variables in all interfaces are requested.
+	  *	@param varName Name of the variable. If omitted, all variables in the hardware interface are requested.*/
+	explicit ClientCommandReqSnapshot( const QString &hwInterface = QString(), const QString &varName = QString() );
+
+	/// Get the requested hardware interface, empty for all.
+	const QString getHwInterface() const
+		{ return mHwInterface; }
+
+	/// Get the requested variable, empty for all in the hardware interface.
+	const QString getVariable() const
+		{ return mVariable; }
+
+	/// @name Inherited methods from ClientCommandBase.
+	/// @{
+	bool applyDomElement( const QDomElement &cmdElement );
+	ClientCommandBase *clone();
+	ClientCommandBase *exactClone();
+	QDomElement getDomElement() const;
+	bool isValid() const;
+	/// @}
+
+private:
+	QString mHwInterface;
+	QString mVariable;
+};
+
+}	//QtuC::
+#endif // CLIENTCOMMANDREQSNAPSHOT_H
@@ -0,0 +1,88 @@
+#include "ClientCommandSnapshot.h"
+#include "DeviceStateVariableBase.h"
+
+using namespace QtuC;
+
+ClientCommandSnapshot::ClientCommandSnapshot() :
+	ClientCommandBase(),
+	mMore(false)
+{
+	mName = "snapshot";
+	mClass = clientCommandControl;
+}
+
+void ClientCommandSnapshot::append( const DeviceStateVariableBase *stateVar )
+{
+	value_t snapshotValue;
+	snapshotValue.hwInterface = stateVar->getHwInterface();
+	snapshotValue.variable = stateVar->getName();
+	snapshotValue.value = stateVar->getValue().toString();
+	snapshotValue.time = stateVar->getLastUpdateTime();
+	mValueList.append( snapshotValue );
+}
+
+bool ClientCommandSnapshot::applyDomElement( const QDomElement &cmdElement )
+{
+	if( !checkTagName(cmdElement) )
+		{ return false; }
+
+	mMore = ( cmdElement.attribute("more") == "true" );
+
+	QDomElement valueElement = cmdElement.firstChildElement( "value" );
+	while( !valueElement.isNull() )
+	{
+		value_t snapshotValue;
+		snapshotValue.hwInterface = valueElement.attribute("hwi");
+		snapshotValue.variable = valueElement.attribute("var");
+		snapshotValue.value = valueElement.text();
+		bool ok;
+		snapshotValue.time = valueElement.attribute("time").toLongLong( &ok, 16 );
+		if( snapshotValue.hwInterface.isEmpty() || snapshotValue.variable.isEmpty() || !ok )
+		{
+			errorDetails_t errDet;
+			errDet.insert( "hwiName", snapshotValue.hwInterface );
+			errDet.insert( "varName", snapshotValue.variable );
+			errDet.insert( "timeStr", valueElement.attribute("time") );
+			error( QtWarningMsg, "Invalid value in snapshot command, skipped", "applyDomElement()", errDet );
+		}
+		else
+			{ mValueList.append( snapshotValue ); }
+		valueElement = valueElement.nextSiblingElement( "value" );
+	}
+
+	return true;
+}
+
+ClientCommandBase *ClientCommandSnapshot::clone()
+{
+	return new ClientCommandSnapshot();
+}
+
+ClientCommandBase *ClientCommandSnapshot::exactClone()
+{
+	ClientCommandSnapshot *clone = new ClientCommandSnapshot();
+	clone->mValueList = mValueList;
+	clone->mMore = mMore;
+	return clone;
+}
+
+QDomElement ClientCommandSnapshot::getDomElement() const
+{
+	QDomDocument dom;
+	QDomElement cmdElement = dom.createElement(mName);
+
+	if( mMore )
+		{ cmdElement.setAttribute( "more", "true" ); }
+
+	for( int i=0; i<mValueList.size(); ++i )
+	{
+		QDomElement valueElement = dom.createElement("value");
+		valueElement.setAttribute( "time", QString::number( mValueList.at(i).time, 16 ) );
+		valueElement.setAttribute( "hwi", mValueList.at(i).hwInterface );
+		valueElement.setAttribute( "var", mValueList.at(i).variable );
+		valueElement.appendChild( dom.createCDATASection(mValueList.at(i).value) );
+		cmdElement.appendChild( valueElement );
+	}
+
+	return cmdElement;
+}
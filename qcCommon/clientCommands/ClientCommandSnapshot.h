@@ -0,0 +1,69 @@
+#ifndef CLIENTCOMMANDSNAPSHOT_H
+#define CLIENTCOMMANDSNAPSHOT_H
+
+#include "ClientCommandBase.h"
+#include <QList>
+
+namespace QtuC
+{
+
+class DeviceStateVariableBase;
+
+/** Snapshot command.
+  *	The reply to reqSnapshot, includes the current value and the last update time of the requested state variables.
+  *	Each value is the same as the one in a set device command, but the whole state table fits in a few commands instead of a set for each variable.
+  *	A big snapshot is split to more snapshot commands (each in its own packet), all but the last one are marked with hasMore().*/
+class ClientCommandSnapshot : public ClientCommandBase
+{
+	Q_OBJECT
+public:
+
+	/// A value in the snapshot.
+	struct value_t
+	{
+		QString hwInterface;
+		QString variable;
+		QString value;		///< The user-side value as a string, as in a set command.
+		qint64 time;		///< Last update time of the variable, UNIX timestamp in milliseconds.
+	};
+
+	explicit ClientCommandSnapshot();
+
+	/** Append the current value of a state variable.
+	  *	@param stateVar The variable.*/
+	void append( const DeviceStateVariableBase *stateVar );
+
+	/// Get the values.
+	const QList<value_t> &getValueList() const
+		{ return mValueList; }
+
+	/// Get the number of values.
+	int size() const
+		{ return mValueList.size(); }
+
+	/** Mark that more snapshot commands follow with the rest of the values.
+	  *	@param more True if more commands follow.*/
+	void setMore( bool more )
+		{ mMore = more; }
+
+	/// Get whether more snapshot commands follow with the rest of the values.
+	bool hasMore() const
+		{ return mMore; }
+
+	/// @name Inherited methods from ClientCommandBase.
+	/// @{
+	bool applyDomElement( const QDomElement &cmdElement );
+	ClientCommandBase *clone();
+	ClientCommandBase *exactClone();
+	QDomElement getDomElement() const;
+	inline bool isValid() const
+		{ return ClientCommandBase::isValid(); }
+	/// @}
+
+private:
+	QList<value_t> mValueList;
+	bool mMore;
+};
+
+}	//QtuC::
+#endif // CLIENTCOMMANDSNAPSHOT_H
@@ -0,0 +1,89 @@
+#include "ClientCommandSubscribeList.h"
+
+using namespace QtuC;
+
+ClientCommandSubscribeList::ClientCommandSubscribeList( bool unSubscribe ) :
+	ClientCommandBase(),
+	mUnSubscribe(unSubscribe)
+{
+	mName = mUnSubscribe ? "unSubscribeList" : "subscribeList";
+	mClass = clientCommandControl;
+}
+
+void ClientCommandSubscribeList::append( quint32 interval, const QString &hwInterface, const QString &varName )
+{
+	subscription_t subscription;
+	subscription.interval = interval;
+	subscription.hwInterface = hwInterface;
+	subscription.variable = varName;
+	mSubscriptionList.append( subscription );
+}
+
+bool ClientCommandSubscribeList::applyDomElement( const QDomElement &cmdElement )
+{
+	if( !checkTagName(cmdElement) )
+		{ return false; }
+
+	QString entryTag = mUnSubscribe ? "unSubscribe" : "subscribe";
+	QDomElement entryElement = cmdElement.firstChildElement( entryTag );
+	while( !entryElement.isNull() )
+	{
+		bool ok = true;
+		quint32 interval = mUnSubscribe ? 0 : entryElement.attribute("interval").toUInt(&ok);
+		if( !ok )
+		{
+			errorDetails_t errDet;
+			errDet.insert( "varName", entryElement.attribute("variable") );
+			errDet.insert( "hwiName", entryElement.attribute("hwInterface") );
+			errDet.insert( "intervalStr", entryElement.attribute("interval") );
+			error( QtWarningMsg, "Invalid string for interval in subscribeList command", "applyDomElement()", errDet );
+			return false;
+		}
+		append( interval, entryElement.attribute("hwInterface"), entryElement.attribute("variable") );
+		entryElement = entryElement.nextSiblingElement( entryTag );
+	}
+	return true;
+}
+
+ClientCommandBase *ClientCommandSubscribeList::clone()
+{
+	return new ClientCommandSubscribeList( mUnSubscribe );
+}
+
+ClientCommandBase *ClientCommandSubscribeList::exactClone()
+{
+	ClientCommandSubscribeList *clone = new ClientCommandSubscribeList( mUnSubscribe );
+	clone->mSubscriptionList = mSubscriptionList;
+	return clone;
+}
+
+QDomElement ClientCommandSubscribeList::getDomElement() const
+{
+	QDomDocument dom;
+	QDomElement cmdElement = dom.createElement(mName);
+
+	for( int i=0; i<mSubscriptionList.size(); ++i )
+	{
+		QDomElement entryElement = dom.createElement( mUnSubscribe ? "unSubscribe" : "subscribe" );
+		if( !mUnSubscribe )
+			{ entryElement.setAttribute( "interval", QString::number(mSubscriptionList.at(i).interval) ); }
+		entryElement.setAttribute( "hwInterface", mSubscriptionList.at(i).hwInterface );
+		entryElement.setAttribute( "variable", mSubscriptionList.at(i).variable );
+		cmdElement.appendChild( entryElement );
+	}
+
+	return cmdElement;
+}
+
+bool ClientCommandSubscribeList::isValid() const
+{
+	if( !mUnSubscribe )
+	{
+		for( int i=0; i<mSubscriptionList.size(); ++i )
+		{
+			if( mSubscriptionList.at(i).interval == 0 )
+				{ return false; }
+		}
+	}
+	return !mSubscriptionList.isEmpty() && ClientCommandBase::isValid();
+}
@@ -0,0 +1,64 @@
+#ifndef CLIENTCOMMANDSUBSCRIBELIST_H
+#define CLIENTCOMMANDSUBSCRIBELIST_H
+
+#include "ClientCommandBase.h"
+#include <QList>
+
+namespace QtuC
+{
+
+/** Subscribe to, or unsubscribe from a list of variables in one command.
+  *	The same class is used for the subscribeList and the unSubscribeList command (see the constructor).
+  *	Each entry is the same as a [subscribe](@ref doc-clientProtocol-command-control-subscribe) or an [unSubscribe](@ref doc-clientProtocol-command-control-unSubscribe) command,
+  *	but the proxy handles the list at once: a subscribeList is only accepted if all of its entries are valid.*/
+class ClientCommandSubscribeList : public ClientCommandBase
+{
+	Q_OBJECT
+public:
+
+	/// An entry of the list.
+	struct subscription_t
+	{
+		quint32 interval;		///< Interval in milliseconds, not used in an unSubscribeList.
+		QString hwInterface;
+		QString variable;
+	};
+
+	/** Create an empty list.
+	  *	@param unSubscribe If true, the command is an unSubscribeList, otherwise a subscribeList.*/
+	explicit ClientCommandSubscribeList( bool unSubscribe = false );
+
+	/** Append an entry.
+	  *	@param interval Update interval, ms. Ignored in an unSubscribeList.
+	  *	@param hwInterface Hardware interface, see ClientCommandSubscribe.
+	  *	@param varName Name of the variable, see ClientCommandSubscribe.*/
+	void append( quint32 interval, const QString &hwInterface = QString(), const QString &varName = QString() );
+
+	/// Get whether this is an unSubscribeList.
+	bool isUnSubscribe() const
+		{ return mUnSubscribe; }
+
+	/// Get the entries.
+	const QList<subscription_t> &getSubscriptionList() const
+		{ return mSubscriptionList; }
+
+	/// Get whether the list is empty.
+	bool isEmpty() const
+		{ return mSubscriptionList.isEmpty(); }
+
+	/// @name Inherited methods from ClientCommandBase.
+	/// @{
+	bool applyDomElement( const QDomElement &cmdElement );
+	ClientCommandBase *clone();
+	ClientCommandBase *exactClone();
+	QDomElement getDomElement() const;
+	bool isValid() const;
+	/// @}
+
+private:
+	bool mUnSubscribe;
+	QList<subscription_t> mSubscriptionList;
+};
+
+}	//QtuC::
+#endif // CLIENTCOMMANDSUBSCRIBELIST_H
@@ -12,8 +12,13 @@
 #include "ClientCommandDevice.h"
 #include "ClientCommandSubscribe.h"
 #include "ClientCommandUnSubscribe.h"
+#include "ClientCommandSubscribeList.h"
 #include "ClientCommandReqDeviceInfo.h"
 #include "ClientCommandDeviceInfo.h"
+#include "ClientCommandReqMetrics.h"
+#include "ClientCommandMetrics.h"
+#include "ClientCommandReqSnapshot.h"
+#include "ClientCommandSnapshot.h"
 class ClientCommandStatus;
 
 #endif // CLIENTCOMMANDS_H
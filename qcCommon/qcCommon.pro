@@ -25,8 +25,20 @@ SOURCES += SettingsManagerBase.cpp \
     clientCommands/ClientCommandReqDeviceApi.cpp \
     clientCommands/ClientCommandUnSubscribe.cpp \
 	clientCommands/ClientCommandSubscribe.cpp \
+    clientCommands/ClientCommandSubscribeList.cpp \
     clientCommands/ClientCommandReqDeviceInfo.cpp \
-    clientCommands/ClientCommandDeviceInfo.cpp
+    clientCommands/ClientCommandDeviceInfo.cpp \
+    clientCommands/ClientCommandReqMetrics.cpp \
+    clientCommands/ClientCommandMetrics.cpp \
+    clientCommands/ClientCommandReqSnapshot.cpp \
+    clientCommands/ClientCommandSnapshot.cpp \
+    LatencyTrace.cpp \
+    LatencyHistogram.cpp \
+    LatencyMonitor.cpp \
+    ClientSetCoalescer.cpp \
+    ClientConnectionWorker.cpp \
+    SharedStateTable.cpp \
+    SharedStateClient.cpp
 
 HEADERS += SettingsManagerBase.h \
 	DeviceStateVariableBase.h \
@@ -47,7 +59,20 @@ HEADERS += SettingsManagerBase.h \
     clientCommands/ClientCommandReqDeviceApi.h \
     clientCommands/ClientCommandUnSubscribe.h \
 	clientCommands/ClientCommandSubscribe.h \
+    clientCommands/ClientCommandSubscribeList.h \
     clientCommands/ClientCommandReqDeviceInfo.h \
-    clientCommands/ClientCommandDeviceInfo.h
+    clientCommands/ClientCommandDeviceInfo.h \
+    clientCommands/ClientCommandReqMetrics.h \
+    clientCommands/ClientCommandMetrics.h \
+    clientCommands/ClientCommandReqSnapshot.h \
+    clientCommands/ClientCommandSnapshot.h \
+    LatencyTrace.h \
+    LatencyHistogram.h \
+    LatencyMonitor.h \
+    ClientSetCoalescer.h \
+    ClientConnectionWorker.h \
+    SpscQueue.h \
+    SharedStateTable.h \
+    SharedStateClient.h
 
 INCLUDEPATH += $$PWD/clientCommands
@@ -0,0 +1,227 @@
+#include "BatchBench.hpp"
+#include "QtuC_Interfaces.hpp"
+#include "QtuC_Binary.hpp"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+uint8_t BatchBench::mVarCount = 0;
+char BatchBench::mVarNames[BatchBench::MMaxVarCount][5] = {};
+QtuC::HashIndex<128> BatchBench::mVarIndex;
+int32_t BatchBench::mValues[BatchBench::MMaxVarCount] = {};
+bool BatchBench::mRunning = false;
+BatchBench::stats_t *BatchBench::mStats = 0;
+
+const char BatchBench::InterfaceName[] = {"bench"};
+
+int BatchBench::run( uint8_t varCount, uint32_t rounds )
+{
+	if( !varCount || varCount > MMaxVarCount || !rounds )
+	{
+		fprintf( stderr, "Invalid benchmark parameters, varCount must be 1..%d, rounds must be positive\n", MMaxVarCount );
+		return 1;
+	}
+
+	mVarCount = varCount;
+	for( uint8_t i=0; i<mVarCount; ++i )
+	{
+		snprintf( mVarNames[i], sizeof(mVarNames[i]), "v%d", i );
+		mValues[i] = i;
+		mVarIndex.insert( QtuC::Tools::hash( mVarNames[i] ), i );
+	}
+	QtuC::Interfaces::regInterface<BatchBench>();
+
+	printf( "Batch benchmark: %d variables, %u rounds of get and set each, batches up to %d characters\n", mVarCount, rounds, QtuC::Conf::maxCommandLength-1 );
+	printf( "%-8s %10s %10s %10s %10s %14s\n", "mode", "txLines", "txBytes", "rxLines", "rxBytes", "updates/s" );
+
+	mRunning = true;
+	stats_t single, batched, binary;
+	runMode( modeSingle, rounds, single );
+	printStats( "single", single );
+	runMode( modeBatched, rounds, batched );
+	printStats( "batched", batched );
+	runMode( modeBinary, rounds, binary );
+	printStats( "binary", binary );
+	mRunning = false;
+
+	printf( "batched/single bytes: to device %.2f, from device %.2f, throughput %.2fx\n",
+			(double)batched.txBytes / single.txBytes, (double)batched.rxBytes / single.rxBytes,
+			( (double)batched.updates / batched.elapsedNs ) / ( (double)single.updates / single.elapsedNs ) );
+	printf( "binary/single bytes: to device %.2f, from device %.2f, throughput %.2fx\n",
+			(double)binary.txBytes / single.txBytes, (double)binary.rxBytes / single.rxBytes,
+			( (double)binary.updates / binary.elapsedNs ) / ( (double)single.updates / single.elapsedNs ) );
+	return 0;
+}
+
+void BatchBench::capture( char const *str )
+{
+	if( !mStats )
+		{ return; }
+	for( ; *str; ++str )
+	{
+		++mStats->rxBytes;
+		if( *str == QtuC::Tools::Endl && !QtuC::Tools::isBinary() )
+			{ ++mStats->rxLines; }
+	}
+}
+
+void BatchBench::capture( char const c )
+{
+	if( !mStats )
+		{ return; }
+	++mStats->rxBytes;
+	if( c == '\0' )
+		{ ++mStats->rxLines; }
+}
+
+bool BatchBench::execCmd( QtuC::cmdType_t type, char *var, char *arg )
+{
+	uint8_t probe = 0;
+	uint32_t hash = QtuC::Tools::hash( var );
+	for( int16_t i = mVarIndex.find( hash, probe ); i >= 0; i = mVarIndex.find( hash, probe ) )
+	{
+		if( QtuC::Tools::isArg( var, mVarNames[i] ) )
+		{
+			if( type == QtuC::cmdGet )
+				{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, mVarNames[i], mValues[i] ); }
+			else if( type == QtuC::cmdSet )
+			{
+				mValues[i] = strtol( arg, 0, 16 );
+				return true;
+			}
+			return false;
+		}
+	}
+	return false;
+}
+
+void BatchBench::runMode( mode_t mode, uint32_t rounds, stats_t &stats )
+{
+	stats = stats_t();
+	mStats = &stats;
+
+	// the variable ids are assigned as qcProxy does, before switching to binary mode
+	if( mode == modeBinary )
+	{
+		mStats = 0;
+		char line[QtuC::Conf::maxCommandLength];
+		for( uint8_t i=0; i<mVarCount && i<QtuC::Conf::maxBinaryIdCount; ++i )
+		{
+			snprintf( line, sizeof(line), "call :proxy binaryId %d %s %s", i, InterfaceName, mVarNames[i] );
+			QtuC::Interfaces::routeCmd( line );
+		}
+		strcpy( line, "call :proxy binary 1" );
+		QtuC::Interfaces::routeCmd( line );
+		mStats = &stats;
+	}
+
+	char line[QtuC::Conf::maxCommandLength];
+	uint8_t const maxLength = QtuC::Conf::maxCommandLength-1;
+	for( uint32_t r=0; r<rounds; ++r )
+	{
+		// poll every variable, then set every variable, the way DeviceAPI sends them
+		for( uint8_t pass=0; pass<2; ++pass )
+		{
+			bool isSet = ( pass == 1 );
+			if( mode == modeBinary )
+			{
+				for( uint8_t i=0; i<mVarCount; ++i )
+				{
+					int32_t value = r+i;
+					sendFrame( isSet ? QtuC::cmdSet : QtuC::cmdGet, i, isSet ? &value : 0, stats );
+				}
+				stats.updates += mVarCount;
+				continue;
+			}
+			if( mode == modeSingle )
+			{
+				for( uint8_t i=0; i<mVarCount; ++i )
+				{
+					if( isSet )
+						{ snprintf( line, sizeof(line), "set %s %s %x", InterfaceName, mVarNames[i], (unsigned)(r+i) ); }
+					else
+						{ snprintf( line, sizeof(line), "get %s %s", InterfaceName, mVarNames[i] ); }
+					send( line, stats );
+				}
+				stats.updates += mVarCount;
+				continue;
+			}
+
+			int length = 0;
+			for( uint8_t i=0; i<mVarCount; ++i )
+			{
+				char item[24];
+				int itemLength = isSet ? snprintf( item, sizeof(item), " %s=%x", mVarNames[i], (unsigned)(r+i) ) : snprintf( item, sizeof(item), " %s", mVarNames[i] );
+				if( length && length + itemLength > maxLength )
+				{
+					send( line, stats );
+					length = 0;
+				}
+				if( !length )
+					{ length = snprintf( line, sizeof(line), "%s %s", isSet ? "mset" : "mget", InterfaceName ); }
+				memcpy( line+length, item, itemLength+1 );
+				length += itemLength;
+			}
+			if( length )
+				{ send( line, stats ); }
+			stats.updates += mVarCount;
+		}
+	}
+
+	mStats = 0;
+	QtuC::Tools::setBinary( false );
+}
+
+void BatchBench::send( char const *line, stats_t &stats )
+{
+	char cmd[QtuC::Conf::maxCommandLength];
+	strcpy( cmd, line );
+	stats.txBytes += strlen(line) + 1;
+	++stats.txLines;
+
+	timespec start, end;
+	clock_gettime( CLOCK_MONOTONIC, &start );
+	QtuC::Interfaces::routeCmd( cmd );
+	clock_gettime( CLOCK_MONOTONIC, &end );
+	stats.elapsedNs += (uint64_t)( end.tv_sec - start.tv_sec ) * 1000000000ULL + end.tv_nsec - start.tv_nsec;
+}
+
+void BatchBench::sendFrame( QtuC::cmdType_t type, uint8_t id, int32_t const *value, stats_t &stats )
+{
+	uint8_t frame[QtuC::Conf::maxCommandLength];
+	uint8_t length = 0;
+	if( id < QtuC::Conf::maxBinaryIdCount )
+	{
+		frame[length++] = type;
+		frame[length++] = id;
+		if( value )
+		{
+			// little endian, as QtuC::Binary::sendValue() sends it
+			frame[length++] = QtuC::Binary::tagInt;
+			for( uint8_t i=0; i<4; ++i )
+				{ frame[length++] = (uint32_t)*value >> (8*i); }
+		}
+	}
+	else
+	{
+		// variables without an id go in a text frame
+		frame[length++] = QtuC::Binary::headerText;
+		if( value )
+			{ length += snprintf( (char*)frame+length, sizeof(frame)-length-2, "set %s %s %x", InterfaceName, mVarNames[id], (unsigned)*value ); }
+		else
+			{ length += snprintf( (char*)frame+length, sizeof(frame)-length-2, "get %s %s", InterfaceName, mVarNames[id] ); }
+	}
+	uint16_t crc = QtuC::Binary::crc16( frame, length );
+	frame[length++] = crc & 0xff;
+	frame[length++] = crc >> 8;
+
+	uint8_t encoded[QtuC::Conf::maxCommandLength+2];
+	QtuC::Binary::cobsEncode( frame, length, encoded );
+	send( (char const*)encoded, stats );
+}
+
+void BatchBench::printStats( char const *mode, stats_t const &stats )
+{
+	double seconds = stats.elapsedNs / 1e9;
+	printf( "%-8s %10u %10u %10u %10u %14.0f\n", mode, stats.txLines, stats.txBytes, stats.rxLines, stats.rxBytes, seconds > 0 ? stats.updates / seconds : 0.0 );
+}
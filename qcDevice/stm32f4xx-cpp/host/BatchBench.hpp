@@ -0,0 +1,97 @@
+#ifndef BATCHBENCH_H
+#define BATCHBENCH_H
+
+#include <stdint.h>
+#include "QtuC_Tools.hpp"
+#include "QtuC_HashIndex.hpp"
+
+/** Benchmark of the batched device commands (mget/mset) and the binary protocol against the single text commands (get/set).
+ *	A "bench" interface with varCount integer variables is registered, then every variable is polled and set rounds times,
+ *	first with single commands, then with batched ones, then with binary frames (see QtuC::Binary), through the same QtuC::Interfaces::routeCmd() the firmware uses.
+ *	The commands to the device are built as qcProxy builds them (batches split to the length advertised in the greeting),
+ *	the replies are captured from QtuC::print() and QtuC::putChar() instead of the port.
+ *	Printed for both modes: lines and bytes on the wire in both directions, and the variable updates per second the device core can process.*/
+class BatchBench
+{
+private:
+	/// Private c'tor. This is a static class, don't instantiate.
+	BatchBench(){}
+
+public:
+	/// Name of the bench interface.
+	static const char InterfaceName[];
+
+	/** Run the benchmark and print the results to stdout.
+	 *	@param varCount Number of variables in the bench interface (max MMaxVarCount).
+	 *	@param rounds Number of times every variable is polled and set.
+	 *	@return 0 on success, 1 on invalid parameters.*/
+	static int run( uint8_t varCount, uint32_t rounds );
+
+	/** Get if the benchmark is running.
+	 *	While running, QtuC::print() must pass the output to capture().*/
+	static inline bool isRunning()
+		{ return mRunning; }
+
+	/** Capture the output of the device.
+	 *	@param str The printed string.*/
+	static void capture( char const *str );
+
+	/** Capture a character of the output of the device.
+	 *	@param c The character.*/
+	static void capture( char const c );
+
+	/// Execute a command sent to the bench interface.
+	static bool execCmd( QtuC::cmdType_t type, char *var, char *arg );
+
+private:
+
+	/// Statistics of a run.
+	struct stats_t
+	{
+		uint32_t txLines;	///< Lines (or frames) sent to the device.
+		uint32_t txBytes;
+		uint32_t rxLines;	///< Lines (or frames) received from the device.
+		uint32_t rxBytes;
+		uint64_t elapsedNs;	///< Time spent in the device core.
+		uint32_t updates;	///< Variables read or written.
+	};
+
+	/// The protocols compared.
+	enum mode_t
+	{
+		modeSingle,
+		modeBatched,
+		modeBinary
+	};
+
+	/** Poll and set every variable rounds times.
+	 *	@param mode The protocol to use.
+	 *	@param rounds Number of rounds.
+	 *	@param stats The statistics, filled by the run.*/
+	static void runMode( mode_t mode, uint32_t rounds, stats_t &stats );
+
+	/** Send a command line to the device core, as ProxyCom would do.
+	 *	@param line The command, without the line end (or the encoded frame, without the terminator).
+	 *	@param stats Statistics to update.*/
+	static void send( char const *line, stats_t &stats );
+
+	/** Send a variable command in a binary frame, as qcProxy builds it.
+	 *	@param type Type of the command.
+	 *	@param id Id of the variable.
+	 *	@param value The value of a set command, sent raw as an int, null for get.
+	 *	@param stats Statistics to update.*/
+	static void sendFrame( QtuC::cmdType_t type, uint8_t id, int32_t const *value, stats_t &stats );
+
+	/// Print a result line.
+	static void printStats( char const *mode, stats_t const &stats );
+
+	static uint8_t const MMaxVarCount = 100;
+	static uint8_t mVarCount;
+	static char mVarNames[MMaxVarCount][5];
+	static QtuC::HashIndex<128> mVarIndex;	///< Index of mVarNames, the variables are found as in HwInterface::Led.
+	static int32_t mValues[MMaxVarCount];
+	static bool mRunning;
+	static stats_t *mStats;	///< Statistics of the current run, for capture().
+};
+
+#endif // BATCHBENCH_H
@@ -0,0 +1,56 @@
+/** @file
+ *	Host platform definitions, included by HAL_Platform.hpp if QTUC_HOST is defined.
+ *	Provides the few STM32 definitions the framework core and the HAL headers use, so they compile on a PC.
+ *	The host build is single threaded: the "interrupts" (HAL::ProxyPort callbacks) are called from the main loop,
+ *	so disabling interrupts is a no-op.*/
+
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include <stdint.h>
+
+/// @name Interrupt control (no-op on the host).
+/// @{
+inline void __disable_irq() {}
+inline void __enable_irq() {}
+/// @}
+
+/// @name GPIO, used by HAL::QIO.
+/// @{
+
+/// A GPIO port, only the set/reset registers used by HAL::QIO.
+typedef struct
+{
+	volatile uint16_t BSRRL;
+	volatile uint16_t BSRRH;
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef HostGPIO[9];	///< Simulated GPIO ports, A to I.
+
+#define GPIOA (HostGPIO+0)
+#define GPIOB (HostGPIO+1)
+#define GPIOC (HostGPIO+2)
+#define GPIOD (HostGPIO+3)
+#define GPIOE (HostGPIO+4)
+#define GPIOF (HostGPIO+5)
+#define GPIOG (HostGPIO+6)
+#define GPIOH (HostGPIO+7)
+#define GPIOI (HostGPIO+8)
+
+typedef enum { GPIO_Mode_IN, GPIO_Mode_OUT, GPIO_Mode_AF, GPIO_Mode_AN } GPIOMode_TypeDef;
+typedef enum { GPIO_OType_PP, GPIO_OType_OD } GPIOOType_TypeDef;
+typedef enum { GPIO_Speed_2MHz, GPIO_Speed_25MHz, GPIO_Speed_50MHz, GPIO_Speed_100MHz } GPIOSpeed_TypeDef;
+typedef enum { GPIO_PuPd_NOPULL, GPIO_PuPd_UP, GPIO_PuPd_DOWN } GPIOPuPd_TypeDef;
+
+typedef struct
+{
+	uint32_t GPIO_Pin;
+	GPIOMode_TypeDef GPIO_Mode;
+	GPIOSpeed_TypeDef GPIO_Speed;
+	GPIOOType_TypeDef GPIO_OType;
+	GPIOPuPd_TypeDef GPIO_PuPd;
+} GPIO_InitTypeDef;
+
+/// @}
+
+#endif // HAL_HOST_H
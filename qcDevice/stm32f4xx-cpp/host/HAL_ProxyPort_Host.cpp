@@ -0,0 +1,116 @@
+#include "HAL_ProxyPort.hpp"
+#include "HwInterface_ProxyCom.hpp"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <poll.h>
+
+using namespace HAL;
+
+/// @name State of the pseudo terminal.
+/// @{
+static int masterFd = -1;		///< Master side, this is the device end.
+static int slaveFd = -1;		///< Slave side, kept open so the master doesn't get EIO while qcProxy is not connected.
+static char slavePath[128] = "";
+static bool transmitEnabled = false;
+static char transmitBuffer[256];	///< Bytes taken from ProxyCom, but not yet written to the pseudo terminal.
+static uint16_t transmitLength = 0;
+/// @}
+
+/// Take bytes from ProxyCom while transmit is enabled (as the TXE interrupt would), and write them to the pseudo terminal.
+static void flushTransmit()
+{
+	while( transmitEnabled && transmitLength < sizeof(transmitBuffer) )
+		{ HwInterface::ProxyCom::handleTransmitEmpty(); }
+
+	if( !transmitLength )
+		{ return; }
+
+	ssize_t written = write( masterFd, transmitBuffer, transmitLength );
+	if( written > 0 )
+	{
+		memmove( transmitBuffer, transmitBuffer+written, transmitLength-written );
+		transmitLength -= written;
+	}
+}
+
+bool ProxyPort::init()
+{
+	masterFd = posix_openpt( O_RDWR | O_NOCTTY );
+	if( masterFd < 0 )
+		{ return false; }
+	if( grantpt(masterFd) != 0 || unlockpt(masterFd) != 0 || !ptsname(masterFd) )
+	{
+		close( masterFd );
+		masterFd = -1;
+		return false;
+	}
+	strncpy( slavePath, ptsname(masterFd), sizeof(slavePath)-1 );
+
+	// raw 8 bit line, as an USART
+	termios tio;
+	tcgetattr( masterFd, &tio );
+	cfmakeraw( &tio );
+	tcsetattr( masterFd, TCSANOW, &tio );
+
+	fcntl( masterFd, F_SETFL, fcntl(masterFd, F_GETFL) | O_NONBLOCK );
+	slaveFd = open( slavePath, O_RDWR | O_NOCTTY );
+	return true;
+}
+
+void ProxyPort::start()
+{}
+
+void ProxyPort::stop()
+{
+	transmitEnabled = false;
+	transmitLength = 0;
+}
+
+void ProxyPort::enableTransmit()
+{
+	transmitEnabled = true;
+}
+
+void ProxyPort::disableTransmit()
+{
+	transmitEnabled = false;
+}
+
+void ProxyPort::sendByte( char const byte )
+{
+	transmitBuffer[transmitLength++] = byte;
+}
+
+char const *ProxyPort::getPath()
+{
+	return slavePath;
+}
+
+void ProxyPort::poll( int const timeoutMs )
+{
+	if( masterFd < 0 )
+		{ return; }
+
+	flushTransmit();
+
+	pollfd pfd;
+	pfd.fd = masterFd;
+	pfd.events = POLLIN;
+	if( transmitLength )
+		{ pfd.events |= POLLOUT; }
+	pfd.revents = 0;
+
+	if( ::poll( &pfd, 1, timeoutMs ) > 0 && ( pfd.revents & POLLIN ) )
+	{
+		char buf[256];
+		ssize_t len = read( masterFd, buf, sizeof(buf) );
+		for( ssize_t i=0; i<len; ++i )
+			{ HwInterface::ProxyCom::handleNewData( (uint8_t)buf[i] ); }
+	}
+
+	flushTransmit();
+}
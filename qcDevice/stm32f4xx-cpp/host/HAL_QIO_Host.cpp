@@ -0,0 +1,39 @@
+#include "HAL_QIO.hpp"
+
+using namespace HAL;
+
+GPIO_TypeDef HostGPIO[9] = {};
+
+GPIO_InitTypeDef QIO::InitStruct =
+{
+	0,
+	GPIO_Mode_OUT,
+	GPIO_Speed_100MHz,
+	GPIO_OType_PP,
+	GPIO_PuPd_NOPULL
+};
+
+QIO::QIO( GPIO_TypeDef* const &ioPort, uint8_t const &ioPinBit ) :
+	mPort(ioPort),
+	mPinBit(ioPinBit),
+	mPin(1<<ioPinBit)
+{}
+
+void QIO::init( GPIO_TypeDef* const &/*GPIOx*/, uint32_t const &pin, const GPIOMode_TypeDef &ioMode, const GPIOOType_TypeDef &oType, const GPIOPuPd_TypeDef &ppType, const GPIOSpeed_TypeDef &ioSpeed, bool /*initClock*/ )
+{
+	InitStruct.GPIO_Pin = pin;
+	InitStruct.GPIO_Mode = ioMode;
+	InitStruct.GPIO_Speed = ioSpeed;
+	InitStruct.GPIO_OType = oType;
+	InitStruct.GPIO_PuPd = ppType;
+}
+
+void QIO::init( const GPIOMode_TypeDef &ioMode, const GPIOOType_TypeDef& oType, const GPIOPuPd_TypeDef& ppType, const GPIOSpeed_TypeDef& ioSpeed )
+{
+	init( mPort, mPin, ioMode, oType, ppType, ioSpeed, false );
+}
+
+void QIO::enablePortRCC( GPIO_TypeDef* const &/*GPIOx*/ )
+{
+	// no clocks on the host
+}
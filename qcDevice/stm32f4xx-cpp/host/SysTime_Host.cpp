@@ -0,0 +1,69 @@
+#include "SysTime.hpp"
+#include <time.h>
+
+/// Ticks (us) in a timer period, same as Conf::SysTime::period on the MCU, so the timestamps look the same.
+static uint64_t const HostTimerPeriod = 4294000000ULL;
+
+/// The monotonic clock at SysTime::init(), in us.
+static uint64_t hostStartUs = 0;
+
+/// Get the microseconds since SysTime::init().
+static uint64_t hostElapsedUs()
+{
+	timespec ts;
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return (uint64_t)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000 - hostStartUs;
+}
+
+/// Convert a timestamp to microseconds since SysTime::init().
+static uint64_t stampToUs( SysTime::sysTimeStamp_t const &stamp )
+{
+	return (uint64_t)stamp.ovf * HostTimerPeriod + stamp.cnt;
+}
+
+uint16_t SysTime::mOvfCnt = 0;
+SysTime::sysTimeStamp_t const SysTime::NullTime = {0,0};
+
+void SysTime::init(void)
+{
+	hostStartUs = 0;
+	hostStartUs = hostElapsedUs();
+}
+
+void SysTime::start(void)
+{}
+
+SysTime::sysTimeStamp_t const SysTime::getTimeStamp(void)
+{
+	uint64_t us = hostElapsedUs();
+	sysTimeStamp_t stamp = { (uint32_t)(us % HostTimerPeriod), (uint16_t)(us / HostTimerPeriod) };
+	return stamp;
+}
+
+bool SysTime::getUsSince( sysTimeStamp_t const &timeStamp, uint32_t &usSinceTimeStamp )
+{
+	uint64_t now = hostElapsedUs();
+	uint64_t then = stampToUs( timeStamp );
+
+	// future stamp, or too long ago
+	if( then > now || now - then > 0xFFFFFFFFULL )
+	{
+		usSinceTimeStamp = 0;
+		return false;
+	}
+
+	usSinceTimeStamp = (uint32_t)( now - then );
+	return true;
+}
+
+SysTime::sysTime_t SysTime::getTimeSince( sysTimeStamp_t const &timeStamp )
+{
+	uint64_t now = hostElapsedUs();
+	uint64_t then = stampToUs( timeStamp );
+	uint64_t diff = ( now > then ) ? ( now - then ) : 0;
+
+	sysTime_t timeSince;
+	timeSince.sec = diff / 1000000ULL;
+	timeSince.usec = diff % 1000000ULL;
+	return timeSince;
+}
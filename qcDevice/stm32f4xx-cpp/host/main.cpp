@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "SysTime.hpp"
+#include "QtuC_Tools.hpp"
+#include "QtuC_Interfaces.hpp"
+#include "QtuC_Streams.hpp"
+#include "HwInterface_ProxyCom.hpp"
+#include "HwInterface_Led.hpp"
+#include "BatchBench.hpp"
+
+/** Device parameters.
+ *	Same as in the firmware, except the platform.*/
+char const *deviceParams[] = {
+	"name", "qcDevice",
+	"desc", "Example code for a qcDevice implementation, running on the host",
+	"platform", "host",
+	"project", "QtuC",
+	"timeTicksPerMs", "1000",
+	"positiveAck", "false",
+	0	// this terminating NULL pointer is necessary
+};
+
+/** Run the device framework on the host.
+ *	The device is served on a pseudo terminal, set its path as devicePort/portName in qcProxy.
+ *	Usage: qcDeviceHost [linkPath]
+ *	If linkPath is given, a symlink is created there to the pseudo terminal, so the path can be fixed in the qcProxy settings.
+ *	Usage: qcDeviceHost --bench-batch [varCount] [rounds]
+ *	Run the batched command benchmark (see BatchBench) instead of serving the device.*/
+int main( int argc, char *argv[] )
+{
+	// start system timer
+	SysTime::init();
+	SysTime::start();
+
+	// Register the device interfaces
+	QtuC::Interfaces::regInterface<HwInterface::ProxyCom>();
+	QtuC::Interfaces::regInterface<HwInterface::Led>();
+
+	if( argc > 1 && strcmp( argv[1], "--bench-batch" ) == 0 )
+	{
+		int varCount = ( argc > 2 ) ? atoi( argv[2] ) : 20;
+		int rounds = ( argc > 3 ) ? atoi( argv[3] ) : 10000;
+		return BatchBench::run( varCount > 0 && varCount < 256 ? varCount : 0, rounds > 0 ? rounds : 0 );
+	}
+
+	// Initialize and start interfaces
+	if( !HwInterface::ProxyCom::init() )
+	{
+		perror( "Failed to open the pseudo terminal" );
+		return 1;
+	}
+
+	char const *portPath = HAL::ProxyPort::getPath();
+	if( argc > 1 )
+	{
+		unlink( argv[1] );
+		if( symlink( portPath, argv[1] ) == 0 )
+			{ portPath = argv[1]; }
+		else
+			{ perror( "Failed to create the symlink" ); }
+	}
+	printf( "qcDevice is running on %s\n", portPath );
+	fflush( stdout );
+
+	HwInterface::ProxyCom::start();
+
+	HwInterface::Led::init();
+	HwInterface::Led::start();
+
+	// We are ready, send device greeting message
+	QtuC::Tools::sendGreeting( deviceParams, "Hi proxy!" );
+
+	// The main loop
+	char cmd[QtuC::Conf::maxCommandLength];
+	while(1)
+	{
+		// Serve the port, this replaces the USART interrupt
+		HAL::ProxyPort::poll( 1 );
+
+		// Receive next pending command and route it to the proper interface
+		while( HwInterface::ProxyCom::isCommandReady() )
+		{
+			HwInterface::ProxyCom::getNextCommand(cmd);
+			QtuC::Interfaces::routeCmd(cmd);
+		}
+
+		// Push the streamed variables which are due
+		QtuC::Streams::tick();
+
+		// Acknowledge the processed commands, and report the commands lost in either direction
+		HwInterface::ProxyCom::acknowledgeReceived();
+		HwInterface::ProxyCom::reportOverflow();
+	}
+
+	return 0;
+}
+
+
+// Print implementation for QtuC::Tools.
+void QtuC::print( const char *str )
+{
+	if( BatchBench::isRunning() )
+		{ BatchBench::capture( str ); }
+	else
+		{ HwInterface::ProxyCom::print( str ); }
+}
+
+// PutChar implementation for QtuC::Tools.
+void QtuC::putChar( const char c )
+{
+	if( BatchBench::isRunning() )
+		{ BatchBench::capture( c ); }
+	else
+		{ HwInterface::ProxyCom::putChar(c); }
+}
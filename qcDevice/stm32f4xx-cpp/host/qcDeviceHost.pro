@@ -0,0 +1,63 @@
+#-------------------------------------------------
+#
+# Host build of the qcDevice framework core.
+# The firmware sources are compiled with QTUC_HOST defined, the platform
+# dependent parts (HAL, SysTime) are replaced with the implementations in
+# this directory. The device is served on a pseudo terminal (unix only).
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = qcDeviceHost
+CONFIG   += console
+CONFIG   -= qt app_bundle
+
+TEMPLATE = app
+
+DEFINES += QTUC_HOST
+
+SRC = $$PWD/../src
+
+SOURCES += main.cpp \
+    HAL_ProxyPort_Host.cpp \
+    HAL_QIO_Host.cpp \
+    SysTime_Host.cpp \
+    BatchBench.cpp \
+    $$SRC/QtuC_Tools.cpp \
+    $$SRC/QtuC_Interfaces.cpp \
+    $$SRC/QtuC_Streams.cpp \
+    $$SRC/QtuC_Binary.cpp \
+    $$SRC/HwInterface_ProxyCom.cpp \
+    $$SRC/HwInterface_Led.cpp
+
+HEADERS += \
+    HAL_Host.hpp \
+    BatchBench.hpp \
+    $$SRC/HAL_Platform.hpp \
+    $$SRC/HAL_ProxyPort.hpp \
+    $$SRC/HAL_QIO.hpp \
+    $$SRC/SysTime.hpp \
+    $$SRC/QtuC_Tools.hpp \
+    $$SRC/QtuC_RingBuffer.hpp \
+    $$SRC/QtuC_HashIndex.hpp \
+    $$SRC/QtuC_Interfaces.hpp \
+    $$SRC/QtuC_Streams.hpp \
+    $$SRC/QtuC_Binary.hpp \
+    $$SRC/HwInterface_ProxyCom.hpp \
+    $$SRC/HwInterface_Led.hpp \
+    $$SRC/DeviceAPI_Schema.hpp
+
+INCLUDEPATH += $$PWD $$SRC
+DEPENDPATH += $$SRC
+
+# The variable schema of the firmware is generated from its deviceAPI with qcApiGen (see doc/deviceAPI.xml.md).
+# It's kept in the source directory, so the firmware builds without qcApiGen, and regenerated here when the deviceAPI changes.
+# Set QCAPIGEN in the environment if qcApiGen is not in the PATH.
+QCAPIGEN = $$(QCAPIGEN)
+isEmpty(QCAPIGEN): QCAPIGEN = qcApiGen
+apiSchema.target = $$SRC/DeviceAPI_Schema.hpp
+apiSchema.depends = $$PWD/../deviceAPI.xml
+apiSchema.commands = $$QCAPIGEN --firmware $$PWD/../deviceAPI.xml $$SRC
+QMAKE_EXTRA_TARGETS += apiSchema
+PRE_TARGETDEPS += $$SRC/DeviceAPI_Schema.hpp
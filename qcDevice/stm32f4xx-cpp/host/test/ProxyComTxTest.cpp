@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "HAL_ProxyPort.hpp"
+#include "HwInterface_ProxyCom.hpp"
+
+/** @file
+ *	Host test of the transmit ring buffer of HwInterface::ProxyCom.
+ *	HAL::ProxyPort is replaced with a model of the USART: transmit enable is the TXE interrupt enable (TXEIE),
+ *	and drain() calls HwInterface::ProxyCom::handleTransmitEmpty() as the TXE interrupt would, taking the bytes off the "wire".
+ *	Checked: the buffer wraps around without losing or reordering bytes, a line which doesn't fit is dropped whole and counted,
+ *	transmit is disabled when the buffer is empty, and a flow control acknowledge dropped on a full buffer is sent again.*/
+
+using HwInterface::ProxyCom;
+
+/// @name Model of the USART.
+/// @{
+static bool txeInterruptEnabled = false;	///< TXEIE.
+static std::string wire;					///< The bytes sent so far.
+/// @}
+
+bool HAL::ProxyPort::init()
+	{ return true; }
+
+void HAL::ProxyPort::start()
+{}
+
+void HAL::ProxyPort::stop()
+	{ txeInterruptEnabled = false; }
+
+void HAL::ProxyPort::enableTransmit()
+	{ txeInterruptEnabled = true; }
+
+void HAL::ProxyPort::disableTransmit()
+	{ txeInterruptEnabled = false; }
+
+void HAL::ProxyPort::sendByte( char const byte )
+	{ wire += byte; }
+
+/** Run the TXE interrupt while it's enabled, at most maxBytes times.
+ *	@param maxBytes Maximum number of interrupts, -1 to drain the buffer.
+ *	@return Number of bytes sent.*/
+static int drain( int maxBytes = -1 )
+{
+	size_t sent = wire.size();
+	for( int i=0; txeInterruptEnabled && ( maxBytes < 0 || i < maxBytes ); ++i )
+		{ ProxyCom::handleTransmitEmpty(); }
+	return wire.size() - sent;
+}
+
+// Print implementation for QtuC::Tools.
+void QtuC::print( const char *str )
+	{ ProxyCom::print( str ); }
+
+// PutChar implementation for QtuC::Tools.
+void QtuC::putChar( const char c )
+	{ ProxyCom::putChar(c); }
+
+static int failCount = 0;
+
+#define CHECK(cond)	\
+	do { if( !(cond) ) { ++failCount; printf( "FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond ); } } while(0)
+
+/// Build a line of len bytes (newline included), the content depends on seq, so a reordered or mixed line shows.
+static std::string makeLine( unsigned const seq, unsigned const len )
+{
+	std::string line;
+	for( unsigned i=0; i+1<len; ++i )
+		{ line += (char)( 'a' + ( seq + i ) % 26 ); }
+	line += '\n';
+	return line;
+}
+
+/// A queued line is sent as is, and transmit stops when the buffer is empty.
+static void testSendAndStop()
+{
+	wire.clear();
+	CHECK( ProxyCom::print( "set led dY 1\n" ) == 13 );
+	CHECK( txeInterruptEnabled );
+	CHECK( drain() == 13 );
+	CHECK( wire == "set led dY 1\n" );
+	CHECK( !txeInterruptEnabled );
+}
+
+/// Queue and drain at different paces, so the indices wrap around the buffer many times at every offset.
+static void testWraparound()
+{
+	wire.clear();
+	std::string expected;
+	uint32_t overflowCount = ProxyCom::getTransmitOverflowCount();
+	for( unsigned seq=0; seq<2000; ++seq )
+	{
+		std::string line = makeLine( seq, 1 + seq * 37 % 97 );
+		CHECK( ProxyCom::print( line.c_str() ) == (uint16_t)line.size() );
+		expected += line;
+		drain( 40 + seq * 53 % 61 );	// faster than queued on average, so nothing is dropped
+	}
+	drain();
+	CHECK( wire == expected );
+	CHECK( ProxyCom::getTransmitOverflowCount() == overflowCount );
+}
+
+/// Fill the buffer, the lines which don't fit are dropped whole and counted, the smaller ones still fit.
+static void testOverflow()
+{
+	wire.clear();
+	std::string expected;
+	uint32_t overflowCount = ProxyCom::getTransmitOverflowCount();
+
+	// the capacity is 511 bytes, the 6th line of 100 bytes doesn't fit
+	for( unsigned seq=0; seq<5; ++seq )
+	{
+		std::string line = makeLine( seq, 100 );
+		CHECK( ProxyCom::print( line.c_str() ) == 100 );
+		expected += line;
+	}
+	std::string dropped = makeLine( 5, 100 );
+	CHECK( ProxyCom::print( dropped.c_str() ) == 0 );
+	CHECK( ProxyCom::print( dropped.c_str() ) == 0 );
+	CHECK( ProxyCom::getTransmitOverflowCount() == overflowCount + 2 );
+
+	// exactly the free space still fits
+	std::string last = makeLine( 6, 11 );
+	CHECK( ProxyCom::print( last.c_str() ) == 11 );
+	expected += last;
+	CHECK( ProxyCom::print( "\n" ) == 0 );
+	CHECK( ProxyCom::getTransmitOverflowCount() == overflowCount + 3 );
+
+	// after some bytes are sent, a line fits again, at the wrapped end of the buffer
+	drain( 150 );
+	std::string wrapped = makeLine( 7, 120 );
+	CHECK( ProxyCom::print( wrapped.c_str() ) == 120 );
+	expected += wrapped;
+
+	drain();
+	CHECK( wire == expected );
+	CHECK( ProxyCom::getTransmitOverflowCount() == overflowCount + 3 );
+	CHECK( !txeInterruptEnabled );
+}
+
+/// Receive a command, as the port does, and take it out of the receive buffer, as the main loop does.
+static void receive( std::string const &line )
+{
+	for( size_t i=0; i<line.size(); ++i )
+		{ ProxyCom::handleNewData( (uint8_t)line[i] ); }
+	char cmd[QtuC::Conf::maxCommandLength];
+	ProxyCom::getNextCommand( cmd );
+}
+
+/// The flow control acknowledge is not lost when the transmit buffer is full, it's sent on a later call.
+static void testAckRetry()
+{
+	wire.clear();
+	char var[] = "flowControl";
+	char arg[] = "1";
+	CHECK( ProxyCom::execCmd( QtuC::cmdCall, var, arg ) );
+
+	// free a quarter of the receive buffer, an acknowledge is due
+	for( unsigned seq=0; seq<QtuC::Conf::receiveBufferSize/4/32 + 1; ++seq )
+		{ receive( makeLine( seq, 32 ) ); }
+
+	// fill the transmit buffer to the last byte
+	uint32_t overflowCount = ProxyCom::getTransmitOverflowCount();
+	while( ProxyCom::print( makeLine( 0, 50 ).c_str() ) ) {}
+	while( ProxyCom::print( "\n" ) ) {}
+	ProxyCom::acknowledgeReceived();
+	CHECK( ProxyCom::getTransmitOverflowCount() == overflowCount + 3 );
+	drain();
+	CHECK( wire.find( "rxAck" ) == std::string::npos );
+
+	// sent once there's room, and only once
+	wire.clear();
+	ProxyCom::acknowledgeReceived();
+	ProxyCom::acknowledgeReceived();
+	drain();
+	CHECK( wire.find( "rxAck" ) != std::string::npos );
+	CHECK( wire.find( "rxAck" ) == wire.rfind( "rxAck" ) );
+
+	arg[0] = '0';
+	ProxyCom::execCmd( QtuC::cmdCall, var, arg );
+}
+
+int main()
+{
+	ProxyCom::init();
+	ProxyCom::start();
+	drain();	// the newline of start()
+
+	testSendAndStop();
+	testWraparound();
+	testOverflow();
+	testAckRetry();
+
+	if( failCount )
+	{
+		printf( "%d checks failed\n", failCount );
+		return 1;
+	}
+	printf( "All checks passed\n" );
+	return 0;
+}
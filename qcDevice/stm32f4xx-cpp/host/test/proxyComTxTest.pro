@@ -0,0 +1,36 @@
+#-------------------------------------------------
+#
+# Host test of the transmit ring buffer of HwInterface::ProxyCom.
+# HAL::ProxyPort is modelled in the test, run the binary: it prints the
+# failed checks and returns non-zero on failure.
+#
+#-------------------------------------------------
+
+QT       -= core gui
+
+TARGET = proxyComTxTest
+CONFIG   += console
+CONFIG   -= qt app_bundle
+
+TEMPLATE = app
+
+DEFINES += QTUC_HOST
+
+SRC = $$PWD/../../src
+
+SOURCES += ProxyComTxTest.cpp \
+    ../SysTime_Host.cpp \
+    $$SRC/QtuC_Tools.cpp \
+    $$SRC/QtuC_Interfaces.cpp \
+    $$SRC/QtuC_Streams.cpp \
+    $$SRC/QtuC_Binary.cpp \
+    $$SRC/HwInterface_ProxyCom.cpp
+
+HEADERS += \
+    ../HAL_Host.hpp \
+    $$SRC/HAL_ProxyPort.hpp \
+    $$SRC/QtuC_RingBuffer.hpp \
+    $$SRC/HwInterface_ProxyCom.hpp
+
+INCLUDEPATH += $$PWD/.. $$SRC
+DEPENDPATH += $$SRC
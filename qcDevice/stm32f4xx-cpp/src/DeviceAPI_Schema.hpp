@@ -0,0 +1,77 @@
+// Generated by qcApiGen from the deviceAPI, don't edit.
+#ifndef DEVICEAPI_SCHEMA_H
+#define DEVICEAPI_SCHEMA_H
+
+#include "QtuC_Tools.hpp"
+#include <stdlib.h>
+
+/** The variables of the deviceAPI.
+ *	The id of a variable is its index in the deviceAPI, the same as in qcProxy, and the same as the binary id qcProxy assigns to it (see QtuC::Binary).
+ *	Every variable has a namespace in the namespace of its interface, with the id, the name, the type of the value,
+ *	send() to send the value to qcProxy, and parse() to parse a value received from qcProxy.*/
+namespace DeviceAPI
+{
+
+char const ApiHash[] = {"9b4e99a0a35a613c72d5b21ff387cc96"};	///< MD5 hash of the deviceAPI, as in qcProxy.
+
+/// Ids of the variables.
+enum varId_t
+{
+	led_stmGreen = 0,
+	led_stmOrange = 1,
+	led_stmRed = 2,
+	led_stmBlue = 3,
+	VarCount
+};
+
+namespace led
+{
+	char const InterfaceName[] = {"led"};
+
+	namespace stmGreen
+	{
+		varId_t const Id = led_stmGreen;
+		char const Name[] = {"stmGreen"};
+		typedef bool type_t;
+		inline bool send( type_t const value )
+			{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ? "1" : "0" ); }
+		inline bool parse( char const *arg, type_t &value )
+			{ value = QtuC::isTrue( arg ); return *arg; }
+	}
+
+	namespace stmOrange
+	{
+		varId_t const Id = led_stmOrange;
+		char const Name[] = {"stmOrange"};
+		typedef bool type_t;
+		inline bool send( type_t const value )
+			{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ? "1" : "0" ); }
+		inline bool parse( char const *arg, type_t &value )
+			{ value = QtuC::isTrue( arg ); return *arg; }
+	}
+
+	namespace stmRed
+	{
+		varId_t const Id = led_stmRed;
+		char const Name[] = {"stmRed"};
+		typedef bool type_t;
+		inline bool send( type_t const value )
+			{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ? "1" : "0" ); }
+		inline bool parse( char const *arg, type_t &value )
+			{ value = QtuC::isTrue( arg ); return *arg; }
+	}
+
+	namespace stmBlue
+	{
+		varId_t const Id = led_stmBlue;
+		char const Name[] = {"stmBlue"};
+		typedef bool type_t;
+		inline bool send( type_t const value )
+			{ return QtuC::Tools::sendCommand( QtuC::cmdSet, InterfaceName, Name, value ? "1" : "0" ); }
+		inline bool parse( char const *arg, type_t &value )
+			{ value = QtuC::isTrue( arg ); return *arg; }
+	}
+}
+
+}	//DeviceAPI::
+#endif // DEVICEAPI_SCHEMA_H
@@ -0,0 +1,17 @@
+/** @file
+ *	Platform selection.
+ *	The framework core and the HAL headers include this instead of the STM32 headers directly.
+ *	If QTUC_HOST is defined, the host platform (host/HAL_Host.hpp) is used, so the framework core can be built and run on a PC (see host/qcDeviceHost.pro).
+ *	Otherwise the STM32F4 Standard Peripheral Library is included.*/
+
+#ifndef HAL_PLATFORM_H
+#define HAL_PLATFORM_H
+
+#ifdef QTUC_HOST
+#include "HAL_Host.hpp"
+#else
+#include "stm32f4xx_conf.h"
+#include "UserCoreConfig.hpp"
+#endif
+
+#endif // HAL_PLATFORM_H
@@ -0,0 +1,99 @@
+#ifndef HAL_PROXYPORT_H
+#define HAL_PROXYPORT_H
+
+#include "HAL_Platform.hpp"
+
+#ifndef QTUC_HOST
+// These must be in global scope
+#define Conf_ProxyPort_USART_IRQHandler USART1_IRQHandler(void)
+extern "C" void Conf_ProxyPort_USART_IRQHandler;
+
+namespace HAL
+{
+
+namespace Conf
+{
+	/// This is a full configuration set, you can safely change it without modifying the implementation code.
+	namespace ProxyPort
+	{
+		namespace Pin
+		{
+			namespace TX {
+				uint32_t const pin = GPIO_Pin_6;
+				GPIO_TypeDef *const port = GPIOB;
+				uint32_t const portRCC = RCC_AHB1Periph_GPIOB;
+				uint8_t const AFPinSource = GPIO_PinSource6;
+			}
+			namespace RX {
+				uint32_t const pin = GPIO_Pin_7;
+				GPIO_TypeDef *const port = GPIOB;
+				uint32_t const portRCC = RCC_AHB1Periph_GPIOB;
+				uint8_t const AFPinSource = GPIO_PinSource7;
+			}
+		}
+		namespace USART
+		{
+			USART_TypeDef* volatile const module = USART1;
+			uint32_t const moduleRCC = RCC_APB2Periph_USART1;
+			uint8_t const AFMap = GPIO_AF_USART1;
+			IRQn_Type const IRQCh = USART1_IRQn;
+			uint32_t const baudRate = 460800;
+		}
+	}
+}
+
+}	//HAL::
+#endif
+
+namespace HAL
+{
+
+/** The serial port to qcProxy, used by HwInterface::ProxyCom.
+ *	The port calls HwInterface::ProxyCom::handleNewData() with every received byte,
+ *	and HwInterface::ProxyCom::handleTransmitEmpty() when a byte can be sent, as long as transmit is enabled.
+ *	On the STM32F4, this is an USART and the callbacks run in its interrupt (HAL_ProxyPort_STM32F4.cpp).
+ *	On the host, this is a pseudo terminal, served from the main loop by poll() (host/HAL_ProxyPort_Host.cpp).*/
+class ProxyPort
+{
+private:
+	/// Private c'tor. This is a static class, don't instantiate.
+	ProxyPort(){}
+
+public:
+
+	/** Initialize the port.
+	 *	@return True on success, false otherwise.*/
+	static bool init();
+
+	/// Start receiving and transmitting.
+	static void start();
+
+	/// Stop the port.
+	static void stop();
+
+	/** Enable transmit.
+	 *	HwInterface::ProxyCom::handleTransmitEmpty() will be called until transmit is disabled.*/
+	static void enableTransmit();
+
+	/// Disable transmit.
+	static void disableTransmit();
+
+	/** Send a byte.
+	 *	Call only from HwInterface::ProxyCom::handleTransmitEmpty().
+	 *	@param byte The byte to send.*/
+	static void sendByte( char const byte );
+
+#ifdef QTUC_HOST
+	/** Get the path of the pseudo terminal, open this with qcProxy.
+	 *	@return The path of the slave side of the pseudo terminal, or an empty string if the port is not initialized.*/
+	static char const *getPath();
+
+	/** Serve the port: read the received bytes and write the pending transmit.
+	 *	Call it from the main loop, this replaces the USART interrupt.
+	 *	@param timeoutMs Maximum time to wait for data, in milliseconds.*/
+	static void poll( int const timeoutMs );
+#endif
+};
+
+}	//HAL::
+#endif // HAL_PROXYPORT_H
@@ -0,0 +1,160 @@
+#include "HAL_ProxyPort.hpp"
+#include "HwInterface_ProxyCom.hpp"
+#include <errno.h>
+#include <sys/unistd.h>
+
+/// The interrupt handler routine of USART.
+extern "C" void Conf_ProxyPort_USART_IRQHandler
+{
+	if( USART_GetITStatus(HAL::Conf::ProxyPort::USART::module, USART_IT_RXNE) != RESET )
+	{
+		/* Read one byte from the receive data register, and give it to ProxyCom */
+		HwInterface::ProxyCom::handleNewData( USART_ReceiveData(HAL::Conf::ProxyPort::USART::module) );
+	}
+	if( USART_GetITStatus(HAL::Conf::ProxyPort::USART::module, USART_IT_TXE) != RESET )
+	{
+		/* Transmit data register is empty, send the next byte */
+		HwInterface::ProxyCom::handleTransmitEmpty();
+	}
+}
+
+using namespace HAL;
+using namespace HAL::Conf::ProxyPort;
+
+bool ProxyPort::init()
+{
+	RCC_AHB1PeriphClockCmd( Pin::TX::portRCC | Pin::RX::portRCC, ENABLE);
+	/// @todo func ptr to RCC init funct!
+	RCC_APB2PeriphClockCmd( USART::moduleRCC, ENABLE );
+
+	GPIOB->BSRRH = Pin::TX::pin | Pin::RX::pin;
+
+	GPIO_InitTypeDef ioInit;
+	ioInit.GPIO_Speed = GPIO_Speed_100MHz;
+	ioInit.GPIO_Mode = GPIO_Mode_AF;
+	ioInit.GPIO_OType = GPIO_OType_PP;
+	ioInit.GPIO_PuPd = GPIO_PuPd_UP;
+
+	ioInit.GPIO_Pin = Pin::TX::pin;
+	GPIO_Init( Pin::TX::port, &ioInit );
+	ioInit.GPIO_Pin = Pin::RX::pin;
+	GPIO_Init( Pin::RX::port, &ioInit );
+
+	GPIO_PinAFConfig( Pin::TX::port, Pin::TX::AFPinSource, USART::AFMap );
+	GPIO_PinAFConfig( Pin::RX::port, Pin::RX::AFPinSource, USART::AFMap );
+
+	USART_InitTypeDef USART_InitStructure;
+	USART_InitStructure.USART_BaudRate = USART::baudRate;
+	USART_InitStructure.USART_WordLength = USART_WordLength_8b;
+	USART_InitStructure.USART_StopBits = USART_StopBits_1;
+	USART_InitStructure.USART_Parity = USART_Parity_No ;
+	USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
+	USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
+
+	/* Configure USART1 */
+	USART_Init( USART::module, &USART_InitStructure );
+
+	/* Enable the USART1 Interrupt */
+	NVIC_InitTypeDef NVIC_InitStructure;
+	NVIC_InitStructure.NVIC_IRQChannel = USART::IRQCh;
+	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
+	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 5;
+	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+	NVIC_Init(&NVIC_InitStructure);
+
+	return true;
+}
+
+void ProxyPort::start()
+{
+	USART_ITConfig( USART::module, USART_IT_RXNE, ENABLE );
+	USART_Cmd( USART::module, ENABLE );
+}
+
+void ProxyPort::stop()
+{
+	USART_ITConfig( USART::module, USART_IT_RXNE, DISABLE );
+	USART_ITConfig( USART::module, USART_IT_TXE, DISABLE );
+	USART_Cmd( USART::module, DISABLE );
+}
+
+void ProxyPort::enableTransmit()
+{
+	USART_ITConfig( USART::module, USART_IT_TXE, ENABLE );
+}
+
+void ProxyPort::disableTransmit()
+{
+	USART_ITConfig( USART::module, USART_IT_TXE, DISABLE );
+}
+
+void ProxyPort::sendByte( char const byte )
+{
+	USART_SendData( USART::module, (u8)byte );
+}
+
+
+extern "C"
+{
+
+/// Read implementation of the newlib stubs
+int _read(int file, char *ptr, int len)
+	{ return 0; }
+/// Write implementation of the newlib stubs
+int _write(int file, char *ptr, int len)
+	{ return 0; }
+
+// If you'd like to implement it...
+/*
+/// Read implementation of the newlib stubs
+int _read(int file, char *ptr, int len) {
+    int n;
+    int num = 0;
+    switch (file)
+    {
+		case STDIN_FILENO:
+			for( n = 0; n < len; n++ )
+			{
+				if( !HwiProxyCom::instance() ) break;
+
+				// ProxyCom doesn't have a getChar method, as it is fully RX interrupt driven.
+				char c = HwInterface::ProxyCom::
+
+				*ptr++ = c;
+				num++;
+			} break;
+		default:
+			errno = EBADF;
+			return -1;
+    }
+    return num;
+}
+
+/// Write implementation of the newlib stubs
+int _write(int file, char *ptr, int len)
+{
+    int n;
+    switch (file)
+    {
+		case STDOUT_FILENO:
+			for( n = 0; n < len; n++ )
+			{
+				if( !HwInterface::ProxyCom::started() ) break;
+				HwInterface::ProxyCom::putChar(*ptr++ & (uint16_t)0x01FF);
+			}
+			break;
+		case STDERR_FILENO:
+			for (n = 0; n < len; n++)
+			{
+				if( !HwInterface::ProxyCom::started() ) break;
+				HwInterface::ProxyCom::putChar(*ptr++ & (uint16_t)0x01FF);
+			}
+			break;
+		default:
+			errno = EBADF;
+			return -1;
+    }
+    return len;
+}
+*/
+}
@@ -1,7 +1,7 @@
 #ifndef HAL_QIO_H
 #define HAL_QIO_H
 
-#include "stm32f4xx_gpio.h"
+#include "HAL_Platform.hpp"
 
 /// @name Define pin bits
 /// @{
@@ -6,13 +6,15 @@ using namespace HwInterface::Conf::Led;
 const char Led::InterfaceName[] = {"led"};
 bool Led::mInitialized = false;
 bool Led::mStarted = false;
+bool Led::mStateList[] = {};
+QtuC::HashIndex<8> Led::mLedIndex;
 
 Led::led_t Led::mLedList[] =
 {
-	{ "stmGreen", HAL::QIO( Pin::stmGreen::port, Pin::stmGreen::bit ) },
-	{ "stmOrange", HAL::QIO( Pin::stmOrange::port, Pin::stmOrange::bit ) },
-	{ "stmRed", HAL::QIO( Pin::stmRed::port, Pin::stmRed::bit ) },
-	{ "stmBlue", HAL::QIO( Pin::stmBlue::port, Pin::stmBlue::bit ) }
+	{ DeviceAPI::led::stmGreen::Name, DeviceAPI::led::stmGreen::send, DeviceAPI::led::stmGreen::parse, HAL::QIO( Pin::stmGreen::port, Pin::stmGreen::bit ) },
+	{ DeviceAPI::led::stmOrange::Name, DeviceAPI::led::stmOrange::send, DeviceAPI::led::stmOrange::parse, HAL::QIO( Pin::stmOrange::port, Pin::stmOrange::bit ) },
+	{ DeviceAPI::led::stmRed::Name, DeviceAPI::led::stmRed::send, DeviceAPI::led::stmRed::parse, HAL::QIO( Pin::stmRed::port, Pin::stmRed::bit ) },
+	{ DeviceAPI::led::stmBlue::Name, DeviceAPI::led::stmBlue::send, DeviceAPI::led::stmBlue::parse, HAL::QIO( Pin::stmBlue::port, Pin::stmBlue::bit ) }
 };
 
 bool Led::init()
@@ -20,7 +22,10 @@ bool Led::init()
 	if( mInitialized ) { return true; }
 
 	for( uint8_t i=0; i<MLedCount; ++i )
-		{ mLedList[i].pin.init( GPIO_Mode_OUT ); }
+	{
+		mLedList[i].pin.init( GPIO_Mode_OUT );
+		mLedIndex.insert( QtuC::Tools::hash( mLedList[i].name ), i );
+	}
 	mInitialized = true;
 	return true;
 }
@@ -35,6 +40,7 @@ bool Led::start()
 
 void Led::set( ledId_t led, bool on )
 {
+	mStateList[led] = on;
 	if( on )
 		{ mLedList[led].pin.set(); }
 	else
@@ -44,19 +50,32 @@ void Led::set( ledId_t led, bool on )
 
 bool Led::execCmd( QtuC::cmdType_t type, char *var, char *arg )
 {
+	int16_t led = find( var );
+	if( led < 0 )
+		{ return false; }
+
 	if( type == QtuC::cmdSet )
 	{
-		bool state = QtuC::isTrue( arg );
-
-		for( uint8_t i=0; i<MLedCount; ++i )
-		{
-			if( QtuC::Tools::isArg( var, mLedList[i].name ) )
-			{
-				set( (ledId_t)i, state );
-				return true;
-			}
-		}
+		bool on;
+		if( !mLedList[led].parse( arg, on ) )
+			{ return false; }
+		set( (ledId_t)led, on );
+		return true;
 	}
+	else if( type == QtuC::cmdGet )
+		{ return mLedList[led].send( mStateList[led] ); }
 
 	return false;
 }
+
+int16_t Led::find( char const *name )
+{
+	uint8_t probe = 0;
+	uint32_t hash = QtuC::Tools::hash( name );
+	for( int16_t i = mLedIndex.find( hash, probe ); i >= 0; i = mLedIndex.find( hash, probe ) )
+	{
+		if( QtuC::Tools::isArg( name, mLedList[i].name ) )
+			{ return i; }
+	}
+	return -1;
+}
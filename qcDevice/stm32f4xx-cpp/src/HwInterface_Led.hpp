@@ -2,7 +2,9 @@
 #define HWINTERFACE_LED_H
 
 #include "QtuC_Tools.hpp"
+#include "QtuC_HashIndex.hpp"
 #include "HAL_QIO.hpp"
+#include "DeviceAPI_Schema.hpp"
 
 namespace HwInterface
 {
@@ -30,7 +32,7 @@ namespace Conf
 				uint8_t const bit = GPIO_Pin_15_Bit;
 				GPIO_TypeDef *const port = GPIOD;
 			}
-			// If you add a new LED, don't forget to update Led::MLedCount, Led::ledId_t, and Led::mLedList!
+			// If you add a new LED, don't forget to add it to the deviceAPI.xml and regenerate DeviceAPI_Schema.hpp, and update Led::MLedCount, Led::ledId_t, and Led::mLedList (and the size of Led::mLedIndex above 7 leds)!
 		}
 	}
 }
@@ -60,20 +62,24 @@ public:
 	static bool execCmd( QtuC::cmdType_t type, char *var, char *arg );
 
 	/** List of leds.
+	 *	The ids of the led variables in the deviceAPI (see DeviceAPI_Schema.hpp).
 	 *	This enum is used for indexing the array of available leds,
-	 *	so this must start with 0 and increase one-by-one.*/
+	 *	so the leds must be the first variables of the deviceAPI, in this order.*/
 	enum ledId_t {
-		stmGreen = 0,
-		stmOrange,
-		stmRed,
-		stmBlue,
+		stmGreen = DeviceAPI::led_stmGreen,
+		stmOrange = DeviceAPI::led_stmOrange,
+		stmRed = DeviceAPI::led_stmRed,
+		stmBlue = DeviceAPI::led_stmBlue,
 	};
 
 	/** Type for representing a led.
 	 *	name: Name of the led (use this in the device commands).<br>
+	 *	send, parse: The typed value functions of the led variable in the deviceAPI schema.<br>
 	 *	pin: Pin of the led.*/
 	struct led_t {
 		const char *name;
+		bool (*send)( bool const value );
+		bool (*parse)( char const *arg, bool &value );
 		HAL::QIO pin;
 	};
 
@@ -90,9 +96,21 @@ public:
 	*	@param led The led to turn off.*/
 	static inline void off( ledId_t led ) { HwInterface::Led::set(led, false); }
 
+	/** Get the state of a led.
+	 *	@param led The led.
+	 *	@return True if the led is on, false if it's off.*/
+	static inline bool isOn( ledId_t led ) { return mStateList[led]; }
+
 private:
+	/** Find a led by name.
+	 *	@param name Name of the led.
+	 *	@return Id of the led (ledId_t), or -1 if there's no such led.*/
+	static int16_t find( char const *name );
+
 	static const uint8_t MLedCount = 4;
 	static led_t mLedList[MLedCount];
+	static QtuC::HashIndex<8> mLedIndex;	///< Index of the led names, built in init().
+	static bool mStateList[MLedCount];	///< Last set state of the leds, to answer get commands.
 
 	static bool mInitialized;
 	static bool mStarted;
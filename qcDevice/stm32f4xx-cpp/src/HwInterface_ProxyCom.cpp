@@ -1,74 +1,40 @@
 #include "HwInterface_ProxyCom.hpp"
-#include <errno.h>
-#include <sys/unistd.h>
+#include "QtuC_Streams.hpp"
+#include "QtuC_Binary.hpp"
 #include <string.h>
 #include <stdio.h>
 
-/// The interrupt handler routine of USART.
-extern "C" void Conf_ProxyCom_USART_IRQHandler
-{
-	if( USART_GetITStatus(HwInterface::Conf::ProxyCom::USART::module, USART_IT_RXNE) != RESET )
-	{
-		/* Read one byte from the receive data register, and give it to ProxyCom */
-		HwInterface::ProxyCom::handleNewData( USART_ReceiveData(HwInterface::Conf::ProxyCom::USART::module) );
-	}
-}
-
 using namespace HwInterface;
-using namespace HwInterface::Conf::ProxyCom;
 
 const char *ProxyCom::InterfaceName = QtuC::Conf::proxyInterfaceName;
 bool ProxyCom::mInitialized = false;
 bool ProxyCom::mStarted = false;
 
-char ProxyCom::mReceiveBuffer[][ProxyCom::MReceiveBufferCmdSize] = {};
-
-uint8_t ProxyCom::mReceiveBufferPtr = 0;
-uint8_t ProxyCom::mReceiveBufferCmdWPtr = 0;
-uint8_t ProxyCom::mReceiveBufferCmdRPtr = 0;
+QtuC::RingBuffer<QtuC::Conf::receiveBufferSize> ProxyCom::mReceiveBuffer;
+uint8_t ProxyCom::mReceiveCmdLength = 0;
+bool ProxyCom::mReceiveDropping = false;
+volatile uint16_t ProxyCom::mReceivedCmdCount = 0;
+uint16_t ProxyCom::mReadCmdCount = 0;
+volatile uint32_t ProxyCom::mReceivedByteCount = 0;
+volatile uint16_t ProxyCom::mReceiveHighWater = 0;
+volatile uint32_t ProxyCom::mReceiveOverflowCount = 0;
+volatile uint32_t ProxyCom::mReceiveTooLongCount = 0;
+uint32_t ProxyCom::mReportedReceiveDropCount = 0;
+
+bool ProxyCom::mFlowControl = false;
+uint32_t ProxyCom::mFlowBase = 0;
+uint32_t ProxyCom::mFlowAcked = 0;
+
+QtuC::RingBuffer<ProxyCom::MTransmitBufferSize> ProxyCom::mTransmitBuffer;
+volatile uint32_t ProxyCom::mTransmitOverflowCount = 0;
+uint32_t ProxyCom::mReportedTransmitOverflowCount = 0;
 
 bool ProxyCom::init()
 {
 	if( mInitialized ) { return true; }
 
-	RCC_AHB1PeriphClockCmd( Pin::TX::portRCC | Pin::RX::portRCC, ENABLE);
-	/// @todo func ptr to RCC init funct!
-	RCC_APB2PeriphClockCmd( USART::moduleRCC, ENABLE );
-
-	GPIOB->BSRRH = Pin::TX::pin | Pin::RX::pin;
-
-	GPIO_InitTypeDef ioInit;
-	ioInit.GPIO_Speed = GPIO_Speed_100MHz;
-	ioInit.GPIO_Mode = GPIO_Mode_AF;
-	ioInit.GPIO_OType = GPIO_OType_PP;
-	ioInit.GPIO_PuPd = GPIO_PuPd_UP;
-
-	ioInit.GPIO_Pin = Pin::TX::pin;
-	GPIO_Init( Pin::TX::port, &ioInit );
-	ioInit.GPIO_Pin = Pin::RX::pin;
-	GPIO_Init( Pin::RX::port, &ioInit );
-
-	GPIO_PinAFConfig( Pin::TX::port, Pin::TX::AFPinSource, USART::AFMap );
-	GPIO_PinAFConfig( Pin::RX::port, Pin::RX::AFPinSource, USART::AFMap );
-
-	USART_InitTypeDef USART_InitStructure;
-	USART_InitStructure.USART_BaudRate = USART::baudRate;
-	USART_InitStructure.USART_WordLength = USART_WordLength_8b;
-	USART_InitStructure.USART_StopBits = USART_StopBits_1;
-	USART_InitStructure.USART_Parity = USART_Parity_No ;
-	USART_InitStructure.USART_HardwareFlowControl = USART_HardwareFlowControl_None;
-	USART_InitStructure.USART_Mode = USART_Mode_Rx | USART_Mode_Tx;
-
-	/* Configure USART1 */
-	USART_Init( USART::module, &USART_InitStructure );
-
-	/* Enable the USART1 Interrupt */
-	NVIC_InitTypeDef NVIC_InitStructure;
-	NVIC_InitStructure.NVIC_IRQChannel = USART::IRQCh;
-	NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0;
-	NVIC_InitStructure.NVIC_IRQChannelSubPriority = 5;
-	NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
-	NVIC_Init(&NVIC_InitStructure);
+	if( !HAL::ProxyPort::init() )
+		{ return false; }
 
 	mInitialized = true;
 	return true;
@@ -78,8 +44,7 @@ bool ProxyCom::start()
 {
 	if( mStarted ) { return true; }
 
-	USART_ITConfig( USART::module, USART_IT_RXNE, ENABLE );
-	USART_Cmd( USART::module, ENABLE );
+	HAL::ProxyPort::start();
 
 	mStarted = true;
 
@@ -91,15 +56,30 @@ bool ProxyCom::start()
 
 void ProxyCom::stop()
 {
-	USART_ITConfig( USART::module, USART_IT_RXNE, DISABLE );
-	USART_Cmd( USART::module, DISABLE );
+	HAL::ProxyPort::stop();
+	mTransmitBuffer.clear();
 	mStarted = false;
 }
 
 bool ProxyCom::execCmd( QtuC::cmdType_t type, char *var, char *arg )
 {
-	//Nothing here.
-	return true;
+	// The proxy calls are about the receive buffer, the binary protocol and the streams.
+	if( type == QtuC::cmdCall && QtuC::Tools::isArg( var, "flowControl" ) )
+	{
+		// counted from the end of this command, as qcProxy counts
+		mFlowControl = QtuC::isTrue( arg );
+		mFlowBase = getConsumedByteCount();
+		mFlowAcked = mFlowBase;
+		return true;
+	}
+	else if( type == QtuC::cmdCall && QtuC::Tools::isArg( var, "rxStats" ) )
+	{
+		sendReceiveStats();
+		return true;
+	}
+	if( strncmp( var, "binary", 6 ) == 0 )
+		{ return QtuC::Binary::execCmd( type, var, arg ); }
+	return QtuC::Streams::execCmd( type, var, arg );
 }
 
 // For this to work, the RX interrupt should be disabled
@@ -112,139 +92,169 @@ bool ProxyCom::execCmd( QtuC::cmdType_t type, char *var, char *arg )
 void ProxyCom::putChar( char const &ch )
 {
 	if( !mStarted ) { return; }
-	USART_SendData( USART::module, (u8)ch );
-	// Wait for the data register to be transferred into the USART shift register
-	for(; USART_GetFlagStatus(USART::module, USART_FLAG_TXE) == RESET ;);
+	queue( &ch, 1 );
 }
 
 uint16_t ProxyCom::print( const char* str )
 {
 	if( !mStarted ) { return 0; }
 
-	uint16_t chcnt = 0;
+	uint16_t len = strlen(str);
+	if( !queue( str, len ) )
+		{ return 0; }
+	return len;
+}
+
+bool ProxyCom::queue( char const *data, uint16_t const len )
+{
+	bool queued;
+	// main loop and interrupts may both print, keep the copy atomic
 	IRQDIS();
-	while( *(str+chcnt) )
-	{
-		ProxyCom::putChar( *(str+chcnt) );
-		chcnt++;
-	}
+	queued = mTransmitBuffer.push( data, len );
+	if( queued )
+		{ HAL::ProxyPort::enableTransmit(); }
+	else
+		{ ++mTransmitOverflowCount; }
 	IRQEN();
-
-	return chcnt;
+	return queued;
 }
 
-void ProxyCom::handleNewData( uint16_t const &newData )
+void ProxyCom::handleTransmitEmpty()
 {
-	// skip carriage return
-	if( newData == 0xd ) return;
-
-	// skip other meaningless bytes
-	if( newData == 0xff ) return;
+	char ch;
+	if( mTransmitBuffer.pop(ch) )
+		{ HAL::ProxyPort::sendByte( ch ); }
+	else
+		{ HAL::ProxyPort::disableTransmit(); }
+}
 
-	if( newData == 0xa )
+void ProxyCom::reportOverflow()
+{
+	char buf[10];
+	uint32_t overflowCount = mTransmitOverflowCount;
+	if( overflowCount != mReportedTransmitOverflowCount )
 	{
-		if( getIncReceiveBufferCmdPtr(mReceiveBufferCmdWPtr) == mReceiveBufferCmdRPtr )
-			{ QtuC::Tools::sendMessage( QtuC::msgError, "Cmd buf ovf, slow down!" ); }
-		else
-		{
-			mReceiveBuffer[mReceiveBufferCmdWPtr][mReceiveBufferPtr] = '\0';
-			mReceiveBufferPtr = 0;
-			incReceiveBufferCmdPtr(mReceiveBufferCmdWPtr);
-		}
+		itoa( overflowCount - mReportedTransmitOverflowCount, buf, 16 );
+		mReportedTransmitOverflowCount = overflowCount;
+		QtuC::Tools::sendMessage( QtuC::msgWarning, "Tx buf ovf, lines dropped: ", buf );
 	}
-	else
+
+	uint32_t dropCount = mReceiveOverflowCount + mReceiveTooLongCount;
+	if( dropCount != mReportedReceiveDropCount )
 	{
-		if( mReceiveBufferPtr < MReceiveBufferCmdSize-1 )
-		{
-			mReceiveBuffer[mReceiveBufferCmdWPtr][mReceiveBufferPtr++] = (char)newData;
-		}
-		else
-			{ QtuC::Tools::sendMessage( QtuC::msgError, "Too long cmd, buf ovf" ); }
+		char highWater[6];
+		itoa( dropCount - mReportedReceiveDropCount, buf, 16 );
+		itoa( mReceiveHighWater, highWater, 16 );
+		mReportedReceiveDropCount = dropCount;
+		QtuC::Tools::sendMessage( QtuC::msgError, "Rx buf ovf or too long cmd, cmds dropped: ", buf, ", high water: ", highWater );
 	}
 }
 
-uint8_t ProxyCom::getIncReceiveBufferCmdPtr( const uint8_t &ptr )
+void ProxyCom::sendReceiveStats()
 {
-	if( ptr < MReceiveBufferCmdCount-1 )
-		{ return ptr+1; }
-	else
-		{ return 0; }
+	char size[6], highWater[6], overflows[10], tooLong[10];
+	itoa( QtuC::Conf::receiveBufferSize-1, size, 16 );
+	itoa( mReceiveHighWater, highWater, 16 );
+	itoa( mReceiveOverflowCount, overflows, 16 );
+	itoa( mReceiveTooLongCount, tooLong, 16 );
+	QtuC::Tools::sendMessage( QtuC::msgInfo, "Rx buf size: ", size, ", high water: ", highWater, ", ovf: ", overflows, ", too long: ", tooLong );
 }
 
-uint8_t ProxyCom::getNextCommand(char* cmd)
+void ProxyCom::acknowledgeReceived()
 {
-	if( mReceiveBufferCmdRPtr != mReceiveBufferCmdWPtr )
-	{
-		strcpy( cmd, mReceiveBuffer[mReceiveBufferCmdRPtr] );
-		incReceiveBufferCmdPtr(mReceiveBufferCmdRPtr);
-		return strlen(cmd);
-	}
-	else
-		{ return 0; }
+	if( !mFlowControl )
+		{ return; }
+
+	// waiting for a quarter keeps the acknowledges rare, and still leaves room for a full command in the window of qcProxy
+	uint32_t consumed = getConsumedByteCount();
+	if( consumed - mFlowAcked < QtuC::Conf::receiveBufferSize/4 )
+		{ return; }
+
+	// the acknowledge is cumulative: if it's dropped on a full transmit buffer, the next call sends it again
+	uint32_t overflowCount = getTransmitOverflowCount();
+	QtuC::Tools::sendCommand( QtuC::cmdCall, QtuC::Conf::proxyInterfaceName, "rxAck", consumed - mFlowBase );
+	if( getTransmitOverflowCount() == overflowCount )
+		{ mFlowAcked = consumed; }
 }
 
-
-extern "C"
+uint32_t ProxyCom::getConsumedByteCount()
 {
-
-/// Read implementation of the newlib stubs
-int _read(int file, char *ptr, int len)
-	{ return 0; }
-/// Write implementation of the newlib stubs
-int _write(int file, char *ptr, int len)
-	{ return 0; }
-
-// If you'd like to implement it...
-/*
-/// Read implementation of the newlib stubs
-int _read(int file, char *ptr, int len) {
-    int n;
-    int num = 0;
-    switch (file)
-    {
-		case STDIN_FILENO:
-			for( n = 0; n < len; n++ )
-			{
-				if( !HwiProxyCom::instance() ) break;
-
-				// ProxyCom doesn't have a getChar method, as it is fully RX interrupt driven.
-				char c = HwInterface::ProxyCom::
-
-				*ptr++ = c;
-				num++;
-			} break;
-		default:
-			errno = EBADF;
-			return -1;
-    }
-    return num;
+	uint32_t consumed;
+	IRQDIS();
+	consumed = mReceivedByteCount - mReceiveBuffer.getUsed();
+	IRQEN();
+	return consumed;
 }
 
-/// Write implementation of the newlib stubs
-int _write(int file, char *ptr, int len)
+void ProxyCom::handleNewData( uint16_t const &newData )
 {
-    int n;
-    switch (file)
-    {
-		case STDOUT_FILENO:
-			for( n = 0; n < len; n++ )
+	++mReceivedByteCount;
+
+	// in binary mode, the frames are terminated by 0, and contain any other byte
+	bool binary = QtuC::Tools::isBinary();
+	if( !binary )
+	{
+		// skip carriage return
+		if( newData == 0xd ) return;
+
+		// skip other meaningless bytes, 0 is sent by qcProxy to terminate a possible binary frame
+		if( newData == 0xff || newData == 0 ) return;
+	}
+
+	if( newData == ( binary ? 0 : 0xa ) )
+	{
+		if( mReceiveDropping )
+			{ mReceiveDropping = false; }
+		else if( mReceiveCmdLength )
+		{
+			if( mReceiveBuffer.stage( '\0' ) )
 			{
-				if( !HwInterface::ProxyCom::started() ) break;
-				HwInterface::ProxyCom::putChar(*ptr++ & (uint16_t)0x01FF);
+				mReceiveBuffer.commit();
+				++mReceivedCmdCount;
+				uint16_t used = mReceiveBuffer.getUsed();
+				if( used > mReceiveHighWater )
+					{ mReceiveHighWater = used; }
 			}
-			break;
-		case STDERR_FILENO:
-			for (n = 0; n < len; n++)
+			else
 			{
-				if( !HwInterface::ProxyCom::started() ) break;
-				HwInterface::ProxyCom::putChar(*ptr++ & (uint16_t)0x01FF);
+				mReceiveBuffer.discard();
+				++mReceiveOverflowCount;
 			}
-			break;
-		default:
-			errno = EBADF;
-			return -1;
-    }
-    return len;
+		}	// else an empty line or frame
+		mReceiveCmdLength = 0;
+		return;
+	}
+
+	if( mReceiveDropping )
+		{ return; }
+
+	// the command is dropped as a whole, the main loop reports it (see reportOverflow())
+	if( mReceiveCmdLength >= QtuC::Conf::maxCommandLength-1 )
+	{
+		mReceiveBuffer.discard();
+		mReceiveDropping = true;
+		++mReceiveTooLongCount;
+	}
+	else if( !mReceiveBuffer.stage( (char)newData ) )
+	{
+		mReceiveBuffer.discard();
+		mReceiveDropping = true;
+		++mReceiveOverflowCount;
+	}
+	else
+		{ ++mReceiveCmdLength; }
 }
-*/
+
+uint8_t ProxyCom::getNextCommand(char* cmd)
+{
+	if( !isCommandReady() )
+		{ return 0; }
+
+	uint8_t len = 0;
+	char c;
+	while( mReceiveBuffer.pop(c) && c )
+		{ cmd[len++] = c; }
+	cmd[len] = '\0';
+	++mReadCmdCount;
+	return len;
 }
@@ -2,51 +2,26 @@
 #define HWINTERFACE_PROXYCOM_H
 
 #include "QtuC_Tools.hpp"
-
-// These must be in global scope
-#define Conf_ProxyCom_USART_IRQHandler USART1_IRQHandler(void)
-extern "C" void Conf_ProxyCom_USART_IRQHandler;
+#include "QtuC_RingBuffer.hpp"
+#include "HAL_ProxyPort.hpp"
 
 namespace HwInterface
 {
 
-namespace Conf
-{
-	/// This is a full configuration set, you can safely change it without modifying the implementation code.
-	namespace ProxyCom
-	{
-		namespace Pin
-		{
-			namespace TX {
-				uint32_t const pin = GPIO_Pin_6;
-				GPIO_TypeDef *const port = GPIOB;
-				uint32_t const portRCC = RCC_AHB1Periph_GPIOB;
-				uint8_t const AFPinSource = GPIO_PinSource6;
-			}
-			namespace RX {
-				uint32_t const pin = GPIO_Pin_7;
-				GPIO_TypeDef *const port = GPIOB;
-				uint32_t const portRCC = RCC_AHB1Periph_GPIOB;
-				uint8_t const AFPinSource = GPIO_PinSource7;
-			}
-		}
-		namespace USART
-		{
-			USART_TypeDef* volatile const module = USART1;
-			uint32_t const moduleRCC = RCC_APB2Periph_USART1;
-			uint8_t const AFMap = GPIO_AF_USART1;
-			IRQn_Type const IRQCh = USART1_IRQn;
-			uint32_t const baudRate = 460800;
-		}
-	}
-}
-
 /** Hardware interface for communicating with qcProxy.
  *	Use ProxyCom::isCommandReady() to check for new incoming command.
  *	Retrieve the received command with ProxyCom::getCommand().<br>
- *	The commands are received to a circular buffer with a size of HwI__ProxyCom_ReceiveBuffer_CmdCount.
- *	Each command buffer can store a command up to HwI__ProxyCom_ReceiveBuffer_Size.
- *	If the circular buffer is full, an error message is sent with QtuC::Tools::sendMessage().*/
+ *	The commands are received to a byte ring buffer of QtuC::Conf::receiveBufferSize bytes, each command takes its length plus a terminator,
+ *	so a burst of short commands (polls, a slider sweep) fits as well as a few long batched commands.
+ *	A command up to QtuC::Conf::maxCommandLength is accepted. A longer command, or one which doesn't fit in the buffer, is dropped and counted,
+ *	the drops and the high-water mark of the buffer are reported by reportOverflow(), and on request with `call :proxy rxStats`.
+ *	A command is terminated by a newline, or by a 0 byte in binary mode (see QtuC::Binary), then the command is the encoded frame.<br>
+ *	On `call :proxy flowControl 1`, the interface starts acknowledging the received data with `call :proxy rxAck <count>`, where count is the number of bytes
+ *	taken out of the receive buffer since the flowControl call (hex, wrapping at 32 bits). qcProxy keeps the data in flight below the buffer size (advertised in the greeting), so it never overruns the buffer.
+ *	The acknowledge is sent by acknowledgeReceived(), when a quarter of the buffer has been freed since the last one.<br>
+ *	Outgoing data is queued in a transmit ring buffer and sent by the port (the USART TXE interrupt on the MCU), so printing doesn't wait for the transmission.
+ *	The serial port itself is HAL::ProxyPort, this class is platform independent.
+ *	A string is either queued as a whole or dropped if it doesn't fit, the dropped strings are counted (see getTransmitOverflowCount() and reportOverflow()).*/
 class ProxyCom
 {
 private:
@@ -54,9 +29,6 @@ private:
 	ProxyCom(){}
 
 public:
-	/// Let's be friends with the USART ISR
-	friend void ::Conf_ProxyCom_USART_IRQHandler;
-
 	/// Name of this hardware interface.
 	static const char *InterfaceName;
 
@@ -91,62 +63,104 @@ public:
 	static bool execCmd( QtuC::cmdType_t type, char *var, char *arg );
 
 	/** Get the next pending command from the receive buffer.
-	 *	@param cmd A buffer to copy the command to.
+	 *	@param cmd A buffer to copy the command to, at least QtuC::Conf::maxCommandLength long.
 	 *	@return The length of the command.*/
 	static uint8_t getNextCommand(char* cmd);
 
 	/** Check if there is a new received command.
 	 *	@return True if there is a pending command in the receive buffer, false otherwise.*/
 	static inline bool isCommandReady()
-		{ return mReceiveBufferCmdRPtr != mReceiveBufferCmdWPtr; }
+		{ return mReceivedCmdCount != mReadCmdCount; }
+
+	/** Send the flow control acknowledge, if enabled, and enough data has been taken from the receive buffer since the last one.
+	 *	Call this periodically from the main loop, after processing the received commands.
+	 *	If the transmit buffer is full, the acknowledge is sent again on the next call.*/
+	static void acknowledgeReceived();
 
 	/** Print a character.
-	 *	Only sending id interface was started...........
+	 *	The character is queued for sending, only if the interface is started.
 	 *	@param ch Character to print.*/
 	static void putChar(char const &ch);
 
 	/** Print a string.
-	 *	Send string to qcProxy.
-	 *	Only sending id interface was started...........
+	 *	Queue the string to be sent to qcProxy, only if the interface is started.
+	 *	The string is queued as a whole, if it doesn't fit in the transmit buffer, it is dropped and counted as an overflow.
+	 *	Interrupts are only disabled while the string is copied to the buffer, so this can be called from interrupts as well.
 	 *	@param str The string to send.
-	 *	@return Number of characters sent.*/
+	 *	@return Number of characters queued.*/
 	static uint16_t print( const char* str );
 
+	/** Get the number of strings dropped because the transmit buffer was full.
+	 *	@return The overflow count since startup.*/
+	static inline uint32_t getTransmitOverflowCount()
+		{ return mTransmitOverflowCount; }
+
+	/** Get the number of received commands dropped because the receive buffer was full.
+	 *	@return The overflow count since startup.*/
+	static inline uint32_t getReceiveOverflowCount()
+		{ return mReceiveOverflowCount; }
+
+	/** Get the highest number of bytes in the receive buffer.
+	 *	@return The high-water mark since startup.*/
+	static inline uint16_t getReceiveHighWater()
+		{ return mReceiveHighWater; }
+
+	/** Send a warning message if strings were dropped in either direction since the last report.
+	 *	Call this periodically from the main loop.*/
+	static void reportOverflow();
+
 	/// Print a newline.
 	static inline void putEndl()
 		{ ProxyCom::putChar('\n'); }
 
-private:
-
-	/** Get a character from the USART1 buffer.
-	 *	@return The character read.*/
-	//unsigned char getChar();
-
 	/** Handle received data from QtuC Proxy.
-	 *	Called from the USART IRQ handler.
+	 *	Called by HAL::ProxyPort (from the USART IRQ handler on the MCU).
 	 *	@param newData The data to process.*/
 	static void handleNewData( uint16_t const &newData );
 
-	/** Get the increased value of an input buffer index.
-	 *	The index itself is left unchanged.
-	 *	@param ptr The index to get the increased value for.
-	 *	@return The increased value.*/
-	static uint8_t getIncReceiveBufferCmdPtr( const uint8_t &ptr );
+	/** Send the next byte from the transmit buffer.
+	 *	Called by HAL::ProxyPort when a byte can be sent (from the USART IRQ handler on the MCU). If there's nothing to send, transmit is disabled.*/
+	static void handleTransmitEmpty();
+
+private:
+
+	/** Queue data in the transmit buffer and enable transmit.
+	 *	@param data The data to queue.
+	 *	@param len Length of the data.
+	 *	@return True if the data has been queued, false if the buffer is full.*/
+	static bool queue( char const *data, uint16_t const len );
 
-	/** Increase an input buffer index.
-	 *	@param ptr The index to increase.*/
-	static inline void incReceiveBufferCmdPtr( uint8_t &ptr )
-		{ ptr = getIncReceiveBufferCmdPtr(ptr); }
+	/** Get the number of bytes taken out of the receive buffer since startup.
+	 *	The skipped bytes and the dropped commands count as taken.
+	 *	@return The byte count, wrapping at 32 bits.*/
+	static uint32_t getConsumedByteCount();
+
+	/** Send the receive buffer statistics as an info message.*/
+	static void sendReceiveStats();
 
 
 	static bool mInitialized;
 	static bool mStarted;
 
-	static uint8_t const MReceiveBufferCmdCount = 4;	///< Number of commands that can be stored in the receive buffer.
-	static uint8_t const MReceiveBufferCmdSize = QtuC::Conf::maxCommandLength;	///< Size of the command receive buffer.
-
-	static char mReceiveBuffer[MReceiveBufferCmdCount][MReceiveBufferCmdSize];	///< The circular input command buffer.
-	static uint8_t mReceiveBufferCmdWPtr, mReceiveBufferCmdRPtr, mReceiveBufferPtr;	///< Pointer indexes for the input buffer.
+	static QtuC::RingBuffer<QtuC::Conf::receiveBufferSize> mReceiveBuffer;	///< The receive buffer, the commands are separated by 0 bytes. Filled by the port (RXNE interrupt), the current command is staged until its terminator.
+	static uint8_t mReceiveCmdLength;	///< Length of the command being received.
+	static bool mReceiveDropping;		///< The command being received is dropped, skip it until its terminator.
+	static volatile uint16_t mReceivedCmdCount;	///< Number of the committed commands, wrapping. Written by the port only.
+	static uint16_t mReadCmdCount;		///< Number of the commands taken by getNextCommand(), wrapping. Written by the main loop only.
+	static volatile uint32_t mReceivedByteCount;	///< Number of received bytes, wrapping.
+	static volatile uint16_t mReceiveHighWater;		///< Highest number of bytes in the receive buffer.
+	static volatile uint32_t mReceiveOverflowCount;	///< Number of commands dropped because the receive buffer was full.
+	static volatile uint32_t mReceiveTooLongCount;	///< Number of commands dropped because they were too long.
+	static uint32_t mReportedReceiveDropCount;		///< Receive overflow and too long count at the last reportOverflow().
+
+	static bool mFlowControl;			///< Acknowledge the received data, see acknowledgeReceived().
+	static uint32_t mFlowBase;			///< getConsumedByteCount() at the flowControl call.
+	static uint32_t mFlowAcked;			///< getConsumedByteCount() at the last acknowledge.
+
+	static uint16_t const MTransmitBufferSize = 512;	///< Size of the transmit buffer. At 460800 baud, the full buffer is sent in about 11ms.
+	static QtuC::RingBuffer<MTransmitBufferSize> mTransmitBuffer;	///< The transmit buffer, drained by the port (TXE interrupt).
+	static volatile uint32_t mTransmitOverflowCount;	///< Number of strings dropped because the transmit buffer was full.
+	static uint32_t mReportedTransmitOverflowCount;		///< mTransmitOverflowCount at the last reportOverflow().
 };
 
 }	//HwInterface::
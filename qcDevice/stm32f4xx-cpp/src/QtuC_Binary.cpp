@@ -0,0 +1,286 @@
+#include "QtuC_Binary.hpp"
+#include "QtuC_Interfaces.hpp"
+#include <stdlib.h>
+
+using namespace QtuC;
+
+Binary::id_t Binary::mIdList[] = {};
+HashIndex<Conf::maxBinaryIdCount*2> Binary::mIdIndex;
+char Binary::mArg[] = {};
+
+bool Binary::execCmd( QtuC::cmdType_t type, char *var, char *arg )
+{
+	if( type != QtuC::cmdCall )
+		{ return false; }
+
+	if( QtuC::Tools::isArg( var, "binaryId" ) )
+	{
+		char *argv[3];
+		uint8_t argc = 3;
+		if( !QtuC::Tools::parseArg( arg, argv, argc ) || argc < 3 )
+		{
+			QtuC::Tools::sendMessage( QtuC::msgError, "Binary: missing id, interface or variable" );
+			return false;
+		}
+		uint32_t id = strtoul( argv[0], 0, 0 );
+		if( id >= Conf::maxBinaryIdCount )
+		{
+			QtuC::Tools::sendMessage( QtuC::msgError, "Binary: too big id ", argv[0] );
+			return false;
+		}
+		Interfaces::interface_t const *hwi = Interfaces::get( argv[1] );
+		if( !hwi )
+		{
+			QtuC::Tools::sendMessage( QtuC::msgError, "Binary: interface ", argv[1], " not found" );
+			return false;
+		}
+		if( strlen(argv[2]) >= Conf::maxBinaryVarLength )
+		{
+			QtuC::Tools::sendMessage( QtuC::msgError, "Binary: too long var name ", argv[2] );
+			return false;
+		}
+		strcpy( mIdList[id].var, argv[2] );
+		mIdList[id].hwi = hwi->name;
+		indexIds();
+		return true;
+	}
+	else if( QtuC::Tools::isArg( var, "binary" ) )
+	{
+		bool on = QtuC::isTrue( arg );
+		if( !on )
+		{
+			QtuC::Tools::setBinary( false );
+			for( uint8_t i=0; i<Conf::maxBinaryIdCount; ++i )
+				{ mIdList[i].hwi = 0; }
+			mIdIndex.clear();
+		}
+		// always acknowledged in text, qcProxy switches when it receives this
+		QtuC::Tools::sendCommand( QtuC::cmdCall, QtuC::Conf::proxyInterfaceName, "binary", on ? "1" : "0" );
+		if( on )
+			{ QtuC::Tools::setBinary( true ); }
+		return true;
+	}
+
+	return false;
+}
+
+bool Binary::decode( char *frame, QtuC::cmdType_t &type, char *&hwi, char *&var, char *&arg )
+{
+	hwi = 0;
+	uint16_t frameLength = strlen(frame);
+	if( !frameLength )
+		{ return false; }
+
+	uint8_t buf[Conf::maxCommandLength];
+	uint16_t length = cobsDecode( (uint8_t const*)frame, frameLength, buf );
+	if( length < 4 || crc16( buf, length-2 ) != ( buf[length-2] | (buf[length-1] << 8) ) )
+	{
+		// a text command from a proxy which doesn't know that we are in binary mode
+		if( frame[frameLength-1] == QtuC::Tools::Endl )
+		{
+			frame[frameLength-1] = '\0';
+			return true;
+		}
+		QtuC::Tools::sendMessage( QtuC::msgError, "Binary: invalid frame" );
+		return false;
+	}
+	length -= 2;
+
+	uint8_t header = buf[0];
+	uint16_t pos = 1;
+	if( header & headerTimestamp )
+		{ pos += 4; }	// the device doesn't need the time of the proxy
+
+	if( header & headerText )
+	{
+		memcpy( frame, buf+pos, length-pos );
+		frame[length-pos] = '\0';
+		return true;
+	}
+
+	if( pos >= length || buf[pos] >= Conf::maxBinaryIdCount || !mIdList[buf[pos]].hwi )
+	{
+		QtuC::Tools::sendMessage( QtuC::msgError, "Binary: unknown id" );
+		return false;
+	}
+	type = (QtuC::cmdType_t)( header & headerTypeMask );
+	hwi = (char*)mIdList[buf[pos]].hwi;
+	var = mIdList[buf[pos]].var;
+	++pos;
+
+	// the interfaces parse the value from string, as in text mode
+	mArg[0] = '\0';
+	arg = mArg;
+	if( pos < length )
+	{
+		uint8_t tag = buf[pos++];
+		uint32_t value = 0;
+		switch( tag )
+		{
+			case tagString:
+			{
+				uint8_t valueLength = buf[pos++];
+				if( pos + valueLength > length || valueLength >= Conf::maxCommandLength )
+					{ return false; }
+				memcpy( mArg, buf+pos, valueLength );
+				mArg[valueLength] = '\0';
+				break;
+			}
+			case tagBool:
+				mArg[0] = buf[pos] ? '1' : '0';
+				mArg[1] = '\0';
+				break;
+			case tagInt:
+			case tagUInt:
+				if( pos + 4 > length )
+					{ return false; }
+				memcpy( &value, buf+pos, 4 );
+				if( tag == tagInt )
+					{ itoa( (int32_t)value, mArg, 16 ); }
+				else
+					{ itoa( value, mArg, 16 ); }
+				break;
+			default:
+				QtuC::Tools::sendMessage( QtuC::msgError, "Binary: unknown value type" );
+				return false;
+		}
+	}
+	return true;
+}
+
+bool Binary::sendValue( QtuC::cmdType_t const type, const char *interface, const char *var, valueTag_t const tag, void const *data, uint16_t const len )
+{
+	int16_t id = findId( interface, var );
+	if( id < 0 || ( type != QtuC::cmdGet && type != QtuC::cmdSet ) || len > MMaxFrameSize-10 )
+		{ return false; }
+	// the length of a string goes in a single byte
+	if( tag == tagString && len > 0xFF )
+		{ return false; }
+
+	uint8_t frame[MMaxFrameSize];
+	uint16_t pos = 0;
+	frame[pos++] = type | ( QtuC::Conf::useCmdTimestamps ? headerTimestamp : 0 );
+	if( QtuC::Conf::useCmdTimestamps )
+	{
+		uint32_t us;
+		SysTime::getUsSince( SysTime::NullTime, us );
+		for( uint8_t i=0; i<4; ++i )
+			{ frame[pos++] = us >> (8*i); }
+	}
+	frame[pos++] = id;
+	if( data )
+	{
+		frame[pos++] = tag;
+		if( tag == tagString )
+			{ frame[pos++] = len; }
+		memcpy( frame+pos, data, len );
+		pos += len;
+	}
+	sendFrame( frame, pos );
+	return true;
+}
+
+void Binary::sendText( char const *text, uint16_t const len )
+{
+	uint8_t frame[MMaxFrameSize];
+	frame[0] = headerText;
+	uint16_t textLength = ( len < MMaxFrameSize-3 ) ? len : MMaxFrameSize-3;
+	memcpy( frame+1, text, textLength );
+	sendFrame( frame, textLength+1 );
+}
+
+void Binary::sendFrame( uint8_t *frame, uint16_t const len )
+{
+	uint16_t crc = crc16( frame, len );
+	frame[len] = crc & 0xff;
+	frame[len+1] = crc >> 8;
+
+	uint8_t encoded[MMaxFrameSize + MMaxFrameSize/254 + 2];
+	cobsEncode( frame, len+2, encoded );
+
+	// the frame and its terminator must not be split by an interrupt
+	IRQDIS();
+	print( (char const*)encoded );
+	putChar( '\0' );
+	IRQEN();
+}
+
+int16_t Binary::findId( const char *interface, const char *var )
+{
+	uint8_t probe = 0;
+	uint32_t hash = QtuC::Tools::hash( var, QtuC::Tools::hash( interface ) );
+	for( int16_t i = mIdIndex.find( hash, probe ); i >= 0; i = mIdIndex.find( hash, probe ) )
+	{
+		if( QtuC::Tools::isArg( mIdList[i].var, var ) && ( mIdList[i].hwi == interface || QtuC::Tools::isArg( mIdList[i].hwi, interface ) ) )
+			{ return i; }
+	}
+	return -1;
+}
+
+void Binary::indexIds()
+{
+	// an id may be reassigned, so the index is rebuilt instead of updated
+	mIdIndex.clear();
+	for( uint8_t i=0; i<Conf::maxBinaryIdCount; ++i )
+	{
+		if( mIdList[i].hwi )
+			{ mIdIndex.insert( QtuC::Tools::hash( mIdList[i].var, QtuC::Tools::hash( mIdList[i].hwi ) ), i ); }
+	}
+}
+
+uint16_t Binary::crc16( uint8_t const *data, uint16_t const len )
+{
+	// a nibble at a time, the table is small enough for any MCU
+	static uint16_t const crcTable[16] = {
+		0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50a5, 0x60c6, 0x70e7,
+		0x8108, 0x9129, 0xa14a, 0xb16b, 0xc18c, 0xd1ad, 0xe1ce, 0xf1ef };
+
+	uint16_t crc = 0xffff;
+	for( uint16_t i=0; i<len; ++i )
+	{
+		crc = ( crc << 4 ) ^ crcTable[ ( crc >> 12 ) ^ ( data[i] >> 4 ) ];
+		crc = ( crc << 4 ) ^ crcTable[ ( crc >> 12 ) ^ ( data[i] & 0x0f ) ];
+	}
+	return crc;
+}
+
+uint16_t Binary::cobsEncode( uint8_t const *src, uint16_t const len, uint8_t *dst )
+{
+	uint16_t codePos = 0;
+	uint16_t out = 1;
+	uint8_t code = 1;
+	for( uint16_t i=0; i<len; ++i )
+	{
+		if( src[i] )
+		{
+			dst[out++] = src[i];
+			++code;
+		}
+		if( !src[i] || code == 0xff )
+		{
+			dst[codePos] = code;
+			codePos = out++;
+			code = 1;
+		}
+	}
+	dst[codePos] = code;
+	dst[out] = 0;
+	return out;
+}
+
+uint16_t Binary::cobsDecode( uint8_t const *src, uint16_t const len, uint8_t *dst )
+{
+	uint16_t in = 0;
+	uint16_t out = 0;
+	while( in < len )
+	{
+		uint8_t code = src[in++];
+		if( !code || in + code - 1 > len )
+			{ return 0; }
+		for( uint8_t i=1; i<code; ++i )
+			{ dst[out++] = src[in++]; }
+		if( code != 0xff && in < len )
+			{ dst[out++] = 0; }
+	}
+	return out;
+}
@@ -0,0 +1,143 @@
+#ifndef QTUC_BINARY_H
+#define QTUC_BINARY_H
+
+#include "QtuC_Tools.hpp"
+#include "QtuC_HashIndex.hpp"
+
+namespace QtuC
+{
+
+namespace Conf
+{
+	uint8_t const maxBinaryIdCount = 32;		///< Number of variable ids qcProxy can assign for the binary protocol. Sent to qcProxy in the greeting.
+	uint8_t const maxBinaryVarLength = 24;		///< Maximum length of a variable name with a binary id, with the null terminator.
+}
+
+/** The binary protocol of the device link.
+ *	The text protocol is the default, qcProxy switches to the binary protocol if the device announces it in the greeting (`binary:<id count>`).
+ *	In binary mode every command is a frame, encoded with COBS (Consistent Overhead Byte Stuffing) and terminated by a 0 byte.
+ *	The frame before the encoding:
+ *	  * header (1 byte): command type (bit 0-1: 1 get, 2 set, 3 call), timestamp follows (bit 2), text frame (bit 3)
+ *	  * timestamp (4 bytes, little endian), if the header says so
+ *	  * variable id (1 byte), or the text command (without the line end) in a text frame
+ *	  * value (optional): a type tag and the raw value, see valueTag_t
+ *	  * CRC16 (CCITT, 2 bytes, little endian) of all the above
+ *
+ *	The variable ids are assigned by qcProxy from the deviceAPI, before switching to binary mode:
+ *	  * `call :proxy binaryId <id> <hwi> <var>`: Assign an id to a variable.
+ *	  * `call :proxy binary 1`: Switch to binary mode. The device acknowledges with the same call, in text, and switches after it.
+ *	  * `call :proxy binary 0`: Switch back to text mode and forget the ids. The acknowledge is sent in text.
+ *
+ *	Everything without an id (calls, messages, commands with more arguments) is sent in a text frame.
+ *	A frame which fails the CRC but ends with a line end is executed as a text command, so a new qcProxy session can always switch the device back to text.
+ *	The proxy interface is HwInterface::ProxyCom, it passes the binary calls to execCmd().*/
+class Binary
+{
+private:
+	/// Private c'tor. This is a static class, don't instantiate.
+	Binary(){}
+
+public:
+	/// Bits of the frame header.
+	enum headerFlag_t
+	{
+		headerTypeMask = 0x03,
+		headerTimestamp = 0x04,
+		headerText = 0x08
+	};
+
+	/// Type tags of the values.
+	enum valueTag_t
+	{
+		tagInt = 'i',		///< int32_t
+		tagUInt = 'u',		///< uint32_t
+		tagBool = 'b',		///< uint8_t, 0 or 1
+		tagString = 's'		///< uint8_t length and the characters, without null terminator
+	};
+
+	/** Execute a command sent to the proxy interface.
+	 *	@param type Type of the command, only calls are handled.
+	 *	@param var The function.
+	 *	@param arg The arguments of the function.
+	 *	@return True on success, false otherwise.*/
+	static bool execCmd( QtuC::cmdType_t type, char *var, char *arg );
+
+	/** Decode a received frame.
+	 *	If the frame is a text frame (or a text command, see above), the text command is copied to frame, and hwi is set to null, parse it with Tools::parseCmd().
+	 *	Otherwise the command parts are set, they point to static buffers which remain valid until the next decode().
+	 *	@param frame The received frame, without the terminating 0. Will be modified.
+	 *	@param type Type of the command.
+	 *	@param hwi The interface name, null for a text command.
+	 *	@param var The variable name.
+	 *	@param arg The value as string, empty if the frame has no value.
+	 *	@return True on success, false if the frame is invalid.*/
+	static bool decode( char *frame, QtuC::cmdType_t &type, char *&hwi, char *&var, char *&arg );
+
+	/** Send a variable command in a frame.
+	 *	@param type Type of the command, get or set.
+	 *	@param interface The interface name.
+	 *	@param var The variable name.
+	 *	@param tag Type of the value.
+	 *	@param data The raw value, null if there is no value.
+	 *	@param len Length of the raw value in bytes.
+	 *	@return True if the frame has been sent, false if the variable has no id or the value doesn't fit in a frame (send it in text then).*/
+	static bool sendValue( QtuC::cmdType_t const type, const char *interface, const char *var, valueTag_t const tag, void const *data, uint16_t const len );
+
+	/** Send a text command in a text frame.
+	 *	@param text The command without the line end.
+	 *	@param len Length of the command.*/
+	static void sendText( char const *text, uint16_t const len );
+
+	/** Calculate CRC16 (CCITT, polynomial 0x1021, initial value 0xffff).
+	 *	@param data The data.
+	 *	@param len Length of the data.
+	 *	@return The CRC.*/
+	static uint16_t crc16( uint8_t const *data, uint16_t const len );
+
+	/** Encode data with COBS.
+	 *	The encoded data contains no 0 byte and is null terminated (the terminator is not counted).
+	 *	@param src The data to encode.
+	 *	@param len Length of the data.
+	 *	@param dst Buffer for the encoded data, len + len/254 + 2 bytes.
+	 *	@return Length of the encoded data.*/
+	static uint16_t cobsEncode( uint8_t const *src, uint16_t const len, uint8_t *dst );
+
+	/** Decode COBS encoded data.
+	 *	Can be done in place (src == dst).
+	 *	@param src The encoded data, without the terminating 0.
+	 *	@param len Length of the encoded data.
+	 *	@param dst Buffer for the decoded data, at least len bytes.
+	 *	@return Length of the decoded data, 0 if the data is invalid.*/
+	static uint16_t cobsDecode( uint8_t const *src, uint16_t const len, uint8_t *dst );
+
+private:
+
+	/** Find the id of a variable.
+	 *	@param interface The interface name.
+	 *	@param var The variable name.
+	 *	@return The id, or -1 if the variable has no id.*/
+	static int16_t findId( const char *interface, const char *var );
+
+	/// Rebuild mIdIndex from mIdList.
+	static void indexIds();
+
+	/** Add the CRC to the frame, encode and send it.
+	 *	@param frame The frame, with 2 free bytes at the end for the CRC.
+	 *	@param len Length of the frame without the CRC.*/
+	static void sendFrame( uint8_t *frame, uint16_t const len );
+
+	/// A variable with a binary id.
+	struct id_t
+	{
+		char const *hwi;	///< Name of the interface, as registered in QtuC::Interfaces. Null if the id is not used.
+		char var[Conf::maxBinaryVarLength];
+	};
+
+	static uint16_t const MMaxFrameSize = Conf::maxSendLength + 8;	///< Size of the frame before encoding, a full text command fits.
+	static id_t mIdList[Conf::maxBinaryIdCount];	///< The variable of every id.
+	static HashIndex<Conf::maxBinaryIdCount*2> mIdIndex;	///< Index of the ids by the hash of the interface and variable name.
+	static char mArg[Conf::maxCommandLength];		///< The decoded value.
+};
+
+}	//QtuC::
+#endif // QTUC_BINARY_H
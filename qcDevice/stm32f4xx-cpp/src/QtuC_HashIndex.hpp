@@ -0,0 +1,88 @@
+#ifndef QTUC_HASHINDEX_H
+#define QTUC_HASHINDEX_H
+
+#include <stdint.h>
+
+namespace QtuC
+{
+
+/** Hash index of a static list of names.
+ *	Maps the hash of a name (see Tools::hash()) to the index of the name in a list, in constant time instead of comparing the name to every item.
+ *	The index doesn't store the names, so the hashes may collide: find() returns every index with the same hash, the caller must compare the name.
+ *	Typical use in an interface:
+ *
+ *		uint8_t probe = 0;
+ *		uint32_t hash = QtuC::Tools::hash( var );
+ *		for( int16_t i = mVarIndex.find( hash, probe ); i >= 0; i = mVarIndex.find( hash, probe ) )
+ *		{
+ *			if( QtuC::Tools::isArg( var, mVarList[i].name ) )
+ *				{ ... }
+ *		}
+ *
+ *	Build the index once, with insert() for every item (e.g. in the init() of the interface). There is no removal, clear() and insert again instead.
+ *	This class is hardware independent, it can be compiled and tested on the host.
+ *	@param size Number of slots, a power of 2, at least one more than the number of names. Twice the number of names keeps the probes short.*/
+template<uint8_t size>
+class HashIndex
+{
+public:
+	HashIndex()
+		{ clear(); }
+
+	/// Remove all names.
+	void clear()
+	{
+		for( uint8_t i=0; i<size; ++i )
+			{ mSlotList[i].index = MEmpty; }
+		mCount = 0;
+	}
+
+	/** Add a name.
+	 *	@param hash Hash of the name.
+	 *	@param index Index of the name in the list.
+	 *	@return True on success, false if the index is full.*/
+	bool insert( uint32_t const hash, uint8_t const index )
+	{
+		if( mCount >= size-1 || index == MEmpty )
+			{ return false; }
+		uint8_t slot = hash & (size-1);
+		while( mSlotList[slot].index != MEmpty )
+			{ slot = (slot+1) & (size-1); }
+		mSlotList[slot].hash = hash;
+		mSlotList[slot].index = index;
+		++mCount;
+		return true;
+	}
+
+	/** Find the next index with the passed hash.
+	 *	@param hash Hash of the name.
+	 *	@param probe Number of probed slots, pass 0 for the first call, and the same variable for the next ones.
+	 *	@return The index of a name with the hash, or -1 if there is no more.*/
+	int16_t find( uint32_t const hash, uint8_t &probe ) const
+	{
+		while( probe < size )
+		{
+			slot_t const &s = mSlotList[ ( hash + probe++ ) & (size-1) ];
+			if( s.index == MEmpty )
+				{ break; }
+			if( s.hash == hash )
+				{ return s.index; }
+		}
+		probe = size;
+		return -1;
+	}
+
+private:
+	struct slot_t
+	{
+		uint32_t hash;
+		uint8_t index;
+	};
+
+	static uint8_t const MEmpty = 0xff;	///< Index of an empty slot.
+	slot_t mSlotList[size];
+	uint8_t mCount;
+};
+
+}	//QtuC::
+#endif // QTUC_HASHINDEX_H
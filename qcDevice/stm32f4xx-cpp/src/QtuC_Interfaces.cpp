@@ -1,25 +1,26 @@
 #include "QtuC_Interfaces.hpp"
+#include "QtuC_Binary.hpp"
 #include <string.h>
 
 using namespace QtuC;
 
-uint8_t Interfaces::mInterfaceCount = 0;
-Interfaces::interface_t Interfaces::mInterfaceList[] = {};
+Interfaces::interface_t *Interfaces::mBucketList[] = {};
 
-bool Interfaces::regInterface( const char *name, bool (* const &execCmdPtr)( QtuC::cmdType_t, char*, char* ) )
+bool Interfaces::regInterface( interface_t &hwi )
 {
-	if( mInterfaceCount == MMaxInterfaceCount )
+	if( !hwi.name || !hwi.execCmd )
+		{ return false; }
+
+	if( get( hwi.name ) )
 	{
-		QtuC::Tools::sendMessage( QtuC::msgError, "Reached max interface count!" );
+		QtuC::Tools::sendMessage( QtuC::msgError, "Interface ", hwi.name, " already registered" );
 		return false;
 	}
 
-	if( !name || !execCmdPtr )
-		{ return false; }
-
-	mInterfaceList[mInterfaceCount].execCmd = execCmdPtr;
-	mInterfaceList[mInterfaceCount].name = name;
-	++mInterfaceCount;
+	hwi.hash = QtuC::Tools::hash( hwi.name );
+	interface_t *&bucket = mBucketList[ hwi.hash & (Conf::interfaceBucketCount-1) ];
+	hwi.next = bucket;
+	bucket = &hwi;
 	return true;
 }
 
@@ -28,25 +29,82 @@ bool Interfaces::routeCmd( char *cmdStr )
 	QtuC::cmdType_t cmdType;
 	char *cmdHwi=0, *cmdVar=0, *cmdArg=0;
 
-	if( !QtuC::Tools::parseCmd( cmdStr, cmdType, cmdHwi, cmdVar, cmdArg ) )
-		{ QtuC::Tools::sendMessage( QtuC::msgError, "Invalid command" ); }
+	// in binary mode the frame holds either a variable command, or a text command to parse
+	if( QtuC::Tools::isBinary() && !QtuC::Binary::decode( cmdStr, cmdType, cmdHwi, cmdVar, cmdArg ) )
+		{ return false; }
+
+	if( !cmdHwi && !QtuC::Tools::parseCmd( cmdStr, cmdType, cmdHwi, cmdVar, cmdArg ) )
+	{
+		QtuC::Tools::sendMessage( QtuC::msgError, "Invalid command" );
+		return false;
+	}
 
 	//call the interface
-	for( uint8_t i=0; i<mInterfaceCount; ++i )
+	interface_t const *hwi = get( cmdHwi );
+	if( !hwi )
 	{
-		if( strcmp( cmdHwi, mInterfaceList[i].name ) == 0 )
-			{ return mInterfaceList[i].execCmd( cmdType, cmdVar, cmdArg ); }
+		QtuC::Tools::sendMessage( QtuC::msgError, "Interface ", cmdHwi, " not found" );
+		return false;
 	}
-	QtuC::Tools::sendMessage( QtuC::msgError, "Interface ", cmdHwi, " not found" );
-	return false;
+	if( cmdType == QtuC::cmdMultiGet || cmdType == QtuC::cmdMultiSet )
+		{ return routeBatch( hwi, cmdType, cmdVar, cmdArg ); }
+	return hwi->execCmd( cmdType, cmdVar, cmdArg );
+}
+
+bool Interfaces::routeBatch( interface_t const *hwi, QtuC::cmdType_t const type, char *firstItem, char *rest )
+{
+	// proxy understands batches, so the replies can be batched as well
+	QtuC::Tools::enableBatch();
+	QtuC::Tools::beginBatch();
+
+	bool success = true;
+	char *item = firstItem;
+	while( item )
+	{
+		// the items are separated by a single separator, the first one is already terminated by parseCmd()
+		char *next = 0;
+		if( item == firstItem )
+			{ next = *rest ? rest : 0; }
+		else
+		{
+			next = strchr( item, QtuC::Tools::CmdSep );
+			if( next )
+				{ *next++ = '\0'; }
+		}
+
+		if( *item )
+		{
+			if( type == QtuC::cmdMultiSet )
+			{
+				char *value = strchr( item, '=' );
+				if( value )
+				{
+					*value++ = '\0';
+					success = hwi->execCmd( QtuC::cmdSet, item, value ) && success;
+				}
+				else
+				{
+					QtuC::Tools::sendMessage( QtuC::msgError, "Batch item without value: ", item );
+					success = false;
+				}
+			}
+			else
+				{ success = hwi->execCmd( QtuC::cmdGet, item, item+strlen(item) ) && success; }
+		}
+		item = next;
+	}
+
+	QtuC::Tools::endBatch();
+	return success;
 }
 
-const Interfaces::interface_t *Interfaces::get( char *hwiName )
+const Interfaces::interface_t *Interfaces::get( char const *hwiName )
 {
-	for( uint8_t i=0; i<mInterfaceCount; ++i )
+	uint32_t hash = QtuC::Tools::hash( hwiName );
+	for( interface_t const *hwi = mBucketList[ hash & (Conf::interfaceBucketCount-1) ]; hwi; hwi = hwi->next )
 	{
-		if( strcmp( mInterfaceList[i].name, hwiName ) == 0 )
-			{ return mInterfaceList+i; }
+		if( hwi->hash == hash && strcmp( hwi->name, hwiName ) == 0 )
+			{ return hwi; }
 	}
 	return 0;
 }
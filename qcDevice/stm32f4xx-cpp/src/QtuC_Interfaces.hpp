@@ -6,48 +6,81 @@
 namespace QtuC
 {
 
+namespace Conf
+{
+	uint8_t const interfaceBucketCount = 8;	///< Number of hash buckets of the interfaces, a power of 2. Any number of interfaces can be registered, but with more than this, lookups may compare more names.
+}
+
 /** Class for managing the software interfaces.
  *	An interface can be on any software layer. You only need to register an interface, if it must handle deviceCommands.
- *	You can register an interface with QtuC::Interfaces::register().
- *	Once you register it, QtuC::Interfaces::routeCmd() will call the static execCmd() method of the destination interface with the parsed command params.*/
+ *	You can register an interface with QtuC::Interfaces::regInterface().
+ *	Once you register it, QtuC::Interfaces::routeCmd() will call the static execCmd() method of the destination interface with the parsed command params.
+ *	The interfaces are found by the hash of their name (see Tools::hash()), so routing takes the same time, whatever the number of interfaces.*/
 class Interfaces
 {
 public:
 	/** Structure to represent a qcInterface on the device.
 	 *	name: Name of the interface.<br>
-	 *	execCmd: Pointer to the static command execute method of the interface.*/
+	 *	execCmd: Pointer to the static command execute method of the interface.<br>
+	 *	hash, next: Used by Interfaces, set them to 0.*/
 	struct interface_t
 	{
 		const char *name;
 		bool (*execCmd)( QtuC::cmdType_t, char*, char* );
+		uint32_t hash;
+		interface_t *next;	///< Next interface in the hash bucket.
 	};
 
 	/** Register an interface as a device Interface.
-	 *	@param name Name of the interface. Use the pointer to the static interfaceName member of the interface.
-	 *	@param execCmdPtr Pointer to the static execCmd member of the interface. Will be called in command arrives for the interface.
+	 *	The interface structure is linked in the interface list, not copied, so it must have static storage.
+	 *	@param hwi The interface, with name and execCmd set.
 	 *	@return True if the interface has successfully registered, otherwise false.
-	 *	Register can fail if the params are invalid, or the qcInterface count reached the maximum. In the latter case, raise QtuC__Interfaces_Max_Interface_Count.*/
-	static bool regInterface( const char *name, bool (* const &execCmdPtr)( QtuC::cmdType_t, char*, char* ) );
+	 *	Register can fail if the params are invalid, or an interface with the same name is already registered.*/
+	static bool regInterface( interface_t &hwi );
+
+	/** Register an interface class as a device Interface.
+	 *	The class must have a static InterfaceName member (the name), and a static execCmd() method, which will be called if a command arrives for the interface.
+	 *	The interface structure is a static member of a template, no need to declare one.
+	 *	@return True if the interface has successfully registered, otherwise false.*/
+	template<class hwiT>
+	static inline bool regInterface()
+		{ return regInterface( Registration<hwiT>::Interface ); }
 
 	/** Route an incoming command to the destination hardware interface.
+	 *	Batched commands (`mget <hwi> var1 var2 ...`, `mset <hwi> var1=val1 var2=val2 ...`) are split to single get/set commands for the interface,
+	 *	and the replies are batched (see Tools::beginBatch()).
+	 *	In binary mode, the command is a received frame, decoded by QtuC::Binary.
 	 *	@param cmdStr The raw command string.
 	 *	@return True on success, false otherwise.*/
 	static bool routeCmd( char *cmdStr );
 
 	/** Get a an interface based on it's name.
 	 *	@param hwiName Name of the interface.
-	 *	@return Pointer to the qcInterface structure.*/
-	static const interface_t *get( char *hwiName );
+	 *	@return Pointer to the qcInterface structure, or null if there is no such interface.*/
+	static const interface_t *get( char const *hwiName );
 
 private:
 
-	/** Maximum number of qcInterfaces.
-	*	Ideally, this matches the number of current interfaces, but if you add a new one, don't forget to update this.*/
-	static uint8_t const MMaxInterfaceCount = 5;
+	/** Execute a batched command.
+	 *	@param hwi The destination interface.
+	 *	@param type cmdMultiGet or cmdMultiSet.
+	 *	@param firstItem The first item, as parsed to var by Tools::parseCmd().
+	 *	@param rest The rest of the items, as parsed to arg by Tools::parseCmd().
+	 *	@return True if all items are executed successfully, false otherwise.*/
+	static bool routeBatch( interface_t const *hwi, QtuC::cmdType_t const type, char *firstItem, char *rest );
 
-	static interface_t mInterfaceList[MMaxInterfaceCount];	///< List of hardware interface representations.
-	static uint8_t mInterfaceCount;	///< Current number of hwInterfaces. Must be less than or equal to QtuC__Interfaces_Max_Interface_Count.
+	/// The interface structure of an interface class, see regInterface().
+	template<class hwiT>
+	struct Registration
+	{
+		static interface_t Interface;
+	};
+
+	static interface_t *mBucketList[Conf::interfaceBucketCount];	///< The registered interfaces, chained by the hash of their names.
 };
 
+template<class hwiT>
+Interfaces::interface_t Interfaces::Registration<hwiT>::Interface = { hwiT::InterfaceName, hwiT::execCmd, 0, 0 };
+
 }	//QtuC::
 #endif // QTUC_INTERFACES_H
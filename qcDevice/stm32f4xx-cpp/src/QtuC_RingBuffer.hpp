@@ -0,0 +1,116 @@
+#ifndef QTUC_RINGBUFFER_H
+#define QTUC_RINGBUFFER_H
+
+#include <stdint.h>
+
+namespace QtuC
+{
+
+/** Byte ring buffer between one writer and one reader context.
+ *	Typical use is a buffer filled from the main loop and drained by an interrupt (or the other way around).
+ *	The writer only modifies the write index, the reader only the read index, so the reader needs no locking.
+ *	If more contexts may write (for example the main loop and an interrupt), guard push() with IRQDIS()/IRQEN().
+ *	One slot is always kept empty to tell a full buffer from an empty one, so the capacity is size-1 bytes.
+ *	Variable length records (for example received commands) can be written a byte at a time with stage(), and published at once with commit(),
+ *	so the reader never sees a partial record. Don't mix push() and stage() between two commit()s.
+ *	This class is hardware independent, it can be compiled and tested on the host.
+ *	@param size Size of the buffer in bytes, 2 < size <= 65535.*/
+template<uint16_t size>
+class RingBuffer
+{
+public:
+	RingBuffer() : mWPtr(0), mSPtr(0), mRPtr(0) {}
+
+	/// Check if the buffer is empty.
+	inline bool isEmpty() const
+		{ return mWPtr == mRPtr; }
+
+	/** Get the number of free bytes.
+	 *	@return Number of bytes that can be pushed.*/
+	inline uint16_t getFree() const
+	{
+		uint16_t r = mRPtr;
+		uint16_t w = mWPtr;
+		return ( r > w ) ? ( r - w - 1 ) : ( size - 1 - w + r );
+	}
+
+	/** Get the number of used bytes, including the staged ones.
+	 *	@return Number of bytes in the buffer.*/
+	inline uint16_t getUsed() const
+	{
+		uint16_t r = mRPtr;
+		uint16_t s = mSPtr;
+		return ( s >= r ) ? ( s - r ) : ( size - r + s );
+	}
+
+	/** Push data to the buffer.
+	 *	The data is pushed only if it fits as a whole, nothing is written otherwise.
+	 *	@param data The data to push.
+	 *	@param len Length of the data.
+	 *	@return True if the data has been pushed, false if there was not enough space.*/
+	bool push( char const *data, uint16_t const len )
+	{
+		if( len > getFree() )
+			{ return false; }
+		uint16_t w = mWPtr;
+		for( uint16_t i=0; i<len; ++i )
+		{
+			mBuf[w] = data[i];
+			w = inc(w);
+		}
+		mSPtr = w;
+		mWPtr = w;	// publish only after the data is in place
+		return true;
+	}
+
+	/** Write a byte after the staged ones, without publishing it to the reader.
+	 *	@param c The byte.
+	 *	@return True on success, false if the buffer is full (the staged bytes are kept, discard() them or make room).*/
+	inline bool stage( char const c )
+	{
+		uint16_t s = mSPtr;
+		if( inc(s) == mRPtr )
+			{ return false; }
+		mBuf[s] = c;
+		mSPtr = inc(s);
+		return true;
+	}
+
+	/// Publish the staged bytes to the reader.
+	inline void commit()
+		{ mWPtr = mSPtr; }
+
+	/// Drop the staged bytes.
+	inline void discard()
+		{ mSPtr = mWPtr; }
+
+	/** Pop a byte from the buffer.
+	 *	@param c The popped byte is written here.
+	 *	@return True if a byte was popped, false if the buffer is empty.*/
+	inline bool pop( char &c )
+	{
+		if( isEmpty() )
+			{ return false; }
+		c = mBuf[mRPtr];
+		mRPtr = inc(mRPtr);
+		return true;
+	}
+
+	/// Drop all data. Must not be called while the reader is active.
+	inline void clear()
+		{ mRPtr = mWPtr; }
+
+private:
+
+	/// Get the index following ptr.
+	static inline uint16_t inc( uint16_t const ptr )
+		{ return ( ptr < size-1 ) ? ptr+1 : 0; }
+
+	char mBuf[size];
+	volatile uint16_t mWPtr;	///< Index of the next byte to write, the end of the published data.
+	volatile uint16_t mSPtr;	///< Index of the next byte to stage, equals mWPtr if nothing is staged.
+	volatile uint16_t mRPtr;	///< Index of the next byte to read.
+};
+
+}	//QtuC::
+#endif // QTUC_RINGBUFFER_H
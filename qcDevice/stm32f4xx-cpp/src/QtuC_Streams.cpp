@@ -0,0 +1,116 @@
+#include "QtuC_Streams.hpp"
+#include <stdlib.h>
+
+using namespace QtuC;
+
+Streams::stream_t Streams::mStreamList[] = {};
+
+bool Streams::execCmd( QtuC::cmdType_t type, char *var, char *arg )
+{
+	if( type != QtuC::cmdCall )
+		{ return false; }
+
+	if( QtuC::Tools::isArg( var, "stream" ) )
+	{
+		char *argv[3];
+		uint8_t argc = 3;
+		if( !QtuC::Tools::parseArg( arg, argv, argc ) || argc < 2 )
+		{
+			QtuC::Tools::sendMessage( QtuC::msgError, "Stream: missing interface or variable" );
+			return false;
+		}
+		uint32_t periodMs = 0;
+		if( argc > 2 )
+			{ periodMs = strtoul( argv[2], 0, 0 ); }
+		return set( argv[0], argv[1], periodMs );
+	}
+	else if( QtuC::Tools::isArg( var, "streamClear" ) )
+	{
+		clear();
+		return true;
+	}
+
+	return false;
+}
+
+bool Streams::set( char *hwiName, char const *varName, uint32_t const periodMs )
+{
+	Interfaces::interface_t const *hwi = Interfaces::get( hwiName );
+	if( !hwi )
+	{
+		QtuC::Tools::sendMessage( QtuC::msgError, "Stream: interface ", hwiName, " not found" );
+		return false;
+	}
+	if( strlen(varName) >= Conf::maxStreamVarLength )
+	{
+		QtuC::Tools::sendMessage( QtuC::msgError, "Stream: too long var name ", varName );
+		return false;
+	}
+
+	// find the stream of the variable, or a free slot for it
+	stream_t *stream = 0;
+	for( uint8_t i=0; i<Conf::maxStreamCount; ++i )
+	{
+		if( mStreamList[i].hwi == hwi && QtuC::Tools::isArg( mStreamList[i].var, varName ) )
+		{
+			stream = mStreamList+i;
+			break;
+		}
+		if( !stream && !mStreamList[i].hwi )
+			{ stream = mStreamList+i; }
+	}
+
+	if( !periodMs )
+	{
+		if( stream && stream->hwi )
+			{ stream->hwi = 0; }
+		return true;
+	}
+
+	if( !stream )
+	{
+		QtuC::Tools::sendMessage( QtuC::msgError, "Stream: reached max stream count!" );
+		return false;
+	}
+
+	// the interrupts never touch the streams, so no need to disable them
+	strcpy( stream->var, varName );
+	stream->periodUs = periodMs * 1000;
+	stream->lastPush = SysTime::getTimeStamp();
+	stream->lagUs = 0;
+	stream->hwi = hwi;
+	return true;
+}
+
+void Streams::clear()
+{
+	for( uint8_t i=0; i<Conf::maxStreamCount; ++i )
+		{ mStreamList[i].hwi = 0; }
+}
+
+void Streams::tick()
+{
+	// the variables due at the same time go out in batches
+	QtuC::Tools::beginBatch();
+	for( uint8_t i=0; i<Conf::maxStreamCount; ++i )
+	{
+		stream_t &stream = mStreamList[i];
+		if( !stream.hwi )
+			{ continue; }
+
+		uint32_t usSince;
+		bool inRange = SysTime::getUsSince( stream.lastPush, usSince );
+		if( inRange && usSince + stream.lagUs < stream.periodUs )
+			{ continue; }
+
+		stream.lastPush = SysTime::getTimeStamp();
+		// carry the lateness over to the next period, but if we are more than a period late, skip the missed pushes
+		if( inRange && usSince + stream.lagUs - stream.periodUs < stream.periodUs )
+			{ stream.lagUs = usSince + stream.lagUs - stream.periodUs; }
+		else
+			{ stream.lagUs = 0; }
+
+		stream.hwi->execCmd( QtuC::cmdGet, stream.var, stream.var+strlen(stream.var) );
+	}
+	QtuC::Tools::endBatch();
+}
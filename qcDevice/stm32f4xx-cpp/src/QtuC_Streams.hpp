@@ -0,0 +1,77 @@
+#ifndef QTUC_STREAMS_H
+#define QTUC_STREAMS_H
+
+#include "QtuC_Tools.hpp"
+#include "QtuC_Interfaces.hpp"
+
+namespace QtuC
+{
+
+namespace Conf
+{
+	uint8_t const maxStreamCount = 8;		///< Maximum number of variables pushed to qcProxy at the same time.
+	uint8_t const maxStreamVarLength = 24;	///< Maximum length of a streamed variable name, with the null terminator.
+}
+
+/** Push state variables to qcProxy periodically.
+ *	Instead of polling a variable with get commands, qcProxy can ask the device to push it at a given period
+ *	(this is the push mode of the device-side autoUpdate in the deviceAPI).
+ *	A stream simply calls the execCmd() of the variable's interface with a get command when the period has elapsed,
+ *	so the interface sends the usual set command (with a timestamp, see Conf::useCmdTimestamps), and any interface that answers get commands can be streamed.
+ *
+ *	The streams are controlled by qcProxy with calls to the proxy interface:
+ *	  * `call :proxy stream <hwi> <var> <periodMs>`: Start pushing the variable, or change its period. A period of 0 stops the stream.
+ *	  * `call :proxy streamClear`: Stop all streams.
+ *
+ *	The proxy interface is HwInterface::ProxyCom, it passes these calls to execCmd(). Call tick() from the main loop.*/
+class Streams
+{
+private:
+	/// Private c'tor. This is a static class, don't instantiate.
+	Streams(){}
+
+public:
+
+	/** Execute a command sent to the proxy interface.
+	 *	@param type Type of the command, only calls are handled.
+	 *	@param var The function.
+	 *	@param arg The arguments of the function.
+	 *	@return True on success, false otherwise.*/
+	static bool execCmd( QtuC::cmdType_t type, char *var, char *arg );
+
+	/** Start, change or stop a stream.
+	 *	@param hwiName Name of the interface of the variable, the interface must be registered.
+	 *	@param varName Name of the variable.
+	 *	@param periodMs Period of the stream in milliseconds, 0 stops the stream.
+	 *	@return True on success, false otherwise.*/
+	static bool set( char *hwiName, char const *varName, uint32_t const periodMs );
+
+	/// Stop all streams.
+	static void clear();
+
+	/** Push the variables whose period has elapsed.
+	 *	Call it from the main loop as often as possible, the jitter of the streams depends on the loop time.*/
+	static void tick();
+
+private:
+
+	/** Type to represent a stream.
+	 *	hwi: The interface of the variable, null if this slot is free.<br>
+	 *	var: Name of the variable.<br>
+	 *	periodUs: Period of the stream.<br>
+	 *	lastPush: Time of the last push.<br>
+	 *	lagUs: Lateness of the last push, subtracted from the next period so the stream doesn't drift with the loop time.*/
+	struct stream_t
+	{
+		Interfaces::interface_t const *hwi;
+		char var[Conf::maxStreamVarLength];
+		uint32_t periodUs;
+		SysTime::sysTimeStamp_t lastPush;
+		uint32_t lagUs;
+	};
+
+	static stream_t mStreamList[Conf::maxStreamCount];	///< List of the streams.
+};
+
+}	//QtuC::
+#endif // QTUC_STREAMS_H
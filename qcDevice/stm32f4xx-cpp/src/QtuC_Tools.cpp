@@ -1,10 +1,17 @@
 #include "QtuC_Tools.hpp"
+#include "QtuC_Binary.hpp"
 
 using namespace QtuC;
 
 volatile uint16_t IRQDisableLevel = 0;
 const char Tools::Endl = '\n';
 const char Tools::CmdSep = ' ';
+const uint32_t Tools::HashSeed = 2166136261u;
+LineBuffer Tools::mBatchLine;
+char const *Tools::mBatchInterface = 0;
+uint8_t Tools::mBatchDepth = 0;
+bool Tools::mBatchEnabled = false;
+bool Tools::mBinary = false;
 
 bool Tools::sendCommandBase( cmdType_t const type, const char *interface, const char *var, const char *arg1, const char *arg2, const char *arg3, const char *arg4, const char *arg5 )
 {
@@ -14,49 +21,61 @@ bool Tools::sendCommandBase( cmdType_t const type, const char *interface, const
 		return false;
 	}
 
-	/// @todo Cache the string to be sent and sent it in one command, only guard that with interrupt blocks
-	IRQDIS();
+	// in binary mode a variable command with a single value goes in a frame with the variable id
+	if( mBinary && ( ( type == cmdGet && !arg1 ) || ( type == cmdSet && arg1 && !arg2 ) ) )
+	{
+		// a value too long for a frame goes in text
+		uint32_t argLength = arg1 ? strlen(arg1) : 0;
+		if( argLength <= 0xFF && Binary::sendValue( type, interface, var, Binary::tagString, arg1, argLength ) )
+			{ return true; }
+	}
+
+	if( mBatchDepth && !mBinary && type == cmdSet && arg1 && !arg2 && !strchr( arg1, CmdSep ) )
+	{
+		appendBatch( interface, var, arg1 );
+		return true;
+	}
+
+	LineBuffer line;
 
-	print( Tools::commandTypeToString(type) );
+	line.append( Tools::commandTypeToString(type) );
 
 	// print timestamp
 	if( QtuC::Conf::useCmdTimestamps )
-		{ printTimeStamp(); }
+		{ printTimeStamp( line ); }
 
-	putChar( CmdSep );
-	print( interface );
-	putChar( CmdSep );
-	print( var );
+	line.append( CmdSep );
+	line.append( interface );
+	line.append( CmdSep );
+	line.append( var );
 
 	if( arg1 )
 	{
-		putChar( CmdSep );
-		print( arg1 );
+		line.append( CmdSep );
+		line.append( arg1 );
 	}
 	if( arg2 )
 	{
-		putChar( CmdSep );
-		print( arg2 );
+		line.append( CmdSep );
+		line.append( arg2 );
 	}
 	if( arg3 )
 	{
-		putChar( CmdSep );
-		print( arg3 );
+		line.append( CmdSep );
+		line.append( arg3 );
 	}
 	if( arg4 )
 	{
-		putChar( CmdSep );
-		print( arg4 );
+		line.append( CmdSep );
+		line.append( arg4 );
 	}
 	if( arg5 )
 	{
-		putChar( CmdSep );
-		print( arg5 );
+		line.append( CmdSep );
+		line.append( arg5 );
 	}
 
-	putChar( Endl );
-
-	IRQEN();
+	printLine( line );
 	return true;
 }
 
@@ -67,25 +86,49 @@ bool Tools::sendCommandBase( cmdType_t const type, const char *interface, const
 bool Tools::parseCmd( char *cmd, cmdType_t &type, char *&hwi, char *&var, char *&arg )
 {
 	type = cmdUndefined;
+	char const *cmdEnd = cmd + strlen(cmd);
 
 	// Parse command type
 	char *tokPos = strtok( cmd, " " );
-	if( strcmp( tokPos, "get" ) == 0 ) { type = cmdGet; }
-	else if( strcmp( tokPos, "set" ) == 0 ) { type = cmdSet; }
-	else if( strcmp( tokPos, "call" ) == 0 ) { type = cmdCall; }
+	if( !tokPos )
+		{ return false; }
+	// the type words differ in the first character (or the second after the batch prefix), one strcmp is enough
+	bool batch = ( *tokPos == 'm' );
+	switch( tokPos[batch ? 1 : 0] )
+	{
+		case 'g': type = ( strcmp( tokPos+batch, "get" ) == 0 ) ? ( batch ? cmdMultiGet : cmdGet ) : cmdUndefined; break;
+		case 's': type = ( strcmp( tokPos+batch, "set" ) == 0 ) ? ( batch ? cmdMultiSet : cmdSet ) : cmdUndefined; break;
+		case 'c': type = ( !batch && strcmp( tokPos, "call" ) == 0 ) ? cmdCall : cmdUndefined; break;
+		default: break;
+	}
 
 	// parse interface name
 	hwi = strtok( NULL, " " );
 
 	//parse variable / function name
 	var = strtok( NULL, " " );
+	if( !hwi || !var )
+		{ return false; }
 
-	// the rest is argument
-	arg = var+strlen(var)+1;
+	// the rest is argument (empty, if there's nothing after var)
+	arg = var+strlen(var);
+	if( arg < cmdEnd )
+		{ ++arg; }
 
 	return true;
 }
 
+uint32_t Tools::hash( char const *str, uint32_t const seed )
+{
+	uint32_t h = seed;
+	while( *str )
+	{
+		h ^= (uint8_t)*str++;
+		h *= 16777619u;
+	}
+	return h;
+}
+
 bool Tools::parseArg( char *arg, char **argv, uint8_t &argc )
 {
 	if( !arg || !argv ) return false;
@@ -106,7 +149,6 @@ bool Tools::parseArg( char *arg, char **argv, uint8_t &argc )
 			arg = partPtr+ strlen(partPtr)+1;
 		}
 		argv[argc++] = partPtr;
-		arg += strlen(partPtr)+1;	// +1 to skip separator
 		if( argc == maxArgCount )
 			{ break; }
 	}
@@ -118,102 +160,118 @@ bool Tools::parseArg( char *arg, char **argv, uint8_t &argc )
 
 void Tools::sendMessage( messageType_t const msgType, char const *msgPart1, char const *msgPart2, char const *msgPart3, char const *msgPart4, char const *msgPart5, char const *msgPart6, char const *msgPart7, char const *msgPart8, char const *msgPart9, char const *msgPart10 )
 {
-	/// @todo Cache the string to be sent and sent it in one command, only guard that with interrupt blocks
-	IRQDIS();
+	LineBuffer line;
 
-	print( Tools::commandTypeToString(cmdCall) );
+	line.append( Tools::commandTypeToString(cmdCall) );
 
 	// print timestamp
 	if( QtuC::Conf::useCmdTimestamps )
-		{ printTimeStamp(); }
+		{ printTimeStamp( line ); }
 
-	putChar( CmdSep );
-	print( QtuC::Conf::proxyInterfaceName );
-	putChar( CmdSep );
-	print( "message" );
+	line.append( CmdSep );
+	line.append( QtuC::Conf::proxyInterfaceName );
+	line.append( CmdSep );
+	line.append( "message" );
 
-	putChar( CmdSep );
-	print( messageTypeToString( msgType ) );
+	line.append( CmdSep );
+	line.append( messageTypeToString( msgType ) );
 
-	putChar( CmdSep );
+	line.append( CmdSep );
 
-	print( msgPart1 );
+	line.append( msgPart1 );
 
 	if( msgPart2 )
-		{ print( msgPart2 ); }
+		{ line.append( msgPart2 ); }
 	if( msgPart3 )
-		{ print( msgPart3 ); }
+		{ line.append( msgPart3 ); }
 	if( msgPart4 )
-		{ print( msgPart4 ); }
+		{ line.append( msgPart4 ); }
 	if( msgPart5 )
-		{ print( msgPart5 ); }
+		{ line.append( msgPart5 ); }
 	if( msgPart6 )
-		{ print( msgPart6 ); }
+		{ line.append( msgPart6 ); }
 	if( msgPart7 )
-		{ print( msgPart7 ); }
+		{ line.append( msgPart7 ); }
 	if( msgPart8 )
-		{ print( msgPart8 ); }
+		{ line.append( msgPart8 ); }
 	if( msgPart9 )
-		{ print( msgPart9 ); }
+		{ line.append( msgPart9 ); }
 	if( msgPart10 )
-		{ print( msgPart10 ); }
-
-	putChar( Endl );
+		{ line.append( msgPart10 ); }
 
-	IRQEN();
+	printLine( line );
 }
 
 void Tools::sendGreeting( char const *deviceParams[], char const *greetingMsg )
 {
-	/// @todo Cache the string to be sent and sent it in one command, only guard that with interrupt blocks
-	IRQDIS();
+	LineBuffer line;
 
-	print( Tools::commandTypeToString(cmdCall) );
+	line.append( Tools::commandTypeToString(cmdCall) );
 
 	// print timestamp
 	if( QtuC::Conf::useCmdTimestamps )
-		{ printTimeStamp(); }
+		{ printTimeStamp( line ); }
 
-	putChar( CmdSep );
-	print( QtuC::Conf::proxyInterfaceName );
-	putChar( CmdSep );
-	print( "greeting" );
+	line.append( CmdSep );
+	line.append( QtuC::Conf::proxyInterfaceName );
+	line.append( CmdSep );
+	line.append( "greeting" );
 
 	if( deviceParams )
 	{
-		putChar( CmdSep );
+		line.append( CmdSep );
 		uint8_t i = 0;
 		while( deviceParams[i] )
 		{
 			if( i> 0 )
-				{ putChar( CmdSep ); }
+				{ line.append( CmdSep ); }
 
-			putChar('"');
-			print( deviceParams[i++] );
-			putChar(':');
+			line.append('"');
+			line.append( deviceParams[i++] );
+			line.append(':');
 			if( deviceParams[i] )
-				{ print( deviceParams[i++] ); }
+				{ line.append( deviceParams[i++] ); }
 			else
 			{
-				putChar('"');
+				line.append('"');
 				break;
 			}
-			putChar('"');
+			line.append('"');
 		}
 	}
 
+	// batched commands are supported up to this length
+	char buf[6];
+	itoa( Conf::maxCommandLength-1, buf );
+	line.append( CmdSep );
+	line.append( "\"batch:" );
+	line.append( buf );
+	line.append('"');
+
+	// the binary protocol is supported with this many variable ids
+	itoa( Conf::maxBinaryIdCount, buf );
+	line.append( CmdSep );
+	line.append( "\"binary:" );
+	line.append( buf );
+	line.append('"');
+
+	// qcProxy may send this much data without an acknowledge (see HwInterface::ProxyCom)
+	itoa( Conf::receiveBufferSize-1, buf );
+	line.append( CmdSep );
+	line.append( "\"rxBuffer:" );
+	line.append( buf );
+	line.append('"');
+
 	if( greetingMsg )
 	{
-		putChar( CmdSep );
-		putChar('"');
-		print( "msg:" );
-		print( greetingMsg );
-		putChar('"');
+		line.append( CmdSep );
+		line.append('"');
+		line.append( "msg:" );
+		line.append( greetingMsg );
+		line.append('"');
 	}
 
-	putChar( Endl );
-
-	IRQEN();
+	printLine( line );
 }
 
 const char *Tools::messageTypeToString( messageType_t const msgType )
@@ -236,10 +294,77 @@ const char* Tools::commandTypeToString( cmdType_t const cType )
 		case cmdGet: return "get";
 		case cmdSet: return "set";
 		case cmdCall: return "call";
+		case cmdMultiGet: return "mget";
+		case cmdMultiSet: return "mset";
 		default: return 0;
 	}
 }
 
+void Tools::beginBatch()
+{
+	if( mBatchEnabled )
+		{ ++mBatchDepth; }
+}
+
+void Tools::endBatch()
+{
+	if( !mBatchDepth )
+		{ return; }
+	if( --mBatchDepth == 0 )
+		{ flushBatch(); }
+}
+
+void Tools::appendBatch( const char *interface, const char *var, const char *value )
+{
+	if( mBatchInterface && !isArg( mBatchInterface, interface ) )
+		{ flushBatch(); }
+
+	// var=value with the leading separator
+	uint16_t pairLength = strlen(var) + strlen(value) + 2;
+	if( mBatchInterface && mBatchLine.length() + pairLength > LineBuffer::maxLength() )
+		{ flushBatch(); }
+
+	if( !mBatchInterface )
+	{
+		mBatchInterface = interface;
+		mBatchLine.append( commandTypeToString(cmdMultiSet) );
+		if( QtuC::Conf::useCmdTimestamps )
+			{ printTimeStamp( mBatchLine ); }
+		mBatchLine.append( CmdSep );
+		mBatchLine.append( interface );
+	}
+
+	mBatchLine.append( CmdSep );
+	mBatchLine.append( var );
+	mBatchLine.append( '=' );
+	mBatchLine.append( value );
+}
+
+void Tools::flushBatch()
+{
+	if( !mBatchInterface )
+		{ return; }
+	printLine( mBatchLine );
+	mBatchLine.clear();
+	mBatchInterface = 0;
+}
+
+void Tools::printLine( LineBuffer &line )
+{
+	if( mBinary )
+		{ Binary::sendText( line.str(), line.length() ); }
+	else
+	{
+		line.appendEndl( Endl );
+		print( line.str() );
+	}
+}
+
+bool Tools::sendBinaryInt( cmdType_t const type, const char *interface, const char *var, uint32_t const value, bool const isSigned )
+{
+	return Binary::sendValue( type, interface, var, isSigned ? Binary::tagInt : Binary::tagUInt, &value, 4 );
+}
+
 bool QtuC::isTrue( const char* str )
 {
 	return ( Tools::isArg( str, "on" ) || Tools::isArg( str, "1" ) || Tools::isArg( str, "true" ) );
@@ -12,9 +12,8 @@
 #ifndef QTUC_TOOLS_H
 #define QTUC_TOOLS_H
 
-#include "stm32f4xx_conf.h"		/// this is only for convenience (as nearly all project files include QtuC_Tools), not needed directly by QtuC_Tools.
+#include "HAL_Platform.hpp"		/// this is only for convenience (as nearly all project files include QtuC_Tools), not needed directly by QtuC_Tools.
 #include <string.h>
-#include "UserCoreConfig.hpp"
 #include "SysTime.hpp"
 
 /** Macro switches for turning interrupts on/off.
@@ -96,7 +95,9 @@ namespace QtuC
 
 namespace Conf
 {
-	uint8_t const maxCommandLength = 50;	///< Maximum length of incoming device commands.
+	uint8_t const maxCommandLength = 80;	///< Maximum length of incoming device commands (with the null terminator). Sent to qcProxy in the greeting, as the limit of the batched commands.
+	uint16_t const receiveBufferSize = 512;	///< Size of the command receive buffer in bytes (see HwInterface::ProxyCom). Must hold at least two commands of maxCommandLength. Sent to qcProxy in the greeting, as the limit of the data in flight.
+	uint8_t const maxSendLength = 250;		///< Maximum length of outgoing device commands (with the line end), longer commands are truncated.
 	char const proxyInterfaceName[] = {":proxy"};		///< Hardware interface name for the special proxy interface (to send messages to qcProxy).
 	bool const useCmdTimestamps = true;		///< Use timestamps in all commands. This way qcProxy is able to handle data points more precisely. You can read more about timekeeping in the Proxy documentation.
 }
@@ -106,7 +107,9 @@ enum cmdType_t {
 	cmdUndefined,
 	cmdGet,
 	cmdSet,
-	cmdCall
+	cmdCall,
+	cmdMultiGet,	///< Batched get: one interface, several variables.
+	cmdMultiSet		///< Batched set: one interface, several var=value pairs.
 };
 
 /// Define device message types
@@ -131,6 +134,70 @@ void print( char const *str );
  *	@param c Character to put.*/
 void putChar( char const c );
 
+/** Buffer to assemble an outgoing command line on the stack.
+ *	The Tools send functions build the whole line here, then print it at once, so the line is queued in one piece
+ *	and the interrupts need not be disabled while the line is assembled.
+ *	If the line is too long, it is truncated, but there is always room for the line end.*/
+class LineBuffer
+{
+public:
+	LineBuffer() : mLength(0)
+		{ mBuf[0] = '\0'; }
+
+	/** Append a string.
+	 *	@param str The string to append.*/
+	inline void append( char const *str )
+	{
+		while( *str && mLength < MSize-2 )
+			{ mBuf[mLength++] = *str++; }
+		mBuf[mLength] = '\0';
+	}
+
+	/** Append a character.
+	 *	@param c The character to append.*/
+	inline void append( char const c )
+	{
+		if( mLength < MSize-2 )
+		{
+			mBuf[mLength++] = c;
+			mBuf[mLength] = '\0';
+		}
+	}
+
+	/** Append the line end.
+	 *	Always fits, call only once, as the last append.
+	 *	@param endl The line end character.*/
+	inline void appendEndl( char const endl )
+	{
+		mBuf[mLength++] = endl;
+		mBuf[mLength] = '\0';
+	}
+
+	/// Get the null terminated line.
+	inline char const *str() const
+		{ return mBuf; }
+
+	/// Get the length of the line.
+	inline uint8_t length() const
+		{ return mLength; }
+
+	/// Get the maximum length of the line, without the line end.
+	static inline uint8_t maxLength()
+		{ return MSize-2; }
+
+	/// Empty the buffer.
+	inline void clear()
+	{
+		mLength = 0;
+		mBuf[0] = '\0';
+	}
+
+private:
+	static uint8_t const MSize = Conf::maxSendLength+1;	///< Buffer size, with the null terminator.
+	char mBuf[MSize];
+	uint8_t mLength;
+};
+
 /** Check if passed string evaluates to true.
  *	@param str String to check.
  *	@return True if string is "on", "true" or "1".*/
@@ -159,6 +226,13 @@ public:
 	static inline bool isArg( char const *str1, char const *str2 )
 		{ return ( strcmp(str1,str2) == 0 ); }
 
+	/** Hash a string (32 bit FNV-1a).
+	 *	Used for the constant time lookup of interface and variable names, see QtuC::HashIndex.
+	 *	@param str The null terminated string.
+	 *	@param seed Continue the hash of another string with this, to hash several strings together.
+	 *	@return The hash.*/
+	static uint32_t hash( char const *str, uint32_t const seed = HashSeed );
+
 	/** Parse device command argument.
 	 *	Tokenize argument by the argument separators and return the pointers to the argument parts.
 	 *	@param arg The argument to parse. Have to be null terminated.
@@ -190,6 +264,9 @@ public:
 	template<typename argT>
 	static inline bool sendCommand( cmdType_t const type, const char *interface, const char *var, const argT &arg )
 	{
+		// in binary mode the raw value is sent
+		if( mBinary && sendBinaryInt( type, interface, var, (uint32_t)arg, argT(-1) < argT(0) ) )
+			{ return true; }
 		char buf[10];	// 8 for representing 32bit in base 16, plus sign, plus null terminator
 		itoa( arg, buf, 16 );
 		return sendCommandBase( type, interface, var, buf);
@@ -246,42 +323,66 @@ public:
 	template<typename int1T, typename int2T>
 	static void sendDebug( char const *str1, int1T const &int1, char const *str2, int2T const &int2 )
 	{
-		/// @todo Cache the string to be sent and sent it in one command, only guard that with interrupt blocks
-		IRQDIS();
+		LineBuffer line;
 
-		print( Tools::commandTypeToString(cmdCall) );
+		line.append( Tools::commandTypeToString(cmdCall) );
 
 		// print timestamp
 		if( QtuC::Conf::useCmdTimestamps )
-			{ printTimeStamp(); }
+			{ printTimeStamp( line ); }
 
-		putChar( CmdSep );
-		print( QtuC::Conf::proxyInterfaceName );
-		putChar( CmdSep );
-		print( "message" );
+		line.append( CmdSep );
+		line.append( QtuC::Conf::proxyInterfaceName );
+		line.append( CmdSep );
+		line.append( "message" );
 
-		putChar( CmdSep );
-		print( messageTypeToString( msgDebug ) );
+		line.append( CmdSep );
+		line.append( messageTypeToString( msgDebug ) );
 
-		putChar( CmdSep );
-		print( str1 );
+		line.append( CmdSep );
+		line.append( str1 );
 
 		char buf[10];
 		itoa( int1, buf, 16 );
-		print( buf );
+		line.append( buf );
 
 		if( str2 )
 		{
-			print( str2 );
+			line.append( str2 );
 			itoa( int2, buf, 16 );
-			print( buf );
+			line.append( buf );
 		}
 
-		putChar( Endl );
-
-		IRQEN();
+		printLine( line );
 	}
 
+	/** Start batching the outgoing set commands.
+	 *	Until endBatch(), the set commands with a single argument (without separator) are not sent one-by-one,
+	 *	but collected to batched set commands (`mset <hwi> var1=val1 var2=val2 ...`), one for every run of the same interface.
+	 *	Batching is only done if qcProxy has sent a batched command (so it surely understands them), otherwise this does nothing.
+	 *	Calls can be nested, the batch is sent at the outermost endBatch().
+	 *	Don't use it from interrupts.*/
+	static void beginBatch();
+
+	/// Send the collected batch and stop batching.
+	static void endBatch();
+
+	/** Enable batching.
+	 *	Called by QtuC::Interfaces when a batched command is received from qcProxy.*/
+	static inline void enableBatch()
+		{ mBatchEnabled = true; }
+
+	/** Switch the binary protocol on or off.
+	 *	Called by QtuC::Binary when qcProxy asks for it. HwInterface::ProxyCom frames the received data accordingly.
+	 *	@param binary True for the binary protocol, false for the text protocol.*/
+	static inline void setBinary( bool binary )
+		{ mBinary = binary; }
+
+	/** Get if the binary protocol is used.
+	 *	@return True in binary mode, false in text mode.*/
+	static inline bool isBinary()
+		{ return mBinary; }
+
 	/** Get command type as string.
 	 *	@param cType Command type.
 	 *	@return String representation of the command type.*/
@@ -294,6 +395,7 @@ public:
 
 	static const char Endl;			///< Endline constant
 	static const char CmdSep;		///< Command part separator character.
+	static const uint32_t HashSeed;	///< Initial value of hash().
 
 private:
 
@@ -311,17 +413,48 @@ private:
 	 *	@return True if command has been successfully sent, false otherwise.*/
 	static bool sendCommandBase( cmdType_t const type, const char *interface, const char *var, const char *arg1 = 0, const char *arg2 = 0, const char *arg3 = 0, const char *arg4 = 0, const char *arg5 = 0 );
 
-	static void inline printTimeStamp()
+	/** Add a set command to the batch.
+	 *	If the interface differs from the batch, or the pair doesn't fit in the line, the batch is sent first.
+	 *	@param interface The Hardware interface name.
+	 *	@param var The variable.
+	 *	@param value The value.*/
+	static void appendBatch( const char *interface, const char *var, const char *value );
+
+	/// Send the collected batch, if not empty.
+	static void flushBatch();
+
+	/** Send a command line.
+	 *	In text mode, the line end is appended and the line is printed. In binary mode, it is sent in a text frame.
+	 *	@param line The command line, without the line end.*/
+	static void printLine( LineBuffer &line );
+
+	/** Send a variable command with an integer value in binary mode.
+	 *	@param type Type of the command.
+	 *	@param interface The Hardware interface name.
+	 *	@param var The variable.
+	 *	@param value The raw value.
+	 *	@param isSigned True if the value is signed.
+	 *	@return True if sent, false if it must be sent in text (see QtuC::Binary::sendValue()).*/
+	static bool sendBinaryInt( cmdType_t const type, const char *interface, const char *var, uint32_t const value, bool const isSigned );
+
+	static bool mBinary;		///< True if the binary protocol is used.
+
+	static LineBuffer mBatchLine;		///< The batched set command being collected.
+	static char const *mBatchInterface;	///< Interface of the batch, null if the batch is empty.
+	static uint8_t mBatchDepth;		///< Nesting level of beginBatch().
+	static bool mBatchEnabled;		///< True if qcProxy understands batched commands.
+
+	/** Append the timestamp to a command line.
+	 *	@param line The line to append to.*/
+	static void inline printTimeStamp( LineBuffer &line )
 	{
 		uint32_t us;
 		SysTime::getUsSince( SysTime::NullTime, us );
 		char buf[9];
 		itoa( us, buf, 16 );
-		IRQDIS();
-		putChar( CmdSep );
-		putChar( '@' );
-		print( buf );
-		IRQEN();
+		line.append( CmdSep );
+		line.append( '@' );
+		line.append( buf );
 	}
 };
 
@@ -1,8 +1,9 @@
 #ifndef SYSTIME_H
 #define SYSTIME_H
 
-#include "stm32f4xx_conf.h"
+#include "HAL_Platform.hpp"
 
+#ifndef QTUC_HOST
 // These must be in global scope
 #define Conf_SysTime_IRQHandler TIM5_IRQHandler(void)
 extern "C" void Conf_SysTime_IRQHandler;
@@ -22,19 +23,23 @@ namespace Conf
 		uint32_t const clockFreq = timerAPBClock / prescaler;
 	}
 }
+#endif
 
 /** Class to measure time.
  *	Initializes a timer to measure the system uptime (time since system startup).
  *	Resolution can be configured.
  *
  *	By default, the timer clock is 1MHz, so a counter increment is 1us. This means an overflow every 4295s (71.58min).
- *	With the 16bit overflow counter, approximately 9years of continuous timekeepeing is possible.*/
+ *	With the 16bit overflow counter, approximately 9years of continuous timekeepeing is possible.
+ *	On the host (QTUC_HOST), the monotonic system clock is used with the same 1us resolution, see host/SysTime_Host.cpp.*/
 class SysTime
 {
 private:
 	SysTime(){}
 public:
+#ifndef QTUC_HOST
 	friend void Conf_SysTime_IRQHandler;
+#endif
 
 	/// Initialize SysTime.
 	static void init(void);
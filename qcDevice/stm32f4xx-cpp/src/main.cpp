@@ -3,6 +3,7 @@
 #include "SysTime.hpp"
 #include "QtuC_Tools.hpp"
 #include "QtuC_Interfaces.hpp"
+#include "QtuC_Streams.hpp"
 #include "HwInterface_ProxyCom.hpp"
 #include "HwInterface_Led.hpp"
 #include "delay.hpp"
@@ -30,9 +31,8 @@ int main(void)
 	SysTime::start();
 
 	// Register the device interfaces
-	QtuC::Interfaces::regInterface( HwInterface::ProxyCom::InterfaceName, HwInterface::ProxyCom::execCmd );
-	QtuC::Interfaces::regInterface( HwInterface::Led::InterfaceName, HwInterface::Led::execCmd );
-	//Don't forget to increase QtuC::Interfaces::MMaxInterfaceCount if necessary!
+	QtuC::Interfaces::regInterface<HwInterface::ProxyCom>();
+	QtuC::Interfaces::regInterface<HwInterface::Led>();
 
 	// Initialize and start interfaces
 	HwInterface::ProxyCom::init();
@@ -55,6 +55,13 @@ int main(void)
 			QtuC::Interfaces::routeCmd(cmd);
 		}
 
+		// Push the streamed variables which are due
+		QtuC::Streams::tick();
+
+		// Acknowledge the processed commands, and report the commands lost in either direction
+		HwInterface::ProxyCom::acknowledgeReceived();
+		HwInterface::ProxyCom::reportOverflow();
+
 		// Some more stuff in the main loop...
 
 	}
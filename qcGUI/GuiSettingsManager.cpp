@@ -20,6 +20,30 @@ GuiSettingsManager::GuiSettingsManager(QObject *parent) :
 		{ setValue( "proxyAddress/host", "localhost" ); }
 	if( !contains("proxyAddress/port") )
 		{ setValue( "proxyAddress/port", 24563 ); }
+	if( !contains("proxyAddress/localName") )
+		{ setValue( "proxyAddress/localName", "" ); }	// local socket of the proxy (its serverSocket/localName), used if the host is localhost; empty: TCP only
+
+	// clientSend
+	if( !contains("clientSend/setIntervalMs") )
+		{ setValue( "clientSend/setIntervalMs", 50 ); }	// minimum time between the packets of sets from the widgets, 0: send every set at once
+
+	// clientReceive
+	if( !contains("clientReceive/workerThread") )
+		{ setValue( "clientReceive/workerThread", true ); }	// read and decode the packets of the proxy in a worker thread, handled once per gui/frameIntervalMs
+	if( !contains("clientReceive/sharedState") )
+		{ setValue( "clientReceive/sharedState", true ); }	// read the values from the shared memory of a proxy on this host, instead of subscribing
+
+	// gui
+	if( !contains("gui/variableView") )
+		{ setValue( "gui/variableView", "widgets" ); }	// widgets: a widget for each variable, table: a table for large deviceAPIs
+	if( !contains("gui/frameIntervalMs") )
+		{ setValue( "gui/frameIntervalMs", 16 ); }	// the widgets of the variables are updated at most once in this time
+	if( !contains("gui/updateReportIntervalMs") )
+		{ setValue( "gui/updateReportIntervalMs", 10000 ); }	// 0: no periodic report
+
+	// latency trace
+	if( !contains("latencyTrace/reportIntervalMs") )
+		{ setValue( "latencyTrace/reportIntervalMs", 10000 ); }	// 0: no periodic report
 
 }
 
@@ -1,11 +1,12 @@
 #include "ProxyConnectionManager.h"
-#include <QTcpSocket>
 #include "GuiSettingsManager.h"
 
 using namespace QtuC;
 
-ProxyConnectionManager::ProxyConnectionManager(QTcpSocket *socket, QObject *parent) :
+ProxyConnectionManager::ProxyConnectionManager(QIODevice *socket, QObject *parent) :
 	ClientConnectionManagerBase( socket, false, parent )
 {
 	socket->setParent(this);
+	if( GuiSettingsManager::instance()->value("clientReceive/workerThread").toBool() )
+		{ startWorkerThread( GuiSettingsManager::instance()->value("gui/frameIntervalMs").toInt() ); }
 }
@@ -10,7 +10,7 @@ class ProxyConnectionManager : public ClientConnectionManagerBase
 {
 	Q_OBJECT
 public:
-	explicit ProxyConnectionManager( QTcpSocket *socket, QObject *parent = 0 );
+	explicit ProxyConnectionManager( QIODevice *socket, QObject *parent = 0 );
 
 };
 
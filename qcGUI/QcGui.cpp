@@ -1,13 +1,17 @@
 #include "QcGui.h"
 #include "GuiSettingsManager.h"
 #include <QCoreApplication>
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include "LatencyMonitor.h"
 
 using namespace QtuC;
 using namespace qcGui;
 
 QcGui::QcGui(QObject *parent) : ErrorHandlerBase(parent),
 	mProxyLink(0),
-	mApiParser(0)
+	mApiParser(0),
+	mApiSubscriptions(0)
 {
 	// create settings
     QSettings::setDefaultFormat( QSettings::IniFormat );
@@ -15,6 +19,13 @@ QcGui::QcGui(QObject *parent) : ErrorHandlerBase(parent),
 
 	mProxyState = new ProxyStateManager(this);
 	connect( mProxyState, SIGNAL(stateVariableSendRequest(DeviceStateVariableBase*)), this, SLOT(handleStateVariableSendRequest(DeviceStateVariableBase*)) );
+	mSetCoalescer = new ClientSetCoalescer( GuiSettingsManager::instance()->value("clientSend/setIntervalMs").toInt(), this );
+	mSharedState = new SharedStateClient( mProxyState, this );
+
+	LatencyMonitor::instance(this)->setReportInterval( GuiSettingsManager::instance()->value("latencyTrace/reportIntervalMs").toInt() );
+
+	mViewBinder = new StateVariableViewBinder( GuiSettingsManager::instance()->value("gui/frameIntervalMs").toInt(), this );
+	mViewBinder->setReportInterval( GuiSettingsManager::instance()->value("gui/updateReportIntervalMs").toInt() );
 }
 
 QcGui::~QcGui()
@@ -38,6 +49,18 @@ void QcGui::connectProxy()
 	selfInfo.insert( QString("version"), QCoreApplication::instance()->applicationVersion() );
 	ClientConnectionManagerBase::setSelfInfo(selfInfo);
 
+	// a proxy on this host is reached on its local socket, if set
+	QString localName = GuiSettingsManager::instance()->value("proxyAddress/localName").toString();
+	if( !localName.isEmpty() && SharedStateClient::isLocalHost( GuiSettingsManager::instance()->value("proxyAddress/host").toString() ) )
+	{
+		QLocalSocket *proxySocket = new QLocalSocket(0);
+		connect( proxySocket, SIGNAL(error(QLocalSocket::LocalSocketError)), this, SLOT(proxyConnectError()) );
+		connect( proxySocket, SIGNAL(connected()), this, SLOT(proxyConnected()) );
+		connect( proxySocket, SIGNAL(disconnected()), this, SLOT(proxyDisconnected()) );
+		proxySocket->connectToServer( localName );
+		return;
+	}
+
 	QTcpSocket *proxySocket = new QTcpSocket(0);
 
 	connect( proxySocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(proxyConnectError()) );
@@ -64,12 +87,22 @@ bool QcGui::setDeviceApi(const QString &apiString)
 			//connect( mDeviceAPI, SIGNAL(newHardwareInterface(QString,QString)), mDeviceInstance, SLOT(addHardwareInterface(QString,QString)) );
 			connect( mApiParser, SIGNAL(newStateVariable(QHash<QString,QString>)), this, SLOT(createDeviceVariable(QHash<QString,QString>)) );
 			connect( mApiParser, SIGNAL(newDeviceFunction(QString,QString,QString)), this, SLOT(createDeviceFunction(QString,QString,QString)) );
+			mApiSubscriptions = new ClientCommandSubscribeList();
 			if( !mApiParser->parseAPI(apiString) )
 			{
 				mApiParser->disconnect();
+				delete mApiSubscriptions;
+				mApiSubscriptions = 0;
 				error( QtCriticalMsg, "Failed to re-parse deviceAPI string", "setDeviceApi()" );
 				return false;
 			}
+
+			// subscribe to all the autoUpdate-user variables in one command, unless all the values are in the shared memory of a local proxy
+			if( attachSharedState(apiString) || mApiSubscriptions->isEmpty() )
+				{ delete mApiSubscriptions; }
+			else
+				{ mProxyLink->sendCommand( mApiSubscriptions ); }
+			mApiSubscriptions = 0;
 		}
 	}
 	else
@@ -92,18 +125,28 @@ bool QcGui::resetDeviceApi(const QString &apiString)
 void QcGui::clearDeviceApi()
 {
 	// first signal that this API will be destroyed
+	mSharedState->detach();
 	emit deviceApiCleared();
 	mApiParser->disconnect();
 	delete mApiParser;
 	mApiParser = 0;
 }
 
+bool QcGui::attachSharedState( const QString &apiString )
+{
+	if( !GuiSettingsManager::instance()->value("clientReceive/sharedState").toBool() || !SharedStateClient::isLocalHost( GuiSettingsManager::instance()->value("proxyAddress/host").toString() ) )
+		{ return false; }
+	return mSharedState->attach( mProxyLink->getClientInfo().value("sharedState"), apiString );
+}
+
 bool QcGui::callDeviceFunction(const QString &hwInterface, const QString &name, const QStringList &argList)
 {
 	ClientCommandDevice *cmd = new ClientCommandDevice(deviceCmdCall);
 	cmd->setInterface(hwInterface);
 	cmd->setFunction(name);
 	cmd->setArgList(argList);
+	// the sets of the widgets before the call go first
+	mSetCoalescer->flush();
 	if( !mProxyLink->sendCommand( cmd ) )
 	{
 		error( QtWarningMsg, "Failed to call function", "callDeviceFunction()" );
@@ -115,20 +158,21 @@ bool QcGui::callDeviceFunction(const QString &hwInterface, const QString &name,
 void QcGui::proxyConnectError()
 {
 	errorDetails_t errDet;
-	errDet.insert( "error", ((QTcpSocket*)sender())->errorString() );
+	errDet.insert( "error", ((QIODevice*)sender())->errorString() );
 	error( QtCriticalMsg, "Failed to connect to proxy", "proxyConnectError", errDet );
 	delete sender();
 }
 
 void QcGui::proxyConnected()
 {
-	mProxyLink = new ProxyConnectionManager( (QTcpSocket*)sender(), this );
+	mProxyLink = new ProxyConnectionManager( (QIODevice*)sender(), this );
 
 	// disconnect socket from me, ProxyConnectionManager is in control now
 	disconnect( sender(), 0, this, 0 );
 
 	connect( mProxyLink, SIGNAL(connectionStateReady()), this, SLOT(proxyConnectionReady()) );
 	connect( mProxyLink, SIGNAL(commandReceived(ClientCommandBase*)), this, SLOT(handleCommand(ClientCommandBase*)) );
+	mSetCoalescer->setConnection( mProxyLink );
 
 	// initialize handshake process
 	mProxyLink->sendHandShake();
@@ -137,19 +181,24 @@ void QcGui::proxyConnected()
 void QcGui::proxyDisconnected()
 {
 	mProxyLink->disconnect();
+	mSetCoalescer->setConnection( 0 );
+	mSharedState->detach();
 	debug( debugLevelInfo, "Proxy disconnected", "proxyDisconnected()" );
 }
 
 void QcGui::proxyConnectionReady()
 {
-	debug( debugLevelVerbose, "Request device API...", "proxyConnectionReady()" );
-	mProxyLink->sendCommand( new ClientCommandReqDeviceApi() );
+	debug( debugLevelVerbose, "Request device API and snapshot...", "proxyConnectionReady()" );
+	// the snapshot is answered after the API, so the variables exist by the time the values arrive
+	QList<ClientCommandBase*> cmdList;
+	cmdList.append( new ClientCommandReqDeviceApi() );
+	cmdList.append( new ClientCommandReqSnapshot() );
+	mProxyLink->sendCommands( cmdList );
 }
 
 void QcGui::handleStateVariableSendRequest(DeviceStateVariableBase *stateVar)
 {
-	ClientCommandDevice *cmd = new ClientCommandDevice( deviceCmdSet, stateVar );
-	mProxyLink->sendCommand( cmd );
+	mSetCoalescer->queueSet( stateVar );
 }
 
 void QcGui::createDeviceVariable(QHash<QString, QString> varParams)
@@ -173,7 +222,9 @@ void QcGui::createDeviceVariable(QHash<QString, QString> varParams)
 			bool ok;
 			quint32 interval;
 			interval = (quint32)varParams.value("autoUpdate-user").toInt(&ok);
-			if( ok )
+			if( ok && mApiSubscriptions )
+				{ mApiSubscriptions->append( interval, stateVar->getHwInterface(), stateVar->getName() ); }
+			else if( ok )
 				{ mProxyLink->sendCommand( new ClientCommandSubscribe( interval, stateVar->getHwInterface(), stateVar->getName() ) ); }
 			else
 			{
@@ -223,7 +274,12 @@ bool QcGui::handleDeviceCmd(ClientCommandDevice *deviceCmd)
 	{
 		DeviceStateVariableBase *var = mProxyState->getVar( deviceCmd->getHwInterface(), deviceCmd->getVariable() );
 		if( var )
-			{ var->updateFromSource( deviceCmd->getArg() ); }
+		{
+			// the widgets are updated on the next display frame, see StateVariableViewBinder
+			var->updateFromSource( deviceCmd->getArg() );
+			if( deviceCmd->hasTrace() )
+				{ mViewBinder->traceUpdate( var, deviceCmd->getTrace() ); }
+		}
 		else
 		{
 			error( QtWarningMsg, QString("Failed to set variable from device, no such variable (hwI: %1, name: %2)").arg(deviceCmd->getHwInterface(),deviceCmd->getVariable()), "handleDeviceCmd()" );
@@ -234,8 +290,31 @@ bool QcGui::handleDeviceCmd(ClientCommandDevice *deviceCmd)
 	else return false;
 }
 
+void QcGui::handleSnapshotCmd( ClientCommandSnapshot *snapshotCmd )
+{
+	if( mSharedState->isAttached() )
+		{ return; }
+
+	const QList<ClientCommandSnapshot::value_t> &valueList = snapshotCmd->getValueList();
+	for( int i=0; i<valueList.size(); ++i )
+	{
+		DeviceStateVariableBase *var = mProxyState->getVar( valueList.at(i).hwInterface, valueList.at(i).variable );
+		if( var )
+			{ var->updateFromSource( valueList.at(i).value, valueList.at(i).time ); }
+		else
+			{ error( QtWarningMsg, QString("Failed to set variable from snapshot, no such variable (hwI: %1, name: %2)").arg(valueList.at(i).hwInterface,valueList.at(i).variable), "handleSnapshotCmd()" ); }
+	}
+}
+
 void QcGui::handleCommand(ClientCommandBase *cmd)
 {
+	// a proxy of more devices sends the commands of all of them, only the default one is shown
+	if( !mProxyLink->isDefaultDevice( cmd->getDevice() ) )
+	{
+		cmd->deleteLater();
+		return;
+	}
+
 	if( cmd->getClass() == ClientCommandBase::clientCommandDevice )
 	{
 		ClientCommandDevice *deviceCmd = (ClientCommandDevice*)cmd;
@@ -248,6 +327,8 @@ void QcGui::handleCommand(ClientCommandBase *cmd)
 		{
 			handleDeviceApiCmd( (ClientCommandDeviceApi*)cmd );
 		}
+		else if( cmd->getName() == "snapshot" )
+			{ handleSnapshotCmd( (ClientCommandSnapshot*)cmd ); }
 		else
 			{ debug( debugLevelInfo, QString("Unhandled command: %1").arg(cmd->getName()), "handleCommand()" ); }
 	}
@@ -5,6 +5,9 @@
 #include "ProxyStateManager.h"
 #include "ProxyConnectionManager.h"
 #include "DeviceAPIParser.h"
+#include "ClientSetCoalescer.h"
+#include "SharedStateClient.h"
+#include "StateVariableViewBinder.h"
 #include "DeviceStateVariableBase.h"
 
 using namespace QtuC;
@@ -53,6 +56,11 @@ public:
 	  *	@return True if the given parameters are valid and the call can be sent to proxy. This does not mean that the function call itself was successful on the device.*/
 	bool callDeviceFunction( const QString &hwInterface, const QString &name, const QStringList &argList = QStringList() );
 
+	/** Get the binder, which updates the widgets of the variables.
+	  *	@return The binder.*/
+	StateVariableViewBinder *getViewBinder()
+		{ return mViewBinder; }
+
 signals:
 
 	/** Emitted if a new Device State Variable is created.
@@ -115,9 +123,23 @@ private:
 	  *	@todo Temporary solution, for proxy passthrough mode.*/
 	bool handleDeviceCmd( ClientCommandDevice *deviceCmd );
 
+	/** Handle a snapshot command, update the variables from it.
+	  *	The values are already up to date if they are read from the shared memory, then the snapshot is ignored.
+	  *	@param snapshotCmd The received snapshot command.*/
+	void handleSnapshotCmd( ClientCommandSnapshot *snapshotCmd );
+
+	/** Read the values from the shared memory of the proxy instead of subscribing, if the proxy is on this host and shares its memory.
+	  *	@param apiString The deviceAPI string, the variables must be created from it.
+	  *	@return True if the values are read from the shared memory, false if they must be subscribed.*/
+	bool attachSharedState( const QString &apiString );
+
 	QtuC::ProxyStateManager *mProxyState;
 	QtuC::ProxyConnectionManager *mProxyLink;
 	QtuC::DeviceAPIParser *mApiParser;
+	QtuC::ClientCommandSubscribeList *mApiSubscriptions;	///< The user-side autoUpdate subscriptions of the API being parsed, sent at once after parsing.
+	QtuC::ClientSetCoalescer *mSetCoalescer;	///< Throttles the sets of the interactive widgets.
+	StateVariableViewBinder *mViewBinder;	///< Updates the widgets of the variables once per display frame.
+	QtuC::SharedStateClient *mSharedState;	///< Reads the values from the shared memory of a local proxy.
 };
 
 }	//QtuC::
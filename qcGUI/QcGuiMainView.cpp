@@ -55,8 +55,19 @@ void QcGuiMainView::createGui()
 	addToolBar( Qt::TopToolBarArea, mMainToolBar );
 	setStatusBar( new QStatusBar(this) );
 
-	mVariableView = new StateVariablesView();
-	mVariableView->setModel( mModel );
+	// the table scales to large deviceAPIs, the widgets are nicer for a few variables
+	if( GuiSettingsManager::instance()->value("gui/variableView").toString() == "table" )
+	{
+		StateVariableTableView *tableView = new StateVariableTableView();
+		tableView->setModel( mModel );
+		mVariableView = tableView;
+	}
+	else
+	{
+		StateVariablesView *widgetView = new StateVariablesView();
+		widgetView->setModel( mModel );
+		mVariableView = widgetView;
+	}
 
 	setCentralWidget(mVariableView);
 	mVariableView->show();
@@ -108,4 +119,6 @@ void QcGuiMainView::initModelView()
 	connect( mModel, SIGNAL(signalError(QtMsgType,QString,QString,QtuC::ErrorHandlerBase::errorDetails_t)), this, SLOT(showError(QtMsgType,QString,QString,QtuC::ErrorHandlerBase::errorDetails_t)) );
 	connect( mModel, SIGNAL(deviceVariableCreated(QtuC::DeviceStateVariableBase*,QString)), mVariableView, SLOT(showVariable(QtuC::DeviceStateVariableBase*,QString)) );
 	connect( mModel, SIGNAL(deviceFunctionCreated(QString,QString)), mVariableView, SLOT(showFunction(QString,QString)) );
+	if( qobject_cast<StateVariableTableView*>(mVariableView) )
+		{ connect( mModel, SIGNAL(deviceApiCleared()), mVariableView, SLOT(clearApiGui()) ); }
 }
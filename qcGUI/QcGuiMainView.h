@@ -3,6 +3,7 @@
 
 #include "QcGui.h"
 #include "StateVariablesView.h"
+#include "StateVariableTableView.h"
 #include <QMainWindow>
 #include <QToolBar>
 #include <QHash>
@@ -45,7 +46,7 @@ private:
 	void initModelView();
 
 	QcGui *mModel;
-	StateVariablesView *mVariableView;
+	QWidget *mVariableView;	///< StateVariablesView or StateVariableTableView, see the `gui/variableView` setting.
 
 	QHash<QString, QAction*> mActions;
 	QToolBar *mMainToolBar;
@@ -0,0 +1,51 @@
+#include "StateVariableDelegate.h"
+#include "StateVariableModel.h"
+#include <QSlider>
+#include <QSpinBox>
+#include <QRegExp>
+
+using namespace qcGui;
+
+StateVariableDelegate::StateVariableDelegate( QObject *parent ) :
+	QStyledItemDelegate(parent)
+{
+}
+
+QWidget *StateVariableDelegate::createEditor( QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index ) const
+{
+	QVariant::Type type = index.data( Qt::EditRole ).type();
+	if( index.column() != StateVariableModel::columnValue || ( type != QVariant::Int && type != QVariant::UInt ) )
+		{ return QStyledItemDelegate::createEditor( parent, option, index ); }
+
+	QString guiHint = index.data( StateVariableModel::guiHintRole ).toString();
+	if( guiHint.startsWith("slider") )
+	{
+		QPair<int,int> limits = QPair<int,int>( -65535, 65535 );
+		QRegExp limitRegexp("slider\\[(-?\\d+),(-?\\d+)\\]");
+		if( limitRegexp.indexIn( guiHint ) != -1 )
+		{
+			if( !limitRegexp.cap(1).isEmpty() )
+				{ limits.first = limitRegexp.cap(1).toInt(); }
+			if( !limitRegexp.cap(2).isEmpty() )
+				{ limits.second = limitRegexp.cap(2).toInt(); }
+		}
+
+		QSlider *slider = new QSlider( Qt::Horizontal, parent );
+		slider->setMinimum( type == QVariant::Int ? limits.first : 0 );
+		slider->setMaximum( limits.second );
+		slider->setSingleStep(5);
+		slider->setPageStep(20);
+		connect( slider, SIGNAL(valueChanged(int)), this, SLOT(commitSlider()) );
+		return slider;
+	}
+
+	QSpinBox *spinBox = new QSpinBox( parent );
+	spinBox->setMinimum( type == QVariant::Int ? -65535 : 0 );
+	spinBox->setMaximum( 65535 );
+	return spinBox;
+}
+
+void StateVariableDelegate::commitSlider()
+{
+	emit commitData( (QWidget*)sender() );
+}
@@ -0,0 +1,28 @@
+#ifndef STATEVARIABLEDELEGATE_H
+#define STATEVARIABLEDELEGATE_H
+
+#include <QStyledItemDelegate>
+
+namespace qcGui
+{
+
+/** Item delegate for the value column of StateVariableModel.
+  *	The editor is only created while a value is edited. Integer variables get a spin box, or a slider if the guiHint of the variable is `slider[min,max]`,
+  *	the same as the widgets of StateVariablesView. Other types use the default editors.*/
+class StateVariableDelegate : public QStyledItemDelegate
+{
+	Q_OBJECT
+public:
+	explicit StateVariableDelegate( QObject *parent = 0 );
+
+	/// Re-implement QStyledItemDelegate::createEditor().
+	QWidget *createEditor( QWidget *parent, const QStyleOptionViewItem &option, const QModelIndex &index ) const;
+
+private slots:
+
+	/// Commit the value of the sender slider while it is dragged (the sets are throttled by ClientSetCoalescer).
+	void commitSlider();
+};
+
+}	//qcGui::
+#endif // STATEVARIABLEDELEGATE_H
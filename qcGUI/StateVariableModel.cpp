@@ -0,0 +1,182 @@
+#include "StateVariableModel.h"
+
+using namespace qcGui;
+using namespace QtuC;
+
+StateVariableModel::StateVariableModel( int frameIntervalMs, QObject *parent ) :
+	QAbstractTableModel(parent)
+{
+	mInsertTimer = new QTimer(this);
+	mInsertTimer->setSingleShot( true );
+	mInsertTimer->setInterval( 0 );
+	connect( mInsertTimer, SIGNAL(timeout()), this, SLOT(insertPending()) );
+
+	mFrameTimer = new QTimer(this);
+	mFrameTimer->setSingleShot( true );
+	mFrameTimer->setInterval( qMax( frameIntervalMs, 0 ) );
+	connect( mFrameTimer, SIGNAL(timeout()), this, SLOT(emitDirty()) );
+}
+
+int StateVariableModel::rowCount( const QModelIndex &parent ) const
+{
+	return parent.isValid() ? 0 : mVars.size();
+}
+
+int StateVariableModel::columnCount( const QModelIndex &parent ) const
+{
+	return parent.isValid() ? 0 : columnEnd;
+}
+
+QVariant StateVariableModel::data( const QModelIndex &index, int role ) const
+{
+	DeviceStateVariableBase *var = getVariable( index.row() );
+	if( !var )
+		{ return QVariant(); }
+
+	switch( role )
+	{
+		case Qt::DisplayRole:
+			switch( index.column() )
+			{
+				case columnInterface: return var->getHwInterface();
+				case columnName: return var->getName();
+				case columnValue: return var->getValue().toString();
+				case columnAccess:
+					switch( var->getAccessMode() )
+					{
+						case DeviceStateVariableBase::readAccess: return QString("r");
+						case DeviceStateVariableBase::writeAccess: return QString("w");
+						case DeviceStateVariableBase::readWriteAccess: return QString("rw");
+						default: return QString();
+					}
+			}
+			break;
+		case Qt::EditRole:
+			if( index.column() == columnValue )
+			{
+				// a null value would give the editor no type
+				QVariant value = var->getValue();
+				if( value.isNull() )
+					{ value = QVariant( var->getType() ); }
+				return value;
+			}
+			return data( index, Qt::DisplayRole );
+		case Qt::ToolTipRole:
+			return QString("%1:%2 (%3)").arg( var->getHwInterface(), var->getName(), QString(QVariant::typeToName(var->getType())) );
+		case guiHintRole:
+			return mGuiHints.at( index.row() );
+		case searchRole:
+			return var->getHwInterface() + ' ' + var->getName();
+		case variableRole:
+			return QVariant::fromValue( (QObject*)var );
+	}
+	return QVariant();
+}
+
+bool StateVariableModel::setData( const QModelIndex &index, const QVariant &value, int role )
+{
+	DeviceStateVariableBase *var = getVariable( index.row() );
+	if( !var || role != Qt::EditRole || index.column() != columnValue || !( var->getAccessMode() & DeviceStateVariableBase::writeAccess ) )
+		{ return false; }
+
+	QVariant newValue( value );
+	if( !newValue.convert( var->getType() ) )
+		{ return false; }
+	if( !var->setValue( newValue ) )
+		{ return false; }
+	emit dataChanged( index, index );
+	return true;
+}
+
+QVariant StateVariableModel::headerData( int section, Qt::Orientation orientation, int role ) const
+{
+	if( orientation != Qt::Horizontal || role != Qt::DisplayRole )
+		{ return QAbstractTableModel::headerData( section, orientation, role ); }
+	switch( section )
+	{
+		case columnInterface: return tr("interface");
+		case columnName: return tr("name");
+		case columnValue: return tr("value");
+		case columnAccess: return tr("access");
+	}
+	return QVariant();
+}
+
+Qt::ItemFlags StateVariableModel::flags( const QModelIndex &index ) const
+{
+	Qt::ItemFlags itemFlags = QAbstractTableModel::flags( index );
+	DeviceStateVariableBase *var = getVariable( index.row() );
+	if( var && index.column() == columnValue && ( var->getAccessMode() & DeviceStateVariableBase::writeAccess ) )
+		{ itemFlags |= Qt::ItemIsEditable; }
+	return itemFlags;
+}
+
+void StateVariableModel::addVariable( DeviceStateVariableBase *var, const QString &guiHint )
+{
+	mPendingVars.append( var );
+	mPendingGuiHints.append( guiHint );
+	if( !mInsertTimer->isActive() )
+		{ mInsertTimer->start(); }
+}
+
+void StateVariableModel::insertPending()
+{
+	if( mPendingVars.isEmpty() )
+		{ return; }
+
+	beginInsertRows( QModelIndex(), mVars.size(), mVars.size() + mPendingVars.size() - 1 );
+	for( int i=0; i<mPendingVars.size(); ++i )
+	{
+		mRows.insert( mPendingVars.at(i), mVars.size() );
+		mVars.append( mPendingVars.at(i) );
+		mGuiHints.append( mPendingGuiHints.at(i) );
+		connect( mPendingVars.at(i), SIGNAL(updated()), this, SLOT(markDirty()) );
+	}
+	mPendingVars.clear();
+	mPendingGuiHints.clear();
+	endInsertRows();
+}
+
+void StateVariableModel::clear()
+{
+	mInsertTimer->stop();
+	mFrameTimer->stop();
+	beginResetModel();
+	for( int i=0; i<mVars.size(); ++i )
+		{ disconnect( mVars.at(i), 0, this, 0 ); }
+	mVars.clear();
+	mGuiHints.clear();
+	mRows.clear();
+	mPendingVars.clear();
+	mPendingGuiHints.clear();
+	mDirtyRows.clear();
+	endResetModel();
+}
+
+void StateVariableModel::markDirty()
+{
+	QHash<const DeviceStateVariableBase*,int>::const_iterator row = mRows.constFind( (const DeviceStateVariableBase*)sender() );
+	if( row == mRows.constEnd() )
+		{ return; }
+	mDirtyRows.insert( row.value() );
+	if( !mFrameTimer->isActive() )
+		{ mFrameTimer->start(); }
+}
+
+void StateVariableModel::emitDirty()
+{
+	if( mDirtyRows.isEmpty() )
+		{ return; }
+
+	// one signal for the whole range, the view only repaints the visible part of it
+	int first = mVars.size();
+	int last = -1;
+	QSet<int>::const_iterator row = mDirtyRows.constBegin();
+	for( ; row != mDirtyRows.constEnd(); ++row )
+	{
+		first = qMin( first, *row );
+		last = qMax( last, *row );
+	}
+	mDirtyRows.clear();
+	emit dataChanged( index( first, columnValue ), index( last, columnValue ) );
+}
@@ -0,0 +1,96 @@
+#ifndef STATEVARIABLEMODEL_H
+#define STATEVARIABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+#include "DeviceStateVariableBase.h"
+
+namespace qcGui
+{
+
+/** Table model of the device state variables, one row for each variable.
+  *	Used by StateVariableTableView instead of a widget for every variable, so the view only paints (and creates editors for) the visible rows.
+  *	The new variables are inserted in one batch when the event loop is free, the updated values are signalled with one dataChanged() per display frame (`gui/frameIntervalMs` setting).
+  *	The value of a variable with write access can be edited, the new value is set in the variable (which sends it to the proxy).*/
+class StateVariableModel : public QAbstractTableModel
+{
+	Q_OBJECT
+public:
+
+	/// Columns of the model.
+	enum column_t
+	{
+		columnInterface,
+		columnName,
+		columnValue,
+		columnAccess,
+		columnEnd
+	};
+
+	/// Custom data roles.
+	enum role_t
+	{
+		guiHintRole = Qt::UserRole,	///< The guiHint of the variable from the deviceAPI (QString), for the delegate.
+		searchRole,				///< `interface name` of the variable (QString), for filtering.
+		variableRole			///< The variable (QObject pointer).
+	};
+
+	/** Create.
+	  *	@param frameIntervalMs Interval of the value updates in milliseconds.
+	  *	@param parent Parent object.*/
+	explicit StateVariableModel( int frameIntervalMs, QObject *parent = 0 );
+
+	/** Get the variable in a row.
+	  *	@param row The row.
+	  *	@return The variable, or 0 if the row is invalid.*/
+	QtuC::DeviceStateVariableBase *getVariable( int row ) const
+		{ return ( row >= 0 && row < mVars.size() ) ? mVars.at(row) : 0; }
+
+	/// @name Inherited methods from QAbstractTableModel.
+	/// @{
+	int rowCount( const QModelIndex &parent = QModelIndex() ) const;
+	int columnCount( const QModelIndex &parent = QModelIndex() ) const;
+	QVariant data( const QModelIndex &index, int role = Qt::DisplayRole ) const;
+	bool setData( const QModelIndex &index, const QVariant &value, int role = Qt::EditRole );
+	QVariant headerData( int section, Qt::Orientation orientation, int role = Qt::DisplayRole ) const;
+	Qt::ItemFlags flags( const QModelIndex &index ) const;
+	/// @}
+
+public slots:
+
+	/** Add a variable.
+	  *	The row is inserted when the event loop is free, together with the other new variables.
+	  *	@param var The variable.
+	  *	@param guiHint The guiHint of the variable from the deviceAPI.*/
+	void addVariable( QtuC::DeviceStateVariableBase *var, const QString &guiHint );
+
+	/// Remove all variables (before the variables are destroyed).
+	void clear();
+
+private slots:
+
+	/// Insert the added variables.
+	void insertPending();
+
+	/// Mark the row of the sender variable changed.
+	void markDirty();
+
+	/// Signal the changed rows with dataChanged().
+	void emitDirty();
+
+private:
+	QList<QtuC::DeviceStateVariableBase*> mVars;	///< The variables by row.
+	QStringList mGuiHints;		///< The guiHints by row.
+	QHash<const QtuC::DeviceStateVariableBase*,int> mRows;	///< The rows of the variables.
+	QList<QtuC::DeviceStateVariableBase*> mPendingVars;	///< Added, but not yet inserted variables.
+	QStringList mPendingGuiHints;
+	QSet<int> mDirtyRows;		///< Rows with a value changed since the last frame.
+	QTimer *mInsertTimer;
+	QTimer *mFrameTimer;
+};
+
+}	//qcGui::
+#endif // STATEVARIABLEMODEL_H
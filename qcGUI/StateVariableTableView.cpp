@@ -0,0 +1,115 @@
+#include "StateVariableTableView.h"
+#include "StateVariableDelegate.h"
+#include "GuiSettingsManager.h"
+#include "ErrorHandlerBase.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QPushButton>
+#include <QLabel>
+
+using namespace qcGui;
+
+StateVariableTableView::StateVariableTableView( QWidget *parent ) :
+	QWidget(parent),
+	mModel(0)
+{
+	mVariableModel = new StateVariableModel( GuiSettingsManager::instance()->value("gui/frameIntervalMs").toInt(), this );
+
+	// only the name columns are searched, and the filter is not re-evaluated on every value update
+	mFilterModel = new QSortFilterProxyModel(this);
+	mFilterModel->setSourceModel( mVariableModel );
+	mFilterModel->setFilterRole( StateVariableModel::searchRole );
+	mFilterModel->setFilterKeyColumn( StateVariableModel::columnInterface );
+	mFilterModel->setFilterCaseSensitivity( Qt::CaseInsensitive );
+	mFilterModel->setDynamicSortFilter( false );
+
+	mTable = new QTableView(this);
+	mTable->setModel( mFilterModel );
+	mTable->setItemDelegateForColumn( StateVariableModel::columnValue, new StateVariableDelegate(mTable) );
+	mTable->setSortingEnabled( true );
+	mTable->setSelectionBehavior( QAbstractItemView::SelectRows );
+	mTable->setEditTriggers( QAbstractItemView::DoubleClicked | QAbstractItemView::EditKeyPressed | QAbstractItemView::SelectedClicked );
+	// fixed row height, so the view never measures the rows
+	mTable->verticalHeader()->setResizeMode( QHeaderView::Fixed );
+	mTable->verticalHeader()->setDefaultSectionSize( mTable->fontMetrics().height() + 6 );
+	mTable->verticalHeader()->hide();
+	mTable->horizontalHeader()->setStretchLastSection( true );
+	mTable->setColumnWidth( StateVariableModel::columnValue, 200 );
+
+	mSearchEdit = new QLineEdit(this);
+	mSearchEdit->setPlaceholderText( tr("search (interface or name, wildcards allowed)") );
+	connect( mSearchEdit, SIGNAL(textChanged(QString)), this, SLOT(setFilter(QString)) );
+
+	mFunctionBox = new QComboBox(this);
+	mFunctionBox->setMinimumContentsLength( 20 );
+	QPushButton *callButton = new QPushButton( tr("call"), this );
+	connect( callButton, SIGNAL(clicked()), this, SLOT(callButtonClicked()) );
+
+	QHBoxLayout *toolLayout = new QHBoxLayout();
+	toolLayout->addWidget( mSearchEdit, 1 );
+	toolLayout->addWidget( new QLabel( tr("function:"), this ) );
+	toolLayout->addWidget( mFunctionBox );
+	toolLayout->addWidget( callButton );
+
+	QVBoxLayout *layout = new QVBoxLayout();
+	layout->addLayout( toolLayout );
+	layout->addWidget( mTable );
+	setLayout( layout );
+}
+
+bool StateVariableTableView::setModel( QcGui *model )
+{
+	if( !mModel )
+	{
+		mModel = model;
+		return true;
+	}
+	else
+	{
+		QtuC::ErrorHandlerBase::error( QtWarningMsg, "Model is already set", "setModel()", "StateVariableTableView" );
+		return false;
+	}
+}
+
+void StateVariableTableView::showVariable( QtuC::DeviceStateVariableBase *newVar, const QString &guiHint )
+{
+	mVariableModel->addVariable( newVar, guiHint );
+}
+
+void StateVariableTableView::showFunction( const QString &hwInterface, const QString &name )
+{
+	QStringList function;
+	function << hwInterface << name;
+	mFunctionBox->addItem( hwInterface + ':' + name, function );
+}
+
+void StateVariableTableView::clearApiGui()
+{
+	mVariableModel->clear();
+	mFunctionBox->clear();
+}
+
+void StateVariableTableView::setFilter( const QString &pattern )
+{
+	mFilterModel->setFilterWildcard( pattern );
+}
+
+void StateVariableTableView::callButtonClicked()
+{
+	if( !mModel )
+	{
+		QtuC::ErrorHandlerBase::error( QtWarningMsg, "No model set, cannot call function", "callButtonClicked()", "StateVariableTableView()" );
+		return;
+	}
+	QStringList function = mFunctionBox->itemData( mFunctionBox->currentIndex() ).toStringList();
+	if( function.size() != 2 )
+		{ return; }
+	if( !mModel->callDeviceFunction( function.at(0), function.at(1) ) )
+	{
+		QtuC::ErrorHandlerBase::errorDetails_t errDet;
+		errDet.insert( "hwInterface", function.at(0) );
+		errDet.insert( "name", function.at(1) );
+		QtuC::ErrorHandlerBase::error( QtWarningMsg, "Function call failed", "callButtonClicked()", "StateVariableTableView()", errDet );
+	}
+}
@@ -0,0 +1,69 @@
+#ifndef STATEVARIABLETABLEVIEW_H
+#define STATEVARIABLETABLEVIEW_H
+
+#include <QWidget>
+#include <QTableView>
+#include <QLineEdit>
+#include <QComboBox>
+#include <QSortFilterProxyModel>
+#include "DeviceStateVariableBase.h"
+#include "StateVariableModel.h"
+#include "QcGui.h"
+
+namespace qcGui
+{
+
+/** Table view of the device variables, for large deviceAPIs.
+  *	The same slots as StateVariablesView, but the variables are rows of a StateVariableModel in a QTableView, instead of a widget for each variable,
+  *	so building and updating the view scales to tens of thousands of variables. Select it with the `gui/variableView` setting (`table`).
+  *	The search field filters the rows by interface and variable name (wildcards can be used), the columns can be sorted.
+  *	The functions are listed in a combo box, with a button to call the selected one.*/
+class StateVariableTableView : public QWidget
+{
+	Q_OBJECT
+
+public:
+	explicit StateVariableTableView( QWidget *parent = 0 );
+
+public slots:
+
+	/** Set model pointer,
+	  *	Set the model and do the necessary initializations (eg. connect())
+	  *	@param model The model pointer to set.
+	  *	@return True on success, false otherwise.*/
+	bool setModel( QcGui *model );
+
+	/** Show variable on the GUI.
+	  *	@param newVar The variable to show.
+	  *	@param guiHint The guiHint of the variable from the deviceAPI.*/
+	void showVariable( QtuC::DeviceStateVariableBase *newVar, const QString &guiHint );
+
+	/** Show function on the GUI.
+	  *	@param hwInterface The hardware interface of the function.
+	  *	@param name The name of the function.*/
+	void showFunction( const QString &hwInterface, const QString &name );
+
+	/** Clear GUI.
+	  *	Remove all variables and functions.*/
+	void clearApiGui();
+
+private slots:
+
+	/** Filter the rows.
+	  *	@param pattern Wildcard pattern matched against `interface name`.*/
+	void setFilter( const QString &pattern );
+
+	/// Call the function selected in the function combo box.
+	void callButtonClicked();
+
+private:
+	QcGui *mModel;		///< Model for this view.
+	StateVariableModel *mVariableModel;
+	QSortFilterProxyModel *mFilterModel;
+	QTableView *mTable;
+	QLineEdit *mSearchEdit;
+	QComboBox *mFunctionBox;
+};
+
+}	//qcGui::
+#endif // STATEVARIABLETABLEVIEW_H
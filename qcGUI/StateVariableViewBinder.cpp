@@ -0,0 +1,187 @@
+#include "StateVariableViewBinder.h"
+#include "LatencyMonitor.h"
+#include <QEvent>
+
+using namespace qcGui;
+using namespace QtuC;
+
+StateVariableViewBinder::StateVariableViewBinder( int frameIntervalMs, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mAppliedCount(0),
+	mMergedCount(0),
+	mSkippedCount(0),
+	mReportedAppliedCount(0)
+{
+	mFrameTimer = new QTimer(this);
+	mFrameTimer->setSingleShot( true );
+	mFrameTimer->setInterval( qMax( frameIntervalMs, 0 ) );
+	connect( mFrameTimer, SIGNAL(timeout()), this, SLOT(applyFrame()) );
+
+	mReportTimer = new QTimer(this);
+	connect( mReportTimer, SIGNAL(timeout()), this, SLOT(printReport()) );
+}
+
+void StateVariableViewBinder::bind( const DeviceStateVariableBase *var, QWidget *widget, const char *slot, QVariant::Type argType )
+{
+	if( !mBindings.contains( var ) )
+	{
+		connect( var, SIGNAL(updated()), this, SLOT(markDirty()) );
+		connect( var, SIGNAL(destroyed(QObject*)), this, SLOT(unbind(QObject*)) );
+	}
+
+	binding_t binding;
+	binding.widget = widget;
+	binding.slot = slot;
+	binding.argType = argType;
+	mBindings[var].append( binding );
+
+	mWidgetVars.insert( widget, var );
+	connect( widget, SIGNAL(destroyed(QObject*)), this, SLOT(unbind(QObject*)) );
+	widget->installEventFilter( this );
+}
+
+void StateVariableViewBinder::traceUpdate( const DeviceStateVariableBase *var, const LatencyTrace &trace )
+{
+	if( mDirty.contains( var ) )
+		{ mPendingTraces.insert( var, trace ); }
+	else
+	{
+		LatencyTrace renderTrace( trace );
+		renderTrace.stamp( LatencyTrace::traceStageRender );
+		LatencyMonitor::instance()->record( renderTrace );
+	}
+}
+
+void StateVariableViewBinder::setReportInterval( int intervalMs )
+{
+	if( intervalMs > 0 )
+		{ mReportTimer->start( intervalMs ); }
+	else
+		{ mReportTimer->stop(); }
+}
+
+bool StateVariableViewBinder::eventFilter( QObject *watched, QEvent *event )
+{
+	if( event->type() == QEvent::Show )
+	{
+		const DeviceStateVariableBase *var = mWidgetVars.value( watched, 0 );
+		const QList<binding_t> bindingList = mBindings.value( var );
+		for( int i=0; i<bindingList.size(); ++i )
+		{
+			if( bindingList.at(i).widget == watched )
+				{ apply( var, bindingList.at(i) ); }
+		}
+	}
+	return false;
+}
+
+void StateVariableViewBinder::markDirty()
+{
+	const DeviceStateVariableBase *var = (const DeviceStateVariableBase*)sender();
+	if( mDirty.contains( var ) )
+	{
+		++mMergedCount;
+		// the merged update is not shown, only the last one
+		mPendingTraces.remove( var );
+		return;
+	}
+	mDirty.insert( var );
+	if( !mFrameTimer->isActive() )
+		{ mFrameTimer->start(); }
+}
+
+void StateVariableViewBinder::applyFrame()
+{
+	QSet<const DeviceStateVariableBase*>::const_iterator var = mDirty.constBegin();
+	for( ; var != mDirty.constEnd(); ++var )
+	{
+		const QList<binding_t> &bindingList = mBindings[*var];
+		for( int i=0; i<bindingList.size(); ++i )
+		{
+			if( !bindingList.at(i).widget )
+				{ continue; }
+			if( bindingList.at(i).widget->isVisible() )
+				{ apply( *var, bindingList.at(i) ); }
+			else
+				{ ++mSkippedCount; }
+		}
+		++mAppliedCount;
+	}
+	mDirty.clear();
+
+	QHash<const DeviceStateVariableBase*, LatencyTrace>::iterator trace = mPendingTraces.begin();
+	for( ; trace != mPendingTraces.end(); ++trace )
+	{
+		trace->stamp( LatencyTrace::traceStageRender );
+		LatencyMonitor::instance()->record( *trace );
+	}
+	mPendingTraces.clear();
+}
+
+void StateVariableViewBinder::apply( const DeviceStateVariableBase *var, const binding_t &binding )
+{
+	QVariant value = var->getValue();
+	bool ok = true;
+	switch( binding.argType )
+	{
+		case QVariant::String:
+			ok = QMetaObject::invokeMethod( binding.widget, binding.slot.constData(), Q_ARG(QString, value.toString()) );
+			break;
+		case QVariant::Int:
+			ok = QMetaObject::invokeMethod( binding.widget, binding.slot.constData(), Q_ARG(int, value.toInt()) );
+			break;
+		case QVariant::UInt:
+			ok = QMetaObject::invokeMethod( binding.widget, binding.slot.constData(), Q_ARG(uint, value.toUInt()) );
+			break;
+		case QVariant::Double:
+			ok = QMetaObject::invokeMethod( binding.widget, binding.slot.constData(), Q_ARG(double, value.toDouble()) );
+			break;
+		case QVariant::Bool:
+			ok = QMetaObject::invokeMethod( binding.widget, binding.slot.constData(), Q_ARG(bool, value.toBool()) );
+			break;
+		default:
+			ok = false;
+	}
+	if( !ok )
+		{ error( QtWarningMsg, QString("Failed to update widget of variable %1:%2 with %3()").arg( var->getHwInterface(), var->getName(), QString(binding.slot) ), "apply()" ); }
+}
+
+void StateVariableViewBinder::unbind( QObject *obj )
+{
+	// the object is being destroyed, only its address is used
+	if( mWidgetVars.contains( obj ) )
+	{
+		const DeviceStateVariableBase *var = mWidgetVars.take( obj );
+		QHash<const DeviceStateVariableBase*, QList<binding_t> >::iterator bindingList = mBindings.find( var );
+		if( bindingList != mBindings.end() )
+		{
+			for( int i=bindingList->size()-1; i>=0; --i )
+			{
+				if( !bindingList->at(i).widget || bindingList->at(i).widget == obj )
+					{ bindingList->removeAt(i); }
+			}
+		}
+		return;
+	}
+
+	const DeviceStateVariableBase *var = (const DeviceStateVariableBase*)obj;
+	const QList<binding_t> bindingList = mBindings.take( var );
+	for( int i=0; i<bindingList.size(); ++i )
+	{
+		if( bindingList.at(i).widget )
+		{
+			mWidgetVars.remove( bindingList.at(i).widget );
+			bindingList.at(i).widget->removeEventFilter( this );
+		}
+	}
+	mDirty.remove( var );
+	mPendingTraces.remove( var );
+}
+
+void StateVariableViewBinder::printReport()
+{
+	if( mAppliedCount == mReportedAppliedCount )
+		{ return; }
+	mReportedAppliedCount = mAppliedCount;
+	debug( debugLevelInfo, QString("Widget updates: %1 applied, %2 merged, %3 skipped (hidden)").arg( QString::number(mAppliedCount), QString::number(mMergedCount), QString::number(mSkippedCount) ), "printReport()" );
+}
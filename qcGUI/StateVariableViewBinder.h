@@ -0,0 +1,112 @@
+#ifndef STATEVARIABLEVIEWBINDER_H
+#define STATEVARIABLEVIEWBINDER_H
+
+#include "ErrorHandlerBase.h"
+#include "DeviceStateVariableBase.h"
+#include "LatencyTrace.h"
+#include <QWidget>
+#include <QPointer>
+#include <QHash>
+#include <QSet>
+#include <QTimer>
+
+namespace qcGui
+{
+
+/** Update the widgets of the state variables once per display frame.
+  *	Connecting the valueChanged() signals of a variable directly to its widgets repaints them on every update, which saturates the GUI thread at high feed rates.
+  *	A bound variable is only marked dirty when updated, and its latest value is applied to its widgets when the frame timer (`gui/frameIntervalMs` setting) fires.
+  *	Several updates of a variable in one frame are merged, only the last value is shown.
+  *	A hidden widget is skipped, it gets the latest value when it is shown again.
+  *	The number of applied, merged and skipped updates is printed periodically (as info debug message, `gui/updateReportIntervalMs` setting), if there are new updates.*/
+class StateVariableViewBinder : public QtuC::ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Create.
+	  *	@param frameIntervalMs Interval of the frame timer in milliseconds, 0 applies the updates as soon as the event loop is free.
+	  *	@param parent Parent object.*/
+	explicit StateVariableViewBinder( int frameIntervalMs, QObject *parent = 0 );
+
+	/** Bind a widget to a variable.
+	  *	The slot is called with the value of the variable converted to argType, when the variable is updated from the source.
+	  *	The binding is removed when the variable or the widget is destroyed.
+	  *	@param var The variable.
+	  *	@param widget The widget.
+	  *	@param slot Name of the slot of the widget, without the signature (e.g. "setText").
+	  *	@param argType Type of the slot argument: QVariant::String, Int, UInt, Double or Bool.*/
+	void bind( const QtuC::DeviceStateVariableBase *var, QWidget *widget, const char *slot, QVariant::Type argType );
+
+	/** Record the latency trace of an update when the update is shown.
+	  *	The render stage is stamped when the value is applied to the widgets, then the trace is recorded in LatencyMonitor.
+	  *	If the variable has no widget, the trace is recorded at once.
+	  *	@param var The updated variable.
+	  *	@param trace The trace of the update.*/
+	void traceUpdate( const QtuC::DeviceStateVariableBase *var, const QtuC::LatencyTrace &trace );
+
+	/** Set the interval of the periodic report.
+	  *	@param intervalMs Report interval in milliseconds, 0 disables the periodic report.*/
+	void setReportInterval( int intervalMs );
+
+	/// Get the number of variable updates applied to the widgets.
+	quint64 getAppliedCount() const
+		{ return mAppliedCount; }
+
+	/// Get the number of variable updates merged into a later one in the same frame.
+	quint64 getMergedCount() const
+		{ return mMergedCount; }
+
+	/// Get the number of widget updates skipped because the widget was hidden.
+	quint64 getSkippedCount() const
+		{ return mSkippedCount; }
+
+protected:
+
+	/// Re-implement QObject::eventFilter(), apply the latest value to a bound widget when it is shown.
+	bool eventFilter( QObject *watched, QEvent *event );
+
+private slots:
+
+	/// Mark the sender variable dirty, and start the frame timer.
+	void markDirty();
+
+	/// Apply the latest values of the dirty variables to their visible widgets.
+	void applyFrame();
+
+	/** Remove the bindings of a destroyed variable or widget.
+	  *	@param obj The destroyed object.*/
+	void unbind( QObject *obj );
+
+	/// Print the update counts, if there are new updates since the last report.
+	void printReport();
+
+private:
+
+	/// A widget bound to a variable.
+	struct binding_t
+	{
+		QPointer<QWidget> widget;
+		QByteArray slot;
+		QVariant::Type argType;
+	};
+
+	/** Apply the value of a variable to a widget.
+	  *	@param var The variable.
+	  *	@param binding The binding of the widget.*/
+	void apply( const QtuC::DeviceStateVariableBase *var, const binding_t &binding );
+
+	QHash<const QtuC::DeviceStateVariableBase*, QList<binding_t> > mBindings;	///< The widgets of the variables.
+	QHash<QObject*, const QtuC::DeviceStateVariableBase*> mWidgetVars;	///< The variable of each bound widget.
+	QSet<const QtuC::DeviceStateVariableBase*> mDirty;	///< The variables updated since the last frame.
+	QHash<const QtuC::DeviceStateVariableBase*, QtuC::LatencyTrace> mPendingTraces;	///< Traces of the dirty variables, recorded when applied.
+	QTimer *mFrameTimer;
+	QTimer *mReportTimer;
+	quint64 mAppliedCount;
+	quint64 mMergedCount;
+	quint64 mSkippedCount;
+	quint64 mReportedAppliedCount;
+};
+
+}	//qcGui::
+#endif // STATEVARIABLEVIEWBINDER_H
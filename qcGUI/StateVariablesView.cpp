@@ -128,7 +128,7 @@ QWidget *StateVariablesView::createVariableWidget(const DeviceStateVariableBase
 			if( var->getAccessMode() == DeviceStateVariableBase::readAccess )
 			{
 				lineEdit->setDisabled(true);
-				connect( var, SIGNAL(valueChanged(QString)), lineEdit, SLOT(setText(QString)) );
+				bindWidget( var, lineEdit, "setText", QVariant::String );
 			}
 			else if( var->getAccessMode() == DeviceStateVariableBase::writeAccess )
 				{ connect( lineEdit, SIGNAL(textEdited(QString)), var, SLOT(setValue(QString)) ); }
@@ -142,7 +142,7 @@ QWidget *StateVariablesView::createVariableWidget(const DeviceStateVariableBase
 			if( var->getAccessMode() == DeviceStateVariableBase::readAccess )
 			{
 				checkBox->setDisabled(true);
-				connect( var, SIGNAL(valueChanged(bool)), checkBox, SLOT(setChecked(bool)) );
+				bindWidget( var, checkBox, "setChecked", QVariant::Bool );
 			}
 			else if( var->getAccessMode() == DeviceStateVariableBase::writeAccess )
 				{ connect( checkBox, SIGNAL(clicked(bool)), var, SLOT(setValue(bool)) ); }
@@ -180,7 +180,7 @@ QWidget *StateVariablesView::createVariableWidget(const DeviceStateVariableBase
 				if( var->getAccessMode() == DeviceStateVariableBase::readAccess )
 				{
 					slider->setDisabled(true);
-					connect( var, SIGNAL(valueChanged(int)), slider, SLOT(setValue(int)) );
+					bindWidget( var, slider, "setValue", QVariant::Int );
 				}
 				else if( var->getAccessMode() == DeviceStateVariableBase::writeAccess )
 					{ connect( slider, SIGNAL(valueChanged(int)), var, SLOT(setValue(int)) ); }
@@ -198,7 +198,7 @@ QWidget *StateVariablesView::createVariableWidget(const DeviceStateVariableBase
 				if( var->getAccessMode() == DeviceStateVariableBase::readAccess )
 				{
 					spinBox->setDisabled(true);
-					connect( var, SIGNAL(valueChanged(int)), spinBox, SLOT(setValue(int)) );
+					bindWidget( var, spinBox, "setValue", QVariant::Int );
 				}
 				else if( var->getAccessMode() == DeviceStateVariableBase::writeAccess )
 					{ connect( spinBox, SIGNAL(valueEdited(int)), var, SLOT(setValue(int)) ); }
@@ -220,7 +220,7 @@ QWidget *StateVariablesView::createCustomVariableWidget(const DeviceStateVariabl
 		lineBitsView->setBValue( var->getValue().toUInt() );
 
 		//lineBitsView->setDisabled(true);
-		connect( var, SIGNAL(valueChanged(uint)), lineBitsView, SLOT(setBValue(uint)) );
+		bindWidget( var, lineBitsView, "setBValue", QVariant::UInt );
 
 		return lineBitsView;
 	}
@@ -228,6 +228,14 @@ QWidget *StateVariablesView::createCustomVariableWidget(const DeviceStateVariabl
 		return 0;
 }
 
+void StateVariablesView::bindWidget( const DeviceStateVariableBase *var, QWidget *widget, const char *slot, QVariant::Type argType )
+{
+	if( mModel )
+		{ mModel->getViewBinder()->bind( var, widget, slot, argType ); }
+	else
+		{ QtuC::ErrorHandlerBase::error( QtWarningMsg, QString("No model set, widget of %1 is not updated").arg(var->getName()), "bindWidget()", "StateVariablesView()" ); }
+}
+
 void StateVariablesView::clearApiGui()
 {
 	for( int i=0; i<mHwInterfaceGroups.size(); ++i )
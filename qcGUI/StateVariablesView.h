@@ -67,6 +67,13 @@ private:
 	/// @todo do this nicer
 	QWidget *createCustomVariableWidget( const QtuC::DeviceStateVariableBase *var );
 
+	/** Update a read-only widget from the variable, through the StateVariableViewBinder of the model (once per display frame).
+	  *	@param var The device state variable.
+	  *	@param widget The widget.
+	  *	@param slot Name of the widget slot to set the value, see StateVariableViewBinder::bind().
+	  *	@param argType Type of the slot argument.*/
+	void bindWidget( const QtuC::DeviceStateVariableBase *var, QWidget *widget, const char *slot, QVariant::Type argType );
+
 	QcGui *mModel;		///< Model for this view.
 	QGridLayout *mLayout;	///< Layout for StateVariablesView
 	QList<QGroupBox*> mHwInterfaceGroups;	///< List of the hardware interface groups.
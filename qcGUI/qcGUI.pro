@@ -18,7 +18,11 @@ SOURCES += main.cpp\
     StateVariablesView.cpp \
     StateVarIntView.cpp \
     StateVariableCustomViewBase.cpp \
-    StateVariableUlongBinView.cpp
+    StateVariableUlongBinView.cpp \
+    StateVariableViewBinder.cpp \
+    StateVariableModel.cpp \
+    StateVariableDelegate.cpp \
+    StateVariableTableView.cpp
 
 HEADERS  += \
     QcGui.h \
@@ -29,11 +33,17 @@ HEADERS  += \
     StateVariablesView.h \
     StateVarIntView.h \
     StateVariableCustomViewBase.h \
-    StateVariableUlongBinView.h
+    StateVariableUlongBinView.h \
+    StateVariableViewBinder.h \
+    StateVariableModel.h \
+    StateVariableDelegate.h \
+    StateVariableTableView.h
 
 win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/release/ -lqcCommon
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/debug/ -lqcCommon
 else:unix: LIBS += -L$$OUT_PWD/../qcCommon/ -lqcCommon
+# setsockopt() of ClientConnectionManagerBase
+win32: LIBS += -lws2_32
 
 INCLUDEPATH += $$PWD/../qcCommon
 INCLUDEPATH += $$PWD/../qcCommon/clientCommands
@@ -24,9 +24,9 @@ void DeviceStateHistoryVariable::clearHistory()
 	mTimestampLimits.first = mTimestampLimits.second = 0;
 }
 
-void DeviceStateHistoryVariable::updateFromSource(const QString &newValue)
+void DeviceStateHistoryVariable::updateFromSource( const QVariant &newValue, const qint64 &timestamp )
 {
-	DeviceStateVariableBase::updateFromSource( newValue );
+	DeviceStateVariableBase::updateFromSource( newValue, timestamp );
 	if( mLogHistory )
 		{ pushToHistory(); }
 }
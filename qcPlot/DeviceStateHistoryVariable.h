@@ -57,7 +57,7 @@ public:
 
 	/** @name Reimplemented from base.
 	*	@{*/
-	void updateFromSource( const QString& newValue );
+	void updateFromSource( const QVariant& newValue, qint64 const &timestamp = 0 );
 	void swapValue( const QVariant &newValue );
 	bool isValid() const;
 	/// @}
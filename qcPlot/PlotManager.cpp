@@ -43,3 +43,18 @@ bool PlotManager::loadXml(const QDomElement &layoutCfgElement)
 	}
 	return true;
 }
+
+QList<QPair<QString, QString> > PlotManager::getStateVariables() const
+{
+	QList<QPair<QString,QString> > varList;
+	for( int i=0; i<mPlotters.size(); ++i )
+	{
+		QList<CurveConfig*> curves = mPlotters.at(i)->cfg()->getCurves();
+		for( int c=0; c<curves.size(); ++c )
+		{
+			if( !varList.contains( curves.at(c)->stateVariable() ) )
+				{ varList.append( curves.at(c)->stateVariable() ); }
+		}
+	}
+	return varList;
+}
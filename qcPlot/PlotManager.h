@@ -22,6 +22,10 @@ public:
 
 	uint getPlotterCount() const
 		{ return mPlotters.size(); }
+
+	/** Get all state variables used by the curves of the plots.
+	  *	@return List of variables as hwInterface-name pairs, without duplicates.*/
+	QList<QPair<QString,QString> > getStateVariables() const;
 	
 signals:
 	void newPlotterAdded( Plotter* );
@@ -0,0 +1,51 @@
+#include "PlotRecordWriter.h"
+
+using namespace qcPlot;
+
+PlotRecordWriter::PlotRecordWriter( const QString &fileName, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mFile(fileName, this),
+	mPendingBlocks(0),
+	mBytesWritten(0)
+{
+}
+
+PlotRecordWriter::~PlotRecordWriter()
+{
+	close();
+}
+
+bool PlotRecordWriter::open()
+{
+	if( !mFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "file", mFile.fileName() );
+		errDet.insert( "error", mFile.errorString() );
+		error( QtCriticalMsg, "Failed to open record file", "open()", errDet );
+		return false;
+	}
+	return true;
+}
+
+void PlotRecordWriter::writeBlock( QByteArray block )
+{
+	if( mFile.isOpen() )
+	{
+		qint64 written = mFile.write( block );
+		if( written != block.size() )
+			{ error( QtWarningMsg, QString("Failed to write record block: %1").arg(mFile.errorString()), "writeBlock()" ); }
+		else
+			{ mBytesWritten += written; }
+	}
+	mPendingBlocks.deref();
+}
+
+void PlotRecordWriter::close()
+{
+	if( mFile.isOpen() )
+	{
+		mFile.flush();
+		mFile.close();
+	}
+}
@@ -0,0 +1,57 @@
+#ifndef PLOTRECORDWRITER_H
+#define PLOTRECORDWRITER_H
+
+#include "ErrorHandlerBase.h"
+#include <QFile>
+#include <QByteArray>
+#include <QAtomicInt>
+
+namespace qcPlot
+{
+
+/** Write serialized record blocks to a file.
+  *	This object is meant to live in its own thread, so the disk I/O won't block the reception and decoding of the samples.
+  *	Blocks are passed in with writeBlock() through a queued connection, the number of blocks waiting to be written is available from getPendingBlockCount().*/
+class PlotRecordWriter : public QtuC::ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+	explicit PlotRecordWriter( const QString &fileName, QObject *parent = 0 );
+
+	~PlotRecordWriter();
+
+	/** Get the number of blocks which are queued, but not yet written.
+	  *	Can be called from any thread.*/
+	int getPendingBlockCount() const
+		{ return (int)mPendingBlocks; }
+
+	/** Mark a block as queued.
+	  *	Call this from the producer thread before emitting the block towards writeBlock().*/
+	void blockQueued()
+		{ mPendingBlocks.ref(); }
+
+	/// Get the number of bytes written to the file so far.
+	qint64 getBytesWritten() const
+		{ return mBytesWritten; }
+
+public slots:
+
+	/** Open the output file.
+	  *	@return True on success, false otherwise.*/
+	bool open();
+
+	/** Write a block to the file.
+	  *	@param block The serialized block data.*/
+	void writeBlock( QByteArray block );
+
+	/// Flush and close the file.
+	void close();
+
+private:
+	QFile mFile;
+	QAtomicInt mPendingBlocks;	///< Blocks queued for writing but not yet written.
+	qint64 mBytesWritten;
+};
+
+}	//qcPlot::
+#endif // PLOTRECORDWRITER_H
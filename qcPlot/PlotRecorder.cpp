@@ -0,0 +1,202 @@
+#include "PlotRecorder.h"
+#include "PlotRecordWriter.h"
+#include "PlotSettingsManager.h"
+#include "ProxyStateManager.h"
+#include <QThread>
+#include <QTimer>
+#include <QDataStream>
+#include <QDateTime>
+
+using namespace qcPlot;
+
+const char PlotRecorder::mFileMagic[] = "QCREC";
+const quint8 PlotRecorder::mFileFormatVersion = 1;
+
+PlotRecorder::PlotRecorder( QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mWriterThread(0),
+	mWriter(0),
+	mFlushTimer(0),
+	mSampleCount(0),
+	mDroppedCount(0),
+	mStartTime(0)
+{
+	mBlockSize = PlotSettingsManager::instance()->value("recorder/blockSize").toInt();
+	if( mBlockSize <= 0 )
+		{ mBlockSize = 4096; }
+	mMaxPendingBlocks = PlotSettingsManager::instance()->value("recorder/maxPendingBlocks").toInt();
+	if( mMaxPendingBlocks <= 0 )
+		{ mMaxPendingBlocks = 256; }
+}
+
+PlotRecorder::~PlotRecorder()
+{
+	stop();
+}
+
+bool PlotRecorder::start( const QString &fileName )
+{
+	if( mWriter )
+	{
+		error( QtWarningMsg, "Recorder is already running", "start()" );
+		return false;
+	}
+
+	// resolve variables, the id of a column is its index in the variable list
+	for( int i=0; i<mVarNames.size(); ++i )
+	{
+		DeviceStateHistoryVariable *var = ProxyStateManager::instance()->getVar( mVarNames.at(i).first, mVarNames.at(i).second );
+		if( !var )
+		{
+			error( QtWarningMsg, QString("No such variable, skip recording it (hwI: %1, name: %2)").arg(mVarNames.at(i).first, mVarNames.at(i).second), "start()" );
+			continue;
+		}
+		if( mColumns.contains(var) )
+			{ continue; }
+
+		// history is useless here, and it would grow forever
+		var->setHistoryLog(false);
+
+		Column *col = new Column();
+		col->id = (quint16)i;
+		col->timestamps.reserve( mBlockSize );
+		col->values.reserve( mBlockSize );
+		mColumns.insert( var, col );
+	}
+
+	if( mColumns.isEmpty() )
+	{
+		error( QtCriticalMsg, "No variables to record", "start()" );
+		return false;
+	}
+
+	mWriter = new PlotRecordWriter( fileName );
+	if( !mWriter->open() )
+	{
+		delete mWriter;
+		mWriter = 0;
+		qDeleteAll( mColumns );
+		mColumns.clear();
+		return false;
+	}
+
+	mWriterThread = new QThread(this);
+	mWriter->moveToThread( mWriterThread );
+	connect( this, SIGNAL(blockReady(QByteArray)), mWriter, SLOT(writeBlock(QByteArray)), Qt::QueuedConnection );
+	mWriterThread->start();
+
+	// header
+	QByteArray header;
+	QDataStream headerStream( &header, QIODevice::WriteOnly );
+	headerStream.writeRawData( mFileMagic, sizeof(mFileMagic)-1 );
+	headerStream << mFileFormatVersion;
+	headerStream << DeviceStateHistoryVariable::getDeviceStartupTime();
+	headerStream << (quint16)mColumns.size();
+	QHash<const DeviceStateHistoryVariable*, Column*>::const_iterator colIt;
+	for( colIt = mColumns.constBegin(); colIt != mColumns.constEnd(); ++colIt )
+		{ headerStream << colIt.value()->id << colIt.key()->getHwInterface() << colIt.key()->getName(); }
+	mWriter->blockQueued();
+	emit blockReady( header );
+
+	mFlushTimer = new QTimer(this);
+	connect( mFlushTimer, SIGNAL(timeout()), this, SLOT(flush()) );
+	mFlushTimer->start( PlotSettingsManager::instance()->value("recorder/flushIntervalMs").toInt() );
+
+	mSampleCount = mDroppedCount = 0;
+	mStartTime = QDateTime::currentMSecsSinceEpoch();
+	debug( debugLevelInfo, QString("Recording %1 variables to %2").arg(QString::number(mColumns.size()), fileName), "start()" );
+	return true;
+}
+
+void PlotRecorder::record( const DeviceStateHistoryVariable *var, qint64 timestamp, const QString &value )
+{
+	Column *col = mColumns.value( var, 0 );
+	if( !col )
+		{ return; }
+
+	bool ok;
+	double dval = value.toDouble( &ok );
+	if( !ok )
+	{
+		error( QtWarningMsg, QString("Cannot convert sample to double: %1").arg(value), "record()" );
+		return;
+	}
+
+	col->timestamps.append( timestamp );
+	col->values.append( dval );
+	++mSampleCount;
+	if( col->values.size() >= mBlockSize )
+		{ flushColumn( col ); }
+}
+
+void PlotRecorder::stop()
+{
+	if( !mWriter )
+		{ return; }
+
+	mFlushTimer->stop();
+	flush();
+
+	// queued blocks are written first, as events are processed in order
+	QMetaObject::invokeMethod( mWriter, "close", Qt::BlockingQueuedConnection );
+	mWriterThread->quit();
+	mWriterThread->wait();
+
+	qint64 elapsedMs = QDateTime::currentMSecsSinceEpoch() - mStartTime;
+	errorDetails_t stats;
+	stats.insert( "samples", QString::number(mSampleCount) );
+	stats.insert( "dropped", QString::number(mDroppedCount) );
+	stats.insert( "bytes", QString::number(mWriter->getBytesWritten()) );
+	stats.insert( "samples/s", QString::number( elapsedMs > 0 ? (mSampleCount*1000)/elapsedMs : 0 ) );
+	debug( debugLevelInfo, "Recording stopped", "stop()", stats );
+
+	delete mWriter;
+	mWriter = 0;
+	delete mWriterThread;
+	mWriterThread = 0;
+	delete mFlushTimer;
+	mFlushTimer = 0;
+	qDeleteAll( mColumns );
+	mColumns.clear();
+}
+
+void PlotRecorder::flush()
+{
+	QHash<const DeviceStateHistoryVariable*, Column*>::iterator colIt;
+	for( colIt = mColumns.begin(); colIt != mColumns.end(); ++colIt )
+	{
+		if( !colIt.value()->values.isEmpty() )
+			{ flushColumn( colIt.value() ); }
+	}
+}
+
+void PlotRecorder::flushColumn( Column *col )
+{
+	quint32 count = col->values.size();
+
+	if( mWriter->getPendingBlockCount() >= mMaxPendingBlocks )
+	{
+		if( mDroppedCount == 0 )
+			{ error( QtWarningMsg, "Record writer can not keep up, dropping samples", "flushColumn()" ); }
+		mDroppedCount += count;
+	}
+	else
+	{
+		QByteArray block;
+		block.reserve( 2+4+8 + count*(4+8) );
+		QDataStream blockStream( &block, QIODevice::WriteOnly );
+		qint64 baseTime = col->timestamps.first();
+		blockStream << col->id << count << baseTime;
+		for( quint32 i=0; i<count; ++i )
+			{ blockStream << (quint32)(col->timestamps.at(i) - baseTime); }
+		for( quint32 i=0; i<count; ++i )
+			{ blockStream << col->values.at(i); }
+
+		mWriter->blockQueued();
+		emit blockReady( block );
+	}
+
+	// clear() would free the reserved memory
+	col->timestamps.resize(0);
+	col->values.resize(0);
+}
@@ -0,0 +1,118 @@
+#ifndef PLOTRECORDER_H
+#define PLOTRECORDER_H
+
+#include "ErrorHandlerBase.h"
+#include "DeviceStateHistoryVariable.h"
+#include <QHash>
+#include <QVector>
+#include <QPair>
+#include <QList>
+#include <QByteArray>
+
+class QThread;
+class QTimer;
+
+namespace qcPlot
+{
+
+class PlotRecordWriter;
+
+/** Headless recorder of state variable samples.
+  *	Record every received sample of a set of variables to a compact binary, columnar file.
+  *	Samples are collected per variable (column) and written out in blocks by a PlotRecordWriter running in its own thread.
+  *	If the writer can not keep up and too many blocks are waiting, new blocks are dropped and counted (see getDroppedCount()).
+  *
+  *	File format (all numbers are big-endian, as written by QDataStream):
+  *		- header: magic `QCREC` (5 bytes), quint8 format version, qint64 device startup time (UNIX ms), quint16 column count,
+  *		  then for every column: quint16 column id, QString hwInterface, QString variable name.
+  *		- blocks, repeated until the end of the file: quint16 column id, quint32 sample count N, qint64 base timestamp (UNIX ms),
+  *		  N x quint32 timestamp offsets from the base (ms), then N x double values.*/
+class PlotRecorder : public QtuC::ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+	explicit PlotRecorder( QObject *parent = 0 );
+
+	~PlotRecorder();
+
+	/** Set the variables to record.
+	  *	Must be called before start().
+	  *	@param varList List of variables as hwInterface-name pairs.*/
+	void setVariables( const QList<QPair<QString,QString> > &varList )
+		{ mVarNames = varList; }
+
+	/// Get the list of recorded variables as hwInterface-name pairs.
+	QList<QPair<QString,QString> > const & getVariables() const
+		{ return mVarNames; }
+
+	/** Start recording.
+	  *	Resolve the variables from the ProxyStateManager, open the file and write the header.
+	  *	@param fileName The output file.
+	  *	@return True on success, false otherwise.*/
+	bool start( const QString &fileName );
+
+	/// Get if the recorder is running.
+	bool isRecording() const
+		{ return mWriter != 0; }
+
+	/** Record a new sample.
+	  *	Samples of variables not set for recording are ignored.
+	  *	@param var The variable.
+	  *	@param timestamp Timestamp of the sample, as a UNIX timestamp in milliseconds.
+	  *	@param value The value as a string.*/
+	void record( const DeviceStateHistoryVariable *var, qint64 timestamp, const QString &value );
+
+	/// Get the number of samples recorded (including the dropped ones).
+	quint64 getSampleCount() const
+		{ return mSampleCount; }
+
+	/// Get the number of samples dropped because the writer could not keep up.
+	quint64 getDroppedCount() const
+		{ return mDroppedCount; }
+
+public slots:
+
+	/** Stop recording.
+	  *	Flush all collected samples, wait for the writer to finish, and close the file.*/
+	void stop();
+
+	/// Flush all collected samples to the writer.
+	void flush();
+
+signals:
+
+	/// Used to pass a block to the writer thread.
+	void blockReady( QByteArray block );
+
+private:
+
+	/// A column of the record, collecting the samples of a variable.
+	class Column
+	{
+	public:
+		quint16 id;
+		QVector<qint64> timestamps;
+		QVector<double> values;
+	};
+
+	/** Serialize the column to a block and pass it to the writer.
+	  *	If the writer queue is full, the samples of the column are dropped.*/
+	void flushColumn( Column *col );
+
+	QList<QPair<QString,QString> > mVarNames;	///< Variables to record, as hwInterface-name pairs.
+	QHash<const DeviceStateHistoryVariable*, Column*> mColumns;	///< Columns by variable.
+	QThread *mWriterThread;
+	PlotRecordWriter *mWriter;
+	QTimer *mFlushTimer;
+	int mBlockSize;	///< Number of samples in a full block.
+	int mMaxPendingBlocks;	///< Maximum number of blocks waiting for the writer, before dropping.
+	quint64 mSampleCount;
+	quint64 mDroppedCount;
+	qint64 mStartTime;
+
+	static const char mFileMagic[];
+	static const quint8 mFileFormatVersion;
+};
+
+}	//qcPlot::
+#endif // PLOTRECORDER_H
@@ -20,6 +20,34 @@ PlotSettingsManager::PlotSettingsManager(QObject *parent) :
 		{ setValue( "proxyAddress/host", "localhost" ); }
 	if( !contains("proxyAddress/port") )
 		{ setValue( "proxyAddress/port", 24563 ); }
+	if( !contains("proxyAddress/localName") )
+		{ setValue( "proxyAddress/localName", "" ); }	// local socket of the proxy (its serverSocket/localName), used if the host is localhost; empty: TCP only
+
+	// recorder
+	if( !contains("recorder/subscribeInterval") )
+		{ setValue( "recorder/subscribeInterval", 20 ); }	// ms
+	if( !contains("recorder/blockSize") )
+		{ setValue( "recorder/blockSize", 4096 ); }	// samples
+	if( !contains("recorder/maxPendingBlocks") )
+		{ setValue( "recorder/maxPendingBlocks", 256 ); }
+	if( !contains("recorder/flushIntervalMs") )
+		{ setValue( "recorder/flushIntervalMs", 500 ); }
+
+	// clientSend
+	if( !contains("clientSend/setIntervalMs") )
+		{ setValue( "clientSend/setIntervalMs", 50 ); }	// minimum time between the packets of sets from the widgets, 0: send every set at once
+
+	// clientReceive
+	if( !contains("clientReceive/workerThread") )
+		{ setValue( "clientReceive/workerThread", true ); }	// read and decode the packets of the proxy in a worker thread
+	if( !contains("clientReceive/drainIntervalMs") )
+		{ setValue( "clientReceive/drainIntervalMs", 16 ); }	// the packets decoded in the worker thread are handled at most once in this time
+	if( !contains("clientReceive/sharedState") )
+		{ setValue( "clientReceive/sharedState", true ); }	// read the values from the shared memory of a proxy on this host, instead of subscribing
+
+	// latency trace
+	if( !contains("latencyTrace/reportIntervalMs") )
+		{ setValue( "latencyTrace/reportIntervalMs", 10000 ); }	// 0: no periodic report
 
 }
 
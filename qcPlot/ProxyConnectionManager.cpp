@@ -1,11 +1,12 @@
 #include "ProxyConnectionManager.h"
-#include <QTcpSocket>
 #include "PlotSettingsManager.h"
 
 using namespace qcPlot;
 
-ProxyConnectionManager::ProxyConnectionManager(QTcpSocket *socket, QObject *parent) :
+ProxyConnectionManager::ProxyConnectionManager(QIODevice *socket, QObject *parent) :
 	QtuC::ClientConnectionManagerBase( socket, false, parent )
 {
 	socket->setParent(this);
+	if( PlotSettingsManager::instance()->value("clientReceive/workerThread").toBool() )
+		{ startWorkerThread( PlotSettingsManager::instance()->value("clientReceive/drainIntervalMs").toInt() ); }
 }
@@ -22,6 +22,9 @@ public:
 	inline DeviceStateHistoryVariable* getVar( const QString& hardwareInterface, const QString& varName )
 		{ return (DeviceStateHistoryVariable*)(StateManagerBase::getVar(hardwareInterface,varName)); }
 
+	inline DeviceStateHistoryVariable* getVar( int id )
+		{ return (DeviceStateHistoryVariable*)(StateManagerBase::getVar(id)); }
+
 	/** @name Reimplemented
 	  * @{*/
 	bool registerNewStateVariable( QHash<QString,QString> params );
@@ -1,11 +1,15 @@
 #include "QcPlot.h"
 #include "PlotSettingsManager.h"
 #include <QCoreApplication>
+#include <QTcpSocket>
+#include <QLocalSocket>
 #include "DeviceStatePlotDataVariable.h"
 #include "PlotConfigView.h"
 #include <QDomDocument>
 #include <QFile>
 #include <QTextStream>
+#include <QDateTime>
+#include "LatencyMonitor.h"
 
 using namespace QtuC;
 using namespace qcPlot;
@@ -14,7 +18,9 @@ QcPlot::QcPlot(QObject *parent) : ErrorHandlerBase(parent),
 	mProxyState(0),
 	mProxyLink(0),
 	mApiParser(0),
-	mPlotManager(0)
+	mApiSubscriptions(0),
+	mPlotManager(0),
+	mRecorder(0)
 {
 	// create settings
     QSettings::setDefaultFormat( QSettings::IniFormat );
@@ -22,8 +28,12 @@ QcPlot::QcPlot(QObject *parent) : ErrorHandlerBase(parent),
 
 	mProxyState = ProxyStateManager::instance(this);
 	connect( mProxyState, SIGNAL(stateVariableSendRequest(DeviceStateVariableBase*)), this, SLOT(handleStateVariableSendRequest(DeviceStateVariableBase*)) );
+	mSetCoalescer = new ClientSetCoalescer( PlotSettingsManager::instance()->value("clientSend/setIntervalMs").toInt(), this );
+	mSharedState = new SharedStateClient( mProxyState, this );
 
 	mPlotManager = new PlotManager(this);
+
+	LatencyMonitor::instance(this)->setReportInterval( PlotSettingsManager::instance()->value("latencyTrace/reportIntervalMs").toInt() );
 }
 
 QcPlot::~QcPlot()
@@ -46,6 +56,18 @@ void QcPlot::connectProxy()
 	selfInfo.insert( QString("version"), QCoreApplication::instance()->applicationVersion() );
 	ClientConnectionManagerBase::setSelfInfo(selfInfo);
 
+	// a proxy on this host is reached on its local socket, if set
+	QString localName = PlotSettingsManager::instance()->value("proxyAddress/localName").toString();
+	if( !localName.isEmpty() && SharedStateClient::isLocalHost( PlotSettingsManager::instance()->value("proxyAddress/host").toString() ) )
+	{
+		QLocalSocket *proxySocket = new QLocalSocket(0);
+		connect( proxySocket, SIGNAL(error(QLocalSocket::LocalSocketError)), this, SLOT(proxyConnectError()) );
+		connect( proxySocket, SIGNAL(connected()), this, SLOT(proxyConnected()) );
+		connect( proxySocket, SIGNAL(disconnected()), this, SLOT(proxyDisconnected()) );
+		proxySocket->connectToServer( localName );
+		return;
+	}
+
 	QTcpSocket *proxySocket = new QTcpSocket(0);
 
 	connect( proxySocket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(proxyConnectError()) );
@@ -72,12 +94,22 @@ bool QcPlot::setDeviceApi(const QString &apiString)
 			//connect( mDeviceAPI, SIGNAL(newHardwareInterface(QString,QString)), mDeviceInstance, SLOT(addHardwareInterface(QString,QString)) );
 			connect( mApiParser, SIGNAL(newStateVariable(QHash<QString,QString>)), this, SLOT(createDeviceVariable(QHash<QString,QString>)) );
 			connect( mApiParser, SIGNAL(newDeviceFunction(QString,QString,QString)), this, SLOT(createDeviceFunction(QString,QString,QString)) );
+			mApiSubscriptions = new ClientCommandSubscribeList();
 			if( !mApiParser->parseAPI(apiString) )
 			{
 				mApiParser->disconnect();
+				delete mApiSubscriptions;
+				mApiSubscriptions = 0;
 				error( QtCriticalMsg, "Failed to re-parse deviceAPI string", "setDeviceApi()" );
 				return false;
 			}
+
+			// subscribe to all the autoUpdate-user variables in one command, unless all the values are in the shared memory of a local proxy
+			if( attachSharedState(apiString) || mApiSubscriptions->isEmpty() )
+				{ delete mApiSubscriptions; }
+			else
+				{ mProxyLink->sendCommand( mApiSubscriptions ); }
+			mApiSubscriptions = 0;
 		}
 	}
 	else
@@ -100,18 +132,28 @@ bool QcPlot::resetDeviceApi(const QString &apiString)
 void QcPlot::clearDeviceApi()
 {
 	// first signal that this API will be destroyed
+	mSharedState->detach();
 	emit deviceApiCleared();
 	mApiParser->disconnect();
 	delete mApiParser;
 	mApiParser = 0;
 }
 
+bool QcPlot::attachSharedState( const QString &apiString )
+{
+	if( !PlotSettingsManager::instance()->value("clientReceive/sharedState").toBool() || !SharedStateClient::isLocalHost( PlotSettingsManager::instance()->value("proxyAddress/host").toString() ) )
+		{ return false; }
+	return mSharedState->attach( mProxyLink->getClientInfo().value("sharedState"), apiString );
+}
+
 bool QcPlot::callDeviceFunction(const QString &hwInterface, const QString &name, const QStringList &argList)
 {
 	ClientCommandDevice *cmd = new ClientCommandDevice(deviceCmdCall);
 	cmd->setInterface(hwInterface);
 	cmd->setFunction(name);
 	cmd->setArgList(argList);
+	// the sets of the widgets before the call go first
+	mSetCoalescer->flush();
 	if( !mProxyLink->sendCommand( cmd ) )
 	{
 		error( QtWarningMsg, "Failed to call function", "callDeviceFunction()" );
@@ -186,23 +228,44 @@ bool QcPlot::loadLayout(const QString &fileName)
 	return true;
 }
 
+bool QcPlot::setupRecorder( const QString &layoutFileName, const QString &outFileName )
+{
+	if( mRecorder )
+	{
+		error( QtWarningMsg, "Recorder is already set up", "setupRecorder()" );
+		return false;
+	}
+	if( !loadLayout( layoutFileName ) )
+		{ return false; }
+
+	mRecorder = new PlotRecorder(this);
+	mRecorder->setVariables( mPlotManager->getStateVariables() );
+	mRecordFileName = outFileName;
+	// both the API and the device startup time is needed, start when the latter arrives
+	connect( this, SIGNAL(deviceApiSet()), this, SLOT(startRecorder()) );
+	connect( this, SIGNAL(deviceStartup()), this, SLOT(startRecorder()) );
+	connect( QCoreApplication::instance(), SIGNAL(aboutToQuit()), mRecorder, SLOT(stop()) );
+	return true;
+}
+
 void QcPlot::proxyConnectError()
 {
 	errorDetails_t errDet;
-	errDet.insert( "error", ((QTcpSocket*)sender())->errorString() );
+	errDet.insert( "error", ((QIODevice*)sender())->errorString() );
 	error( QtCriticalMsg, "Failed to connect to proxy", "proxyConnectError", errDet );
 	delete sender();
 }
 
 void QcPlot::proxyConnected()
 {
-	mProxyLink = new ProxyConnectionManager( (QTcpSocket*)sender(), this );
+	mProxyLink = new ProxyConnectionManager( (QIODevice*)sender(), this );
 
 	// disconnect socket from me, ProxyConnectionManager is in control now
 	disconnect( sender(), 0, this, 0 );
 
 	connect( mProxyLink, SIGNAL(connectionStateReady()), this, SLOT(proxyConnectionReady()) );
 	connect( mProxyLink, SIGNAL(commandReceived(ClientCommandBase*)), this, SLOT(handleCommand(ClientCommandBase*)) );
+	mSetCoalescer->setConnection( mProxyLink );
 
 	// initialize handshake process
 	mProxyLink->sendHandShake();
@@ -211,21 +274,26 @@ void QcPlot::proxyConnected()
 void QcPlot::proxyDisconnected()
 {
 	mProxyLink->disconnect();
+	mSetCoalescer->setConnection( 0 );
+	mSharedState->detach();
 	debug( debugLevelInfo, "Proxy disconnected", "proxyDisconnected()" );
 }
 
 void QcPlot::proxyConnectionReady()
 {
 	emit proxyHasConnected();
-	debug( debugLevelVerbose, "Request device API...", "proxyConnectionReady()" );
-	mProxyLink->sendCommand( new ClientCommandReqDeviceApi() );
-	mProxyLink->sendCommand( new ClientCommandReqDeviceInfo() );
+	debug( debugLevelVerbose, "Request device API and snapshot...", "proxyConnectionReady()" );
+	// the snapshot is answered after the API, so the variables exist by the time the values arrive
+	QList<ClientCommandBase*> cmdList;
+	cmdList.append( new ClientCommandReqDeviceApi() );
+	cmdList.append( new ClientCommandReqSnapshot() );
+	cmdList.append( new ClientCommandReqDeviceInfo() );
+	mProxyLink->sendCommands( cmdList );
 }
 
 void QcPlot::handleStateVariableSendRequest(DeviceStateVariableBase *stateVar )
 {
-	ClientCommandDevice *cmd = new ClientCommandDevice( deviceCmdSet, stateVar );
-	mProxyLink->sendCommand( cmd );
+	mSetCoalescer->queueSet( stateVar );
 }
 
 void QcPlot::createDeviceVariable(QHash<QString, QString> varParams)
@@ -241,6 +309,10 @@ void QcPlot::createDeviceVariable(QHash<QString, QString> varParams)
 			return;
 		}
 
+		// nothing is plotted when recording
+		if( mRecorder )
+			{ stateVar->setHistoryLog(false); }
+
 		emit deviceVariableCreated( stateVar, varParams.value("guiHint") );
 		connect( this, SIGNAL(deviceStartup()), stateVar, SLOT(onDeviceStartup()) );
 
@@ -250,7 +322,9 @@ void QcPlot::createDeviceVariable(QHash<QString, QString> varParams)
 			bool ok;
 			quint32 interval;
 			interval = (quint32)varParams.value("autoUpdate-user").toInt(&ok);
-			if( ok )
+			if( ok && mApiSubscriptions )
+				{ mApiSubscriptions->append( interval, stateVar->getHwInterface(), stateVar->getName() ); }
+			else if( ok )
 				{ mProxyLink->sendCommand( new ClientCommandSubscribe( interval, stateVar->getHwInterface(), stateVar->getName() ) ); }
 			else
 			{
@@ -266,6 +340,25 @@ void QcPlot::createDeviceVariable(QHash<QString, QString> varParams)
 		{ error( QtWarningMsg, QString("Unable to register new stateVariable %1:%2").arg( varParams.value("hwInterface"), varParams.value("name") ), "createDeviceVariable()" ); }
 }
 
+void QcPlot::startRecorder()
+{
+	if( !mRecorder || mRecorder->isRecording() || !mApiParser || DeviceStateHistoryVariable::getDeviceStartupTime() == 0 )
+		{ return; }
+
+	quint32 interval = PlotSettingsManager::instance()->value("recorder/subscribeInterval").toUInt();
+	QList<QPair<QString,QString> > const &varList = mRecorder->getVariables();
+	ClientCommandSubscribeList *subscribeList = new ClientCommandSubscribeList();
+	for( int i=0; i<varList.size(); ++i )
+		{ subscribeList->append( interval, varList.at(i).first, varList.at(i).second ); }
+	if( subscribeList->isEmpty() )
+		{ delete subscribeList; }
+	else
+		{ mProxyLink->sendCommand( subscribeList ); }
+
+	if( !mRecorder->start( mRecordFileName ) )
+		{ error( QtCriticalMsg, "Failed to start recorder", "startRecorder()" ); }
+}
+
 void QcPlot::createDeviceFunction(QString hwInterface, QString name, QString args)
 {
 	Q_UNUSED(args);
@@ -301,7 +394,16 @@ bool QcPlot::handleDeviceCmd(ClientCommandDevice *deviceCmd)
 	{
 		DeviceStateHistoryVariable *var = (DeviceStateHistoryVariable*)mProxyState->getVar( deviceCmd->getHwInterface(), deviceCmd->getVariable() );
 		if( var )
-			{ var->updateFromSource( deviceCmd->getArg() ); }
+		{
+			if( mRecorder )
+				{ mRecorder->record( var, deviceCmd->hasTimestamp() ? (qint64)deviceCmd->getTimestamp() : QDateTime::currentMSecsSinceEpoch(), deviceCmd->getArg() ); }
+			var->updateFromSource( deviceCmd->getArg() );
+			if( deviceCmd->hasTrace() )
+			{
+				deviceCmd->stampTrace( LatencyTrace::traceStageRender );
+				LatencyMonitor::instance()->record( deviceCmd->getTrace() );
+			}
+		}
 		else
 		{
 			error( QtWarningMsg, QString("Failed to set variable from device, no such variable (hwI: %1, name: %2)").arg(deviceCmd->getHwInterface(),deviceCmd->getVariable()), "handleDeviceCmd()" );
@@ -312,8 +414,37 @@ bool QcPlot::handleDeviceCmd(ClientCommandDevice *deviceCmd)
 	else return false;
 }
 
+void QcPlot::handleSnapshotCmd( ClientCommandSnapshot *snapshotCmd )
+{
+	if( mSharedState->isAttached() )
+		{ return; }
+
+	const QList<ClientCommandSnapshot::value_t> &valueList = snapshotCmd->getValueList();
+	for( int i=0; i<valueList.size(); ++i )
+	{
+		DeviceStateHistoryVariable *var = (DeviceStateHistoryVariable*)mProxyState->getVar( valueList.at(i).hwInterface, valueList.at(i).variable );
+		if( var )
+		{
+			// a variable never updated on the proxy has no update time
+			qint64 updateTime = valueList.at(i).time ? valueList.at(i).time : QDateTime::currentMSecsSinceEpoch();
+			if( mRecorder )
+				{ mRecorder->record( var, updateTime, valueList.at(i).value ); }
+			var->updateFromSource( valueList.at(i).value, updateTime );
+		}
+		else
+			{ error( QtWarningMsg, QString("Failed to set variable from snapshot, no such variable (hwI: %1, name: %2)").arg(valueList.at(i).hwInterface,valueList.at(i).variable), "handleSnapshotCmd()" ); }
+	}
+}
+
 void QcPlot::handleCommand(ClientCommandBase *cmd)
 {
+	// a proxy of more devices sends the commands of all of them, only the default one is shown
+	if( !mProxyLink->isDefaultDevice( cmd->getDevice() ) )
+	{
+		cmd->deleteLater();
+		return;
+	}
+
 	if( cmd->getClass() == ClientCommandBase::clientCommandDevice )
 	{
 		ClientCommandDevice *deviceCmd = (ClientCommandDevice*)cmd;
@@ -332,6 +463,8 @@ void QcPlot::handleCommand(ClientCommandBase *cmd)
 			DeviceStateHistoryVariable::setDeviceStartupTime( cmdDeviceInfo->getStartupTime() );
 			emit deviceStartup();
 		}
+		else if( cmd->getName() == "snapshot" )
+			{ handleSnapshotCmd( (ClientCommandSnapshot*)cmd ); }
 		else
 			{ debug( debugLevelInfo, QString("Unhandled command: %1").arg(cmd->getName()), "handleCommand()" ); }
 	}
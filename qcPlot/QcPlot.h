@@ -5,7 +5,10 @@
 #include "ProxyStateManager.h"
 #include "ProxyConnectionManager.h"
 #include "DeviceAPIParser.h"
+#include "ClientSetCoalescer.h"
+#include "SharedStateClient.h"
 #include "PlotManager.h"
+#include "PlotRecorder.h"
 
 using namespace QtuC;
 
@@ -64,6 +67,18 @@ public:
 	bool saveLayout( QString const &fileName ) const;
 	bool loadLayout( QString const &fileName );
 
+	/** Set up headless recording.
+	  *	Load the layout file and record all variables used in it to the output file, instead of plotting them.
+	  *	Recording starts when both the device API and the device info is received, the variables are subscribed with the interval in the `recorder/subscribeInterval` setting.
+	  *	@param layoutFileName The layout file, as saved by saveLayout().
+	  *	@param outFileName The file to record to. See PlotRecorder for the format.
+	  *	@return True on success, false otherwise.*/
+	bool setupRecorder( QString const &layoutFileName, QString const &outFileName );
+
+	/// Get the recorder, null if not recording.
+	inline PlotRecorder *recorder() const
+		{ return mRecorder; }
+
 signals:
 
 	/** Emitted if a new Device State Variable is created.
@@ -121,6 +136,9 @@ private slots:
 	  *	Parameters as of QtuC::DeviceAPIParser::newDeviceFunction() signal.*/
 	void createDeviceFunction( QString hwInterface, QString name, QString args );
 
+	/// Subscribe to the recorded variables and start the recorder.
+	void startRecorder();
+
 private:
 
 	/** Handle device API client command if received.
@@ -132,10 +150,25 @@ private:
 	  *	@todo Temporary solution, for proxy passthrough mode.*/
 	bool handleDeviceCmd( ClientCommandDevice *deviceCmd );
 
+	/** Handle a snapshot command, update the variables from it, with the update times of the proxy.
+	  *	The values are already up to date if they are read from the shared memory, then the snapshot is ignored.
+	  *	@param snapshotCmd The received snapshot command.*/
+	void handleSnapshotCmd( ClientCommandSnapshot *snapshotCmd );
+
+	/** Read the values from the shared memory of the proxy instead of subscribing, if the proxy is on this host and shares its memory.
+	  *	@param apiString The deviceAPI string, the variables must be created from it.
+	  *	@return True if the values are read from the shared memory, false if they must be subscribed.*/
+	bool attachSharedState( const QString &apiString );
+
 	ProxyStateManager *mProxyState;
 	ProxyConnectionManager *mProxyLink;
 	QtuC::DeviceAPIParser *mApiParser;
+	ClientCommandSubscribeList *mApiSubscriptions;	///< The user-side autoUpdate subscriptions of the API being parsed, sent at once after parsing.
+	ClientSetCoalescer *mSetCoalescer;	///< Throttles the sets of the interactive widgets.
+	SharedStateClient *mSharedState;	///< Reads the values from the shared memory of a local proxy.
 	PlotManager *mPlotManager;
+	PlotRecorder *mRecorder;
+	QString mRecordFileName;
 };
 
 }	//QcPlot::
@@ -2,11 +2,27 @@
 #include "ErrorHandlerBase.h"
 #include "QcPlot.h"
 #include "QcPlotMainView.h"
+#include <csignal>
+
+#ifdef Q_OS_UNIX
+	#include <unistd.h>
+	#include <QSocketNotifier>
+#endif
 
 using namespace QtuC;
 using namespace qcPlot;
 
-void parseAppArg( const QString &, int & );
+void parseAppArg( const QStringList &, int & );
+#ifdef Q_OS_UNIX
+void quitOnSignal( int );
+#endif
+
+QString recordLayoutFile;	///< Layout file for headless recording (-r).
+QString recordOutFile;		///< Output file for headless recording (-o).
+
+#ifdef Q_OS_UNIX
+int quitSignalPipe[2];		///< Self-pipe of quitOnSignal(), the handler writes it, the event loop quits when it's readable.
+#endif
 
 int main(int argc, char *argv[])
 {
@@ -14,7 +30,15 @@ int main(int argc, char *argv[])
 	int versionMinor = 1;
 	int versionFix = 0;
 
-	QApplication qcPlotApp(argc, argv);
+	// Headless recording (-r) needs no GUI, this must be known before the application is created.
+	bool headless = false;
+	for( int i=1; i<argc; ++i )
+	{
+		if( QString(argv[i]) == "-r" )
+			{ headless = true; }
+	}
+
+	QApplication qcPlotApp(argc, argv, !headless);
 
 	qcPlotApp.setApplicationName( "QcPlot" );
 	qcPlotApp.setOrganizationName( "QtuC" );
@@ -34,7 +58,7 @@ int main(int argc, char *argv[])
 			continue;
 		}
 
-		parseAppArg( appArgs.at(i), i );
+		parseAppArg( appArgs, i );
 	}
 
 	// create gui model
@@ -50,6 +74,28 @@ int main(int argc, char *argv[])
 	{
 		qcPlotModel->connect( &qcPlotApp, SIGNAL(aboutToQuit()), qcPlotModel, SLOT(deleteLater()) );
 
+		if( headless )
+		{
+			if( recordOutFile.isEmpty() || !qcPlotModel->setupRecorder( recordLayoutFile, recordOutFile ) )
+			{
+				qCritical( "Failed to set up recorder, usage: qcPlot -r <layoutFile> -o <outputFile>" );
+				return 1;
+			}
+		#ifdef Q_OS_UNIX
+			// stop the recorder and close the file properly on Ctrl+C, but quit from the event loop, not the signal handler
+			if( pipe( quitSignalPipe ) == 0 )
+			{
+				QSocketNotifier *quitNotifier = new QSocketNotifier( quitSignalPipe[0], QSocketNotifier::Read, &qcPlotApp );
+				QObject::connect( quitNotifier, SIGNAL(activated(int)), &qcPlotApp, SLOT(quit()) );
+				signal( SIGINT, quitOnSignal );
+				signal( SIGTERM, quitOnSignal );
+			}
+			else
+				{ qWarning( "Failed to create the signal pipe, Ctrl+C won't close the output file" ); }
+		#endif
+			qcPlotModel->connectProxy();
+			return qcPlotApp.exec();
+		}
 
 		QcPlotMainView mainView(qcPlotModel);
 		mainView.setWindowTitle( qcPlotApp.applicationName() );
@@ -60,9 +106,9 @@ int main(int argc, char *argv[])
 	}
 }
 
-void parseAppArg( const QString &appArg, int &argIndex )
+void parseAppArg( const QStringList &appArgs, int &argIndex )
 {
-	QString arg(appArg);
+	QString arg(appArgs.at(argIndex));
 	// switches
 	if( arg.startsWith('-') )
 	{
@@ -77,10 +123,35 @@ void parseAppArg( const QString &appArg, int &argIndex )
 			ErrorHandlerBase::setDebugLevel( debugLevelVeryVerbose );
 			++argIndex;
 		}
+		else if( arg == "r" && argIndex+1 < appArgs.size() )
+		{
+			recordLayoutFile = appArgs.at(argIndex+1);
+			argIndex += 2;
+		}
+		else if( arg == "o" && argIndex+1 < appArgs.size() )
+		{
+			recordOutFile = appArgs.at(argIndex+1);
+			argIndex += 2;
+		}
+		else
+			{ ++argIndex; }
 	}
 	// args
 	else if( arg.startsWith("--") )
 	{
 		arg = arg.mid(2);
 	}
+	else
+		{ ++argIndex; }
+}
+
+#ifdef Q_OS_UNIX
+void quitOnSignal( int sig )
+{
+	Q_UNUSED(sig);
+	// only async-signal-safe calls here, the event loop does the rest
+	char byte = 1;
+	ssize_t written = write( quitSignalPipe[1], &byte, sizeof(byte) );
+	Q_UNUSED(written);
 }
+#endif
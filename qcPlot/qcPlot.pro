@@ -27,7 +27,9 @@ SOURCES += main.cpp\
     CurveView.cpp \
     Qwt2AxisMagnifier.cpp \
     PlotterView.cpp \
-    QcPlotCurve.cpp
+    QcPlotCurve.cpp \
+    PlotRecorder.cpp \
+    PlotRecordWriter.cpp
 
 HEADERS  += \
     QcPlot.h \
@@ -47,11 +49,15 @@ HEADERS  += \
     CurveView.h \
     Qwt2AxisMagnifier.h \
     PlotterView.h \
-    QcPlotCurve.h
+    QcPlotCurve.h \
+    PlotRecorder.h \
+    PlotRecordWriter.h
 
 win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/release/ -lqcCommon
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/debug/ -lqcCommon
 else:unix: LIBS += -L$$OUT_PWD/../qcCommon/ -lqcCommon
+# setsockopt() of ClientConnectionManagerBase
+win32: LIBS += -lws2_32
 
 INCLUDEPATH += $$PWD/../qcCommon
 INCLUDEPATH += $$PWD/../qcCommon/clientCommands
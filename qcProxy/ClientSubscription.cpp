@@ -1,6 +1,5 @@
 #include "ClientSubscription.h"
 #include "DeviceStateVariableBase.h"
-#include <QTimerEvent>
 
 using namespace QtuC;
 
@@ -11,8 +10,7 @@ ClientSubscription::ClientSubscription(ClientConnectionManagerBase *client, quin
 	mClient(client),
 	mVariable(variable),
 	mHwInterface(hwInterface),
-	mInterval(interval),
-	mTimerId(0)
+	mInterval(interval)
 {
 
 	errorDetails_t errDet;
@@ -37,33 +35,6 @@ ClientSubscription::~ClientSubscription()
 	debug( debugLevelVeryVerbose, "Destroyed", "~ClientSubscription()" );
 }
 
-bool ClientSubscription::start()
-{
-	if( mTimerId != 0 )
-	{
-		error( QtWarningMsg, "Timer is already running, stop it first", "start()" );
-		return false;
-	}
-
-	if( !isValid() )
-	{
-		error( QtWarningMsg, "Subscription is invalid, not started", "start()" );
-		return false;
-	}
-
-	mTimerId = startTimer( mInterval );
-	return ( mTimerId != 0 );
-}
-
-void ClientSubscription::stop()
-{
-	if( mTimerId != 0 )
-	{
-		killTimer( mTimerId );
-		mTimerId = 0;
-	}
-}
-
 bool ClientSubscription::operator ==( const ClientSubscription &otherSubscription) const
 {
 	return ( mHwInterface == otherSubscription.getHwInterface() && mVariable == otherSubscription.getVariable() );
@@ -98,9 +69,3 @@ bool ClientSubscription::isValid()
 	valid = valid && !( mHwInterface.isEmpty() && !mVariable.isEmpty() );
 	return valid;
 }
-
-void ClientSubscription::timerEvent(QTimerEvent *timerEvent)
-{
-	timerEvent->accept();
-	emit subscriptionTick();
-}
@@ -11,7 +11,7 @@ class DeviceStateVariableBase;
 /** Class to represent a clientSubscription.
   *	To every subscribe command a ClientSubscription is created, unless it results in a subscription duplicate.
   *	(For example a single variable will not be subscribed if the whole hardware interface of that variable is already subscribed.)
-  *	Use start() to start the periodic emitting of subscriptionTick signal.*/
+  *	The subscription has no timer of its own, ClientSubscriptionManager ticks the subscriptions of a client with the same interval together.*/
 class ClientSubscription : public ErrorHandlerBase
 {
 	Q_OBJECT
@@ -28,14 +28,6 @@ public:
 
 	~ClientSubscription();
 
-	/** Start the subscribe feed.
-	  *	The subscriptionTick() signal will be emitted at the specified intervals.
-	  *	@return True if the subscription is valid and the feed can be started, false otherwise.*/
-	bool start();
-
-	/// Stop emitting subscriptionTick(), subscription feed will stop.
-	void stop();
-
 	/** Custom equality operator.
 	  *	Two ClientSubscription is equal if both the hardware interface and the variable is the same. Frequency may be different.
 	  *	@return True if the two ClientSubscriptions are equal, false if not.*/
@@ -91,23 +83,16 @@ public slots:
 
 signals:
 
-	/// Emitted when the timer of this subscription is timed out.
-	void subscriptionTick();
-
 	/** Emitted when this subscriiption can be deleted.
 	  * (For example the client disconnected)*/
 	void destroyMe();
 
 private:
 
-	/// Re-implement QObject::timerEvent().
-	void timerEvent( QTimerEvent *timerEvent );
-
 	ClientConnectionManagerBase *mClient;	///< The client that requested this subscription.
 	QString mVariable;			///< Subscription variable.
 	QString mHwInterface;		///< Subscription hardware interface.
 	quint32 mInterval;	///< Interval of the subscripiton, in milliseconds, 32bit unsigned integer.
-	int mTimerId;	///< Internal id of the QObject timer in use.
 	static quint32 mMinSubscriptionInterval;	///< Minimum interval of a client subscription in milliseconds.
 
 };
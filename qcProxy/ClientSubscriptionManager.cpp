@@ -1,5 +1,6 @@
 #include "ClientSubscriptionManager.h"
 //#include "DeviceStateVariableBase.h"
+#include <QTimerEvent>
 
 using namespace QtuC;
 
@@ -10,38 +11,88 @@ ClientSubscriptionManager::ClientSubscriptionManager(QObject *parent) :
 
 bool ClientSubscriptionManager::subscribe(ClientConnectionManagerBase *client, quint32 interval, const QString &hwInterface, const QString &variable)
 {
-	ClientSubscription *subscription = new ClientSubscription( client, interval, hwInterface, variable, this );
+	ClientSubscription *subscription = createSubscription( client, interval, hwInterface, variable );
+	if( !subscription )
+		{ return false; }
+	return addSubscription( subscription );
+}
+
+bool ClientSubscriptionManager::subscribeList( ClientConnectionManagerBase *client, const QList<ClientCommandSubscribeList::subscription_t> &subscriptionList )
+{
+	// create all first, so nothing is subscribed if an entry is invalid
+	QList<ClientSubscription*> created;
+	for( int i=0; i<subscriptionList.size(); ++i )
+	{
+		ClientSubscription *subscription = createSubscription( client, subscriptionList.at(i).interval, subscriptionList.at(i).hwInterface, subscriptionList.at(i).variable );
+		if( !subscription )
+		{
+			for( int c=0; c<created.size(); ++c )
+				{ created.at(c)->deleteLater(); }
+			error( QtWarningMsg, QString("Entry %1 of subscribeList is invalid, the list is ignored").arg(QString::number(i)), "subscribeList()" );
+			return false;
+		}
+		created.append( subscription );
+	}
 
+	int added = 0;
+	for( int i=0; i<created.size(); ++i )
+	{
+		if( addSubscription( created.at(i) ) )
+			{ ++added; }
+	}
+	debug( debugLevelVerbose, QString("%1 of %2 subscriptions added for client %3").arg( QString::number(added), QString::number(created.size()), client->getID() ), "subscribeList()" );
+	return true;
+}
+
+ClientSubscription *ClientSubscriptionManager::createSubscription( ClientConnectionManagerBase *client, quint32 interval, const QString &hwInterface, const QString &variable )
+{
+	ClientSubscription *subscription = new ClientSubscription( client, interval, hwInterface, variable, this );
 	if( !subscription->isValid() )
 	{
-		error( QtWarningMsg, "Created subscription is invalid, ignored", "subscribe()" );
+		error( QtWarningMsg, "Created subscription is invalid, ignored", "createSubscription()" );
 		subscription->deleteLater();
-		return false;
+		return 0;
 	}
+	return subscription;
+}
 
-	bool found = false;
+bool ClientSubscriptionManager::addSubscription( ClientSubscription *subscription )
+{
 	for( int i=0; i<mSubscriptions.size(); ++i )
 	{
-		if( *(mSubscriptions.at(i)) == *subscription )
+		if( mSubscriptions.at(i)->getClient() == subscription->getClient() && *(mSubscriptions.at(i)) == *subscription )
 		{
-			found = true;
-			break;
+			subscription->deleteLater();
+			return false;
 		}
 	}
 
-	if( !found )
+	mSubscriptions.append( subscription );
+	connect( subscription, SIGNAL(destroyMe()), this, SLOT(destroySubscription()) );
+
+	QHash<int,tickGroup_t>::iterator group = mTickGroups.begin();
+	for( ; group != mTickGroups.end(); ++group )
 	{
-		mSubscriptions.append( subscription );
-		connect( subscription, SIGNAL(subscriptionTick()), this, SLOT(handleSubscriptionTick()) );
-		connect( subscription, SIGNAL(destroyMe()), this, SLOT(destroySubscription()) );
-		subscription->start();
-		return true;
+		if( group->client == subscription->getClient() && group->interval == subscription->getInterval() )
+			{ break; }
 	}
-	else
+	if( group == mTickGroups.end() )
 	{
-		subscription->deleteLater();
-		return false;
+		int timerId = startTimer( subscription->getInterval() );
+		if( timerId == 0 )
+		{
+			error( QtWarningMsg, "Failed to start subscription timer", "addSubscription()" );
+			mSubscriptions.removeAll( subscription );
+			subscription->deleteLater();
+			return false;
+		}
+		tickGroup_t newGroup;
+		newGroup.client = subscription->getClient();
+		newGroup.interval = subscription->getInterval();
+		group = mTickGroups.insert( timerId, newGroup );
 	}
+	group->subscriptionList.append( subscription );
+	return true;
 }
 
 void ClientSubscriptionManager::destroySubscription( ClientSubscription *subscription )
@@ -57,15 +108,21 @@ void ClientSubscriptionManager::destroySubscription( ClientSubscription *subscri
 		}
 	}
 
-	for( int i=0; i<mSubscriptions.size(); ++i )
+	if( mSubscriptions.removeAll( subscription ) == 0 )
+		{ return; }
+
+	QHash<int,tickGroup_t>::iterator group = mTickGroups.begin();
+	while( group != mTickGroups.end() )
 	{
-		if( mSubscriptions.at(i) == subscription )
+		if( group->subscriptionList.removeAll( subscription ) && group->subscriptionList.isEmpty() )
 		{
-			subscription->stop();
-			subscription->deleteLater();
-			mSubscriptions.removeAt(i);
+			killTimer( group.key() );
+			group = mTickGroups.erase( group );
 		}
+		else
+			{ ++group; }
 	}
+	subscription->deleteLater();
 }
 
 void ClientSubscriptionManager::unSubscribe( ClientConnectionManagerBase *client, const QString &hwInterface, const QString &variable )
@@ -79,15 +136,25 @@ void ClientSubscriptionManager::unSubscribe( ClientConnectionManagerBase *client
 		   ( variable == "*" && hwInterface == "*" ) ||
 		   ( variable == "*" && hwInterface == mSubscriptions.at(i)->getHwInterface() )
 		){
+			// removed from the list
 			destroySubscription( mSubscriptions.at(i) );
+			--i;
 		}
 	}
 }
 
-void ClientSubscriptionManager::handleSubscriptionTick()
+void ClientSubscriptionManager::unSubscribeList( ClientConnectionManagerBase *client, const QList<ClientCommandSubscribeList::subscription_t> &subscriptionList )
+{
+	for( int i=0; i<subscriptionList.size(); ++i )
+		{ unSubscribe( client, subscriptionList.at(i).hwInterface, subscriptionList.at(i).variable ); }
+}
+
+void ClientSubscriptionManager::timerEvent( QTimerEvent *timerEvent )
 {
-	ClientSubscription *subscription = (ClientSubscription*)sender();
-	emit subscriptionFeedRequest( subscription );
+	timerEvent->accept();
+	QHash<int,tickGroup_t>::const_iterator group = mTickGroups.constFind( timerEvent->timerId() );
+	if( group != mTickGroups.constEnd() )
+		{ emit subscriptionFeedRequest( group->subscriptionList ); }
 }
 
 bool ClientSubscriptionManager::moreSpecificSubscriptionExists( const DeviceStateVariableBase *variable, const ClientSubscription *subscription ) const
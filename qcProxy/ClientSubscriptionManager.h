@@ -4,6 +4,8 @@
 #include "ErrorHandlerBase.h"
 #include "ClientCommandDevice.h"
 #include "ClientSubscription.h"
+#include "ClientCommandSubscribeList.h"
+#include <QHash>
 
 namespace QtuC
 {
@@ -15,7 +17,8 @@ class DeviceStateVariableBase;
   *	Subscriptions are managed globally (with one ClientSubscriptionManager), and each subscription object stores a pointer to its own subscriber client.
   *	For detailed rules of subscription, see the [subscribe](@ref doc-clientProtocol-packets-control-subscribe) clientCommand.
   *	When a client subscribes, proxy only chekcs if there's a subscription exactly like the requested one.
-  *	Whether there is a more specific one is tested for each variable when sending the subscription feed.*/
+  *	Whether there is a more specific one is tested for each variable when sending the subscription feed.
+  *	The subscriptions of a client with the same interval share one timer, and are fed together (see subscriptionFeedRequest()).*/
 class ClientSubscriptionManager : public ErrorHandlerBase
 {
 	Q_OBJECT
@@ -43,6 +46,13 @@ public slots:
 	 *	@param variable Variable name.*/
 	bool subscribe( ClientConnectionManagerBase *client, quint32 interval, const QString &hwInterface, const QString &variable );
 
+	/** Subscribe client to a list of variable sets at once.
+	 *	The list is handled atomically: if an entry is invalid, none of them is subscribed. Entries already subscribed are skipped.
+	 *	@param client The client to subscribe.
+	 *	@param subscriptionList The entries, see subscribe() for the members.
+	 *	@return True if the list is accepted, false otherwise.*/
+	bool subscribeList( ClientConnectionManagerBase *client, const QList<ClientCommandSubscribeList::subscription_t> &subscriptionList );
+
 	/** Unsubscribe client from the requested set of variables.
 	 *	See [unSubscribe command](#doc-clientProtocol-packets-unSubscribe) for more info on how to use the arguments.
 	 *	@param client The client to subscribe.
@@ -50,16 +60,16 @@ public slots:
 	 *	@param variable Variable name.*/
 	void unSubscribe( ClientConnectionManagerBase *client, const QString &hwInterface, const QString &variable );
 
+	/** Unsubscribe client from a list of variable sets.
+	 *	@param client The client to unsubscribe.
+	 *	@param subscriptionList The entries, see unSubscribe() for the members (the interval is not used).*/
+	void unSubscribeList( ClientConnectionManagerBase *client, const QList<ClientCommandSubscribeList::subscription_t> &subscriptionList );
+
 	/** Cancel a subscription.
 	  *	Cancel subscription feed, and destroy subscription.
 	  *	@param subscription The subscription to cancel.*/
 	void destroySubscription( ClientSubscription *subscription = 0 );
 
-private slots:
-
-	/// Called when the timer of one of the subscriptions is timed out.
-	void handleSubscriptionTick();
-
 signals:
 
 	/* Emitted when a subscription feed must be sent to the client.
@@ -72,13 +82,34 @@ signals:
 	  *	@param cmd Command to be sent in the feed packet.*/
 	//void sendSubscriptionFeed( ClientConnectionManagerBase *client, ClientCommandDevice *cmd );
 
-	/** Emitted when the timer of this subscription is timed out.
-	  *	@param subscription The sender subscription.*/
-	void subscriptionFeedRequest( ClientSubscription *subscription );
+	/** Emitted when the timer of a group of subscriptions is timed out.
+	  *	@param subscriptionList The subscriptions of the same client and interval, to be fed in one packet.*/
+	void subscriptionFeedRequest( const QList<ClientSubscription*> &subscriptionList );
 
 private:
 
+	/// Subscriptions of a client with the same interval, ticked by the same timer.
+	struct tickGroup_t
+	{
+		ClientConnectionManagerBase *client;
+		quint32 interval;
+		QList<ClientSubscription*> subscriptionList;
+	};
+
+	/// Re-implement QObject::timerEvent(), emit the feed request of a tick group.
+	void timerEvent( QTimerEvent *timerEvent );
+
+	/** Create a subscription, without adding it.
+	  *	@return The subscription, or 0 if it is invalid.*/
+	ClientSubscription *createSubscription( ClientConnectionManagerBase *client, quint32 interval, const QString &hwInterface, const QString &variable );
+
+	/** Add a created subscription and start its feed, unless the client already has the same subscription.
+	  *	@param subscription The subscription, deleted if not added.
+	  *	@return True if added, false otherwise.*/
+	bool addSubscription( ClientSubscription *subscription );
+
 	QList<ClientSubscription*> mSubscriptions;	///< Holds the list of client subscriptions.
+	QHash<int,tickGroup_t> mTickGroups;	///< The tick groups by timer id.
 
 };
 
@@ -1,13 +1,18 @@
 #include "ConnectionServer.h"
 #include "ClientConnectionManagerBase.h"
 #include "ProxySettingsManager.h"
+#include "SharedStateServer.h"
 #include <QCoreApplication>
+#include <QTcpSocket>
+#include <QLocalSocket>
 
 using namespace QtuC;
 
-ConnectionServer::ConnectionServer(QObject *parent) : ErrorHandlerBase(parent)
+ConnectionServer::ConnectionServer(QObject *parent) : ErrorHandlerBase(parent),
+	mSharedStateServer(0)
 {
 	mTcpServer = new QTcpServer(this);
+	mLocalServer = new QLocalServer(this);
 
 	QHash<QString,QString> selfInfo;
 	selfInfo.insert( QString("id"), ProxySettingsManager::instance()->value( "serverInfo/id" ).toString() );
@@ -18,12 +23,15 @@ ConnectionServer::ConnectionServer(QObject *parent) : ErrorHandlerBase(parent)
 	ClientConnectionManagerBase::setSelfInfo(selfInfo);
 
 	connect( mTcpServer, SIGNAL(newConnection()), this, SLOT(handleNewConnection()) );
+	connect( mLocalServer, SIGNAL(newConnection()), this, SLOT(handleNewLocalConnection()) );
 }
 
 ConnectionServer::~ConnectionServer()
 {
 	if( mTcpServer && mTcpServer->isListening() )
 		{ mTcpServer->close(); }
+	if( mLocalServer->isListening() )
+		{ mLocalServer->close(); }
 	/// @todo destroy clients (so far this is not necessary, both socket and client objects are parent of server), but we should disconnect them first
 }
 
@@ -33,13 +41,29 @@ void ConnectionServer::handleNewConnection()
 	if( newClientSocket )
 	{
 		debug( debugLevelInfo, QString("New client connection, index: #%1").arg(mClients.size()), "handleNewConnection()" );
-		ClientConnectionManagerBase *newClient = new ClientConnectionManagerBase(newClientSocket, true, this);
-		mClients.append(newClient);
-		connect( newClient, SIGNAL(clientDisconnected()), this, SLOT(handleClientDisconnect()) );
-		emit newClientConnected(newClient);
+		addClient( newClientSocket );
 	}
 }
 
+void ConnectionServer::handleNewLocalConnection()
+{
+	QLocalSocket *newClientSocket = mLocalServer->nextPendingConnection();
+	if( newClientSocket )
+	{
+		debug( debugLevelInfo, QString("New local client connection, index: #%1").arg(mClients.size()), "handleNewLocalConnection()" );
+		addClient( newClientSocket );
+	}
+}
+
+void ConnectionServer::addClient( QIODevice *socket )
+{
+	ClientConnectionManagerBase *newClient = new ClientConnectionManagerBase(socket, true, this);
+	newClient->setSocketBufferSizes( ProxySettingsManager::instance()->value("serverSocket/sendBufferSize").toInt(), ProxySettingsManager::instance()->value("serverSocket/receiveBufferSize").toInt() );
+	mClients.append(newClient);
+	connect( newClient, SIGNAL(clientDisconnected()), this, SLOT(handleClientDisconnect()) );
+	emit newClientConnected(newClient);
+}
+
 void ConnectionServer::handleClientDisconnect()
 {
 	// who dares!?...
@@ -81,12 +105,28 @@ ClientConnectionManagerBase *ConnectionServer::getClient(int clientNumber)
 	return mClients.at(clientNumber);
 }
 
+int ConnectionServer::getClientCount() const
+{
+	return mClients.size();
+}
+
 bool ConnectionServer::startListening()
 {
 	// duh, why can't QHostAddress do this?
 	QString address = ProxySettingsManager::instance()->value("serverSocket/host").toString();
 	if( address == "localhost" )
 		{ address = "127.0.0.1"; }
+	QString localName = ProxySettingsManager::instance()->value("serverSocket/localName").toString();
+	if( !localName.isEmpty() )
+	{
+		// a socket left by a crashed proxy
+		QLocalServer::removeServer( localName );
+		if( mLocalServer->listen( localName ) )
+			{ debug( debugLevelInfo, QString("Listening on local socket %1.").arg( mLocalServer->fullServerName() ), "startListening()" ); }
+		else
+			{ error( QtWarningMsg, QString("Failed to listen on local socket %1, local clients must use TCP").arg( localName ), "startListening()" ); }
+	}
+
 	if( mTcpServer->listen( QHostAddress(address), ProxySettingsManager::instance()->value("serverSocket/port").toInt() ) )
 	{
 		debug( debugLevelInfo, QString("Listening on %1, port %2.").arg( ProxySettingsManager::instance()->value("serverSocket/host").toString(), ProxySettingsManager::instance()->value("serverSocket/port").toString() ), "startListening()" );
@@ -99,6 +139,22 @@ bool ConnectionServer::startListening()
 	return false;
 }
 
+bool ConnectionServer::startSharedState( const QList<DeviceStateVariableBase*> &varList, const QString &apiString )
+{
+	if( mSharedStateServer )
+		{ return true; }
+	SharedStateServer *sharedStateServer = new SharedStateServer(this);
+	if( !sharedStateServer->start( varList, apiString ) )
+	{
+		error( QtWarningMsg, "Failed to start the shared state, local clients will use TCP only", "startSharedState()" );
+		delete sharedStateServer;
+		return false;
+	}
+	mSharedStateServer = sharedStateServer;
+	ClientConnectionManagerBase::setSelfInfo( "sharedState", mSharedStateServer->getKey() );
+	return true;
+}
+
 bool ConnectionServer::broadcast( ClientCommandBase *cmd )
 {
 	if( !( cmd && cmd->isValid() ) )
@@ -123,7 +179,10 @@ bool ConnectionServer::broadcast( ClientCommandBase *cmd )
 			ok = false;
 			continue;
 		}
-		if( !mClients.value(i)->sendCommand( cmd->exactClone() ) )
+		// exactClone() copies only the members of the command class, the device address is in the base
+		ClientCommandBase *clone = cmd->exactClone();
+		clone->setDevice( cmd->getDevice() );
+		if( !mClients.value(i)->sendCommand( clone ) )
 		{
 			error( QtWarningMsg, QString( "Failed to send command (name: %1) to client: %2").arg(cmd->getName(), mClients.at(i)->getID()), "broadcast()" );
 			ok = false;
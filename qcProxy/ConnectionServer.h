@@ -4,6 +4,7 @@
 #include "ErrorHandlerBase.h"
 #include <QString>
 #include <QTcpServer>
+#include <QLocalServer>
 #include <QList>
 
 namespace QtuC
@@ -11,9 +12,13 @@ namespace QtuC
 
 class ClientConnectionManagerBase;
 class ClientCommandBase;
+class DeviceStateVariableBase;
+class SharedStateServer;
 
 /** Class to manage client connections.
-  * As a TCP server, handle incoming connections, store connected clients and do some other server-level activities, such as broadcast a command to all clients.*/
+  * As a TCP server, handle incoming connections, store connected clients and do some other server-level activities, such as broadcast a command to all clients.
+  *	Next to the TCP server, a local server (a Unix domain socket, or a named pipe on Windows) accepts the clients on the same host, with less overhead than the TCP stack.
+  *	Next to TCP, the values of the variables can be shared with the clients on the same host in shared memory, see startSharedState().*/
 class ConnectionServer : public ErrorHandlerBase
 {
 	Q_OBJECT
@@ -37,11 +42,26 @@ public:
 	  * @return The ClientConnectionManagerBase object of the client if clientNumber was a valid one, otherwise return 0.*/
 	ClientConnectionManagerBase* getClient( int clientNumber = 0 );
 
+	/** Get the number of connected clients.
+	  *	@return The number of clients.*/
+	int getClientCount() const;
+
 	/** Start listening.
-	  *	Host and port defined in settings.
-	  *	@return True on success, false otherwise.*/
+	  *	Host and port defined in settings, and the name of the local server, if not empty (`serverSocket/localName`).
+	  *	@return True on success, false otherwise. Failing to listen on the local server is not an error, only TCP is used then.*/
 	bool startListening();
 
+	/** Start sharing the values of the variables with the local clients (see SharedStateServer).
+	  *	The key of the shared memory is advertised in the handshake, so call this before startListening().
+	  *	@param varList The variables, in the order of their ids.
+	  *	@param apiString The deviceAPI string sent to the clients.
+	  *	@return True on success, false otherwise.*/
+	bool startSharedState( const QList<DeviceStateVariableBase*> &varList, const QString &apiString );
+
+	/// Get the shared state server, null if the shared state is not started.
+	SharedStateServer *getSharedStateServer() const
+		{ return mSharedStateServer; }
+
 	/** Send a broadcast command.
 	  *	The passed command will be sent to all clients, then destroyed.
 	  *	@param cmd The command to send.
@@ -59,12 +79,22 @@ private slots:
 	 *	This slot should be connected to QTcpServer::newConnection() signal.*/
 	void handleNewConnection();
 
+	/** Handle incoming local connection.
+	 *	This slot should be connected to QLocalServer::newConnection() signal.*/
+	void handleNewLocalConnection();
+
 	/** Called when a client has disconnected.*/
 	void handleClientDisconnect();
 
 private:
+	/** Create the connection manager of a new client.
+	  *	@param socket The socket of the client.*/
+	void addClient( QIODevice *socket );
+
 	QTcpServer* mTcpServer;	///< Holds the QTcpServer object
+	QLocalServer* mLocalServer;	///< Server of the clients on the same host.
 	QList<ClientConnectionManagerBase*> mClients;	///< The list of connected clients
+	SharedStateServer *mSharedStateServer;	///< Shares the values with the local clients, null if not started.
 
 };
 
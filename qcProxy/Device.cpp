@@ -2,45 +2,13 @@
 
 using namespace QtuC;
 
-Device *Device::mInstance = 0;
-QStringList Device::mHardwareInterfaces = QStringList();
-QStringList Device::mHardwareInterfaceInfo = QStringList();
-QList<QStringList> Device::mFunctions = QList<QStringList>();
-bool Device::mPositiveAck = false;
-QHash<QString,QString> Device::mInfo = QHash<QString,QString>();
-qint64 Device::mStartupTime = 0;
-double Device::mDeviceTimeTicksPerMs = 1000.0;
-
-Device *Device::create(QObject *parent)
-{
-	if( mInstance )
-	{
-		error( QtWarningMsg, "Only one Device insatnce can exist at a time! Use clear() first!", "create()", "Device" );
-		return 0;
-	}
-	mInstance = new Device(parent);
-	return mInstance;
-}
-
-Device *Device::create( const QStringList& hwInterfaceList, const QStringList& hwInterfaceInfoList, const QString & deviceName, QObject *parent )
-{
-	if( mInstance )
-	{
-		error( QtWarningMsg, "Only one Device insatnce can exist at a time! Use clear() first!", "create()", "Device" );
-		return 0;
-	}
-
-	if( hwInterfaceList.isEmpty() )
-	{
-		ErrorHandlerBase::error( QtCriticalMsg, "Cannot create Device with no hardware interface!", "create()", "Device" );
-		return 0;
-	}
-
-	mInstance = new Device( hwInterfaceList, hwInterfaceInfoList, deviceName, parent);
-	return mInstance;
-}
-
-Device::Device( QObject *parent ) : ErrorHandlerBase( parent ), mCreated(false)
+Device::Device( const QString &deviceId, QObject *parent ) :
+	ErrorHandlerBase( parent ),
+	mId(deviceId),
+	mCreated(false),
+	mPositiveAck(false),
+	mStartupTime(0),
+	mDeviceTimeTicksPerMs(1000.0)
 {
 	mInfo.insert( "name", QString() );
 	mInfo.insert( "description", QString() );
@@ -48,67 +16,52 @@ Device::Device( QObject *parent ) : ErrorHandlerBase( parent ), mCreated(false)
 	mInfo.insert( "project", QString() );
 
 	mHardwareInterfaces.append( ":proxy" );
+	mHardwareInterfaceInfo.append( QString() );
 }
 
-Device::Device( const QStringList& hwInterfaceList, const QStringList& hwInterfaceInfoList, const QString & deviceName, QObject *parent ) : ErrorHandlerBase( parent ), mCreated(false)
+bool Device::isValidHwInterface( const QString& hwInterfaceName ) const
 {
-	mHardwareInterfaces = QStringList( hwInterfaceList );
-	mHardwareInterfaceInfo = QStringList( hwInterfaceInfoList );
-
-	mInfo.insert( "name", deviceName );
-	mInfo.insert( "description", QString() );
-	mInfo.insert( "platform", QString() );
-	mInfo.insert( "project", QString() );
-
-	mHardwareInterfaces.append( ":proxy" );
+	return mHardwareInterfaces.contains( hwInterfaceName );
 }
 
-Device* Device::instance()
+const QString Device::getHwInterfaceInfo( const QString& name ) const
 {
-	if( mInstance->isCreated() )
-		{ return 0; }
-	else
-	{
-		error( QtWarningMsg, "Try to access Device instance, but it hasn't been created yet, use create()", "instance()", "Device" );
-		return mInstance;
-	}
+	return mHardwareInterfaceInfo.at( mHardwareInterfaces.indexOf(name) );
 }
 
-Device* Device::swap(Device *newDevice)
+const QString Device::getInfo(const QString &key) const
 {
-	Device* oldInstance = mInstance;
-	mInstance = newDevice;
-	return oldInstance;
+	return mInfo.value( key, QString() );
 }
 
-bool Device::isValidHwInterface( const QString& hwInterfaceName )
+const QString Device::getDescription() const
 {
-	return mHardwareInterfaces.contains( hwInterfaceName );
+	return mInfo.value( "description" );
 }
 
-const QString Device::getHwInterfaceInfo( const QString& name )
+const QString Device::getPlatform() const
 {
-	return mHardwareInterfaceInfo.at( mHardwareInterfaces.indexOf(name) );
+	return mInfo.value( "platform" );
 }
 
-const QString Device::getInfo(const QString &key)
+const QString Device::getProject() const
 {
-	return mInfo.value( key, QString() );
+	return mInfo.value( "project" );
 }
 
-const QString Device::getDescription()
+int Device::getBatchMaxLength() const
 {
-	return mInfo.value( "description" );
+	return mInfo.value( "batch" ).toInt();
 }
 
-const QString Device::getPlatform()
+int Device::getBinaryIdCount() const
 {
-	return mInfo.value( "platform" );
+	return mInfo.value( "binary" ).toInt();
 }
 
-const QString Device::getProject()
+int Device::getRxBufferSize() const
 {
-	return mInfo.value( "project" );
+	return mInfo.value( "rxBuffer" ).toInt();
 }
 
 void Device::clear()
@@ -120,8 +73,6 @@ void Device::clear()
 	mInfo.clear();
 	mPositiveAck = false;
 	mCreated = false;
-	mInstance->deleteLater();
-	mInstance = 0;
 	mStartupTime = 0;
 }
 
@@ -145,7 +96,7 @@ const QString Device::messageTypeToString(deviceMessageType_t msgType)
 	}
 }
 
-const QString Device::getName()
+const QString Device::getName() const
 {
 	return mInfo.value( "name" );
 }
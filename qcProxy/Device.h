@@ -21,84 +21,67 @@ enum deviceMessageType_t
 };
 
 /** Device class.
- *	Device info class, storing the Device parameters as static members, and contains a singleton object which can be made immutable with setCreated(). <br>
- *	Before using this class, you must call it's create() method.
+ *	Device info class, storing the parameters of one device. The proxy can serve more devices, each DeviceAPI owns its own Device object, identified by getId(). <br>
  *	The device should not be modified after it's been created and all the parameters were set. <br>
  *	@par How to use
- *	First create the Device object with create(), then set all necessary params (you can use the slots of the Device singleton), and finally call setCreated().
- *	After calling setCreated(), the Device singleton object cannot be reached, (unless a its pointer was saved previously), only the static getters are usable, or swap().
- *	With swap() you can set the Device singleton to a new object (without changing the static members), which is still mutable, until setCreated() is called.*/
+ *	First create the Device object, then set all necessary params (you can use the slots), and finally call setCreated().
+ *	After calling setCreated(), the setters do nothing, only the getters are usable, until setCreated(false) unlocks the Device again.*/
 class Device : public ErrorHandlerBase
 {
 	Q_OBJECT
 public:
 
-	/** Create an empty Device singleton.
-	 *	Can only be called if no instance exists yet. Use clear() to delete the current.
-	 *	@return The new Device instance.*/
-	static Device *create( QObject *parent );
-
-	/** Create the Device singleton.
-	 *	Can only be called if no instance exists yet. Use clear() to delete the current.
-	 *	@param hwInterfaceList A QStringList of the valid hardware interfaces.
-	 *	@param hwInterfaceInfoList Info strings for the hardware interfaces.
-	 *	@param deviceName Name of the device. (ASCII, max 50 char).
-	 *	@return The new Device instance.*/
-	static Device *create( const QStringList& hwInterfaceList, const QStringList& hwInterfaceInfoList, const QString & deviceName, QObject *parent );
-
-	/** Get Device instance.
-	  *	You can only get the pointer, if setCreated() hasn't been called yet.
-	  *	@return Pointer to the Device singleton, or 0 if it is already initialized.*/
-	static Device *instance();
-
-	/** Swap the Device singleton for the passed Device object.
-	  *	Leave the static members, and swap the device singleton object only.
-	  * The new Device object (and so all static member of the class) will be modifiable until setCreated() is called on it.
-	  *	Think twice before you use this!
-	  *	@param newDevice The new Device singleton.*/
-	Device* swap( Device *newDevice );
+	/** Create an empty Device.
+	 *	@param deviceId Id of the device, as the clients address it (see ProxySettingsManager::getDeviceIds()). Empty for the single device of the proxy.
+	 *	@param parent Parent object.*/
+	Device( const QString &deviceId, QObject *parent = 0 );
+
+	/** Get the id of the device.
+	  *	@return The id, empty for the single device of the proxy.*/
+	const QString getId() const
+		{ return mId; }
 
 	/** Get if hardware interface exists and is valid.
 	  *	@param hwInterfaceName Name of the hardware interface.
 	  *	@return True if hardware interface exists and is valid, false otherwise.*/
-	static bool isValidHwInterface( const QString& hwInterfaceName );
+	bool isValidHwInterface( const QString& hwInterfaceName ) const;
 
 	/** Get info about a hardware interface.
 	  *	@param hwInterfaceName Name of the hardware interface.
 	  *	@return The info param of the hardware interface.*/
-	static const QString getHwInterfaceInfo( const QString& hwInterfaceName );
+	const QString getHwInterfaceInfo( const QString& hwInterfaceName ) const;
 
 	/** Get device information.
 	  *	Returns valid value only after the device handshake has happened. Before that, this returns the values in the deviceAPI.
 	  *	@param key Name of the information.
 	  *	@return The requested device information.*/
-	static const QString getInfo( const QString & key );
+	const QString getInfo( const QString & key ) const;
 
 	/** Get device information list.
 	  *	Returns valid value only after the device handshake has happened. Before that, this returns the values in the deviceAPI.
 	  *	@return The list of current device informations.*/
-	static const QHash<QString,QString> getInfoList()
+	const QHash<QString,QString> getInfoList() const
 		{ return mInfo; }
 
 	/** Get the device name.
 	 *	Returns valid value only after the device handshake has happened. Before that, this returns the values in the deviceAPI.
 	 *	@return The device name.*/
-	static const QString getName();
+	const QString getName() const;
 
 	/** Get the device description.
 	 *	Returns valid value only after the device handshake has happened. Before that, this returns the values in the deviceAPI.
 	 *	@return The device description 8if exists, empty string otherwise.*/
-	static const QString getDescription();
+	const QString getDescription() const;
 
 	/** Get the device platform.
 	 *	Returns valid value only after the device handshake has happened. Before that, this returns the values in the deviceAPI.
 	 *	@return The device platform if exists, empty string otherwise.*/
-	static const QString getPlatform();
+	const QString getPlatform() const;
 
 	/** Get the device project.
 	 *	Returns valid value only after the device handshake has happened. Before that, this returns the values in the deviceAPI.
 	 *	@return The device project if exists, empty string otherwise.*/
-	static const QString getProject();
+	const QString getProject() const;
 
 	/** Get device connection status. Will be true only after a successful handshake.
 	 *	@return COnnection status: true if connected, false if not or an error happened.*/
@@ -109,32 +92,47 @@ public:
 	*	Ideally this is set based on the device timestamp parsed from the device greeting message.
 	*	If the device doesn't use timekeeping, it should be set to the arrival time of the first device command.
 	  *	@return Startup timestamp.*/
-	static inline qint64 getStartupTime()
+	qint64 getStartupTime() const
 		{ return mStartupTime; }
 
 	/** Set whether the device uses positive acknowledge to verify received commands.
 	  *	@return True if device uses poitive acknowledge, false if not.*/
-	static bool positiveAck()
+	bool positiveAck() const
 		{ return mPositiveAck; }
 
+	/** Get the maximum length of a batched command (`mget`, `mset`) the device accepts.
+	  *	The device advertises it with the `batch` parameter of the greeting.
+	  *	@return The maximum length of the command without the line end, or 0 if the device doesn't support batched commands.*/
+	int getBatchMaxLength() const;
+
+	/** Get the number of variable ids the device accepts on the binary protocol.
+	  *	The device advertises it with the `binary` parameter of the greeting.
+	  *	@return The number of ids, or 0 if the device doesn't support the binary protocol.*/
+	int getBinaryIdCount() const;
+
+	/** Get the size of the command receive buffer of the device.
+	  *	The device advertises it with the `rxBuffer` parameter of the greeting. A device with this parameter supports flow control (see DeviceConnectionManagerBase::startFlowControl()).
+	  *	@return The number of bytes the device can buffer, or 0 if the device doesn't support flow control.*/
+	int getRxBufferSize() const;
+
 	/** Get device time resolution (tick per millisecond).
 	  *	@return Device time resolution (tick per millisecond).*/
-	static double getDeviceTimeTicksPerMs()
+	double getDeviceTimeTicksPerMs() const
 		{ return mDeviceTimeTicksPerMs; }
 
 	/** Get if device instance was created.
-	  *	If device is created, th device instance cannot be reached, only swapped with swap().
+	  *	If device is created, the setters do nothing.
 	  *	@return True if the device has already been created, false otherwise.*/
-	bool isCreated()
+	bool isCreated() const
 		{ return mCreated; }
 
 	/** Mark device as created.
-	  *	After this function call, the device singleton cannot be reached or modified, only the static getters will work.*/
+	  *	After this function call, the device cannot be modified, only the getters will work.*/
 	void setCreated( bool created = true )
 		{ mCreated = created; }
 
 	/** Clear Device.
-	  *	Delete all info and data, the static members and the singleton object as well..
+	  *	Delete all info and data, and unlock the Device.
 	  *	@warning Think twice before you use this...*/
 	void clear();
 
@@ -217,52 +215,37 @@ public slots:
 	  *	Conversion is based on mDeviceTimeTicksPerMs, which is read from the configuration file.
 	  *	@param deviceTimeStamp The device timestamp.
 	  *	@return The device timestamp converted to millisec resolution.*/
-	static quint32 timeStampToMs( quint64 const &deviceTimeStamp )
+	quint32 timeStampToMs( quint64 const &deviceTimeStamp ) const
 		{ return (quint32)( deviceTimeStamp / mDeviceTimeTicksPerMs + 0.5 ); }
 
 	/** Convert device timestamp to a stabdard UNIX timestamp.
 	  *	Conversion is based on mDeviceTimeTicksPerMs, which is read from the configuration file, and mStartupTime
 	  *	@param deviceTimeStamp The device timestamp.
 	  *	@return The UNIX timestamp.*/
-	static qint64 timeStampToUnix( quint64 const &deviceTimeStamp )
+	qint64 timeStampToUnix( quint64 const &deviceTimeStamp ) const
 		{ return mStartupTime + timeStampToMs(deviceTimeStamp); }
 
 private:
 
-	/** Private constructor.
-	 *	Use the static overloaded function create().
-	 *	This will clear all existing static device data! Use swap() to replace only the Device object, and leave the static params.
-	 *	The Device must have a QObject parent.*/
-	Device( QObject *parent );
-
-	/** Create the Device object.
-	 *	Use the static overloaded function create().
-	 *	This will clear all existing static device data! Use swap() to replace only the Device object, and leave the static params.
-	 *	@param hwInterfaceList A QStringList of the valid hardware interfaces.
-	 *	@param hwInterfaceInfoList Info strings for the hardware interfaces.
-	 *	@param deviceName Name of the device. (ASCII, max 50 char)*/
-	Device( const QStringList& hwInterfaceList, const QStringList& hwInterfaceInfoList, const QString & deviceName, QObject *parent = 0 );
-
-	static Device *mInstance;	///< Pointer to the Device singleton.
+	QString mId;	///< Id of the device.
 	bool mCreated;	///< After the Device is created, it cannot be modified.
-	static QStringList mHardwareInterfaces;	///< List of the valid hardware interfaces.
-	static QStringList mHardwareInterfaceInfo;	///< List of hardware interface informations.
-	static QList<QStringList> mFunctions;		///< Device function list.
-	static bool mPositiveAck;	///< Whether the device uses positive acknowledge to verify received commands.
-	static QHash<QString,QString> mInfo;	///< Several device information, parsed from deviceAPI.
+	QStringList mHardwareInterfaces;	///< List of the valid hardware interfaces.
+	QStringList mHardwareInterfaceInfo;	///< List of hardware interface informations.
+	QList<QStringList> mFunctions;		///< Device function list.
+	bool mPositiveAck;	///< Whether the device uses positive acknowledge to verify received commands.
+	QHash<QString,QString> mInfo;	///< Several device information, parsed from deviceAPI.
 
 	/** Timestamp of the device startup.
 	*	This timestamp is a UNIX timestamp, so it has millisec resolution.
 	*	Ideally this is set based on the device timestamp parsed from the device greeting message.
 	*	If the device doesn't use timekeeping, this will be set to the arrival time of the first device command.*/
-	static qint64 mStartupTime;
+	qint64 mStartupTime;
 
 	/** Device time resolution.
 	  *	Resolution is given in tick / millisecond.
 	  *	For example if the device timekeeping is microsecond based, this value should be 1000.*/
-	static double mDeviceTimeTicksPerMs;
+	double mDeviceTimeTicksPerMs;
 };
 
 }	//QtuC::
 #endif //DEVICE_H
-
@@ -2,41 +2,54 @@
 #include "DeviceCommand.h"
 #include "SerialDeviceConnector.h"
 #include "DummySocketDevice.h"
+#include "ReplayDeviceConnector.h"
+#include "SimulatedDeviceConnector.h"
+#include "RelayDeviceConnector.h"
 #include "DeviceAPIFileHandler.h"
 #include "ProxySettingsManager.h"
+#include "ProxyMetrics.h"
 #include <QDateTime>
 
 using namespace QtuC;
 
-DeviceAPI::DeviceAPI( QObject *parent ) :
+DeviceAPI::DeviceAPI( const QString &deviceId, QObject *parent ) :
 	ErrorHandlerBase(parent),
+	mDeviceLink(0),
+	mScheduler(0),
+	mCommandRecorder(0),
 	mEmitAllCmd(false),
+	mDeviceStreamsEnabled(false),
 	mReceivedDeviceCommandCounter(0)
 {
-	mStateManager = new DeviceStateManager(this);
+	mDeviceInstance = new Device( deviceId, this );
+	mStateManager = new DeviceStateManager( mDeviceInstance, this );
 	mDeviceAPI = new DeviceAPIFileHandler(this);
-	mDeviceInstance = Device::create(this);
-
-	mDeviceLink = new SerialDeviceConnector(this);
-	//mDeviceLink = new DummySocketDevice(this);
+	mRequestTracker = new DeviceRequestTracker( deviceId, this );
+	connect( mRequestTracker, SIGNAL(healthChanged(DeviceRequestTracker::health_t)), this, SLOT(handleDeviceHealthChange(DeviceRequestTracker::health_t)) );
 
 	// set device command separator
 	DeviceCommand::setSeparator( ProxySettingsManager::instance()->value( "device/commandSeparator" ).toChar() );
 
 	// set Device Time resolution
 	bool ok;
-	mDeviceInstance->setDeviceTimeTicksPerMs( ProxySettingsManager::instance()->value( "device/timeTicksPerMs" ).toDouble(&ok) );
+	mDeviceInstance->setDeviceTimeTicksPerMs( ProxySettingsManager::instance()->deviceValue( deviceId, "device/timeTicksPerMs" ).toDouble(&ok) );
 	if( !ok )
-		{ error( QtWarningMsg, QString("Invalid value in config file for device/timeTicksPerMs, fallback to default(%1)").arg(QString::number(Device::getDeviceTimeTicksPerMs())), "DeviceAPI()" ); }
+		{ error( QtWarningMsg, QString("Invalid value in config file for device/timeTicksPerMs, fallback to default(%1)").arg(QString::number(mDeviceInstance->getDeviceTimeTicksPerMs())), "DeviceAPI()" ); }
 	else
-		{ debug( debugLevelVerbose, QString("Device time resolution set to %1 ticks / ms").arg( QString::number(Device::getDeviceTimeTicksPerMs()) ), "DeviceAPI()" ); }
+		{ debug( debugLevelVerbose, QString("Device time resolution set to %1 ticks / ms").arg( QString::number(mDeviceInstance->getDeviceTimeTicksPerMs()) ), "DeviceAPI()" ); }
 
 	connect( mStateManager, SIGNAL(stateVariableUpdateRequest(DeviceStateProxyVariable*)), this, SLOT(handleStateVariableUpdateRequest(DeviceStateProxyVariable*)) );
 	connect( mStateManager, SIGNAL(stateVariableSendRequest(DeviceStateProxyVariable*)), this, SLOT(handleStateVariableSendRequest(DeviceStateProxyVariable*)) );
+	connect( mStateManager, SIGNAL(stateVariableStreamRequest(DeviceStateProxyVariable*,quint32)), this, SLOT(handleStateVariableStreamRequest(DeviceStateProxyVariable*,quint32)) );
 }
 
 bool DeviceAPI::call( const QString &hwInterface, const QString &function, const QString &arg )
 {
+	if( !mDeviceInstance->isValidHwInterface( hwInterface ) )
+	{
+		error( QtWarningMsg, QString("Invalid (non-existent) hardware interface '%1', command is ignored.").arg(hwInterface), "call()" );
+		return false;
+	}
 	DeviceCommand *dCmd = new DeviceCommand();
 	dCmd->setType( deviceCmdCall );
 	if( !dCmd->setInterface( hwInterface ) )
@@ -52,7 +65,7 @@ bool DeviceAPI::call( const QString &hwInterface, const QString &function, const
 		dCmd->deleteLater();
 		return false;
 	}
-	if( !mDeviceLink->sendCommand( dCmd ) )
+	if( !mScheduler->schedule( dCmd, DeviceCommandScheduler::priorityControl ) )
 	{
 		error( QtWarningMsg, "Device function call failed", "call()" );
 		return false;
@@ -73,6 +86,14 @@ DeviceStateVariableBase *DeviceAPI::getVar( const QString &hwInterface, const QS
 	return var;
 }
 
+DeviceStateProxyVariable *DeviceAPI::getCommandVar( DeviceCommand *cmd )
+{
+	// the binary ids are assigned from the variable list in requestBinaryProtocol(), so the id is the index of the variable
+	if( cmd->getVarId() >= 0 )
+		{ return (DeviceStateProxyVariable*)mStateManager->getVar( cmd->getVarId() ); }
+	return (DeviceStateProxyVariable*)mStateManager->getVar( cmd->getHwInterface(), cmd->getVariable() );
+}
+
 QList<DeviceStateVariableBase*> DeviceAPI::getVarList(const QString &hardwareInterface)
 {
 	return mStateManager->getVarList( hardwareInterface );
@@ -80,13 +101,19 @@ QList<DeviceStateVariableBase*> DeviceAPI::getVarList(const QString &hardwareInt
 
 bool DeviceAPI::update( const QString &hwInterface, const QString &varName )
 {
-	return handleStateVariableUpdateRequest( (DeviceStateProxyVariable*)getVar( hwInterface, varName ) );
+	DeviceStateProxyVariable *var = (DeviceStateProxyVariable*)getVar( hwInterface, varName );
+	if( !var )
+		{ return false; }
+	return requestUpdate( var, DeviceCommandScheduler::priorityInteractive );
 }
 
 bool DeviceAPI::command(DeviceCommand *cmd)
 {
 	if( cmd->isValid() )
-		{ return mDeviceLink->sendCommand( cmd ); }
+	{
+		mScheduler->flush();
+		return mDeviceLink->sendCommand( cmd );
+	}
 	else
 	{
 		error( QtWarningMsg, "Invalid command", "command()" );
@@ -96,14 +123,14 @@ bool DeviceAPI::command(DeviceCommand *cmd)
 
 bool DeviceAPI::set( const QString &hwInterface, const QString &varName, const QString &newVal )
 {/// @todo QVariant version of this func? Also: QVariant.toString is not an elegant solution... somehow a static deviceformatter function?
-	if( Device::positiveAck() )
+	if( mDeviceInstance->positiveAck() )
 	{
 		DeviceCommand *cmd = new DeviceCommand();
 		cmd->setType( deviceCmdSet);
 		cmd->setInterface( hwInterface );
 		cmd->setVariable( varName );
 		cmd->setArgumentString( newVal );
-		if( !mDeviceLink->sendCommand( cmd ) )
+		if( !sendVariableCommand( cmd, DeviceCommandScheduler::priorityInteractive ) )
 		{
 			errorDetails_t errDet;
 			errDet.insert( "posAck", "true");
@@ -145,10 +172,19 @@ bool DeviceAPI::initAPI( const QString &apiDefString )
 		return false;
 	}
 
-	if( !apiDefString.isEmpty() )
+	// command line arguments are parsed by now, the device link can be created
+	if( !mDeviceLink )
+		{ createDeviceLink(); }
+
+	// a relay takes the deviceAPI of the upstream proxy
+	QString apiString = apiDefString;
+	if( apiString.isEmpty() )
+		{ apiString = mDeviceLink->fetchDeviceApi(); }
+
+	if( !apiString.isEmpty() )
 	{
 		// Connect nothing on first pass, only if API is successfully parsed
-		if( !mDeviceAPI->parseAPI(apiDefString) )
+		if( !mDeviceAPI->parseAPI(apiString) )
 		{
 			error( QtCriticalMsg, "Failed to parse deviceAPI string", "initAPI()" );
 			return false;
@@ -159,7 +195,7 @@ bool DeviceAPI::initAPI( const QString &apiDefString )
 			connect( mDeviceAPI, SIGNAL(newHardwareInterface(QString,QString)), mDeviceInstance, SLOT(addHardwareInterface(QString,QString)) );
 			connect( mDeviceAPI, SIGNAL(newStateVariable(QHash<QString,QString>)), mStateManager, SLOT(registerNewStateVariable(QHash<QString,QString>)) );
 			connect( mDeviceAPI, SIGNAL(newDeviceFunction(QString,QString,QString)), mDeviceInstance, SLOT(addFunction(QString,QString,QString)) );
-			if( !mDeviceAPI->parseAPI(apiDefString) )
+			if( !mDeviceAPI->parseAPI(apiString) )
 			{
 				error( QtCriticalMsg, "Failed to re-parse deviceAPI string", "initAPI()" );
 				return false;
@@ -170,7 +206,7 @@ bool DeviceAPI::initAPI( const QString &apiDefString )
 	else
 	{
 		// Connect nothing on first pass, only if API is successfully parsed
-		if( !mDeviceAPI->load() )
+		if( !mDeviceAPI->load( ProxySettingsManager::instance()->deviceValue( getId(), "apiFilePath" ).toString() ) )
 		{
 			error( QtCriticalMsg, "Failed to pre-load deviceAPI", "initAPI()" );
 			return false;
@@ -190,7 +226,10 @@ bool DeviceAPI::initAPI( const QString &apiDefString )
 		}
 	}
 
-	debug( debugLevelInfo, "deviceAPI loaded, Device created", "initAPI()" );
+	if( getId().isEmpty() )
+		{ debug( debugLevelInfo, "deviceAPI loaded, Device created", "initAPI()" ); }
+	else
+		{ debug( debugLevelInfo, QString("deviceAPI loaded, Device %1 created").arg(getId()), "initAPI()" ); }
 
 	// === Connect to device ================
 
@@ -200,10 +239,65 @@ bool DeviceAPI::initAPI( const QString &apiDefString )
 		error( QtCriticalMsg, "Failed to connect to device", "initAPI()" );
 		return false;
 	}
+	mDeviceStreamsEnabled = true;
+	requestFlowControl();
+	requestBinaryProtocol();
+	requestDeviceStreams();
 
 	return true;
 }
 
+void DeviceAPI::createDeviceLink()
+{
+	// command line overrides settings, a replay file (argument or setting) implies the replay connector
+	// the command line only applies to the default device
+	ProxySettingsManager *settings = ProxySettingsManager::instance();
+	QString connectorName = settings->getDeviceCmdArgValue( getId(), ProxySettingsManager::cmdArgConnector ).toString();
+	if( connectorName.isEmpty() && ( !settings->getDeviceCmdArgValue( getId(), ProxySettingsManager::cmdArgReplay ).toString().isEmpty() || !settings->deviceValue( getId(), "deviceReplay/path" ).toString().isEmpty() ) )
+		{ connectorName = "replay"; }
+	if( connectorName.isEmpty() )
+		{ connectorName = settings->deviceValue( getId(), "device/connector" ).toString(); }
+
+	if( connectorName == "simulated" )
+		{ mDeviceLink = new SimulatedDeviceConnector( mDeviceInstance, mStateManager, this ); }
+	else if( connectorName == "replay" )
+		{ mDeviceLink = new ReplayDeviceConnector( mDeviceInstance, this ); }
+	else if( connectorName == "dummySocket" )
+		{ mDeviceLink = new DummySocketDevice( mDeviceInstance, this ); }
+	else if( connectorName == "relay" )
+		{ mDeviceLink = new RelayDeviceConnector( mDeviceInstance, mStateManager, this ); }
+	else
+	{
+		if( connectorName != "serial" )
+			{ error( QtWarningMsg, QString("Unknown device connector '%1', fallback to serial").arg(connectorName), "createDeviceLink()" ); }
+		mDeviceLink = new SerialDeviceConnector( mDeviceInstance, this );
+	}
+	debug( debugLevelVerbose, QString("Device connector: %1").arg(connectorName), "createDeviceLink()" );
+	mScheduler = new DeviceCommandScheduler( mDeviceLink, this );
+	connect( mScheduler, SIGNAL(commandSent(const DeviceCommand*)), mRequestTracker, SLOT(handleSent(const DeviceCommand*)) );
+
+	// record device commands, if requested
+	QString recordPath = settings->getDeviceCmdArgValue( getId(), ProxySettingsManager::cmdArgRecord ).toString();
+	if( recordPath.isEmpty() )
+		{ recordPath = settings->deviceValue( getId(), "deviceRecord/path" ).toString(); }
+	if( !recordPath.isEmpty() )
+	{
+		mCommandRecorder = new DeviceCommandRecorder(this);
+		if( !mCommandRecorder->open( recordPath ) )
+		{
+			delete mCommandRecorder;
+			mCommandRecorder = 0;
+		}
+	}
+}
+
+qint64 DeviceAPI::getPendingByteCount() const
+{
+	if( !mDeviceLink )
+		{ return 0; }
+	return mDeviceLink->getPendingByteCount();
+}
+
 bool DeviceAPI::reInitAPI( const QString &apiDefString )
 {
 	debug( debugLevelInfo, "reinitAPI() is not implemented yet. Do nothing.", "reInitAPI()" );
@@ -214,6 +308,7 @@ bool DeviceAPI::reInitAPI( const QString &apiDefString )
 	// Stop everithing, or delete everything (timers, autoupdates, subscriptions....
 	// reinit StateManager, stateVars
 	// reparse API, file
+	mDeviceStreamsEnabled = false;
 	mDeviceLink->closeDevice();
 
 	Device *oldDevice = mDeviceInstance;
@@ -238,7 +333,7 @@ void DeviceAPI::handleDeviceGreeting( DeviceCommand *greetingCmd )
 	if( greetingCmd->hasArg() )
 	{
 		QHash<QString,QString> greetingInfoList;
-		QHash<QString,QString> deviceInfoList = Device::getInfoList();
+		QHash<QString,QString> deviceInfoList = mDeviceInstance->getInfoList();
 		QString greetingMsg;
 
 		QStringList argList = greetingCmd->getArgList();
@@ -252,6 +347,14 @@ void DeviceAPI::handleDeviceGreeting( DeviceCommand *greetingCmd )
 				{ greetingInfoList.insert( key, val ); }
 		}
 
+		// a device without batched commands doesn't advertise it, the support of a previous device must not remain
+		if( !greetingInfoList.contains("batch") && deviceInfoList.contains("batch") )
+			{ greetingInfoList.insert( "batch", "0" ); }
+		if( !greetingInfoList.contains("binary") && deviceInfoList.contains("binary") )
+			{ greetingInfoList.insert( "binary", "0" ); }
+		if( !greetingInfoList.contains("rxBuffer") && deviceInfoList.contains("rxBuffer") )
+			{ greetingInfoList.insert( "rxBuffer", "0" ); }
+
 		/// @todo This should reach the clients as well!
 		if( !greetingMsg.isEmpty() )
 			{ debug( debugLevelInfo, QString("Device greeting received: %1").arg( greetingMsg ), "handleDeviceGreeting()" ); }
@@ -305,13 +408,19 @@ void DeviceAPI::handleDeviceGreeting( DeviceCommand *greetingCmd )
 		if( greetingCmd->hasTimestamp() )
 		{
 			mDeviceInstance->setCreated( false );
-			mDeviceInstance->setStartupTime( QDateTime::currentMSecsSinceEpoch() - Device::timeStampToMs(greetingCmd->getTimestamp()) );
+			mDeviceInstance->setStartupTime( QDateTime::currentMSecsSinceEpoch() - mDeviceInstance->timeStampToMs(greetingCmd->getTimestamp()) );
 			mDeviceInstance->setCreated();
 		}
 	}
 	else /// @todo This should reach the clients as well!
 		{ debug( debugLevelInfo, "Device greeting received (empty greeting)", "handleDeviceGreeting()" ); }
 
+	// the device has (re)started, the outstanding gets are lost, the flow control, the binary protocol and the streams must be requested again
+	mRequestTracker->clear();
+	requestFlowControl();
+	requestBinaryProtocol();
+	requestDeviceStreams();
+
 	emit greetingReceived();
 
 	greetingCmd->deleteLater();
@@ -321,19 +430,24 @@ void DeviceAPI::handleDeviceCommand( DeviceCommand *cmd )
 {
 	++mReceivedDeviceCommandCounter;
 
+	if( mCommandRecorder )
+		{ mCommandRecorder->record( cmd ); }
+
 	if( mEmitAllCmd && !( cmd->getType() == deviceCmdCall && cmd->getHwInterface() == ":proxy" && cmd->getVariable() == "greeting" ) )
 	{
+		stampDeviceTime( cmd );
+		cmd->stampTrace( LatencyTrace::traceStageApi );
 		emit commandReceived( cmd );
 		return;
 	}
 
 	// If this is the first command, try to set device startup time
 	// this should run, even if this is a greeting message (handleDeviceGreeting() only sets startupTime if the greeting has a timestamp)
-	if( mReceivedDeviceCommandCounter == 1 && !Device::getStartupTime() )
+	if( mReceivedDeviceCommandCounter == 1 && !mDeviceInstance->getStartupTime() )
 	{
 		qint64 startupTime = 0;
 		if( cmd->hasTimestamp() )	// if command has timestamp, use it
-			{ startupTime = QDateTime::currentMSecsSinceEpoch() - Device::timeStampToMs(cmd->getTimestamp()); }
+			{ startupTime = QDateTime::currentMSecsSinceEpoch() - mDeviceInstance->timeStampToMs(cmd->getTimestamp()); }
 		else	// otherwise device startup time will be the current time
 			{ startupTime = QDateTime::currentMSecsSinceEpoch(); }
 
@@ -342,6 +456,8 @@ void DeviceAPI::handleDeviceCommand( DeviceCommand *cmd )
 		mDeviceInstance->setCreated();
 	}
 
+	stampDeviceTime( cmd );
+
 	if( cmd->getType() == deviceCmdCall )
 	{
 		if( cmd->getHwInterface() == ":proxy" )
@@ -365,22 +481,35 @@ void DeviceAPI::handleDeviceCommand( DeviceCommand *cmd )
 	{
 		if( cmd->getType() == deviceCmdGet )
 		{
-			DeviceCommand *setCmd = DeviceCommand::fromVariable( deviceCmdSet, (DeviceStateProxyVariable*)mStateManager->getVar( cmd->getHwInterface(), cmd->getVariable() ) );
-			if( !mDeviceLink->sendCommand( setCmd ) )
+			DeviceCommand *setCmd = DeviceCommand::fromVariable( deviceCmdSet, getCommandVar( cmd ) );
+			if( !sendVariableCommand( setCmd, DeviceCommandScheduler::priorityInteractive ) )
 				{ error( QtWarningMsg, "Failed to reply to device get", "handleDeviceCommand()" ); }
 		}
 		else if( cmd->getType() == deviceCmdSet )
 		{
-			DeviceStateProxyVariable *var = (DeviceStateProxyVariable*)mStateManager->getVar( cmd->getHwInterface(), cmd->getVariable() );
+			DeviceStateProxyVariable *var = getCommandVar( cmd );
 
 			qint64 updateTime = 0;
 			if( cmd->hasTimestamp() )	// if command has timestamp, use it
-				{ updateTime = Device::timeStampToUnix(cmd->getTimestamp()); }
+				{ updateTime = mDeviceInstance->timeStampToUnix(cmd->getTimestamp()); }
 			else
 				{ updateTime = QDateTime::currentMSecsSinceEpoch(); }
 
 			if( var )
-				{ var->updateFromDevice( cmd->getArg(), updateTime ); }
+			{
+				mRequestTracker->handleReply( var->getHwInterface(), var->getName() );
+				if( mDeviceLink->carriesUserValues() )
+					{ var->updateFromUpstream( cmd->getArg(), updateTime ); }
+				else
+					{ var->updateFromDevice( cmd->getArg(), updateTime ); }
+				ProxyMetrics::instance()->countStateUpdate();
+				if( cmd->hasTrace() )
+				{
+					// the trace waits in the variable for the next subscription feed
+					cmd->stampTrace( LatencyTrace::traceStageApi );
+					var->setTrace( cmd->getTrace() );
+				}
+			}
 			else
 				{ error( QtWarningMsg, QString("Failed to set variable from device, no such variable (hwI: %1, name: %2)").arg(cmd->getHwInterface(),cmd->getVariable()), "handleDeviceCommand()" ); }
 		}
@@ -390,9 +519,18 @@ void DeviceAPI::handleDeviceCommand( DeviceCommand *cmd )
 	}
 }
 
+void DeviceAPI::stampDeviceTime( DeviceCommand *cmd )
+{
+	if( cmd->hasTrace() && cmd->hasTimestamp() && mDeviceInstance->getStartupTime() )
+		{ cmd->stampTrace( LatencyTrace::traceStageDevice, (quint64)mDeviceInstance->timeStampToUnix( cmd->getTimestamp() ) * 1000 ); }
+}
+
 bool DeviceAPI::handleStateVariableUpdateRequest(DeviceStateProxyVariable *stateVar)
 {
-	if( !mDeviceLink->sendCommand( DeviceCommand::fromVariable( deviceCmdGet, stateVar ) ) )
+	// the upstream proxy feeds every variable, polling it would only duplicate the feed
+	if( mDeviceLink->carriesUserValues() )
+		{ return true; }
+	if( !requestUpdate( stateVar, DeviceCommandScheduler::priorityBackground ) )
 	{
 		error( QtWarningMsg, QString("Failed to update stateVar: %1").arg(stateVar->getName()), "handleStateVariableUpdateRequest()" );
 		return false;
@@ -400,8 +538,103 @@ bool DeviceAPI::handleStateVariableUpdateRequest(DeviceStateProxyVariable *state
 	return true;
 }
 
+bool DeviceAPI::requestUpdate( DeviceStateProxyVariable *stateVar, DeviceCommandScheduler::priority_t priority )
+{
+	// the reply of the outstanding get will update the variable
+	if( mRequestTracker->isOutstanding( stateVar->getHwInterface(), stateVar->getName() ) )
+		{ return true; }
+	if( !sendVariableCommand( DeviceCommand::fromVariable( deviceCmdGet, stateVar ), priority ) )
+		{ return false; }
+	mRequestTracker->addRequest( stateVar->getHwInterface(), stateVar->getName() );
+	return true;
+}
+
+void DeviceAPI::handleDeviceHealthChange( DeviceRequestTracker::health_t health )
+{
+	QString msg = QString("Device connection health: %1").arg( DeviceRequestTracker::healthToString(health) );
+	if( health == DeviceRequestTracker::healthStalled || health == DeviceRequestTracker::healthDegraded )
+		{ error( QtWarningMsg, msg + QString(", %1 gets timed out so far").arg(QString::number(mRequestTracker->getTimeoutCount())), "handleDeviceHealthChange()" ); }
+	else
+		{ debug( debugLevelInfo, msg, "handleDeviceHealthChange()" ); }
+}
+
 void DeviceAPI::handleStateVariableSendRequest(DeviceStateProxyVariable *stateVar)
 {
-	if( !mDeviceLink->sendCommand( DeviceCommand::fromVariable( deviceCmdSet, stateVar ) ) )
+	if( !sendVariableCommand( DeviceCommand::fromVariable( deviceCmdSet, stateVar ), DeviceCommandScheduler::priorityInteractive ) )
 		{ error( QtWarningMsg, QString("Failed to send %1:%2 to device").arg(stateVar->getHwInterface(),stateVar->getName()), "handleSetVariableSendRequest()" ); }
 }
+
+bool DeviceAPI::sendVariableCommand( DeviceCommand *cmd, DeviceCommandScheduler::priority_t priority )
+{
+	if( !cmd )
+		{ return false; }
+	return mScheduler->schedule( cmd, priority );
+}
+
+void DeviceAPI::handleStateVariableStreamRequest( DeviceStateProxyVariable *stateVar, quint32 intervalMs )
+{
+	if( mDeviceStreamsEnabled )
+		{ sendStreamCall( stateVar, intervalMs ); }
+}
+
+void DeviceAPI::requestDeviceStreams()
+{
+	if( !mDeviceStreamsEnabled )
+		{ return; }
+
+	QList<DeviceStateVariableBase*> varList = mStateManager->getVarList();
+	QList<DeviceStateProxyVariable*> pushVarList;
+	for( int i=0; i<varList.size(); ++i )
+	{
+		DeviceStateProxyVariable *var = (DeviceStateProxyVariable*)varList.at(i);
+		if( var->getAutoUpdateMode() == DeviceStateProxyVariable::autoUpdatePush && var->isAutoUpdateActive() )
+			{ pushVarList.append( var ); }
+	}
+	if( pushVarList.isEmpty() )
+		{ return; }
+
+	call( ":proxy", "streamClear", QString() );
+	for( int i=0; i<pushVarList.size(); ++i )
+		{ sendStreamCall( pushVarList.at(i), pushVarList.at(i)->getAutoUpdateInterval() ); }
+	debug( debugLevelVerbose, QString("Device streams requested for %1 variables").arg(QString::number(pushVarList.size())), "requestDeviceStreams()" );
+}
+
+void DeviceAPI::requestFlowControl()
+{
+	int windowSize = mDeviceInstance->getRxBufferSize();
+	if( !mDeviceStreamsEnabled || windowSize <= 0 || !ProxySettingsManager::instance()->deviceValue( getId(), "device/flowControl" ).toBool() )
+		{ return; }
+
+	if( !mDeviceLink->startFlowControl( windowSize ) )
+		{ debug( debugLevelVerbose, "The device link doesn't support flow control", "requestFlowControl()" ); }
+}
+
+void DeviceAPI::requestBinaryProtocol()
+{
+	int idCount = mDeviceInstance->getBinaryIdCount();
+	if( !mDeviceStreamsEnabled || idCount <= 0 || !ProxySettingsManager::instance()->deviceValue( getId(), "device/binaryProtocol" ).toBool() )
+		{ return; }
+
+	QList<DeviceStateVariableBase*> varList = mStateManager->getVarList();
+	QStringList keyList;
+	QList<QVariant::Type> rawTypeList;
+	for( int i=0; i<varList.size() && keyList.size() < idCount; ++i )
+	{
+		keyList.append( varList.at(i)->getHwInterface() + '/' + varList.at(i)->getName() );
+		rawTypeList.append( ((DeviceStateProxyVariable*)varList.at(i))->getRawType() );
+	}
+
+	if( !mDeviceLink->startBinaryProtocol( keyList, rawTypeList ) )
+		{ debug( debugLevelVerbose, "The device link doesn't support the binary protocol, staying on text", "requestBinaryProtocol()" ); }
+}
+
+bool DeviceAPI::sendStreamCall( DeviceStateProxyVariable *stateVar, quint32 intervalMs )
+{
+	QChar sep = DeviceCommand::getSeparator();
+	if( !call( ":proxy", "stream", stateVar->getHwInterface() + sep + stateVar->getName() + sep + QString::number(intervalMs) ) )
+	{
+		error( QtWarningMsg, QString("Failed to request device stream for %1:%2").arg(stateVar->getHwInterface(),stateVar->getName()), "sendStreamCall()" );
+		return false;
+	}
+	return true;
+}
@@ -6,21 +6,37 @@
 #include "DeviceStateManager.h"
 #include "DeviceConnectionManagerBase.h"
 #include "DeviceAPIFileHandler.h"
+#include "DeviceCommandRecorder.h"
+#include "DeviceCommandScheduler.h"
+#include "DeviceRequestTracker.h"
 
 namespace QtuC
 {
 
 /** DeviceAPI class.
  * Acts as an interface to the various device variables, device functions, states, communication, etc...
- * and manage all the device-related objects.*/
+ * and manage all the device-related objects.
+ * A DeviceAPI serves one device, with its own Device, connector and state manager. The settings can be overridden for the device (see ProxySettingsManager::deviceValue()).*/
 class DeviceAPI : public ErrorHandlerBase
 {
 	Q_OBJECT
 public:
 
 	/** Constructor.
-	*	Creates the device API object.*/
-	DeviceAPI( QObject *parent = 0 );
+	*	Creates the device API object.
+	*	@param deviceId Id of the device (see ProxySettingsManager::getDeviceIds()), empty for the single device of the proxy.
+	*	@param parent Parent object.*/
+	DeviceAPI( const QString &deviceId, QObject *parent = 0 );
+
+	/** Get the id of the device.
+	  *	@return The id, empty for the single device of the proxy.*/
+	const QString getId() const
+		{ return mDeviceInstance->getId(); }
+
+	/** Get the device.
+	  *	@return The device.*/
+	const Device *getDevice() const
+		{ return mDeviceInstance; }
 
 	/** Call a device function.
 	 *	@param hwInterface The hardvare interface.
@@ -92,6 +108,24 @@ public:
 	const DeviceAPIParser *getApiParser()
 		{ return (DeviceAPIParser*)mDeviceAPI; }
 
+	/// Get the number of commands received from the device.
+	quint64 getReceivedCommandCount() const
+		{ return mReceivedDeviceCommandCounter; }
+
+	/** Get the number of bytes waiting to be written to the device.
+	  *	@return The number of pending bytes, 0 if there is no device link.*/
+	qint64 getPendingByteCount() const;
+
+	/** Get the command scheduler of the device link.
+	  *	@return The scheduler, 0 if there is no device link.*/
+	const DeviceCommandScheduler *getScheduler() const
+		{ return mScheduler; }
+
+	/** Get the tracker of the gets sent to the device (round-trip times, connection health).
+	  *	@return The tracker.*/
+	const DeviceRequestTracker *getRequestTracker() const
+		{ return mRequestTracker; }
+
 private slots:
 
 	/** Handle an incoming command from the device.
@@ -106,6 +140,7 @@ private slots:
 
 	/** Handle if a variable needs update.
 	  * Send a get command to the device with theinterface and name of the variable.
+	  *	Not sent if the link mirrors an upstream proxy (see DeviceConnectionManagerBase::carriesUserValues()), its subscription feed already keeps the variable updated.
 	  *	@param stateVar The state who sent the request.
 	  * @return True on success, false otherwise.*/
 	bool handleStateVariableUpdateRequest( DeviceStateProxyVariable *stateVar );
@@ -115,6 +150,16 @@ private slots:
 	  *	@param stateVar The variable to send.*/
 	void handleStateVariableSendRequest( DeviceStateProxyVariable *stateVar );
 
+	/** Log the change of the device connection health.
+	  *	@param health The new health.*/
+	void handleDeviceHealthChange( DeviceRequestTracker::health_t health );
+
+	/** Handle if the device stream of a variable must be started, changed or stopped.
+	  *	Send a stream call to the device, if the device link is open. Otherwise the stream is requested with the others, when the link opens.
+	  *	@param stateVar The variable in push auto-update mode.
+	  *	@param intervalMs The interval of the stream in milliseconds, 0 to stop the stream.*/
+	void handleStateVariableStreamRequest( DeviceStateProxyVariable *stateVar, quint32 intervalMs );
+
 signals:
 
 	/** Emitted if a message is received from the device
@@ -130,16 +175,67 @@ signals:
 	void greetingReceived();
 
 private:
+	/** Create the device connector and the command recorder, depending on settings and command line arguments.*/
+	void createDeviceLink();
+
 	/** Handle the device greeting message.
 	 *	If the greeting contains device parameters (name, platform, ...), parse the parameters and update the Device object accordingly.
 	 *	@param greetingCmd The greeting command.*/
 	void handleDeviceGreeting( DeviceCommand *greetingCmd );
 
+	/** Request the device streams of all variables with an active push auto-update.
+	  *	Previous streams are cleared first, as they may be left on the device by an earlier proxy session.
+	  *	Called when the device link opens, and on device greeting, as a reset device has no streams.*/
+	void requestDeviceStreams();
+
+	/** Limit the data in flight to the device to its receive buffer, if enabled in the settings and supported by the device.
+	  *	Called when the device link opens, and on device greeting, as a reset device starts without flow control.*/
+	void requestFlowControl();
+
+	/** Switch the device link to the binary protocol, if enabled in the settings and supported by the device.
+	  *	The variables get their binary ids in the order of the deviceAPI, as many as the device accepts.
+	  *	Called when the device link opens, and on device greeting, as a reset device starts with the text protocol.*/
+	void requestBinaryProtocol();
+
+	/** Send a stream call to the device for a variable.
+	  *	@param stateVar The variable.
+	  *	@param intervalMs The interval of the stream in milliseconds, 0 to stop the stream.
+	  *	@return True on success, false otherwise.*/
+	bool sendStreamCall( DeviceStateProxyVariable *stateVar, quint32 intervalMs );
+
+	/** Send a get or set command of a variable to the device.
+	  *	The command is scheduled with DeviceCommandScheduler, which merges it with a waiting command of the same variable, paces it, and batches it if the device supports batched commands.
+	  *	@param cmd The command.
+	  *	@param priority Priority class of the command: background for the auto-update polls, interactive for the client requests.
+	  *	@return True if the command is scheduled, false otherwise.*/
+	bool sendVariableCommand( DeviceCommand *cmd, DeviceCommandScheduler::priority_t priority );
+
+	/** Send a get command of a variable to the device, unless the variable already has an outstanding get (see DeviceRequestTracker).
+	  *	@param stateVar The variable.
+	  *	@param priority Priority class of the command.
+	  *	@return True if the get is sent or outstanding, false otherwise.*/
+	bool requestUpdate( DeviceStateProxyVariable *stateVar, DeviceCommandScheduler::priority_t priority );
+
+	/** Get the variable of a device get or set command.
+	  *	If the command carries the id of the variable (binary protocol), the variable is found by the id, otherwise by the interface and the name.
+	  *	@param cmd The device command.
+	  *	@return The variable, or 0 if not found.*/
+	DeviceStateProxyVariable *getCommandVar( DeviceCommand *cmd );
+
+	/** Stamp the device stage of a traced command from the device timestamp.
+	  *	Does nothing if the command is not traced, has no timestamp, or the device startup time is unknown yet.
+	  *	@param cmd The device command.*/
+	void stampDeviceTime( DeviceCommand *cmd );
+
 	DeviceStateManager* mStateManager;		///< The DeviceStateManager instance. Handles the device variables
 	DeviceConnectionManagerBase* mDeviceLink;	///< DeviceConnectionManagerBase instance. Handles the connection to the device.
 	DeviceAPIFileHandler *mDeviceAPI;		///< DeviceAPIFileHandler intance. handles deviceAPI and device API file.
-	Device* mDeviceInstance;		///< Pointer to the current device singleton.
+	Device* mDeviceInstance;		///< The device.
+	DeviceCommandScheduler *mScheduler;	///< Schedules the commands to the device, created with the device link.
+	DeviceRequestTracker *mRequestTracker;	///< Tracks the outstanding gets.
+	DeviceCommandRecorder *mCommandRecorder;	///< Records all received device commands, if enabled (null otherwise).
 	bool mEmitAllCmd;	///< If true, emit all received device command ("passThrough" mode)
+	bool mDeviceStreamsEnabled;	///< True if the device link is open, so the stream requests can be sent.
 	quint64 mReceivedDeviceCommandCounter;
 };
 
@@ -1,19 +1,24 @@
 #include "DeviceCommand.h"
-#include "Device.h"
 #include "ProxySettingsManager.h"
 
 using namespace QtuC;
 
 QChar DeviceCommand::mSeparator = ' ';
+const QString DeviceCommand::mBatchPrefix = QString("m");
+const QChar DeviceCommand::mBatchAssign = '=';
 
 DeviceCommand::DeviceCommand() :
 	ErrorHandlerBase(),
-	DeviceCommandBase()
+	DeviceCommandBase(),
+	mBatch(false),
+	mVarId(-1)
 {}
 
 DeviceCommand::DeviceCommand( const QString &commandString ) :
 	ErrorHandlerBase(),
-	DeviceCommandBase()
+	DeviceCommandBase(),
+	mBatch(false),
+	mVarId(-1)
 {
 	QStringList cmdExploded = QString(commandString).remove('\n').split( mSeparator, QString::SkipEmptyParts );
 
@@ -48,7 +53,9 @@ DeviceCommand::DeviceCommand( const QString &commandString ) :
 }
 
 DeviceCommand::DeviceCommand(const DeviceCommandBase &cmdBase) :
-	DeviceCommandBase(cmdBase)
+	DeviceCommandBase(cmdBase),
+	mBatch(false),
+	mVarId(-1)
 {}
 
 DeviceCommand *DeviceCommand::fromString( const QString &commandString )
@@ -71,12 +78,6 @@ DeviceCommand *DeviceCommand::fromString( const QString &commandString )
 	if( cmdExploded.at(1).at(0) == '@' )
 		{ hwiIndex = 2; }
 
-	if( !Device::isValidHwInterface( cmdExploded.at(hwiIndex) ) )
-	{
-		error( QtWarningMsg, QString("Try to set command from string with invalid hardware interface '%1', command ignored.").arg(cmdExploded.at(hwiIndex)), "fromString()", "DeviceCommand" );
-		return 0;
-	}
-
 	DeviceCommand *cmd = new DeviceCommand( commandString );
 
 	if( cmd->isValid() )
@@ -90,14 +91,77 @@ DeviceCommand *DeviceCommand::fromString( const QString &commandString )
 	}
 }
 
-bool DeviceCommand::setInterface(const QString &hwi)
+QList<DeviceCommand*> DeviceCommand::listFromString( const QString &commandString )
 {
-	if( !Device::isValidHwInterface(hwi) )
+	QList<DeviceCommand*> cmdList;
+	QChar sep = ProxySettingsManager::instance()->value( "device/commandSeparator" ).toChar();
+	QStringList cmdExploded = QString(commandString).remove('\n').split( sep, QString::SkipEmptyParts );
+
+	deviceCommandType_t batchType = deviceCmdUndefined;
+	if( !cmdExploded.isEmpty() && cmdExploded.at(0).startsWith(mBatchPrefix) )
+		{ batchType = commandTypeFromString( cmdExploded.at(0).mid( mBatchPrefix.size() ) ); }
+
+	if( batchType != deviceCmdGet && batchType != deviceCmdSet )
 	{
-		error( QtWarningMsg, QString("Try to set command from string with invalid (non-existent) hardware interface '%1'.").arg(hwi), "setInterface()" );
-		return false;
+		DeviceCommand *cmd = fromString( commandString );
+		if( cmd )
+			{ cmdList.append( cmd ); }
+		return cmdList;
 	}
-	else if( hwi.contains(mSeparator) )
+
+	int hwiIndex = 1;
+	// timestamp?
+	quint64 timestamp = 0;
+	bool hasTimestamp = false;
+	if( cmdExploded.size() > 1 && cmdExploded.at(1).at(0) == '@' )
+	{
+		timestamp = cmdExploded.at(1).mid(1).toULongLong( &hasTimestamp, 16 );
+		if( !hasTimestamp )
+			{ error( QtWarningMsg, "Invalid timestamp in batched command, ignored.", "listFromString()", "DeviceCommand" ); }
+		hwiIndex = 2;
+	}
+
+	if( cmdExploded.size() < hwiIndex+2 )
+	{
+		error( QtWarningMsg, "Try to set batched command from string without items, ignored.", "listFromString()", "DeviceCommand" );
+		return cmdList;
+	}
+
+	for( int i=hwiIndex+1; i<cmdExploded.size(); ++i )
+	{
+		DeviceCommand *cmd = new DeviceCommand();
+		cmd->setType( batchType );
+		cmd->setInterface( cmdExploded.at(hwiIndex) );
+		if( hasTimestamp )
+			{ cmd->setTimestamp( timestamp ); }
+
+		if( batchType == deviceCmdSet )
+		{
+			int assignIndex = cmdExploded.at(i).indexOf( mBatchAssign );
+			if( assignIndex > 0 )
+			{
+				cmd->setVariable( cmdExploded.at(i).left(assignIndex) );
+				cmd->setArg( cmdExploded.at(i).mid(assignIndex+1) );
+			}
+		}
+		else
+			{ cmd->setVariable( cmdExploded.at(i) ); }
+
+		if( cmd->isValid() )
+			{ cmdList.append( cmd ); }
+		else
+		{
+			error( QtWarningMsg, QString("Invalid item in batched command: %1, ignored.").arg(cmdExploded.at(i)), "listFromString()", "DeviceCommand" );
+			delete cmd;
+		}
+	}
+
+	return cmdList;
+}
+
+bool DeviceCommand::setInterface(const QString &hwi)
+{
+	if( hwi.contains(mSeparator) )
 	{
 		error( QtWarningMsg, QString("Passed interface ('%1') contains the command separator character.").arg(hwi), "setInterface()" );
 		return false;
@@ -128,11 +192,16 @@ const QString DeviceCommand::getCommandString() const
 	}
 
 	QString strCmd;
-	// Explicit cast for QStringBuilder to work. See http://blog.qt.digia.com/2011/06/13/string-concatenation-with-qstringbuilder/
-	strCmd = QString( commandTypeToString(mType) + mSeparator + mHwInterface + mSeparator + mVariable );
+	if( mBatch )
+		{ strCmd = QString( mBatchPrefix + commandTypeToString(mType) + mSeparator + mHwInterface + mSeparator + mArgs.join(mSeparator) ); }
+	else
+	{
+		// Explicit cast for QStringBuilder to work. See http://blog.qt.digia.com/2011/06/13/string-concatenation-with-qstringbuilder/
+		strCmd = QString( commandTypeToString(mType) + mSeparator + mHwInterface + mSeparator + mVariable );
 
-	if( !mArgs.isEmpty() )
-		{ strCmd += QString( mSeparator + getArgumentString() ); }
+		if( !mArgs.isEmpty() )
+			{ strCmd += QString( mSeparator + getArgumentString() ); }
+	}
 
 	if( !strCmd.endsWith('\n') )
 		{ strCmd.append('\n'); }
@@ -233,3 +302,267 @@ bool DeviceCommand::applyVariable( const DeviceStateProxyVariable *stateVar )
 		return false;
 	}
 }
+
+DeviceCommand *DeviceCommand::batch( deviceCommandType_t cmdType, const QString &hwInterface )
+{
+	if( cmdType != deviceCmdGet && cmdType != deviceCmdSet )
+	{
+		error( QtWarningMsg, "Try to build a batched command with a type other than get or set", "batch()", "DeviceCommand" );
+		return 0;
+	}
+
+	DeviceCommand *deviceCommand = new DeviceCommand();
+	deviceCommand->setType( cmdType );
+	deviceCommand->mBatch = true;
+	if( deviceCommand->setInterface( hwInterface ) )
+		{ return deviceCommand; }
+	else
+	{
+		delete deviceCommand;
+		return 0;
+	}
+}
+
+bool DeviceCommand::appendToBatch( const DeviceCommand *cmd, int maxLength )
+{
+	if( !mBatch || !cmd || cmd->isBatch() || !cmd->isValid() || cmd->getType() != mType || cmd->getHwInterface() != mHwInterface || cmd->getVariable().isEmpty() )
+		{ return false; }
+
+	QString item = cmd->getVariable();
+	if( mType == deviceCmdSet )
+	{
+		// the device splits the items at the separator, and the variable from the value at the first assign
+		if( cmd->getArgList().size() != 1 || cmd->getArg().contains(mSeparator) || item.contains(mBatchAssign) )
+			{ return false; }
+		item += mBatchAssign + cmd->getArg();
+	}
+
+	if( maxLength > 0 )
+	{
+		int length = mBatchPrefix.size() + commandTypeToString(mType).size() + 1 + mHwInterface.size();
+		for( int i=0; i<mArgs.size(); ++i )
+			{ length += 1 + mArgs.at(i).size(); }
+		if( length + 1 + item.size() > maxLength )
+			{ return false; }
+	}
+
+	if( mArgs.isEmpty() )
+		{ mVariable = cmd->getVariable(); }
+	mArgs.append( item );
+	return true;
+}
+
+bool DeviceCommand::isValid() const
+{
+	return DeviceCommandBase::isValid() && !( mBatch && mArgs.isEmpty() );
+}
+
+const QByteArray DeviceCommand::getBinaryFrame( const QHash<QString,binaryVar_t> &binaryVars ) const
+{
+	if( !isValid() )
+	{
+		error( QtWarningMsg, "Unable to build binary frame: command is invalid", "getBinaryFrame()" );
+		return QByteArray();
+	}
+
+	QByteArray frame;
+	QHash<QString,binaryVar_t>::const_iterator binaryVar = binaryVars.constFind( mHwInterface + '/' + mVariable );
+	QByteArray value;
+	if( binaryVar != binaryVars.constEnd() && mType == deviceCmdSet && mArgs.size() == 1 )
+		{ value = getBinaryValue( mArgs.first(), binaryVar.value().rawType ); }
+	if( binaryVar != binaryVars.constEnd() && !mBatch && ( ( mType == deviceCmdGet && mArgs.isEmpty() ) || ( mType == deviceCmdSet && !value.isEmpty() ) ) )
+	{
+		// the proxy doesn't send its time to the device
+		frame.append( (char)mType );
+		frame.append( (char)binaryVar.value().id );
+		frame.append( value );
+	}
+	else
+	{
+		frame.append( (char)binaryHeaderText );
+		frame.append( getCommandString().toAscii() );
+		frame.chop(1);	// the line end
+	}
+
+	quint16 crc = crc16( frame );
+	frame.append( (char)( crc & 0xff ) );
+	frame.append( (char)( crc >> 8 ) );
+
+	QByteArray encoded = cobsEncode( frame );
+	encoded.append( '\0' );
+	return encoded;
+}
+
+QByteArray DeviceCommand::getBinaryValue( const QString &valueStr, QVariant::Type rawType )
+{
+	QByteArray value;
+	bool ok = false;
+	quint32 intValue = 0;
+	switch( rawType )
+	{
+		case QVariant::Int:
+			intValue = (quint32)valueStr.toInt( &ok, 16 );
+			value.append( 'i' );
+			break;
+		case QVariant::UInt:
+			intValue = valueStr.toUInt( &ok, 16 );
+			value.append( 'u' );
+			break;
+		case QVariant::Bool:
+			if( valueStr == "1" || valueStr.compare( "true", Qt::CaseInsensitive ) == 0 || valueStr.compare( "on", Qt::CaseInsensitive ) == 0 )
+				{ value.append( 'b' ).append( (char)1 ); }
+			else if( valueStr == "0" || valueStr.compare( "false", Qt::CaseInsensitive ) == 0 || valueStr.compare( "off", Qt::CaseInsensitive ) == 0 )
+				{ value.append( 'b' ).append( (char)0 ); }
+			return value.isEmpty() ? getBinaryValue( valueStr, QVariant::String ) : value;
+		default:
+		{
+			// the length is a single byte, a longer value goes in a text frame
+			QByteArray str = valueStr.toAscii();
+			if( str.size() < 256 )
+				{ value.append( 's' ).append( (char)str.size() ).append( str ); }
+			return value;
+		}
+	}
+
+	if( !ok )
+		{ return getBinaryValue( valueStr, QVariant::String ); }
+	for( int i=0; i<4; ++i )
+		{ value.append( (char)( intValue >> (8*i) ) ); }
+	return value;
+}
+
+QList<DeviceCommand*> DeviceCommand::listFromBinaryFrame( const QByteArray &frame, const QStringList &binaryIdList )
+{
+	QList<DeviceCommand*> cmdList;
+	QByteArray data = cobsDecode( frame );
+	if( data.size() < 4 || crc16( data.left(data.size()-2) ) != ( (quint8)data.at(data.size()-2) | ( (quint8)data.at(data.size()-1) << 8 ) ) )
+	{
+		error( QtWarningMsg, "Binary frame with invalid encoding or CRC, ignored.", "listFromBinaryFrame()", "DeviceCommand" );
+		return cmdList;
+	}
+	data.chop(2);
+
+	quint8 header = data.at(0);
+	int pos = 1;
+	quint32 timestamp = 0;
+	if( header & binaryHeaderTimestamp )
+	{
+		if( data.size() < pos+4 )
+		{
+			error( QtWarningMsg, "Binary frame too short for the timestamp, ignored.", "listFromBinaryFrame()", "DeviceCommand" );
+			return cmdList;
+		}
+		for( int i=0; i<4; ++i )
+			{ timestamp |= (quint32)(quint8)data.at(pos++) << (8*i); }
+	}
+
+	if( header & binaryHeaderText )
+		{ return listFromString( QString::fromAscii( data.mid(pos) ) ); }
+
+	if( data.size() <= pos || (quint8)data.at(pos) >= binaryIdList.size() )
+	{
+		error( QtWarningMsg, "Binary frame with unknown variable id, ignored.", "listFromBinaryFrame()", "DeviceCommand" );
+		return cmdList;
+	}
+	int id = (quint8)data.at(pos++);
+	QString key = binaryIdList.at(id);
+
+	DeviceCommand *cmd = new DeviceCommand();
+	cmd->mVarId = id;
+	cmd->setType( (deviceCommandType_t)( header & binaryHeaderTypeMask ) );
+	cmd->setInterface( key.section( '/', 0, 0 ) );
+	cmd->setVariable( key.section( '/', 1 ) );
+	if( header & binaryHeaderTimestamp )
+		{ cmd->setTimestamp( timestamp ); }
+
+	if( pos < data.size() )
+	{
+		char tag = data.at(pos++);
+		quint32 value = 0;
+		if( ( tag == 'i' || tag == 'u' ) && data.size() >= pos+4 )
+		{
+			for( int i=0; i<4; ++i )
+				{ value |= (quint32)(quint8)data.at(pos++) << (8*i); }
+		}
+
+		if( tag == 's' && data.size() > pos && data.size() >= pos + 1 + (quint8)data.at(pos) )
+			{ cmd->setArg( QString::fromAscii( data.mid( pos+1, (quint8)data.at(pos) ) ) ); }
+		else if( tag == 'i' && pos == data.size() )
+			{ cmd->setArg( QString::number( (qint32)value, 16 ) ); }
+		else if( tag == 'u' && pos == data.size() )
+			{ cmd->setArg( QString::number( value, 16 ) ); }
+		else if( tag == 'b' && data.size() > pos )
+			{ cmd->setArg( data.at(pos) ? "1" : "0" ); }
+		else
+		{
+			error( QtWarningMsg, QString("Binary frame with invalid value (type '%1'), ignored.").arg(tag), "listFromBinaryFrame()", "DeviceCommand" );
+			delete cmd;
+			return cmdList;
+		}
+	}
+
+	if( cmd->isValid() )
+		{ cmdList.append( cmd ); }
+	else
+	{
+		error( QtWarningMsg, "Invalid command in binary frame, ignored.", "listFromBinaryFrame()", "DeviceCommand" );
+		delete cmd;
+	}
+	return cmdList;
+}
+
+quint16 DeviceCommand::crc16( const QByteArray &data )
+{
+	quint16 crc = 0xffff;
+	for( int i=0; i<data.size(); ++i )
+	{
+		crc ^= (quint16)(quint8)data.at(i) << 8;
+		for( int bit=0; bit<8; ++bit )
+			{ crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ 0x1021 : crc << 1; }
+	}
+	return crc;
+}
+
+QByteArray DeviceCommand::cobsEncode( const QByteArray &data )
+{
+	QByteArray encoded;
+	encoded.reserve( data.size() + data.size()/254 + 1 );
+	int codePos = 0;
+	encoded.append( (char)0 );
+	quint8 code = 1;
+	for( int i=0; i<data.size(); ++i )
+	{
+		if( data.at(i) )
+		{
+			encoded.append( data.at(i) );
+			++code;
+		}
+		if( !data.at(i) || code == 0xff )
+		{
+			encoded[codePos] = code;
+			codePos = encoded.size();
+			encoded.append( (char)0 );
+			code = 1;
+		}
+	}
+	encoded[codePos] = code;
+	return encoded;
+}
+
+QByteArray DeviceCommand::cobsDecode( const QByteArray &data )
+{
+	QByteArray decoded;
+	decoded.reserve( data.size() );
+	int in = 0;
+	while( in < data.size() )
+	{
+		quint8 code = data.at(in++);
+		if( !code || in + code - 1 > data.size() )
+			{ return QByteArray(); }
+		decoded.append( data.mid( in, code-1 ) );
+		in += code-1;
+		if( code != 0xff && in < data.size() )
+			{ decoded.append( (char)0 ); }
+	}
+	return decoded;
+}
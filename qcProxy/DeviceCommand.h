@@ -4,6 +4,7 @@
 #include "DeviceCommandBase.h"
 #include "ErrorHandlerBase.h"
 #include "DeviceStateProxyVariable.h"
+#include <QHash>
 
 namespace QtuC
 {
@@ -14,7 +15,11 @@ namespace QtuC
  *	  * you can call the constructor and use the setters to set all necessary command parts
  *	  * use fromString() to parse an existing device command
  *	  * use fromVariable() to build a `get` or `set` command for a particular variable.
- *	Use getCommandString() to get the string representation of the command.*/
+ *	  * use batch() and appendToBatch() to join `get` or `set` commands of the same interface to a batched command (`mget` or `mset`).
+ *	Use getCommandString() to get the string representation of the command.
+ *	Batched commands received from the device are expanded to single commands by listFromString().
+ *	On the binary device protocol use getBinaryFrame() and listFromBinaryFrame() instead of the command strings, with the binary ids of the device link.
+ *	The hardware interface of a parsed command is not checked here, the commands are not bound to a Device, see DeviceAPI.*/
 class DeviceCommand : public ErrorHandlerBase, public DeviceCommandBase
 {
 	Q_OBJECT
@@ -35,6 +40,34 @@ public:
 	 *	@return The new DeviceCommand instance on success, 0 otherwise.*/
 	static DeviceCommand *fromString( const QString &commandString );
 
+	/** Parse the passed command string, and create the DeviceCommand instances from it.
+	 *	A batched command (`mset` or `mget`) is expanded to single `set` or `get` commands, with the timestamp of the batch.
+	 *	Any other command string is parsed with fromString().
+	 *	@param commandString The command string.
+	 *	@return The list of new DeviceCommand instances, empty on failure.*/
+	static QList<DeviceCommand*> listFromString( const QString &commandString );
+
+	/** Parse a frame of the binary device protocol, and create the DeviceCommand instances from it.
+	 *	A text frame is parsed with listFromString(), a value frame is converted to a `get` or `set` command, with a hexadecimal value for integers, as in the text protocol.
+	 *	@param frame The received frame, COBS encoded, without the terminating 0.
+	 *	@param binaryIdList The variables with an id on the device link, as `hwInterface/variable`, the id is the index.
+	 *	@return The list of new DeviceCommand instances, empty on failure.*/
+	static QList<DeviceCommand*> listFromBinaryFrame( const QByteArray &frame, const QStringList &binaryIdList );
+
+	/// A variable with an id on the binary device protocol.
+	struct binaryVar_t
+	{
+		int id;
+		QVariant::Type rawType;		///< The device-side type of the variable, the value of a set is sent raw in this type.
+	};
+
+	/** Get the frame of the command for the binary device protocol.
+	 *	A `get` without arguments or a `set` with a single argument of a variable with an id is sent as a value frame, anything else in a text frame.
+	 *	The value of an int, uint or bool variable is sent raw (see getBinaryValue()), any other as string.
+	 *	@param binaryVars The variables with an id on the device link, by `hwInterface/variable`.
+	 *	@return The COBS encoded frame with the terminating 0, or an empty array if the command is invalid.*/
+	const QByteArray getBinaryFrame( const QHash<QString,binaryVar_t> &binaryVars ) const;
+
 	/** Build a command from/for a device variable.
 	  *	Build a command from the passed type, and the name and raw (device-side) value of the passed device variable.
 	  *	@param cmdType Type of the command. Can be set or get, any other value will trigger an error.
@@ -42,6 +75,42 @@ public:
 	  *	@return A command object, or 0 on failure.*/
 	static DeviceCommand* fromVariable( deviceCommandType_t cmdType, const DeviceStateProxyVariable* stateVar );
 
+	/** Create an empty batched command.
+	  *	Add the commands to it with appendToBatch(), the batch is invalid until the first one is added.
+	  *	@param cmdType Type of the batched commands. Can be set or get, any other value will trigger an error.
+	  *	@param hwInterface The interface of the batched commands.
+	  *	@return A command object, or 0 on failure.*/
+	static DeviceCommand* batch( deviceCommandType_t cmdType, const QString &hwInterface );
+
+	/** Append a command to the batch.
+	  *	Only commands of the same type and interface, and with a single argument without a separator (in case of set) can be batched.
+	  *	The appended command is not modified or deleted.
+	  *	@param cmd The command to append.
+	  *	@param maxLength Maximum length of the batched command string, without the line end. 0 means no limit.
+	  *	@return True if the command is appended, false if it can not be batched, or the batch would exceed maxLength.*/
+	bool appendToBatch( const DeviceCommand *cmd, int maxLength = 0 );
+
+	/** Get if this is a batched command.
+	  *	The arguments of a batched command are the batch items (`var` for get, `var=value` for set), the variable is the one of the first item.
+	  *	@return True if batched, false otherwise.*/
+	bool isBatch() const
+		{ return mBatch; }
+
+	/** Get the number of commands in the batch.
+	  *	@return The number of batched commands, 1 if this is not a batched command.*/
+	int getBatchSize() const
+		{ return mBatch ? mArgs.size() : 1; }
+
+	/** Get the id of the variable, if known.
+	  *	Commands received in binary frames carry the id of the variable (the binary id, which is the id of the variable in the deviceAPI, see StateManagerBase::getVar(int)).
+	  *	@return The id, or -1 if unknown.*/
+	int getVarId() const
+		{ return mVarId; }
+
+	/** Inherited from DeviceCommandBase.
+	  *	A batched command must contain at least one command.*/
+	bool isValid() const;
+
 	/** @name Inherited from DeviceCommandBase.
 	  *	@{*/
 	bool setInterface( const QString & hwi );
@@ -80,7 +149,42 @@ private:
 	  *	@return The device-compatible argument string.*/
 	const QString getArgumentString() const;
 
+	/** Calculate the CRC16 (CCITT, polynomial 0x1021, initial value 0xffff) of a binary frame.
+	  *	@param data The data.
+	  *	@return The CRC.*/
+	static quint16 crc16( const QByteArray &data );
+
+	/** Get the type tag and the value of a set command in a binary frame.
+	  *	Integers are read from the hexadecimal argument the device would get in text, and sent as 4 bytes, little endian.
+	  *	If the argument can't be read as the raw type, it's sent as string.
+	  *	@param valueStr The argument of the set command.
+	  *	@param rawType The device-side type of the variable.
+	  *	@return The type tag and the value.*/
+	static QByteArray getBinaryValue( const QString &valueStr, QVariant::Type rawType );
+
+	/** Encode data with COBS (Consistent Overhead Byte Stuffing).
+	  *	@param data The data.
+	  *	@return The encoded data, without 0 bytes and without the terminator.*/
+	static QByteArray cobsEncode( const QByteArray &data );
+
+	/** Decode COBS encoded data.
+	  *	@param data The encoded data, without the terminator.
+	  *	@return The decoded data, empty if the data is invalid.*/
+	static QByteArray cobsDecode( const QByteArray &data );
+
+	/// Bits of the binary frame header.
+	enum binaryHeaderFlag_t
+	{
+		binaryHeaderTypeMask = 0x03,
+		binaryHeaderTimestamp = 0x04,
+		binaryHeaderText = 0x08
+	};
+
 	static QChar mSeparator;		///< Command delimiter. Used to separate command words from each other.
+	static const QString mBatchPrefix;	///< Prefix of the command type in a batched command.
+	static const QChar mBatchAssign;	///< Separator of the variable and the value in a batched set item.
+	bool mBatch;	///< True if this is a batched command.
+	int mVarId;		///< Id of the variable, -1 if unknown.
 };
 
 }	//QtuC::
@@ -0,0 +1,93 @@
+#include "DeviceCommandRecorder.h"
+#include "ProxySettingsManager.h"
+#include <QDateTime>
+
+using namespace QtuC;
+
+const char DeviceCommandRecorder::mLogMagic[] = "QCDLOG";
+const char DeviceCommandRecorder::mIndexMagic[] = "QCDIDX";
+const quint8 DeviceCommandRecorder::mFormatVersion = 1;
+
+DeviceCommandRecorder::DeviceCommandRecorder( QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mRecordCount(0)
+{
+	mIndexInterval = ProxySettingsManager::instance()->value("deviceRecord/indexInterval").toUInt();
+	if( mIndexInterval == 0 )
+		{ mIndexInterval = 1000; }
+}
+
+DeviceCommandRecorder::~DeviceCommandRecorder()
+{
+	close();
+}
+
+bool DeviceCommandRecorder::open( const QString &fileName )
+{
+	mLogFile.setFileName( fileName );
+	mIndexFile.setFileName( fileName + ".idx" );
+	if( !mLogFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) || !mIndexFile.open( QIODevice::WriteOnly | QIODevice::Truncate ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "file", fileName );
+		errDet.insert( "error", mLogFile.isOpen() ? mIndexFile.errorString() : mLogFile.errorString() );
+		error( QtCriticalMsg, "Failed to open device command log", "open()", errDet );
+		close();
+		return false;
+	}
+
+	mLogStream.setDevice( &mLogFile );
+	mIndexStream.setDevice( &mIndexFile );
+
+	mLogStream.writeRawData( mLogMagic, sizeof(mLogMagic)-1 );
+	mLogStream << mFormatVersion << QDateTime::currentMSecsSinceEpoch();
+	mIndexStream.writeRawData( mIndexMagic, sizeof(mIndexMagic)-1 );
+	mIndexStream << mFormatVersion;
+
+	mRecordCount = 0;
+	mClock.start();
+	debug( debugLevelInfo, QString("Recording device commands to %1").arg(fileName), "open()" );
+	return true;
+}
+
+void DeviceCommandRecorder::close()
+{
+	if( mLogFile.isOpen() )
+	{
+		mLogStream.setDevice(0);
+		mLogFile.close();
+		debug( debugLevelVerbose, QString("Device command log closed, %1 commands recorded").arg(QString::number(mRecordCount)), "close()" );
+	}
+	if( mIndexFile.isOpen() )
+	{
+		mIndexStream.setDevice(0);
+		mIndexFile.close();
+	}
+}
+
+void DeviceCommandRecorder::record( const DeviceCommand *cmd )
+{
+	if( !mLogFile.isOpen() )
+		{ return; }
+
+	quint64 receiveTime = mClock.nsecsElapsed() / 1000;
+
+	if( mRecordCount % mIndexInterval == 0 )
+	{
+		// keep the index usable even if the proxy is killed: the log is written up to the offset before the entry pointing there
+		mLogFile.flush();
+		mIndexStream << receiveTime << mLogFile.pos() << mRecordCount;
+		mIndexFile.flush();
+	}
+
+	quint8 flags = 0;
+	if( cmd->hasTimestamp() )
+		{ flags |= recordFlagHasTimestamp; }
+
+	mLogStream << receiveTime << flags;
+	if( cmd->hasTimestamp() )
+		{ mLogStream << cmd->getTimestamp(); }
+	mLogStream << cmd->getCommandString().toAscii();
+
+	++mRecordCount;
+}
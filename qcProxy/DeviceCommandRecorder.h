@@ -0,0 +1,69 @@
+#ifndef DEVICECOMMANDRECORDER_H
+#define DEVICECOMMANDRECORDER_H
+
+#include "ErrorHandlerBase.h"
+#include "DeviceCommand.h"
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+
+namespace QtuC
+{
+
+/** Record all commands received from the device to an indexed binary log.
+  *	The log can be played back later with ReplayDeviceConnector, to reproduce a session without the device.
+  *
+  *	Log file format (all numbers are big-endian, as written by QDataStream):
+  *		- header: magic `QCDLOG` (6 bytes), quint8 format version, qint64 recording start time (UNIX ms).
+  *		- records: quint64 receive time (microseconds since recording start), quint8 flags (bit 0: has device timestamp),
+  *		  quint64 device timestamp (only if flagged), QByteArray command string (without timestamp).
+  *
+  *	Index file format (the log file name with an `.idx` suffix):
+  *		- header: magic `QCDIDX` (6 bytes), quint8 format version.
+  *		- entries for every N-th record: quint64 receive time (microseconds since recording start), qint64 offset of the record in the log, quint64 record number.*/
+class DeviceCommandRecorder : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+	explicit DeviceCommandRecorder( QObject *parent = 0 );
+
+	~DeviceCommandRecorder();
+
+	/** Open the log and the index file and write the headers.
+	  *	@param fileName Path of the log file.
+	  *	@return True on success, false otherwise.*/
+	bool open( const QString &fileName );
+
+	/// Flush and close the files.
+	void close();
+
+	/** Record a device command.
+	  *	@param cmd The command, as received from the device.*/
+	void record( const DeviceCommand *cmd );
+
+	/// Get the number of recorded commands.
+	quint64 getRecordCount() const
+		{ return mRecordCount; }
+
+	static const char mLogMagic[];
+	static const char mIndexMagic[];
+	static const quint8 mFormatVersion;
+
+	/// Flag bits of a record.
+	enum recordFlag_t
+	{
+		recordFlagHasTimestamp = 0x01
+	};
+
+private:
+	QFile mLogFile;
+	QFile mIndexFile;
+	QDataStream mLogStream;
+	QDataStream mIndexStream;
+	QElapsedTimer mClock;	///< Measures the receive time since recording start.
+	quint64 mRecordCount;
+	quint32 mIndexInterval;	///< Write an index entry for every mIndexInterval-th record.
+};
+
+}	//QtuC::
+#endif // DEVICECOMMANDRECORDER_H
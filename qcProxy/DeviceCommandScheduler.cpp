@@ -0,0 +1,257 @@
+#include "DeviceCommandScheduler.h"
+#include "ProxySettingsManager.h"
+#include "Device.h"
+
+using namespace QtuC;
+
+DeviceCommandScheduler::DeviceCommandScheduler( DeviceConnectionManagerBase *deviceLink, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mDeviceLink(deviceLink),
+	mMergedCount(0)
+{
+	mMaxPendingBytes = ProxySettingsManager::instance()->deviceValue( mDeviceLink->getDevice()->getId(), "deviceSend/maxPendingBytes" ).toLongLong();
+	mRate = ProxySettingsManager::instance()->deviceValue( mDeviceLink->getDevice()->getId(), "deviceSend/rate" ).toLongLong();
+	mBurst = ProxySettingsManager::instance()->deviceValue( mDeviceLink->getDevice()->getId(), "deviceSend/burst" ).toLongLong();
+	if( mBurst <= 0 )
+		{ mBurst = 512; }
+	mTokens = mBurst;
+	mRefillClock.start();
+
+	mDispatchTimer = new QTimer(this);
+	mDispatchTimer->setSingleShot( true );
+	connect( mDispatchTimer, SIGNAL(timeout()), this, SLOT(dispatch()) );
+
+	debug( debugLevelVerbose, QString("Device send limits: %1 bytes in flight, %2 bytes/s, burst %3 bytes").arg( QString::number(mMaxPendingBytes), QString::number(mRate), QString::number(mBurst) ), "DeviceCommandScheduler()" );
+}
+
+DeviceCommandScheduler::~DeviceCommandScheduler()
+{
+	for( int p=0; p<priorityCount; ++p )
+	{
+		while( !mQueue[p].isEmpty() )
+			{ mQueue[p].takeFirst()->deleteLater(); }
+	}
+}
+
+bool DeviceCommandScheduler::schedule( DeviceCommand *cmd, priority_t priority )
+{
+	if( !cmd )
+		{ return false; }
+	if( !cmd->isValid() )
+	{
+		error( QtWarningMsg, "Command is invalid, cannot be scheduled", "schedule()" );
+		cmd->deleteLater();
+		return false;
+	}
+
+	QString key = mergeKey( cmd );
+	DeviceCommand *waiting = key.isNull() ? 0 : mMergeIndex.value( key, 0 );
+	if( waiting )
+	{
+		int p = 0;
+		int index = -1;
+		for( ; p<priorityCount && index < 0; ++p )
+			{ index = mQueue[p].indexOf( waiting ); }
+		--p;
+
+		// the newest value of a set wins, a get is the same anyway
+		if( cmd->getType() == deviceCmdSet )
+		{
+			mQueue[p][index] = cmd;
+			mMergeIndex.insert( key, cmd );
+			waiting->deleteLater();
+		}
+		else
+		{
+			cmd->deleteLater();
+			cmd = waiting;
+		}
+		++mMergedCount;
+
+		if( priority < p )
+			{ mQueue[priority].append( mQueue[p].takeAt( index ) ); }
+	}
+	else
+	{
+		if( !key.isNull() )
+			{ mMergeIndex.insert( key, cmd ); }
+		mQueue[priority].append( cmd );
+	}
+
+	if( !mDispatchTimer->isActive() )
+		{ mDispatchTimer->start( 0 ); }
+	return true;
+}
+
+int DeviceCommandScheduler::getScheduledCount() const
+{
+	int count = 0;
+	for( int p=0; p<priorityCount; ++p )
+		{ count += mQueue[p].size(); }
+	return count;
+}
+
+void DeviceCommandScheduler::flush()
+{
+	mDispatchTimer->stop();
+	QList<DeviceCommand*> cmdList;
+	for( int p=0; p<priorityCount; ++p )
+	{
+		while( !mQueue[p].isEmpty() )
+			{ cmdList.append( takeFirst( p ) ); }
+	}
+	send( cmdList );
+}
+
+void DeviceCommandScheduler::dispatch()
+{
+	refillTokens();
+	qint64 pending = mDeviceLink->getPendingByteCount();
+
+	QList<DeviceCommand*> cmdList;
+	qint64 sendBytes = 0;
+	qint64 missingTokens = 0;
+	bool blocked = false;
+	for( int p=0; p<priorityCount && !blocked; ++p )
+	{
+		while( !mQueue[p].isEmpty() )
+		{
+			// batching only makes it shorter
+			qint64 length = mQueue[p].first()->getCommandString().size();
+
+			// a single command is always let through, even if longer than the limits
+			qint64 inFlight = pending + sendBytes;
+			if( mMaxPendingBytes > 0 && inFlight > 0 && inFlight + length > mMaxPendingBytes )
+			{
+				blocked = true;
+				break;
+			}
+			if( mRate > 0 && mTokens < length && mTokens < mBurst )
+			{
+				missingTokens = length - (qint64)mTokens;
+				blocked = true;
+				break;
+			}
+
+			if( mRate > 0 )
+				{ mTokens -= length; }
+			sendBytes += length;
+			cmdList.append( takeFirst( p ) );
+		}
+	}
+
+	send( cmdList );
+
+	if( getScheduledCount() > 0 )
+		{ mDispatchTimer->start( missingTokens > 0 ? (int)( ( missingTokens * 1000 + mRate - 1 ) / mRate ) : MLinkPollInterval ); }
+}
+
+QString DeviceCommandScheduler::mergeKey( const DeviceCommand *cmd )
+{
+	if( cmd->isBatch() || ( cmd->getType() != deviceCmdGet && cmd->getType() != deviceCmdSet ) )
+		{ return QString(); }
+	return DeviceCommandBase::commandTypeToString( cmd->getType() ) + ' ' + cmd->getHwInterface() + ' ' + cmd->getVariable();
+}
+
+DeviceCommand *DeviceCommandScheduler::takeFirst( int priority )
+{
+	DeviceCommand *cmd = mQueue[priority].takeFirst();
+	QString key = mergeKey( cmd );
+	if( !key.isNull() && mMergeIndex.value( key, 0 ) == cmd )
+		{ mMergeIndex.remove( key ); }
+	return cmd;
+}
+
+void DeviceCommandScheduler::refillTokens()
+{
+	qint64 elapsedMs = mRefillClock.restart();
+	if( mRate <= 0 )
+		{ return; }
+	mTokens += (double)elapsedMs * mRate / 1000.0;
+	if( mTokens > mBurst )
+		{ mTokens = mBurst; }
+}
+
+void DeviceCommandScheduler::send( const QList<DeviceCommand*> &cmdList )
+{
+	bool batching = ( mDeviceLink->getDevice()->getBatchMaxLength() > 0 && !mDeviceLink->isBinaryProtocol() );
+
+	QList< QList<DeviceCommand*> > batchList;
+	for( int i=0; i<cmdList.size(); ++i )
+	{
+		DeviceCommand *cmd = cmdList.at(i);
+		emit commandSent( cmd );
+		if( !batching || mergeKey( cmd ).isNull() )
+		{
+			for( int b=0; b<batchList.size(); ++b )
+				{ sendBatch( batchList.at(b) ); }
+			batchList.clear();
+			if( !mDeviceLink->sendCommand( cmd ) )
+				{ error( QtWarningMsg, QString("Failed to send %1 command to device").arg(DeviceCommandBase::commandTypeToString(cmd->getType())), "send()" ); }
+			continue;
+		}
+
+		int batchIndex = -1;
+		bool reordered = false;
+		for( int b=0; b<batchList.size(); ++b )
+		{
+			if( batchList.at(b).first()->getHwInterface() != cmd->getHwInterface() )
+				{ continue; }
+			bool sameType = ( batchList.at(b).first()->getType() == cmd->getType() );
+			if( sameType )
+				{ batchIndex = b; }
+			for( int c=0; c<batchList.at(b).size() && !sameType; ++c )
+			{
+				if( batchList.at(b).at(c)->getVariable() == cmd->getVariable() )
+					{ reordered = true; }
+			}
+		}
+
+		if( reordered )
+		{
+			for( int b=0; b<batchList.size(); ++b )
+				{ sendBatch( batchList.at(b) ); }
+			batchList.clear();
+			batchIndex = -1;
+		}
+		if( batchIndex < 0 )
+		{
+			batchList.append( QList<DeviceCommand*>() );
+			batchIndex = batchList.size()-1;
+		}
+		batchList[batchIndex].append( cmd );
+	}
+
+	for( int b=0; b<batchList.size(); ++b )
+		{ sendBatch( batchList.at(b) ); }
+}
+
+void DeviceCommandScheduler::sendBatch( const QList<DeviceCommand*> &cmdList )
+{
+	int i = 0;
+	while( i < cmdList.size() )
+	{
+		DeviceCommand *batchCmd = DeviceCommand::batch( cmdList.at(i)->getType(), cmdList.at(i)->getHwInterface() );
+		int first = i;
+		while( batchCmd && i < cmdList.size() && batchCmd->appendToBatch( cmdList.at(i), mDeviceLink->getDevice()->getBatchMaxLength() ) )
+			{ ++i; }
+
+		// a single command, or one that can not be batched, is sent as it is
+		DeviceCommand *cmd = batchCmd;
+		if( !batchCmd || i - first <= 1 )
+		{
+			if( batchCmd )
+				{ batchCmd->deleteLater(); }
+			cmd = cmdList.at(first);
+			i = first+1;
+		}
+		else
+		{
+			for( int c=first; c<i; ++c )
+				{ cmdList.at(c)->deleteLater(); }
+		}
+
+		if( !mDeviceLink->sendCommand( cmd ) )
+			{ error( QtWarningMsg, QString("Failed to send %1 variable command(s) to device").arg(QString::number(cmd->getBatchSize())), "sendBatch()" ); }
+	}
+}
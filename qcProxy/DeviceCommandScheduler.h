@@ -0,0 +1,119 @@
+#ifndef DEVICECOMMANDSCHEDULER_H
+#define DEVICECOMMANDSCHEDULER_H
+
+#include "ErrorHandlerBase.h"
+#include "DeviceCommand.h"
+#include "DeviceConnectionManagerBase.h"
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+namespace QtuC
+{
+
+/** Schedule the commands sent to the device.
+  *	The auto-update polls, the client sets and the calls all go through the scheduler, which sends them from the event loop:
+  *	  * by priority: control calls first, then the interactive commands (client sets and gets), then the background polls (auto-update)
+  *	  * while the data in flight (see DeviceConnectionManagerBase::getPendingByteCount()) is below the `deviceSend/maxPendingBytes` setting
+  *	  * paced by a token bucket of `deviceSend/rate` bytes per second and `deviceSend/burst` bytes, if the rate is not 0
+  *
+  *	While a command waits, a new `get` of the same variable is merged into it, and a new `set` of the same variable replaces its value (the command keeps its place in the queue).
+  *	A merged command is moved up to the higher priority of the two.
+  *	The get and set commands sent together are joined to batched commands by type and interface, if the device supports them (see Device::getBatchMaxLength()).*/
+class DeviceCommandScheduler : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/// Priority classes, in the order they are served.
+	enum priority_t
+	{
+		priorityControl,		///< Calls (streams, functions), never merged.
+		priorityInteractive,	///< Client sets and gets, replies to the device.
+		priorityBackground,		///< Auto-update polls.
+		priorityCount
+	};
+
+	/** Create.
+	  *	@param deviceLink The device link to send the commands on.
+	  *	@param parent Parent object.*/
+	DeviceCommandScheduler( DeviceConnectionManagerBase *deviceLink, QObject *parent = 0 );
+
+	~DeviceCommandScheduler();
+
+	/** Schedule a command.
+	  *	The command is sent from the event loop, or merged into a waiting command, see the class description.
+	  *	@param cmd The command, the scheduler takes ownership.
+	  *	@param priority Priority class of the command.
+	  *	@return True if the command is scheduled, false if it is invalid (and deleted).*/
+	bool schedule( DeviceCommand *cmd, priority_t priority );
+
+	/** Get the number of waiting commands.
+	  *	@return The number of commands in all priority classes.*/
+	int getScheduledCount() const;
+
+	/** Get the number of commands merged into a waiting one.
+	  *	@return The count since start.*/
+	quint64 getMergedCount() const
+		{ return mMergedCount; }
+
+signals:
+
+	/** Emitted for every command, when it is written to the device link (before it is joined to a batch).
+	  *	@param cmd The command, valid only during the emit.*/
+	void commandSent( const DeviceCommand *cmd );
+
+public slots:
+
+	/** Send all the waiting commands now, without pacing.
+	  *	Call this before sending a command directly on the device link, to keep the order.*/
+	void flush();
+
+private slots:
+
+	/** Send the waiting commands the in-flight limit and the pacing allow.
+	  *	If commands are left, the dispatch is scheduled again: when the token bucket has enough tokens, or after a short time if the device link is full.*/
+	void dispatch();
+
+private:
+
+	/** Get the key of a get or set command to find a waiting command of the same variable.
+	  *	@param cmd The command.
+	  *	@return The key, or a null string if the command can not be merged.*/
+	static QString mergeKey( const DeviceCommand *cmd );
+
+	/** Take the first command of a priority class from the queue.
+	  *	@param priority The priority class, must not be empty.
+	  *	@return The command.*/
+	DeviceCommand *takeFirst( int priority );
+
+	/// Add the tokens for the time passed since the last refill.
+	void refillTokens();
+
+	/** Send a list of commands, joining the get and set commands to batches.
+	  *	A command other than get and set is sent on its own, after the batches collected before it, to keep the order.
+	  *	If a variable has both a get and a set in the list, the batches collected so far are sent first, to keep the order of the two.
+	  *	@param cmdList The commands, deleted after sending.*/
+	void send( const QList<DeviceCommand*> &cmdList );
+
+	/** Send a list of commands of the same type and interface, joined to as few batched commands as the device accepts.
+	  *	A batch of a single command is sent as the command itself. The commands in the list are deleted.
+	  *	@param cmdList The commands.*/
+	void sendBatch( const QList<DeviceCommand*> &cmdList );
+
+	static const int MLinkPollInterval = 5;	///< Interval of the dispatch in milliseconds, while the device link is full.
+
+	DeviceConnectionManagerBase *mDeviceLink;
+	QList<DeviceCommand*> mQueue[priorityCount];	///< The waiting commands of each priority class.
+	QHash<QString,DeviceCommand*> mMergeIndex;	///< The waiting get and set commands by mergeKey().
+	QTimer *mDispatchTimer;
+	qint64 mMaxPendingBytes;	///< Limit of the data in flight, 0 for no limit.
+	qint64 mRate;				///< Pacing in bytes per second, 0 for no pacing.
+	qint64 mBurst;				///< Size of the token bucket in bytes.
+	double mTokens;				///< Bytes that can be sent now.
+	QElapsedTimer mRefillClock;	///< Measures the time since the last refill.
+	quint64 mMergedCount;
+};
+
+}	//QtuC::
+#endif // DEVICECOMMANDSCHEDULER_H
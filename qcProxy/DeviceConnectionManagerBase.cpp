@@ -1,8 +1,43 @@
 #include "DeviceConnectionManagerBase.h"
+#include "Device.h"
+#include "ProxySettingsManager.h"
+#include "LatencyMonitor.h"
 
 using namespace QtuC;
 
-DeviceConnectionManagerBase::DeviceConnectionManagerBase( QObject *parent ) : ErrorHandlerBase(parent)
+DeviceConnectionManagerBase::DeviceConnectionManagerBase( const Device *device, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mDevice(device)
 {
 
 }
+
+QVariant DeviceConnectionManagerBase::deviceSetting( const QString &key ) const
+{
+	return ProxySettingsManager::instance()->deviceValue( mDevice->getId(), key );
+}
+
+void DeviceConnectionManagerBase::traceReceived( DeviceCommand *cmd, quint64 rxTime )
+{
+	if( LatencyMonitor::instance()->sample() )
+	{
+		LatencyTrace trace;
+		trace.stamp( LatencyTrace::traceStageRx, rxTime );
+		cmd->setTrace( trace );
+	}
+}
+
+int DeviceConnectionManagerBase::emitReceived( const QString &cmdString, quint64 rxTime )
+{
+	return emitReceived( DeviceCommand::listFromString( cmdString ), rxTime );
+}
+
+int DeviceConnectionManagerBase::emitReceived( const QList<DeviceCommand*> &cmdList, quint64 rxTime )
+{
+	for( int i=0; i<cmdList.size(); ++i )
+	{
+		traceReceived( cmdList.at(i), rxTime );
+		emit commandReceived( cmdList.at(i) );
+	}
+	return cmdList.size();
+}
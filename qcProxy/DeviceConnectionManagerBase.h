@@ -2,19 +2,30 @@
 #define DEVICECONNECTIONMANAGERBASE_H
 
 #include "DeviceCommand.h"
+#include <QVariant>
 
 namespace QtuC
 {
 
+class Device;
+
 /** DeviceConnectionManagerBase class.
- *	The base class for implementing a class to handle device connection.*/
+ *	The base class for implementing a class to handle device connection.
+ *	A connector belongs to one Device, its settings can be overridden for the device (see deviceSetting()).*/
 class DeviceConnectionManagerBase : public ErrorHandlerBase
 {
 	Q_OBJECT
 public:
 
-	/** C'tor*/
-	DeviceConnectionManagerBase( QObject *parent = 0 );
+	/** C'tor
+	  *	@param device The device of the link.
+	  *	@param parent Parent object.*/
+	DeviceConnectionManagerBase( const Device *device, QObject *parent = 0 );
+
+	/** Get the device of the link.
+	  *	@return The device.*/
+	const Device *getDevice() const
+		{ return mDevice; }
 
 	//virtual ~DeviceConnectionManagerBase()=0;
 
@@ -29,12 +40,82 @@ public:
 	 *	@return True on success, false otherwise.*/
 	virtual bool openDevice() = 0;
 
+	/** Get the number of bytes waiting to be written to the device.
+	  *	Connectors without an outgoing buffer return 0.
+	  *	@return The number of pending bytes.*/
+	virtual qint64 getPendingByteCount() const
+		{ return 0; }
+
+	/** Switch the device link to the binary protocol (see DeviceCommand::getBinaryFrame()).
+	  *	The variables get their binary ids in the order of the list, the device must support at least as many ids (see Device::getBinaryIdCount()).
+	  *	The switch is asynchronous, the commands sent in the meantime are delivered after it.
+	  *	Connectors without binary support return false and remain on the text protocol.
+	  *	@param varKeyList The variables to send in binary frames, as `hwInterface/variable`.
+	  *	@param rawTypeList The device-side types of the variables, in the same order.
+	  *	@return True if the switch is requested, false if the connector doesn't support the binary protocol.*/
+	virtual bool startBinaryProtocol( const QStringList &varKeyList, const QList<QVariant::Type> &rawTypeList )
+		{ Q_UNUSED(varKeyList); Q_UNUSED(rawTypeList); return false; }
+
+	/** Start flow control on the device link.
+	  *	The device acknowledges the data it has taken from its receive buffer, and the connector keeps the unacknowledged data below the window,
+	  *	holding back the rest until an acknowledge. So a burst of commands never overruns the device.
+	  *	Connectors without flow control support return false and send without limit.
+	  *	@param windowSize The size of the device receive buffer in bytes (see Device::getRxBufferSize()).
+	  *	@return True if flow control is started, false if the connector doesn't support it.*/
+	virtual bool startFlowControl( int windowSize )
+		{ Q_UNUSED(windowSize); return false; }
+
+	/** Get the deviceAPI from the device side of the link.
+	  *	Called before openDevice(), if no deviceAPI string is passed to DeviceAPI::initAPI().
+	  *	Connectors which can not provide it return an empty string, and the deviceAPI is loaded from file.
+	  *	@return The deviceAPI string, or an empty string.*/
+	virtual QString fetchDeviceApi()
+		{ return QString(); }
+
+	/** Get if the `set` commands of the link carry the user-side values instead of the raw device values.
+	  *	True for the link to an upstream proxy (see RelayDeviceConnector), which sends the converted values, as to any client.
+	  *	@return True if user-side values, false if raw values.*/
+	virtual bool carriesUserValues() const
+		{ return false; }
+
+	/** Get if the device link uses the binary protocol.
+	  *	@return True if binary, false if text.*/
+	virtual bool isBinaryProtocol() const
+		{ return false; }
+
 signals:
 
 	/** Emitted when a command is received.
 	  *	@param cmd The command object.*/
 	void commandReceived( DeviceCommand *cmd );
 
+protected:
+
+	/** Start the latency trace of a received command, if LatencyMonitor samples it.
+	  *	Call for every received command, before emitting commandReceived().
+	  *	@param cmd The received command.
+	  *	@param rxTime The time the command was received, as returned by LatencyTrace::now() at the end of the line.*/
+	void traceReceived( DeviceCommand *cmd, quint64 rxTime );
+
+	/** Parse a received command string, and emit commandReceived() with the parsed command(s).
+	  *	A batched command is expanded to single commands (see DeviceCommand::listFromString()), and every one of them is traced.
+	  *	@param cmdString The received command string.
+	  *	@param rxTime The time the command was received, as returned by LatencyTrace::now() at the end of the line.
+	  *	@return The number of emitted commands, 0 if the command string is invalid.*/
+	int emitReceived( const QString &cmdString, quint64 rxTime );
+
+	/** Emit commandReceived() with already parsed commands, and trace every one of them.
+	  *	@param cmdList The received commands.
+	  *	@param rxTime The time the commands were received, as returned by LatencyTrace::now().
+	  *	@return The number of emitted commands.*/
+	int emitReceived( const QList<DeviceCommand*> &cmdList, quint64 rxTime );
+
+	/** Get a setting of the connector for the device of the link (see ProxySettingsManager::deviceValue()).
+	  *	@param key The key of the setting.
+	  *	@return The setting.*/
+	QVariant deviceSetting( const QString &key ) const;
+
+	const Device *mDevice;	///< The device of the link.
 };
 
 }	//QtuC::
@@ -0,0 +1,127 @@
+#include "DeviceRequestTracker.h"
+#include "ProxySettingsManager.h"
+#include "LatencyTrace.h"
+#include <QStringList>
+
+using namespace QtuC;
+
+DeviceRequestTracker::DeviceRequestTracker( const QString &deviceId, QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mTimeoutCount(0),
+	mTimeoutsInRow(0),
+	mHealth(healthUnknown)
+{
+	quint64 timeoutMs = ProxySettingsManager::instance()->deviceValue( deviceId, "deviceSend/getTimeoutMs" ).toULongLong();
+	if( timeoutMs == 0 )
+		{ timeoutMs = 1000; }
+	mTimeoutUs = timeoutMs * 1000;
+
+	mTimeoutTimer = new QTimer(this);
+	mTimeoutTimer->setInterval( qMax( (int)timeoutMs/4, 1 ) );
+	connect( mTimeoutTimer, SIGNAL(timeout()), this, SLOT(checkTimeouts()) );
+}
+
+void DeviceRequestTracker::addRequest( const QString &hwInterface, const QString &varName )
+{
+	request_t request;
+	request.scheduledUs = LatencyTrace::now();
+	request.sentUs = 0;
+	mOutstanding.insert( key( hwInterface, varName ), request );
+}
+
+void DeviceRequestTracker::handleSent( const DeviceCommand *cmd )
+{
+	if( cmd->getType() != deviceCmdGet )
+		{ return; }
+	QHash<QString,request_t>::iterator request = mOutstanding.find( key( cmd->getHwInterface(), cmd->getVariable() ) );
+	if( request != mOutstanding.end() && !request->sentUs )
+	{
+		request->sentUs = LatencyTrace::now();
+		if( !mTimeoutTimer->isActive() )
+			{ mTimeoutTimer->start(); }
+	}
+}
+
+void DeviceRequestTracker::handleReply( const QString &hwInterface, const QString &varName )
+{
+	QHash<QString,request_t>::iterator request = mOutstanding.find( key( hwInterface, varName ) );
+	if( request == mOutstanding.end() )
+		{ return; }
+
+	quint64 now = LatencyTrace::now();
+	quint64 sentUs = request->sentUs ? request->sentUs : request->scheduledUs;
+	quint64 rttUs = ( now > sentUs ) ? now - sentUs : 0;
+	mRtt.add( rttUs );
+
+	// smoothed as the TCP RTT estimate, 1/8 of the new sample
+	QHash<QString,quint64>::iterator varRtt = mVariableRtt.find( request.key() );
+	if( varRtt == mVariableRtt.end() )
+		{ mVariableRtt.insert( request.key(), rttUs ); }
+	else
+		{ *varRtt = ( *varRtt * 7 + rttUs ) / 8; }
+
+	mOutstanding.erase( request );
+	if( mOutstanding.isEmpty() )
+		{ mTimeoutTimer->stop(); }
+
+	mTimeoutsInRow = 0;
+	setHealth( healthOk );
+}
+
+void DeviceRequestTracker::clear()
+{
+	mOutstanding.clear();
+	mTimeoutTimer->stop();
+}
+
+void DeviceRequestTracker::checkTimeouts()
+{
+	quint64 now = LatencyTrace::now();
+	QStringList timedOut;
+	bool sentLeft = false;
+	QHash<QString,request_t>::iterator request = mOutstanding.begin();
+	while( request != mOutstanding.end() )
+	{
+		// a get still in the scheduler queue is not the device's delay, its timeout starts when it's written
+		if( request->sentUs && now - request->sentUs > mTimeoutUs )
+		{
+			timedOut.append( request.key() );
+			request = mOutstanding.erase( request );
+			continue;
+		}
+		sentLeft = sentLeft || request->sentUs;
+		++request;
+	}
+	if( !sentLeft )
+		{ mTimeoutTimer->stop(); }
+	if( timedOut.isEmpty() )
+		{ return; }
+
+	mTimeoutCount += timedOut.size();
+	++mTimeoutsInRow;
+	debug( debugLevelVerbose, QString("Device get timed out for %1").arg(timedOut.join(", ")), "checkTimeouts()" );
+
+	if( mTimeoutsInRow >= MStalledTimeouts )
+		{ setHealth( healthStalled ); }
+	else if( mTimeoutsInRow >= MDegradedTimeouts )
+		{ setHealth( healthDegraded ); }
+}
+
+void DeviceRequestTracker::setHealth( health_t health )
+{
+	if( health == mHealth )
+		{ return; }
+	mHealth = health;
+	emit healthChanged( health );
+}
+
+QString DeviceRequestTracker::healthToString( health_t health )
+{
+	switch( health )
+	{
+		case healthOk: return "ok";
+		case healthDegraded: return "degraded";
+		case healthStalled: return "stalled";
+		default: return "unknown";
+	}
+}
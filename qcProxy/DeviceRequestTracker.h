@@ -0,0 +1,135 @@
+#ifndef DEVICEREQUESTTRACKER_H
+#define DEVICEREQUESTTRACKER_H
+
+#include "ErrorHandlerBase.h"
+#include "DeviceCommand.h"
+#include "LatencyHistogram.h"
+#include <QHash>
+#include <QTimer>
+
+namespace QtuC
+{
+
+/** Track the get commands sent to the device until the device replies with a set of the same variable.
+  *	A variable has at most one outstanding get: DeviceAPI doesn't send a new one while the previous is outstanding, which spares the redundant polls of a slow device.
+  *	The round-trip time is measured from the time the get is written to the device link (see DeviceCommandScheduler::commandSent()), for every variable (smoothed), and in a histogram for all of them.
+  *	A get without a reply in `deviceSend/getTimeoutMs` milliseconds from sending times out, so the variable is polled again. A get still queued in the scheduler doesn't time out.
+  *	The health of the device connection follows the timeout checks in a row which found a timed out get: one is degraded, three are stalled, a reply makes it ok again.*/
+class DeviceRequestTracker : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/// Health of the device connection.
+	enum health_t
+	{
+		healthUnknown,	///< No reply yet.
+		healthOk,		///< The device replies.
+		healthDegraded,	///< A get has timed out.
+		healthStalled	///< Several gets have timed out in a row, the device is probably not responding.
+	};
+
+	/** Create.
+	  *	@param deviceId Id of the device, for its settings (see ProxySettingsManager::deviceValue()).
+	  *	@param parent Parent object.*/
+	explicit DeviceRequestTracker( const QString &deviceId, QObject *parent = 0 );
+
+	/** Check if a variable has an outstanding get.
+	  *	@param hwInterface Interface of the variable.
+	  *	@param varName Name of the variable.
+	  *	@return True if a get is outstanding, false otherwise.*/
+	bool isOutstanding( const QString &hwInterface, const QString &varName ) const
+		{ return mOutstanding.contains( key( hwInterface, varName ) ); }
+
+	/** Add an outstanding get.
+	  *	Call this when the get is scheduled, the round-trip time is measured from handleSent().
+	  *	@param hwInterface Interface of the variable.
+	  *	@param varName Name of the variable.*/
+	void addRequest( const QString &hwInterface, const QString &varName );
+
+	/** Handle a set received from the device.
+	  *	If the variable has an outstanding get, this is the reply: the round-trip time is measured, and the get is no longer outstanding.
+	  *	@param hwInterface Interface of the variable.
+	  *	@param varName Name of the variable.*/
+	void handleReply( const QString &hwInterface, const QString &varName );
+
+	/** Forget the outstanding gets.
+	  *	Call this when the replies can not arrive any more, e.g. on device reset.*/
+	void clear();
+
+	/// Get the health of the device connection.
+	health_t getHealth() const
+		{ return mHealth; }
+
+	/** Get the name of a health state.
+	  *	@param health The health.
+	  *	@return The name (unknown, ok, degraded, stalled).*/
+	static QString healthToString( health_t health );
+
+	/// Get the number of outstanding gets.
+	int getOutstandingCount() const
+		{ return mOutstanding.size(); }
+
+	/// Get the number of gets timed out since start.
+	quint64 getTimeoutCount() const
+		{ return mTimeoutCount; }
+
+	/// Get the round-trip times of all variables.
+	const LatencyHistogram &getRtt() const
+		{ return mRtt; }
+
+	/** Get the smoothed round-trip times of the variables.
+	  *	@return The times in microseconds, by `hwInterface/variable`, only for the variables with a reply.*/
+	const QHash<QString,quint64> &getVariableRttList() const
+		{ return mVariableRtt; }
+
+public slots:
+
+	/** Handle a command written to the device link.
+	  *	Connected to DeviceCommandScheduler::commandSent(). The send time of an outstanding get is set.
+	  *	@param cmd The command.*/
+	void handleSent( const DeviceCommand *cmd );
+
+signals:
+
+	/** Emitted when the health of the device connection changes.
+	  *	@param health The new health.*/
+	void healthChanged( DeviceRequestTracker::health_t health );
+
+private slots:
+
+	/// Remove the outstanding gets sent longer ago than the timeout, and update the health.
+	void checkTimeouts();
+
+private:
+
+	/// An outstanding get.
+	struct request_t
+	{
+		quint64 scheduledUs;	///< The time the get was scheduled.
+		quint64 sentUs;			///< The time the get was written, 0 if not yet.
+	};
+
+	/// Get the key of a variable.
+	static QString key( const QString &hwInterface, const QString &varName )
+		{ return hwInterface + '/' + varName; }
+
+	/** Set the health, and emit healthChanged() if changed.
+	  *	@param health The new health.*/
+	void setHealth( health_t health );
+
+	static const int MDegradedTimeouts = 1;	///< Timeout checks in a row with a timeout, to be degraded.
+	static const int MStalledTimeouts = 3;	///< Timeout checks in a row with a timeout, to be stalled.
+
+	QHash<QString,request_t> mOutstanding;	///< The outstanding gets by key().
+	QHash<QString,quint64> mVariableRtt;	///< Smoothed round-trip time of the variables by key().
+	LatencyHistogram mRtt;
+	QTimer *mTimeoutTimer;
+	quint64 mTimeoutUs;
+	quint64 mTimeoutCount;
+	int mTimeoutsInRow;		///< Timeout checks in a row which found a timed out get.
+	health_t mHealth;
+};
+
+}	//QtuC::
+#endif // DEVICEREQUESTTRACKER_H
@@ -1,9 +1,12 @@
 #include "DeviceStateManager.h"
 #include "DeviceStateProxyVariable.h"
+#include "Device.h"
 
 using namespace QtuC;
 
-DeviceStateManager::DeviceStateManager( QObject *parent ) : StateManagerBase(parent)
+DeviceStateManager::DeviceStateManager( const Device *device, QObject *parent ) :
+	StateManagerBase(parent),
+	mDevice(device)
 {
 
 }
@@ -15,11 +18,19 @@ bool DeviceStateManager::registerNewStateVariable( QHash<QString,QString> params
 		params.insert( "userType", params["type"] );
 		params.insert( "deviceType", params["type"] );
 	}
+	if( !mDevice->isValidHwInterface( params["hwInterface"] ) )
+	{
+		error( QtWarningMsg, "Attempt to create a DeviceStateVariable with invalid hardware interface: "+params["hwInterface"]+". Variable not created.", "registerNewStateVariable(QHash<QString,QString>)" );
+		return false;
+	}
 	DeviceStateProxyVariable *newStateVar = DeviceStateProxyVariable::init( params["hwInterface"], params["name"], params["userType"], params["deviceType"], params["access-mode"], params["toUserScript"], params["toDeviceScript"] );
 	if( newStateVar )
 	{
 		//set autoupdate if necessary
 		/// @todo dont start this in passThrough mode!!
+		connect( newStateVar, SIGNAL(streamMe(quint32)), this, SLOT(onStreamRequest(quint32)) );
+		if( params.contains("autoUpdate-device-mode") )
+			{ newStateVar->setAutoUpdateMode( DeviceStateProxyVariable::autoUpdateModeFromString( params.value("autoUpdate-device-mode") ) ); }
 		if( params.contains("autoUpdate-device") )
 		{
 			bool ok;
@@ -64,3 +75,8 @@ void DeviceStateManager::onSendRequest()
 {
 	emit stateVariableSendRequest( (DeviceStateProxyVariable*)sender() );
 }
+
+void DeviceStateManager::onStreamRequest( quint32 intervalMs )
+{
+	emit stateVariableStreamRequest( (DeviceStateProxyVariable*)sender(), intervalMs );
+}
@@ -7,13 +7,18 @@
 namespace QtuC
 {
 
+class Device;
+
 /** Class DeviceStateManager.
  *	Manages the state of the device through the DeviceStateVariables.*/
 class DeviceStateManager : public StateManagerBase
 {
 	Q_OBJECT
 public:
-	DeviceStateManager( QObject *parent = 0 );
+	/** Create.
+	  *	@param device The device of the variables, only variables of its hardware interfaces are registered.
+	  *	@param parent Parent object.*/
+	DeviceStateManager( const Device *device, QObject *parent = 0 );
 
 public slots:
 
@@ -30,6 +35,11 @@ signals:
 	  *	@param stateVar The stateVariable who made the request.*/
 	void stateVariableSendRequest( DeviceStateProxyVariable *stateVar );
 
+	/** Emitted when a state variable in push auto-update mode requested a device stream.
+	  *	@param stateVar The stateVariable who made the request.
+	  *	@param intervalMs The interval of the stream in milliseconds, 0 to stop the stream.*/
+	void stateVariableStreamRequest( DeviceStateProxyVariable *stateVar, quint32 intervalMs );
+
 private slots:
 
 	/** Handle update request from a state variable.*/
@@ -37,6 +47,12 @@ private slots:
 
 	/** Rrequest to send a set command.*/
 	void onSendRequest();
+
+	/** Request to start, change or stop a device stream.*/
+	void onStreamRequest( quint32 intervalMs );
+
+private:
+	const Device *mDevice;
 };
 
 }	//QtuC::
@@ -1,5 +1,6 @@
 #include "DeviceStateProxyVariable.h"
-#include "Device.h"
+#include "ProxyMetrics.h"
+#include <QElapsedTimer>
 
 using namespace QtuC;
 
@@ -12,6 +13,9 @@ DeviceStateProxyVariable::DeviceStateProxyVariable(const DeviceStateProxyVariabl
 	mConvertToRawScript = otherVar.getConvertScript(false);
 	mConvertFromRawScript = otherVar.getConvertScript(true);
 	mAutoUpdateInterval = otherVar.getAutoUpdateInterval();
+	mAutoUpdateTimer = 0;
+	mAutoUpdateMode = otherVar.getAutoUpdateMode();
+	mAutoUpdatePushActive = false;
 
 	if( otherVar.isAutoUpdateActive() )
 	{
@@ -32,12 +36,6 @@ DeviceStateProxyVariable* DeviceStateProxyVariable::init( const QString &varHwIn
 	if( !checkBaseInitParams( varHwInterface, varName, varType ) )
 		{ return 0; }
 
-	if( !Device::isValidHwInterface(varHwInterface) )
-	{
-		error( QtWarningMsg, "Attempt to create a DeviceStateVariable with invalid hardware interface: "+varHwInterface+". Variable not created.", "init()", "DeviceStateProxyVariable" );
-		return 0;
-	}
-
 	if( !varRawType.isEmpty() && !isValidType(varRawType) )
 	{
 		error( QtWarningMsg, "DeviceStateVariable initialized an invalid rawType ("+varRawType+")! Variable not created.", "init()", "DeviceStateProxyVariable" );
@@ -50,7 +48,9 @@ DeviceStateProxyVariable* DeviceStateProxyVariable::init( const QString &varHwIn
 DeviceStateProxyVariable::DeviceStateProxyVariable( const QString& varHwInterface, const QString& varName, const QString& varType, const QString& varRawType, const QString &accessModeStr, const QString convertScriptFromRaw, const QString convertScriptToRaw )
 	: DeviceStateVariableBase( varHwInterface, varName, varType, accessModeStr ),
 	  mAutoUpdateInterval(0),
-	  mAutoUpdateTimer(0)
+	  mAutoUpdateTimer(0),
+	  mAutoUpdateMode(autoUpdatePoll),
+	  mAutoUpdatePushActive(false)
 {
 	if( varRawType.isEmpty() )
 		{ mRawType = mType; }
@@ -102,6 +102,38 @@ void DeviceStateProxyVariable::updateFromDevice( const QString& newRawValue, con
 	}
 }
 
+void DeviceStateProxyVariable::updateFromUpstream( const QString& newValue, const qint64 &timestamp )
+{
+	QVariant castNewVal( variantFromString( newValue, mType ) );
+
+	if( !castNewVal.isValid() || castNewVal.isNull() )
+	{
+		errorDetails_t errDetails;
+		errDetails.insert( "name", mName );
+		errDetails.insert( "type",  QString(QVariant::typeToName(mType)) );
+		errDetails.insert( "newValue", newValue );
+		error( QtWarningMsg, "Invalid value from upstream proxy!", "updateFromUpstream()", errDetails );
+		return;
+	}
+
+	if( mValue != castNewVal )
+	{
+		mValue = castNewVal;
+		timestamp? mLastUpdate = timestamp : mLastUpdate = QDateTime::currentMSecsSinceEpoch();
+		// the raw value follows without emitValueChangedRaw(), which would send the value back (see updateFromDevice())
+		scriptConvert( false );
+		emit updated();
+		emitValueChanged();
+	}
+}
+
+LatencyTrace DeviceStateProxyVariable::takeTrace()
+{
+	LatencyTrace trace = mTrace;
+	mTrace.clear();
+	return trace;
+}
+
 const QString DeviceStateProxyVariable::getConvertScript(bool fromRaw) const
 {
 	if( fromRaw )
@@ -245,7 +277,10 @@ bool DeviceStateProxyVariable::scriptConvert( bool fromRaw )
 	else
 	{
 		mConvertEngine.globalObject().setProperty( mName, mConvertEngine.newVariant(fromType) );
+		QElapsedTimer scriptTimer;
+		scriptTimer.start();
 		QVariant scriptReturn = mConvertEngine.evaluate(*convertScript).toVariant();
+		ProxyMetrics::instance()->addScriptConversion( scriptTimer.nsecsElapsed() / 1000 );
 
 		if( mConvertEngine.hasUncaughtException() )
 		{
@@ -321,9 +356,6 @@ bool DeviceStateProxyVariable::startAutoUpdate( quint32 intervalMs )
 		return false;
 	}
 
-	if( !mAutoUpdateTimer )
-		{ mAutoUpdateTimer = new QTimer(this); }
-
 	if( intervalMs == 0 && mAutoUpdateInterval )
 		{ intervalMs = mAutoUpdateInterval; }
 
@@ -339,7 +371,20 @@ bool DeviceStateProxyVariable::startAutoUpdate( quint32 intervalMs )
 		return false;
 	}
 
-	connect( mAutoUpdateTimer, SIGNAL(timeout()), this, SIGNAL(updateMe()) );
+	if( mAutoUpdateMode == autoUpdatePush )
+	{
+		mAutoUpdatePushActive = true;
+		emit streamMe( mAutoUpdateInterval );
+		debug( debugLevelVerbose, QString("Device push requested at a %3ms interval for variable %2:%1").arg(mName, mHwInterface, QString::number(mAutoUpdateInterval)), "startAutoUpdate()" );
+		return true;
+	}
+
+	if( !mAutoUpdateTimer )
+	{
+		mAutoUpdateTimer = new QTimer(this);
+		connect( mAutoUpdateTimer, SIGNAL(timeout()), this, SIGNAL(updateMe()) );
+	}
+	mAutoUpdateTimer->setInterval( mAutoUpdateInterval );
 	mAutoUpdateTimer->start();
 
 	debug( debugLevelVerbose, QString("Auto-update started at a %3ms interval for variable %2:%1").arg(mName, mHwInterface, QString::number(mAutoUpdateInterval)), "startAutoUpdate()" );
@@ -364,6 +409,8 @@ bool DeviceStateProxyVariable::setAutoUpdateInterval( quint32 intervalMs )
 	mAutoUpdateInterval = intervalMs;
 	if( mAutoUpdateTimer )
 		{ mAutoUpdateTimer->setInterval( intervalMs ); }
+	if( mAutoUpdatePushActive )
+		{ emit streamMe( intervalMs ); }
 
 	return true;
 }
@@ -391,12 +438,36 @@ bool DeviceStateProxyVariable::setConvertScript( bool fromRaw, const QString &sc
 
 void DeviceStateProxyVariable::stopAutoUpdate()
 {
-	mAutoUpdateTimer->stop();
+	if( mAutoUpdateTimer )
+		{ mAutoUpdateTimer->stop(); }
+	if( mAutoUpdatePushActive )
+	{
+		mAutoUpdatePushActive = false;
+		emit streamMe( 0 );
+	}
 }
 
 bool DeviceStateProxyVariable::isAutoUpdateActive() const
 {
-	return mAutoUpdateTimer->isActive();
+	return mAutoUpdatePushActive || ( mAutoUpdateTimer && mAutoUpdateTimer->isActive() );
+}
+
+bool DeviceStateProxyVariable::setAutoUpdateMode( autoUpdateMode_t mode )
+{
+	if( isAutoUpdateActive() )
+	{
+		error( QtWarningMsg, QString("Cannot change auto-update mode while auto-update is active (var: %1:%2)").arg(mHwInterface,mName), "setAutoUpdateMode()" );
+		return false;
+	}
+	mAutoUpdateMode = mode;
+	return true;
+}
+
+DeviceStateProxyVariable::autoUpdateMode_t DeviceStateProxyVariable::autoUpdateModeFromString( const QString &modeStr )
+{
+	if( modeStr == "push" )
+		{ return autoUpdatePush; }
+	return autoUpdatePoll;
 }
 
 int DeviceStateProxyVariable::getAutoUpdateInterval() const
@@ -3,6 +3,7 @@
 
 #include <DeviceStateVariableBase.h>
 #include <QScriptEngine>
+#include "LatencyTrace.h"
 
 namespace QtuC
 {
@@ -23,6 +24,13 @@ class DeviceStateProxyVariable : public DeviceStateVariableBase
 
 public:
 
+	/// How the device-side auto-update is done.
+	enum autoUpdateMode_t
+	{
+		autoUpdatePoll,	///< The proxy sends a get command to the device on every tick.
+		autoUpdatePush	///< The device is asked to push the variable periodically (device stream), the proxy sends nothing while it runs.
+	};
+
 	/** Copy constructor.*/
 	DeviceStateProxyVariable( const DeviceStateProxyVariable &otherVar );
 
@@ -63,6 +71,16 @@ public:
 	  *	@return The string formatted for the device.*/
 	const QString getDeviceReadyString() const;
 
+	/** Take the latency trace of the last update.
+	  *	The trace is cleared, so it is only sent with the first subscription feed after the update.
+	  *	@return The trace, empty if the last update was not traced or the trace was already taken.*/
+	LatencyTrace takeTrace();
+
+	/** Set the latency trace of the last update.
+	  *	@param trace The trace of the device command which updated the variable.*/
+	void setTrace( const LatencyTrace &trace )
+		{ mTrace = trace; }
+
 	/** Get the state of auto-update.
 	  * @returns True if auto-update is active, false if not.*/
 	bool isAutoUpdateActive() const;
@@ -71,12 +89,29 @@ public:
 	  * @returns The interval of auto-update in milliseconds, even if auto-update is inactive.*/
 	int getAutoUpdateInterval() const;
 
+	/** Get the mode of auto-update.
+	  * @returns The auto-update mode.*/
+	autoUpdateMode_t getAutoUpdateMode() const
+		{ return mAutoUpdateMode; }
+
+	/** Set the mode of auto-update.
+	  *	Set it before startAutoUpdate(), changing the mode of an active auto-update is not possible.
+	  *	@param mode The new mode.
+	  *	@return True on success, false if auto-update is active.*/
+	bool setAutoUpdateMode( autoUpdateMode_t mode );
+
+	/** Get auto-update mode from string.
+	  *	@param modeStr The mode string as in the deviceAPI (`poll` or `push`).
+	  *	@return The mode, autoUpdatePoll if the string is invalid.*/
+	static autoUpdateMode_t autoUpdateModeFromString( const QString &modeStr );
+
 public slots:
 
 	/** Start auto-update.
 	  * Start the auto update cycle for this variable.
 	  * The parameters for the auto-update can be set in the deviceAPI file. If there's no information for the update in deviceAPI,
 	  * intervalMs parameter is omitted, and this is the first call of startAutoUpdate() (so there's no previous interval info), this function does nothing, and returns false.
+	  * In push mode no timer is started, streamMe() is emitted to ask the device for a stream instead.
 	  * @param intervalMs The auto-update interval. See setAutoUpdateInterval(). This param overrides any possible deviceAPI data.
 	  * @returns True if the updater starts, false otherwise.*/
 	bool startAutoUpdate( quint32 intervalMs = 0 );
@@ -136,8 +171,12 @@ public slots:
 	bool setRawValue( bool newRawValue );
 
 	/// Inherited from base.
-	void updateFromSource( const QString& newValue )
-		{ updateFromDevice( newValue ); } // When changing to QVariant arg, just pass newValue.toString() to updateFromDevice.
+	void updateFromSource( const QString& newValue, qint64 const &timestamp = 0 )
+		{ updateFromDevice( newValue, timestamp ); }
+
+	/// Inherited from base.
+	void updateFromSource( const QVariant& newValue, qint64 const &timestamp = 0 )
+		{ updateFromDevice( newValue.toString(), timestamp ); }
 
 	/** Updates the rawValue of the variable as got from the device.
 	 *	Call or connect this slot when you receive a set command from the device.
@@ -146,6 +185,13 @@ public slots:
 	 *	@param timestamp An optional timestamp value. If given, the last update time of the variable will be set to this stamp. If omitted, the current time will be used.*/
 	void updateFromDevice( const QString& newRawValue, qint64 const &timestamp = 0 );
 
+	/** Updates the user-side value of the variable as got from an upstream proxy (see RelayDeviceConnector).
+	 *	The upstream proxy sends the converted values, so the raw value is calculated from the new value, but sendMe() is not emitted.
+	 *	Emits updated() and all valueChanged signals.
+	 *	@param newValue The new user-side value (string) as parsed from the command.
+	 *	@param timestamp An optional timestamp value. If given, the last update time of the variable will be set to this stamp. If omitted, the current time will be used.*/
+	void updateFromUpstream( const QString& newValue, qint64 const &timestamp = 0 );
+
 private slots:
 
 	/** Calculate raw or user-side value based on the convert scripts.
@@ -169,6 +215,10 @@ signals:
 	void valueChangedRaw( double );		///< Emitted if rawValue has changed. @param The rawValue cast to a double.
 	void valueChangedRaw( bool );		///< Emitted if rawValue has changed. @param The rawValue cast to a boolean.
 
+	/** Emitted in push mode, when the device stream of the variable must be started, changed or stopped.
+	  *	@param intervalMs The new interval of the stream in milliseconds, 0 to stop the stream.*/
+	void streamMe( quint32 intervalMs );
+
 private:
 	/** A private constructor.
 	 *	Use init() to create a new DeviceStateVariable.
@@ -188,7 +238,10 @@ private:
 	QString mConvertFromRawScript;	///< fromRaw script string. Used to convert the value from device to user side.
 	quint32 mAutoUpdateInterval;	///< Auto update interval, milliseconds, 32bit unsigned integer.
 	QTimer* mAutoUpdateTimer;	///< Timer object for auto update.
+	autoUpdateMode_t mAutoUpdateMode;	///< Poll or push auto-update.
+	bool mAutoUpdatePushActive;	///< True if the device stream is requested (push mode).
 	static quint32 minAutoUpdateInterval;	///< Minimum allowed interval of auto-update timer.
+	LatencyTrace mTrace;	///< Latency trace of the last update, if traced.
 
 	void emitValueChangedRaw(); ///< Emit valueChangedRaw signals for all types.
 
@@ -1,10 +1,10 @@
 #include "DummySocketDevice.h"
-#include "ProxySettingsManager.h"
+#include "ProxyMetrics.h"
 
 using namespace QtuC;
 
-DummySocketDevice::DummySocketDevice(QObject *parent) :
-	DeviceConnectionManagerBase(parent)
+DummySocketDevice::DummySocketDevice( const Device *device, QObject *parent ) :
+	DeviceConnectionManagerBase(device, parent)
 {
 	connect( this, SIGNAL(quitRequestFromDevice()), this, SLOT(handleQuitRequestFromDevice()) );
 
@@ -84,13 +84,14 @@ void DummySocketDevice::handleDeviceData()
 			return;
 		}
 		mCmdRxBuffer = mCmdRxBufferShadow;
+		quint64 rxTime = LatencyTrace::now();
 		debug( debugLevelInfo, QString("Command received on serial: %1").arg(mCmdRxBuffer), "receivePart()" );
 
-		DeviceCommand *cmd = DeviceCommand::fromString( mCmdRxBuffer );
-		if( cmd )
-			{ emit commandReceived((DeviceCommand*)cmd); }
-		else
-			{ error( QtWarningMsg, "Invalid device command received, command dropped", "receivePart()"); }
+		if( !emitReceived( mCmdRxBuffer, rxTime ) )
+		{
+			error( QtWarningMsg, "Invalid device command received, command dropped", "receivePart()");
+			ProxyMetrics::instance()->countParseFailure();
+		}
 		mCmdRxBufferShadow.clear();
 	}
 }
@@ -122,22 +123,27 @@ void DummySocketDevice::closeDevice()
 	debug( debugLevelInfo, "Dummy device socket disconnected", "closeFile()" );
 }
 
+qint64 DummySocketDevice::getPendingByteCount() const
+{
+	return mDeviceSocket->bytesToWrite();
+}
+
 bool DummySocketDevice::openDevice()
 {
-	QString host = ProxySettingsManager::instance()->value("dummyDeviceSocket/host").toString();
+	QString host = deviceSetting("dummyDeviceSocket/host").toString();
 	if( host == "localhost" )
 		{ host = "127.0.0.1"; }
 
-	if( mDeviceServer->listen( QHostAddress(host), ProxySettingsManager::instance()->value("dummyDeviceSocket/port").toInt() ) )
+	if( mDeviceServer->listen( QHostAddress(host), deviceSetting("dummyDeviceSocket/port").toInt() ) )
 	{
-		debug( debugLevelVerbose, QString("Listening for dummy device on %1, port %2.").arg( ProxySettingsManager::instance()->value("dummyDeviceSocket/host").toString(), ProxySettingsManager::instance()->value("dummyDeviceSocket/port").toString() ), "openDevice()" );
+		debug( debugLevelVerbose, QString("Listening for dummy device on %1, port %2.").arg( deviceSetting("dummyDeviceSocket/host").toString(), deviceSetting("dummyDeviceSocket/port").toString() ), "openDevice()" );
 		return true;
 	}
 	else
 	{
 		errorDetails_t errDet;
 		errDet.insert( "error", mDeviceServer->errorString() );
-		error( QtCriticalMsg, QString("Listen for dummy device on %1, port %2").arg( ProxySettingsManager::instance()->value("dummyDeviceSocket/host").toString(), ProxySettingsManager::instance()->value("dummyDeviceSocket/port").toString() ), "openDevice()", errDet );
+		error( QtCriticalMsg, QString("Listen for dummy device on %1, port %2").arg( deviceSetting("dummyDeviceSocket/host").toString(), deviceSetting("dummyDeviceSocket/port").toString() ), "openDevice()", errDet );
 		return false;
 	}
 }
@@ -15,7 +15,7 @@ class DummySocketDevice : public DeviceConnectionManagerBase
 {
 	Q_OBJECT
 public:
-	explicit DummySocketDevice(QObject *parent = 0);
+	explicit DummySocketDevice( const Device *device, QObject *parent = 0 );
 
 	~DummySocketDevice();
 
@@ -28,6 +28,9 @@ public:
 	/// Inherited from DeviceConnectionManagerBase.
 	bool openDevice();
 
+	/// Inherited from DeviceConnectionManagerBase.
+	qint64 getPendingByteCount() const;
+
 signals:
 	/// Emitted when a close request is received from the dummy device (quit command)
 	void quitRequestFromDevice();
@@ -0,0 +1,201 @@
+#include "ProxyMetrics.h"
+#include "DeviceAPI.h"
+#include "ConnectionServer.h"
+#include "SharedStateServer.h"
+#include "ClientConnectionManagerBase.h"
+#include "ProxySettingsManager.h"
+#include "LatencyMonitor.h"
+#include <QStringList>
+
+using namespace QtuC;
+
+ProxyMetrics *ProxyMetrics::mInstance = 0;
+const int ProxyMetrics::mRateWindowMs = 1000;
+
+ProxyMetrics::ProxyMetrics( QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mDevice(0),
+	mConnectionServer(0),
+	mParseFailures(0),
+	mStateUpdates(0),
+	mSubscriptionTicks(0),
+	mRateWindowStart(0),
+	mRateWindowLines(0),
+	mRateWindowUpdates(0),
+	mRateWindowTicks(0),
+	mLinesPerSec(0.0),
+	mStateUpdatesPerSec(0.0),
+	mSubscriptionTicksPerSec(0.0)
+{
+	mProbeTimer = new QTimer(this);
+	connect( mProbeTimer, SIGNAL(timeout()), this, SLOT(probe()) );
+	mLogTimer = new QTimer(this);
+	connect( mLogTimer, SIGNAL(timeout()), this, SLOT(printReport()) );
+	mUptime.start();
+}
+
+ProxyMetrics::~ProxyMetrics()
+{
+	if( mInstance == this )
+		{ mInstance = 0; }
+}
+
+ProxyMetrics *ProxyMetrics::instance( QObject *parent )
+{
+	if( !mInstance )
+		{ mInstance = new ProxyMetrics(parent); }
+	return mInstance;
+}
+
+void ProxyMetrics::setSources( DeviceAPI *device, ConnectionServer *connectionServer )
+{
+	mDevice = device;
+	mConnectionServer = connectionServer;
+}
+
+void ProxyMetrics::start()
+{
+	int probeIntervalMs = ProxySettingsManager::instance()->value("metrics/probeIntervalMs").toInt();
+	if( probeIntervalMs <= 0 )
+	{
+		error( QtWarningMsg, "Invalid metrics/probeIntervalMs, fallback to 100ms", "start()" );
+		probeIntervalMs = 100;
+	}
+	mProbeClock.start();
+	mProbeTimer->start( probeIntervalMs );
+
+	int logIntervalMs = ProxySettingsManager::instance()->value("metrics/logIntervalMs").toInt();
+	if( logIntervalMs > 0 )
+		{ mLogTimer->start( logIntervalMs ); }
+}
+
+quint64 ProxyMetrics::getDeviceLineCount() const
+{
+	return ( mDevice ? mDevice->getReceivedCommandCount() : 0 ) + mParseFailures;
+}
+
+void ProxyMetrics::probe()
+{
+	// the timer should have fired exactly one interval after the previous probe, the difference is the time spent in other events
+	qint64 elapsedUs = mProbeClock.nsecsElapsed() / 1000;
+	mProbeClock.start();
+	qint64 lagUs = elapsedUs - (qint64)mProbeTimer->interval() * 1000;
+	mEventLoopLag.add( lagUs > 0 ? lagUs : 0 );
+
+	qint64 now = mUptime.elapsed();
+	if( now - mRateWindowStart >= mRateWindowMs )
+	{
+		double windowSec = ( now - mRateWindowStart ) / 1000.0;
+		quint64 lines = getDeviceLineCount();
+		mLinesPerSec = ( lines - mRateWindowLines ) / windowSec;
+		mStateUpdatesPerSec = ( mStateUpdates - mRateWindowUpdates ) / windowSec;
+		mSubscriptionTicksPerSec = ( mSubscriptionTicks - mRateWindowTicks ) / windowSec;
+		mRateWindowLines = lines;
+		mRateWindowUpdates = mStateUpdates;
+		mRateWindowTicks = mSubscriptionTicks;
+		mRateWindowStart = now;
+	}
+}
+
+const QHash<QString,QString> ProxyMetrics::getMetrics() const
+{
+	QHash<QString,QString> metrics;
+	metrics.insert( "uptimeSec", QString::number( mUptime.elapsed() / 1000 ) );
+
+	// device
+	metrics.insert( "device.lines", QString::number( getDeviceLineCount() ) );
+	metrics.insert( "device.linesPerSec", QString::number( mLinesPerSec, 'f', 1 ) );
+	metrics.insert( "device.parseFailures", QString::number( mParseFailures ) );
+	metrics.insert( "device.stateUpdates", QString::number( mStateUpdates ) );
+	metrics.insert( "device.stateUpdatesPerSec", QString::number( mStateUpdatesPerSec, 'f', 1 ) );
+	if( mDevice )
+		{ metrics.insert( "device.queueBytes", QString::number( mDevice->getPendingByteCount() ) ); }
+	if( mDevice && mDevice->getScheduler() )
+	{
+		metrics.insert( "device.scheduledCommands", QString::number( mDevice->getScheduler()->getScheduledCount() ) );
+		metrics.insert( "device.mergedCommands", QString::number( mDevice->getScheduler()->getMergedCount() ) );
+	}
+	if( mDevice )
+	{
+		const DeviceRequestTracker *tracker = mDevice->getRequestTracker();
+		metrics.insert( "device.health", DeviceRequestTracker::healthToString( tracker->getHealth() ) );
+		metrics.insert( "device.outstandingGets", QString::number( tracker->getOutstandingCount() ) );
+		metrics.insert( "device.getTimeouts", QString::number( tracker->getTimeoutCount() ) );
+		metrics.insert( "device.rttP50Us", QString::number( tracker->getRtt().getPercentile(50) ) );
+		metrics.insert( "device.rttP99Us", QString::number( tracker->getRtt().getPercentile(99) ) );
+		metrics.insert( "device.rttMaxUs", QString::number( tracker->getRtt().getMax() ) );
+		QHash<QString,quint64>::const_iterator varRtt = tracker->getVariableRttList().constBegin();
+		for( ; varRtt != tracker->getVariableRttList().constEnd(); ++varRtt )
+			{ metrics.insert( QString("device.var.%1.rttUs").arg(varRtt.key()), QString::number( varRtt.value() ) ); }
+	}
+
+	// convert scripts
+	metrics.insert( "script.conversions", QString::number( mScriptConversion.getCount() ) );
+	metrics.insert( "script.p50Us", QString::number( mScriptConversion.getPercentile(50) ) );
+	metrics.insert( "script.p99Us", QString::number( mScriptConversion.getPercentile(99) ) );
+	metrics.insert( "script.maxUs", QString::number( mScriptConversion.getMax() ) );
+
+	// subscriptions
+	metrics.insert( "subscription.ticks", QString::number( mSubscriptionTicks ) );
+	metrics.insert( "subscription.ticksPerSec", QString::number( mSubscriptionTicksPerSec, 'f', 1 ) );
+
+	// event loop
+	metrics.insert( "eventLoop.lagP50Us", QString::number( mEventLoopLag.getPercentile(50) ) );
+	metrics.insert( "eventLoop.lagP99Us", QString::number( mEventLoopLag.getPercentile(99) ) );
+	metrics.insert( "eventLoop.lagMaxUs", QString::number( mEventLoopLag.getMax() ) );
+
+	// clients
+	if( mConnectionServer )
+	{
+		metrics.insert( "clients", QString::number( mConnectionServer->getClientCount() ) );
+		for( int i=0; i<mConnectionServer->getClientCount(); ++i )
+		{
+			ClientConnectionManagerBase *client = mConnectionServer->getClient(i);
+			QString prefix = QString("client.%1.").arg( client->getID().isEmpty() ? QString::number(i) : client->getID() );
+			metrics.insert( prefix + "packetsSent", QString::number( client->getSentPacketCount() ) );
+			metrics.insert( prefix + "bytesSent", QString::number( client->getSentByteCount() ) );
+			metrics.insert( prefix + "packetsReceived", QString::number( client->getReceivedPacketCount() ) );
+			metrics.insert( prefix + "bytesReceived", QString::number( client->getReceivedByteCount() ) );
+			metrics.insert( prefix + "queueBytes", QString::number( client->getPendingByteCount() ) );
+		}
+
+		SharedStateServer *sharedState = mConnectionServer->getSharedStateServer();
+		if( sharedState )
+		{
+			metrics.insert( "sharedState.clients", QString::number( sharedState->getClientCount() ) );
+			metrics.insert( "sharedState.updates", QString::number( sharedState->getUpdateCount() ) );
+		}
+	}
+
+	// latency traces, if enabled
+	LatencyMonitor *latencyMonitor = LatencyMonitor::instance();
+	for( int i=1; i<LatencyTrace::traceStageCount; ++i )
+	{
+		const LatencyHistogram &hop = latencyMonitor->getHop( (LatencyTrace::traceStage_t)i );
+		if( !hop.getCount() )
+			{ continue; }
+		QString prefix = QString("latency.%1->%2.").arg( LatencyTrace::stageToString( (LatencyTrace::traceStage_t)(i-1) ), LatencyTrace::stageToString( (LatencyTrace::traceStage_t)i ) );
+		metrics.insert( prefix + "p50Us", QString::number( hop.getPercentile(50) ) );
+		metrics.insert( prefix + "p99Us", QString::number( hop.getPercentile(99) ) );
+		metrics.insert( prefix + "maxUs", QString::number( hop.getMax() ) );
+	}
+
+	return metrics;
+}
+
+const QString ProxyMetrics::getReport() const
+{
+	QHash<QString,QString> metrics = getMetrics();
+	QStringList names = metrics.keys();
+	names.sort();
+
+	QStringList lines;
+	for( int i=0; i<names.size(); ++i )
+		{ lines.append( QString("%1: %2").arg( names.at(i), metrics.value(names.at(i)) ) ); }
+	return lines.join("\n");
+}
+
+void ProxyMetrics::printReport()
+{
+	debug( debugLevelInfo, QString("Proxy metrics:\n%1").arg( getReport() ), "printReport()" );
+}
@@ -0,0 +1,112 @@
+#ifndef PROXYMETRICS_H
+#define PROXYMETRICS_H
+
+#include "ErrorHandlerBase.h"
+#include "LatencyHistogram.h"
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+
+namespace QtuC
+{
+
+class DeviceAPI;
+class ConnectionServer;
+
+/** Runtime metrics of the proxy.
+ *	Counters are incremented in place by the code doing the work (see the count*() functions), everything else (per-client traffic, queue depths, the
+ *	received device command count) is read from the sources only when the metrics are requested, so the metrics can be left on all the time.
+ *	A probe timer measures the event loop lag (how late the timer fires) and updates the per second rates.
+ *
+ *	The metrics can be requested by clients with the [reqMetrics](@ref doc-clientProtocol-command-control-reqMetrics) command, and printed periodically (`metrics/logIntervalMs` setting).
+ *	This is a singleton, use instance() to get it.*/
+class ProxyMetrics : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	/** Get the instance.
+	  *	@param parent On first call, the object will be created, so a parent argument should be passed. On subsequent calls, you can omit it.
+	  *	@return The ProxyMetrics instance.*/
+	static ProxyMetrics *instance( QObject *parent = 0 );
+
+	~ProxyMetrics();
+
+	/** Set the objects to read the metrics from.
+	  *	@param device The device API.
+	  *	@param connectionServer The connection server of the clients.*/
+	void setSources( DeviceAPI *device, ConnectionServer *connectionServer );
+
+	/** Start the probe timer and the periodic log, as set in the settings.*/
+	void start();
+
+	/// Count a device command line that could not be parsed.
+	void countParseFailure()
+		{ ++mParseFailures; }
+
+	/// Count a state variable update from the device.
+	void countStateUpdate()
+		{ ++mStateUpdates; }
+
+	/// Count a subscription tick.
+	void countSubscriptionTick()
+		{ ++mSubscriptionTicks; }
+
+	/** Add the duration of a value conversion script run.
+	  *	@param timeUs The duration in microseconds.*/
+	void addScriptConversion( quint64 timeUs )
+		{ mScriptConversion.add( timeUs ); }
+
+	/** Get all metrics.
+	  *	Keys are dot-separated names (for example `device.linesPerSec`, `client.qcGui.bytesSent`), values are numbers as strings.
+	  *	@return The metrics.*/
+	const QHash<QString,QString> getMetrics() const;
+
+	/** Get the metrics as text, one `name: value` pair in each line, sorted by name.
+	  *	@return The metrics report.*/
+	const QString getReport() const;
+
+private slots:
+
+	/// Measure the event loop lag and update the rates.
+	void probe();
+
+	/// Print the report.
+	void printReport();
+
+private:
+
+	/** Private constructor, use instance().*/
+	explicit ProxyMetrics( QObject *parent = 0 );
+
+	/** Get the number of device command lines received (parsed or not).*/
+	quint64 getDeviceLineCount() const;
+
+	static ProxyMetrics *mInstance;
+	DeviceAPI *mDevice;
+	ConnectionServer *mConnectionServer;
+
+	quint64 mParseFailures;
+	quint64 mStateUpdates;
+	quint64 mSubscriptionTicks;
+	LatencyHistogram mScriptConversion;		///< Duration of the convert script runs.
+
+	QTimer *mProbeTimer;
+	QTimer *mLogTimer;
+	QElapsedTimer mUptime;
+	QElapsedTimer mProbeClock;		///< Measures the time since the previous probe.
+	LatencyHistogram mEventLoopLag;
+
+	qint64 mRateWindowStart;	///< Start of the current rate window, milliseconds of mUptime.
+	quint64 mRateWindowLines;	///< Device lines at the start of the window.
+	quint64 mRateWindowUpdates;	///< State updates at the start of the window.
+	quint64 mRateWindowTicks;	///< Subscription ticks at the start of the window.
+	double mLinesPerSec;
+	double mStateUpdatesPerSec;
+	double mSubscriptionTicksPerSec;
+
+	static const int mRateWindowMs;		///< Length of the window the rates are calculated for.
+};
+
+}	//QtuC::
+#endif // PROXYMETRICS_H
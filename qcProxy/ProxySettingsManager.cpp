@@ -6,7 +6,11 @@ using namespace QtuC;
 
 QString ProxySettingsManager::mCmdArgNames[] = {
 	QString("passthrough"),
-	QString("verbose")
+	QString("verbose"),
+	QString("record"),
+	QString("replay"),
+	QString("replay-speed"),
+	QString("connector")
 };
 
 ProxySettingsManager::ProxySettingsManager(QObject *parent) :
@@ -15,6 +19,10 @@ ProxySettingsManager::ProxySettingsManager(QObject *parent) :
 	if( !contains("apiFilePath") )
 		{ setValue( "apiFilePath", "deviceAPI.xml" ); }
 
+	// devices: the settings of a device can be overridden in the devices/<id>/ group, see deviceValue()
+	if( !contains("devices/ids") )
+		{ setValue( "devices/ids", QString() ); }	// comma separated ids of the devices, each with its own connector and deviceAPI, empty: a single device
+
 	// Device
 	if( !contains("device/commandSeparator") )
 		{ setValue( "device/commandSeparator", QChar(' ') ); }
@@ -22,6 +30,25 @@ ProxySettingsManager::ProxySettingsManager(QObject *parent) :
 	if( !contains("device/timeTicksPerMs") )
 		{ setValue( "device/timeTicksPerMs", 1000.0 ); }
 
+	if( !contains("device/connector") )
+		{ setValue( "device/connector", "serial" ); }	// serial, dummySocket, replay, simulated, relay
+
+	if( !contains("device/binaryProtocol") )
+		{ setValue( "device/binaryProtocol", false ); }	// use the binary protocol, if the device supports it
+
+	if( !contains("device/flowControl") )
+		{ setValue( "device/flowControl", true ); }	// never send more than the device can buffer, if the device supports it
+
+	// deviceSend: see DeviceCommandScheduler
+	if( !contains("deviceSend/maxPendingBytes") )
+		{ setValue( "deviceSend/maxPendingBytes", 256 ); }	// hold the commands back while this many bytes wait to be written to the device, 0 for no limit
+	if( !contains("deviceSend/rate") )
+		{ setValue( "deviceSend/rate", 0 ); }	// pace the commands to this many bytes per second, 0 for no pacing
+	if( !contains("deviceSend/burst") )
+		{ setValue( "deviceSend/burst", 512 ); }	// bytes that can be sent at once when paced
+	if( !contains("deviceSend/getTimeoutMs") )
+		{ setValue( "deviceSend/getTimeoutMs", 1000 ); }	// a get without reply in this time is timed out, see DeviceRequestTracker
+
 	// devicePort
 	if( !contains("devicePort/portName") )
 		{ setValue( "devicePort/portName", "/dev/ttyS1"); }
@@ -46,6 +73,22 @@ ProxySettingsManager::ProxySettingsManager(QObject *parent) :
 		{ setValue( "serverSocket/port", 24563 ); }
 	if( !contains("serverSocket/heartBeatTimeout") )
 		{ setValue( "serverSocket/heartBeatTimeout", 3 ); } // sec
+	if( !contains("serverSocket/localName") )
+		{ setValue( "serverSocket/localName", "qcProxy" ); }	// name of the local socket for the clients on the same host, empty: TCP only
+	if( !contains("serverSocket/sendBufferSize") )
+		{ setValue( "serverSocket/sendBufferSize", 65536 ); }	// bytes, SO_SNDBUF of the TCP client sockets, 0: system default
+	if( !contains("serverSocket/receiveBufferSize") )
+		{ setValue( "serverSocket/receiveBufferSize", 65536 ); }	// bytes, SO_RCVBUF of the TCP client sockets, 0: system default
+
+	// snapshot
+	if( !contains("snapshot/maxValuesPerCommand") )
+		{ setValue( "snapshot/maxValuesPerCommand", 200 ); }	// values in one snapshot command, a bigger snapshot is sent in more packets (a packet is at most 64KiB)
+
+	// sharedState
+	if( !contains("sharedState/enabled") )
+		{ setValue( "sharedState/enabled", true ); }	// share the values with the clients on the same host in shared memory
+	if( !contains("sharedState/key") )
+		{ setValue( "sharedState/key", "qcProxy_sharedState" ); }	// key of the shared memory and name of the local notification socket
 
 	// Dummy device
 	if( !contains("dummyDeviceSocket/host") )
@@ -54,6 +97,38 @@ ProxySettingsManager::ProxySettingsManager(QObject *parent) :
 	if( !contains("dummyDeviceSocket/port") )
 		{ setValue( "dummyDeviceSocket/port", 8246 ); }
 
+	// Simulated device
+	if( !contains("simDevice/rate") )
+		{ setValue( "simDevice/rate", 100.0 ); }	// set commands / s / variable
+	if( !contains("simDevice/waveform") )
+		{ setValue( "simDevice/waveform", "sine" ); }
+	if( !contains("simDevice/period") )
+		{ setValue( "simDevice/period", 1000.0 ); }	// ms
+	if( !contains("simDevice/amplitude") )
+		{ setValue( "simDevice/amplitude", 100.0 ); }
+	if( !contains("simDevice/offset") )
+		{ setValue( "simDevice/offset", 0.0 ); }
+	if( !contains("simDevice/tickMs") )
+		{ setValue( "simDevice/tickMs", 1 ); }
+	if( !contains("simDevice/messageIntervalMs") )
+		{ setValue( "simDevice/messageIntervalMs", 5000 ); }
+
+	// Relay: see RelayDeviceConnector
+	if( !contains("relay/upstreamHost") )
+		{ setValue( "relay/upstreamHost", "localhost" ); }
+	if( !contains("relay/upstreamPort") )
+		{ setValue( "relay/upstreamPort", 24563 ); }
+	if( !contains("relay/upstreamLocalName") )
+		{ setValue( "relay/upstreamLocalName", QString() ); }	// local socket of an upstream proxy on this host, empty: TCP
+	if( !contains("relay/upstreamDevice") )
+		{ setValue( "relay/upstreamDevice", QString() ); }	// id of the relayed device, if the upstream proxy serves more devices, empty: its default device
+	if( !contains("relay/feedIntervalMs") )
+		{ setValue( "relay/feedIntervalMs", 20 ); }	// interval of the subscription to all variables of the upstream proxy
+	if( !contains("relay/connectTimeoutMs") )
+		{ setValue( "relay/connectTimeoutMs", 5000 ); }	// wait this long for the deviceAPI of the upstream proxy on start
+	if( !contains("relay/reconnectIntervalMs") )
+		{ setValue( "relay/reconnectIntervalMs", 2000 ); }
+
 	// device log
 	if( !contains("deviceLog/debugLogPath") )
 		{ setValue( "deviceLog/debugLogPath", "deviceDebugMsgLog" ); }
@@ -62,6 +137,30 @@ ProxySettingsManager::ProxySettingsManager(QObject *parent) :
 	if( !contains("deviceLog/errorLogPath") )
 		{ setValue( "deviceLog/errorLogPath", "deviceErrorMsgLog" ); }
 
+	// device command record / replay
+	if( !contains("deviceRecord/path") )
+		{ setValue( "deviceRecord/path", QString() ); }	// empty: don't record
+	if( !contains("deviceRecord/indexInterval") )
+		{ setValue( "deviceRecord/indexInterval", 1000 ); }	// commands
+	if( !contains("deviceReplay/path") )
+		{ setValue( "deviceReplay/path", QString() ); }	// non-empty: replay this log, unless an other connector is given on the command line
+	if( !contains("deviceReplay/speed") )
+		{ setValue( "deviceReplay/speed", 1.0 ); }	// 0: as fast as possible
+	if( !contains("deviceReplay/startMs") )
+		{ setValue( "deviceReplay/startMs", 0 ); }
+
+	// latency trace
+	if( !contains("latencyTrace/sampleInterval") )
+		{ setValue( "latencyTrace/sampleInterval", 0 ); }	// trace every Nth device command, 0: off
+	if( !contains("latencyTrace/reportIntervalMs") )
+		{ setValue( "latencyTrace/reportIntervalMs", 10000 ); }	// 0: no periodic report
+
+	// runtime metrics
+	if( !contains("metrics/probeIntervalMs") )
+		{ setValue( "metrics/probeIntervalMs", 100 ); }	// event loop lag probe
+	if( !contains("metrics/logIntervalMs") )
+		{ setValue( "metrics/logIntervalMs", 0 ); }	// 0: no periodic log
+
 	sync();
 
 	// init command line params
@@ -86,6 +185,10 @@ void ProxySettingsManager::initCmdParser()
 	static const QCommandLineConfigEntry conf[] = {
 		{ QCommandLine::Switch, 'v', mCmdArgNames[cmdArgVerbose], "increase verbosity", QCommandLine::OptionalMultiple },
 		{ QCommandLine::Switch, 'p', mCmdArgNames[cmdArgPassthrough], "Enable passThrough mode", QCommandLine::Optional },
+		{ QCommandLine::Option, 'r', mCmdArgNames[cmdArgRecord], "Record device commands to file", QCommandLine::Optional },
+		{ QCommandLine::Option, 'R', mCmdArgNames[cmdArgReplay], "Replay device commands from a recorded file instead of connecting the device", QCommandLine::Optional },
+		{ QCommandLine::Option, 's', mCmdArgNames[cmdArgReplaySpeed], "Replay speed multiplier, 0 for maximum speed", QCommandLine::Optional },
+		{ QCommandLine::Option, 'c', mCmdArgNames[cmdArgConnector], "Device connector: serial, dummySocket, replay, simulated or relay", QCommandLine::Optional },
 		QCOMMANDLINE_CONFIG_ENTRY_END
 	};
 	mCmdParser->setConfig( conf );
@@ -101,7 +204,16 @@ void ProxySettingsManager::cmdSwitchFound(const QString &name)
 
 void ProxySettingsManager::cmdOptionFound(const QString &name, const QVariant &value)
 {
-	qDebug() << "Option:" << name << value;
+	if( name == mCmdArgNames[cmdArgRecord] )
+		{ mCmdArgs[cmdArgRecord] = value; }
+	else if( name == mCmdArgNames[cmdArgReplay] )
+		{ mCmdArgs[cmdArgReplay] = value; }
+	else if( name == mCmdArgNames[cmdArgReplaySpeed] )
+		{ mCmdArgs[cmdArgReplaySpeed] = value; }
+	else if( name == mCmdArgNames[cmdArgConnector] )
+		{ mCmdArgs[cmdArgConnector] = value; }
+	else
+		{ qDebug() << "Option:" << name << value; }
 }
 
 void ProxySettingsManager::cmdParamFound(const QString &name, const QVariant &value)
@@ -118,3 +230,32 @@ const QVariant ProxySettingsManager::getCmdArgValue(ProxySettingsManager::cmdArg
 {
 	return mCmdArgs.value(arg);
 }
+
+QStringList ProxySettingsManager::getDeviceIds()
+{
+	QStringList idList;
+	QStringList settingList = value("devices/ids").toString().split( ',', QString::SkipEmptyParts );
+	for( int i=0; i<settingList.size(); ++i )
+	{
+		QString id = settingList.at(i).trimmed();
+		if( !id.isEmpty() && !idList.contains(id) )
+			{ idList.append( id ); }
+	}
+	if( idList.isEmpty() )
+		{ idList.append( QString() ); }
+	return idList;
+}
+
+QVariant ProxySettingsManager::deviceValue( const QString &deviceId, const QString &key )
+{
+	if( !deviceId.isEmpty() && contains( "devices/" + deviceId + '/' + key ) )
+		{ return value( "devices/" + deviceId + '/' + key ); }
+	return value( key );
+}
+
+const QVariant ProxySettingsManager::getDeviceCmdArgValue( const QString &deviceId, cmdArg_t arg )
+{
+	if( deviceId != getDeviceIds().first() )
+		{ return QVariant(); }
+	return mCmdArgs.value(arg);
+}
@@ -4,6 +4,7 @@
 #include "SettingsManagerBase.h"
 #include <QHash>
 #include <QVariant>
+#include <QStringList>
 
 namespace QtuC
 {
@@ -16,7 +17,11 @@ public:
 
 	typedef enum {
 		cmdArgPassthrough = 0,
-		cmdArgVerbose
+		cmdArgVerbose,
+		cmdArgRecord,
+		cmdArgReplay,
+		cmdArgReplaySpeed,
+		cmdArgConnector
 	} cmdArg_t;
 
 	explicit ProxySettingsManager(QObject *parent = 0);
@@ -25,6 +30,24 @@ public:
 
 	QVariant const getCmdArgValue( cmdArg_t arg );
 
+	/** Get the ids of the devices served by the proxy (`devices/ids`).
+	  *	@return The ids, the first is the default device. A single empty id if no devices are configured.*/
+	QStringList getDeviceIds();
+
+	/** Get a setting of a device.
+	  *	The settings in the `devices/<deviceId>/` group override the global ones for the device.
+	  *	@param deviceId Id of the device, empty for the global setting.
+	  *	@param key The key of the setting, as the global one (for example `devicePort/portName`).
+	  *	@return The setting of the device, or the global setting if the device doesn't override it.*/
+	QVariant deviceValue( const QString &deviceId, const QString &key );
+
+	/** Get the value of a command line argument for a device.
+	  *	The device arguments (connector, record, replay) only apply to the default device.
+	  *	@param deviceId Id of the device.
+	  *	@param arg The argument.
+	  *	@return The value, or an invalid QVariant if the device is not the default one.*/
+	QVariant const getDeviceCmdArgValue( const QString &deviceId, cmdArg_t arg );
+
 private:
 	void initCmdParser();
 	void cmdSwitchFound( const QString & name );
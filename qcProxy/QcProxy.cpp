@@ -4,6 +4,8 @@
 #include "ClientConnectionManagerBase.h"
 #include <QCoreApplication>
 #include "ProxySettingsManager.h"
+#include "LatencyMonitor.h"
+#include "ProxyMetrics.h"
 #include <QFile>
 #include <QTextStream>
 
@@ -11,18 +13,28 @@ using namespace QtuC;
 
 QcProxy::QcProxy( QObject *parent ) :
 	ErrorHandlerBase( parent ),
-	mDevice( 0 ),
 	mConnectionServer( 0 ),
-	mClientSubscriptionManager(0),
 	mPassThrough(false)
 {
 	connect( QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(deleteLater()) );
 
-	mDevice = new DeviceAPI( this );
+	QStringList deviceIds = ProxySettingsManager::instance()->getDeviceIds();
+	for( int i=0; i<deviceIds.size(); ++i )
+	{
+		proxiedDevice_t device;
+		device.api = new DeviceAPI( deviceIds.at(i), this );
+		device.subscriptionManager = new ClientSubscriptionManager(this);
+		connect( device.subscriptionManager, SIGNAL(subscriptionFeedRequest(QList<ClientSubscription*>)), this, SLOT(sendSubscriptionFeed(QList<ClientSubscription*>)) );
+		mDevices.append( device );
+	}
 	mConnectionServer = new ConnectionServer( this );
-	mClientSubscriptionManager = new ClientSubscriptionManager(this);
 
-	connect( mClientSubscriptionManager, SIGNAL(subscriptionFeedRequest(ClientSubscription*)), this, SLOT(sendSubscriptionFeed(ClientSubscription*)) );
+	LatencyMonitor *latencyMonitor = LatencyMonitor::instance(this);
+	latencyMonitor->setSampleInterval( ProxySettingsManager::instance()->value("latencyTrace/sampleInterval").toUInt() );
+	latencyMonitor->setReportInterval( ProxySettingsManager::instance()->value("latencyTrace/reportIntervalMs").toInt() );
+
+	// the device metrics are of the default device
+	ProxyMetrics::instance(this)->setSources( mDevices.first().api, mConnectionServer );
 }
 
 QcProxy::~QcProxy()
@@ -32,28 +44,42 @@ bool QcProxy::start()
 {
 	setPassThrough( ProxySettingsManager::instance()->getCmdArgValue(ProxySettingsManager::cmdArgPassthrough).toBool() );
 
-	if( !mDevice->initAPI() )
+	QStringList deviceIds;
+	for( int i=0; i<mDevices.size(); ++i )
 	{
-		error( QtCriticalMsg, "Failed to initialize device", "start()" );
-		return false;
+		DeviceAPI *device = mDevices.at(i).api;
+		if( !device->initAPI() )
+		{
+			error( QtCriticalMsg, QString("Failed to initialize device %1").arg(device->getId()), "start()" );
+			return false;
+		}
+		connect( device, SIGNAL(messageReceived(deviceMessageType_t,QString)), this, SLOT(handleDeviceMessage(deviceMessageType_t,QString)) );
+		connect( device, SIGNAL(commandReceived(DeviceCommand*)), this, SLOT(route(DeviceCommand*)) );
+		connect( device, SIGNAL(greetingReceived()), this, SLOT(handleDeviceGreeting()) );
+		deviceIds.append( device->getId() );
 	}
-	connect( mDevice, SIGNAL(messageReceived(deviceMessageType_t,QString)), this, SLOT(handleDeviceMessage(deviceMessageType_t,QString)) );
-	connect( mDevice, SIGNAL(commandReceived(DeviceCommand*)), this, SLOT(route(DeviceCommand*)) );
-	connect( mDevice, SIGNAL(greetingReceived()), this, SLOT(handleDeviceGreeting()) );
+	// advertise the devices in the handshake, if there are more
+	if( mDevices.size() > 1 )
+		{ ClientConnectionManagerBase::setSelfInfo( "devices", deviceIds.join(",") ); }
 
 	connect( mConnectionServer, SIGNAL( newClientConnected( ClientConnectionManagerBase * ) ), this, SLOT( handleNewClient( ClientConnectionManagerBase * ) ) );
+	// the values only change through the stateful API, only the default device is shared
+	if( !mPassThrough && ProxySettingsManager::instance()->value("sharedState/enabled").toBool() )
+		{ mConnectionServer->startSharedState( mDevices.first().api->getVarList(), mDevices.first().api->getApiParser()->getApiString() ); }
 	if( !mConnectionServer->startListening() )
 	{
 		error( QtCriticalMsg, "Failed to start TCP server", "start()" );
 		return false;
 	}
+	ProxyMetrics::instance()->start();
 	return true;
 }
 
 void QcProxy::setPassThrough(bool pass)
 {
 	mPassThrough = pass;
-	mDevice->setEmitAllCommand( pass );
+	for( int i=0; i<mDevices.size(); ++i )
+		{ mDevices.at(i).api->setEmitAllCommand( pass ); }
 	if( mPassThrough )
 		{ debug( debugLevelInfo, "qcProxy is in PassThrough mode", "setPassThrough()" ); }
 }
@@ -63,33 +89,58 @@ bool QcProxy::route(ClientCommandBase *clientCommand)
 	ClientConnectionManagerBase *client = (ClientConnectionManagerBase*)sender();
 	/// @todo implement, break apart into more subfunctions, return false on error, but don't forget to delete the command at the end: solution: sg. like: ClientCommandBase cmd = &*clientCommand; ? no copy but on the stack->implicit delete: check!
 
+	int deviceIdx = deviceIndex( clientCommand->getDevice() );
+	if( deviceIdx < 0 )
+	{
+		error( QtWarningMsg, QString("ClientCommand %1 to unknown device %2, dropped").arg(clientCommand->getName(),clientCommand->getDevice()), "route(ClientCommandBase*)" );
+		clientCommand->deleteLater();
+		return false;
+	}
+	DeviceAPI *device = mDevices.at(deviceIdx).api;
+	ClientSubscriptionManager *subscriptionManager = mDevices.at(deviceIdx).subscriptionManager;
+
 	if( clientCommand->getClass() == ClientCommandBase::clientCommandControl )
 	{
 		if( clientCommand->getName() == "reqDeviceAPI" )
 		{	/// @todo Permission to send API?
 			debug( debugLevelVeryVerbose, "Got API request, send API...", "route(ClientCommandBase*)" );
-			client->sendCommand( new ClientCommandDeviceApi( mDevice->getApiParser()->getApiString() ) );
+			ClientCommandDeviceApi *apiCmd = new ClientCommandDeviceApi( device->getApiParser()->getApiString() );
+			apiCmd->setDevice( device->getId() );
+			client->sendCommand( apiCmd );
 		}
 		else if( clientCommand->getName() == "subscribe" )
 		{
 			/// @todo ignore when in passthrough mode
 			ClientCommandSubscribe *subscribeCmd = (ClientCommandSubscribe*)clientCommand;
-			mClientSubscriptionManager->subscribe( client, subscribeCmd->getInterval(), subscribeCmd->getHwInterface(), subscribeCmd->getVariable() );
+			subscriptionManager->subscribe( client, subscribeCmd->getInterval(), subscribeCmd->getHwInterface(), subscribeCmd->getVariable() );
 		}
 		else if( clientCommand->getName() == "unSubscribe" )
 		{
 			/// @todo ignore when in passthrough mode
 			ClientCommandUnSubscribe *unSubscribeCmd = (ClientCommandUnSubscribe*)clientCommand;
-			mClientSubscriptionManager->unSubscribe( client, unSubscribeCmd->getHwInterface(), unSubscribeCmd->getVariable() );
+			subscriptionManager->unSubscribe( client, unSubscribeCmd->getHwInterface(), unSubscribeCmd->getVariable() );
+		}
+		else if( clientCommand->getName() == "subscribeList" )
+		{
+			/// @todo ignore when in passthrough mode
+			ClientCommandSubscribeList *subscribeListCmd = (ClientCommandSubscribeList*)clientCommand;
+			subscriptionManager->subscribeList( client, subscribeListCmd->getSubscriptionList() );
+		}
+		else if( clientCommand->getName() == "unSubscribeList" )
+		{
+			/// @todo ignore when in passthrough mode
+			ClientCommandSubscribeList *unSubscribeListCmd = (ClientCommandSubscribeList*)clientCommand;
+			subscriptionManager->unSubscribeList( client, unSubscribeListCmd->getSubscriptionList() );
 		}
 		else if( clientCommand->getName() == "reqDeviceInfo" )
+			{ client->sendCommand( buildDeviceInfo( device, false ) ); }
+		else if( clientCommand->getName() == "reqSnapshot" )
+			{ sendSnapshot( client, device, (ClientCommandReqSnapshot*)clientCommand ); }
+		else if( clientCommand->getName() == "reqMetrics" )
 		{
-			ClientCommandDeviceInfo *cmdInfo = new ClientCommandDeviceInfo();
-			cmdInfo->setStartup(false);
-			cmdInfo->setStartupTime( Device::getStartupTime() );
-			cmdInfo->setPositiveAck( Device::positiveAck() );
-			cmdInfo->setInfoList( Device::getInfoList() );
-			client->sendCommand( cmdInfo );
+			ClientCommandMetrics *cmdMetrics = new ClientCommandMetrics();
+			cmdMetrics->setMetrics( ProxyMetrics::instance()->getMetrics() );
+			client->sendCommand( cmdMetrics );
 		}
 		else
 			{ error( QtWarningMsg, QString("Unimplemented control clientCommand received: %1").arg(clientCommand->getName()), "route(ClientCommandBase*)" ); }
@@ -99,7 +150,7 @@ bool QcProxy::route(ClientCommandBase *clientCommand)
 		DeviceCommandBase *clientCommandDevice = (ClientCommandDevice*)clientCommand;
 		if( mPassThrough )
 		{
-			if( !mDevice->command( new DeviceCommand(*clientCommandDevice) ) )
+			if( !device->command( new DeviceCommand(*clientCommandDevice) ) )
 			{
 				error( QtWarningMsg, QString("Failed to send device command %1").arg(DeviceCommandBase::commandTypeToString(clientCommandDevice->getType())), "route(ClientCommandBase*)" );
 			}
@@ -110,19 +161,21 @@ bool QcProxy::route(ClientCommandBase *clientCommand)
 			{
 				case deviceCmdGet:
 				{
-					if( !client->sendCommand( new ClientCommandDevice( deviceCmdSet, mDevice->getVar( clientCommandDevice->getHwInterface(), clientCommandDevice->getVariable() ) ) ) )
+					ClientCommandDevice *replyCmd = new ClientCommandDevice( deviceCmdSet, device->getVar( clientCommandDevice->getHwInterface(), clientCommandDevice->getVariable() ) );
+					replyCmd->setDevice( device->getId() );
+					if( !client->sendCommand( replyCmd ) )
 						{ error( QtWarningMsg, QString("Failed to send set device command to %1").arg(client->getID()), "route(ClientCommandBase*)" ); }
 				}
 					break;
 				case deviceCmdSet:
 				{
-					mDevice->set( clientCommandDevice->getHwInterface(), clientCommandDevice->getVariable(), clientCommandDevice->getArg() );
+					device->set( clientCommandDevice->getHwInterface(), clientCommandDevice->getVariable(), clientCommandDevice->getArg() );
 				}
 					break;
 				case deviceCmdCall:
 				{
 					/// @todo separate args
-					mDevice->call( clientCommandDevice->getHwInterface(), clientCommandDevice->getFunction(), clientCommandDevice->getArgList().join(" ") );
+					device->call( clientCommandDevice->getHwInterface(), clientCommandDevice->getFunction(), clientCommandDevice->getArgList().join(" ") );
 				}
 					break;
 				case deviceCmdUndefined:
@@ -146,7 +199,10 @@ bool QcProxy::route( DeviceCommand *deviceCommand )
 	debug( debugLevelVeryVerbose, QString("Route device command: %1").arg( deviceCommand->getCommandString() ), "route(DeviceCommand*)" );
 	if( mPassThrough )
 	{
-		mConnectionServer->broadcast( new ClientCommandDevice(deviceCommand) );
+		ClientCommandDevice *clientCmd = new ClientCommandDevice(deviceCommand);
+		clientCmd->setDevice( ((DeviceAPI*)sender())->getId() );
+		clientCmd->stampTrace( LatencyTrace::traceStageFeed );
+		mConnectionServer->broadcast( clientCmd );
 	}
 	else	// If mPassThrough is false, only commands sent to the special ":proxy" interface should get here
 	{
@@ -161,12 +217,13 @@ bool QcProxy::handleDeviceMessage(deviceMessageType_t msgType, QString const &ms
 	/// @todo implement sending to clients, and clean up this logging thing...
 
 	// log
+	QString deviceId = ((DeviceAPI*)sender())->getId();
 	QString logFilePath;
 	switch( msgType )
 	{
-		case deviceMsgInfo: logFilePath = ProxySettingsManager::instance()->value("deviceLog/infoLogPath").toString(); break;
-		case deviceMsgDebug: logFilePath = ProxySettingsManager::instance()->value("deviceLog/debugLogPath").toString(); break;
-		case deviceMsgError: logFilePath = ProxySettingsManager::instance()->value("deviceLog/errorLogPath").toString(); break;
+		case deviceMsgInfo: logFilePath = ProxySettingsManager::instance()->deviceValue(deviceId,"deviceLog/infoLogPath").toString(); break;
+		case deviceMsgDebug: logFilePath = ProxySettingsManager::instance()->deviceValue(deviceId,"deviceLog/debugLogPath").toString(); break;
+		case deviceMsgError: logFilePath = ProxySettingsManager::instance()->deviceValue(deviceId,"deviceLog/errorLogPath").toString(); break;
 		default:
 			error( QtWarningMsg, "Unknown device message type", "handleDeviceMessage()" );
 			return false;
@@ -189,13 +246,41 @@ bool QcProxy::handleDeviceMessage(deviceMessageType_t msgType, QString const &ms
 }
 
 void QcProxy::handleDeviceGreeting()
+{
+	mConnectionServer->broadcast( buildDeviceInfo( (DeviceAPI*)sender(), true ) );
+}
+
+ClientCommandDeviceInfo *QcProxy::buildDeviceInfo( const DeviceAPI *device, bool startup )
 {
 	ClientCommandDeviceInfo *cmdInfo = new ClientCommandDeviceInfo();
-	cmdInfo->setStartup(true);
-	cmdInfo->setStartupTime( Device::getStartupTime() );
-	cmdInfo->setPositiveAck( Device::positiveAck() );
-	cmdInfo->setInfoList( Device::getInfoList() );
-	mConnectionServer->broadcast( cmdInfo );
+	cmdInfo->setDevice( device->getId() );
+	cmdInfo->setStartup( startup );
+	cmdInfo->setStartupTime( device->getDevice()->getStartupTime() );
+	cmdInfo->setPositiveAck( device->getDevice()->positiveAck() );
+	cmdInfo->setInfoList( device->getDevice()->getInfoList() );
+	return cmdInfo;
+}
+
+int QcProxy::deviceIndex( const QString &deviceId ) const
+{
+	if( deviceId.isEmpty() )
+		{ return 0; }
+	for( int i=0; i<mDevices.size(); ++i )
+	{
+		if( mDevices.at(i).api->getId() == deviceId )
+			{ return i; }
+	}
+	return -1;
+}
+
+int QcProxy::deviceIndex( const QObject *deviceObject ) const
+{
+	for( int i=0; i<mDevices.size(); ++i )
+	{
+		if( mDevices.at(i).api == deviceObject || mDevices.at(i).subscriptionManager == deviceObject )
+			{ return i; }
+	}
+	return -1;
 }
 
 void QcProxy::handleNewClient( ClientConnectionManagerBase *newClient )
@@ -203,48 +288,105 @@ void QcProxy::handleNewClient( ClientConnectionManagerBase *newClient )
 	connect( newClient, SIGNAL(commandReceived(ClientCommandBase*)), this, SLOT(route(ClientCommandBase*)) );
 }
 
-void QcProxy::sendSubscriptionFeed( ClientSubscription *subscription )
+void QcProxy::sendSubscriptionFeed( const QList<ClientSubscription*> &subscriptionList )
 {
-	if( subscription->getVariable().isEmpty() )
+	int deviceIdx = deviceIndex( sender() );
+	if( subscriptionList.isEmpty() || deviceIdx < 0 )
+		{ return; }
+	ProxyMetrics::instance()->countSubscriptionTick();
+
+	QList<ClientCommandBase*> clientCmdList;
+	for( int i=0; i<subscriptionList.size(); ++i )
+		{ appendFeedCommands( mDevices.at(deviceIdx), subscriptionList.at(i), clientCmdList ); }
+	for( int i=0; i<clientCmdList.size(); ++i )
+		{ clientCmdList.at(i)->setDevice( mDevices.at(deviceIdx).api->getId() ); }
+
+	if( clientCmdList.isEmpty() )
+		{ return; }
+
+	ClientConnectionManagerBase *client = subscriptionList.first()->getClient();
+	if( !client->sendCommands( clientCmdList ) )
 	{
-		QList<DeviceStateVariableBase*> varList = mDevice->getVarList( subscription->getHwInterface() );
-		QList<ClientCommandBase*> clientCmdList;
+		errorDetails_t errDet;
+		errDet.insert( "subscriptionCount", QString::number(subscriptionList.size()) );
+		errDet.insert( "interval", QString::number(subscriptionList.first()->getInterval()) );
+		error( QtWarningMsg, QString("An error occured while sending subscription feed to client: %1").arg(client->getID()), "sendSubscriptionFeed()", errDet );
+	}
+}
 
+void QcProxy::appendFeedCommands( const proxiedDevice_t &device, ClientSubscription *subscription, QList<ClientCommandBase*> &clientCmdList )
+{
+	if( subscription->getVariable().isEmpty() )
+	{
+		QList<DeviceStateVariableBase*> varList = device.api->getVarList( subscription->getHwInterface() );
 		for( int i=0; i<varList.size(); ++i )
 		{
 			// Don't send uninitialized and invalid variables
 			if( !(!varList.at(i)->isNull() && varList.at(i)->isValid()) )
 				{ continue; }
 			// Don't send if a more specific subscription is available
-			if( !mClientSubscriptionManager->moreSpecificSubscriptionExists( varList.at(i), subscription ) )
-				{ clientCmdList.append( new ClientCommandDevice( deviceCmdSet, varList.at(i) ) ); }
+			if( !device.subscriptionManager->moreSpecificSubscriptionExists( varList.at(i), subscription ) )
+				{ clientCmdList.append( buildFeedCommand( varList.at(i) ) ); }
 		}
+	}
+	else
+	{
+		DeviceStateVariableBase *stateVar = device.api->getVar( subscription->getHwInterface(), subscription->getVariable() );
 
-		if( clientCmdList.isEmpty() )
+		// Don't send unknown, uninitialized and invalid variables
+		if( !stateVar || !(!stateVar->isNull() && stateVar->isValid()) )
 			{ return; }
-
-		if( !subscription->getClient()->sendCommands( clientCmdList ) )
-		{
-			errorDetails_t errDet;
-			errDet.insert( "subscriptionVar", subscription->getVariable() );
-			errDet.insert( "subscriptionInterface", subscription->getHwInterface() );
-			error( QtWarningMsg, QString("An error occured while sending subscription update to client: %1").arg(subscription->getClient()->getID()), "sendSubscriptionFeed()", errDet );
-		}
+		clientCmdList.append( buildFeedCommand( stateVar ) );
 	}
+}
+
+void QcProxy::sendSnapshot( ClientConnectionManagerBase *client, DeviceAPI *device, const ClientCommandReqSnapshot *reqCmd )
+{
+	QList<DeviceStateVariableBase*> varList;
+	if( reqCmd->getVariable().isEmpty() )
+		{ varList = device->getVarList( reqCmd->getHwInterface() ); }
 	else
 	{
-		DeviceStateVariableBase *stateVar = mDevice->getVar( subscription->getHwInterface(), subscription->getVariable() );
+		DeviceStateVariableBase *stateVar = device->getVar( reqCmd->getHwInterface(), reqCmd->getVariable() );
+		if( stateVar )
+			{ varList.append( stateVar ); }
+		else
+			{ error( QtWarningMsg, QString("Snapshot of unknown variable requested (hwI: %1, name: %2)").arg(reqCmd->getHwInterface(),reqCmd->getVariable()), "sendSnapshot()" ); }
+	}
 
+	int maxValues = qMax( 1, ProxySettingsManager::instance()->value("snapshot/maxValuesPerCommand").toInt() );
+	ClientCommandSnapshot *snapshotCmd = new ClientCommandSnapshot();
+	for( int i=0; i<varList.size(); ++i )
+	{
 		// Don't send uninitialized and invalid variables
-		if( !(!stateVar->isNull() && stateVar->isValid()) )
-			{ return; }
-
-		if( !subscription->getClient()->sendCommand( new ClientCommandDevice( deviceCmdSet, stateVar ) ) )
+		if( !(!varList.at(i)->isNull() && varList.at(i)->isValid()) )
+			{ continue; }
+		if( snapshotCmd->size() == maxValues )
 		{
-			errorDetails_t errDet;
-			errDet.insert( "subscriptionVar", subscription->getVariable() );
-			errDet.insert( "subscriptionInterface", subscription->getHwInterface() );
-			error( QtWarningMsg, QString("An error occured while sending subscription feed to client: %1").arg(subscription->getClient()->getID()), "sendSubscriptionFeed()", errDet );
+			snapshotCmd->setMore( true );
+			snapshotCmd->setDevice( device->getId() );
+			client->sendCommand( snapshotCmd );
+			snapshotCmd = new ClientCommandSnapshot();
 		}
+		snapshotCmd->append( varList.at(i) );
+	}
+
+	// the last one is sent even if empty, the client knows the snapshot is complete
+	snapshotCmd->setDevice( device->getId() );
+	if( !client->sendCommand( snapshotCmd ) )
+		{ error( QtWarningMsg, QString("Failed to send snapshot to %1").arg(client->getID()), "sendSnapshot()" ); }
+	else
+		{ debug( debugLevelVeryVerbose, QString("Snapshot sent to %1").arg(client->getID()), "sendSnapshot()" ); }
+}
+
+ClientCommandDevice *QcProxy::buildFeedCommand( DeviceStateVariableBase *stateVar )
+{
+	ClientCommandDevice *cmd = new ClientCommandDevice( deviceCmdSet, stateVar );
+	LatencyTrace trace = ((DeviceStateProxyVariable*)stateVar)->takeTrace();
+	if( !trace.isEmpty() )
+	{
+		trace.stamp( LatencyTrace::traceStageFeed );
+		cmd->setTrace( trace );
 	}
+	return cmd;
 }
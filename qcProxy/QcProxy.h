@@ -13,10 +13,15 @@ namespace QtuC
 class ConnectionServer;
 class DeviceAPI;
 class ClientConnectionManagerBase;
+class ClientCommandDeviceInfo;
+class ClientCommandReqSnapshot;
 
 /** QcProxy class.
  *	The QcProxy class is the main coordinator between the device and the clients.
- *	See route() methods for the actual data flow between them.*/
+ *	See route() methods for the actual data flow between them.
+ *	The proxy can serve more devices (see ProxySettingsManager::getDeviceIds()), each with its own DeviceAPI and subscriptions.
+ *	The clients address a device with the `device` attribute of the commands (see ClientCommandBase::getDevice()), the commands without it go to the default (first) device.
+ *	The commands sent to the clients carry the id of their device.*/
 class QcProxy : public ErrorHandlerBase
 {
 	Q_OBJECT
@@ -53,22 +58,67 @@ private slots:
 	void handleNewClient( ClientConnectionManagerBase *newClient );
 
 	/** Handle incoming device message*
+	  *	The messages are logged to the files of the device (`deviceLog/` settings).
 	  *	@param msgType Message type.
 	  *	@param msg The message string.
 	  * @return True on success, false otherwise.*/
 	bool handleDeviceMessage( deviceMessageType_t msgType, const QString &msg );
 
+	/// Broadcast the deviceInfo of the device who received a greeting.
 	void handleDeviceGreeting();
 
 	/** Handle subscription feed request and send the feed to the client.
-	  *	Called on every ClientSubscription::subscriptionTick() of every subscription.
-	  *	@param subscription The subscription who sent the request.*/
-	void sendSubscriptionFeed( ClientSubscription *subscription );
+	  *	Called on every tick of a group of subscriptions (see ClientSubscriptionManager::subscriptionFeedRequest()), the feed of the group is sent in one packet.
+	  *	@param subscriptionList The subscriptions of the same client and interval.*/
+	void sendSubscriptionFeed( const QList<ClientSubscription*> &subscriptionList );
 
 private:
-	DeviceAPI *mDevice;		///< API object for the device.
+
+	/// A device served by the proxy, with the client subscriptions to its variables.
+	struct proxiedDevice_t
+	{
+		DeviceAPI *api;
+		ClientSubscriptionManager *subscriptionManager;
+	};
+
+	/** Get the index of a device in mDevices.
+	  *	@param deviceId Id of the device, empty for the default device.
+	  *	@return The index, -1 if there is no such device.*/
+	int deviceIndex( const QString &deviceId ) const;
+
+	/** Get the index of the device of a DeviceAPI or a subscription manager in mDevices.
+	  *	@param deviceObject The DeviceAPI or ClientSubscriptionManager, usually the sender().
+	  *	@return The index, -1 if the object doesn't belong to a device.*/
+	int deviceIndex( const QObject *deviceObject ) const;
+
+	/** Build a deviceInfo command of a device.
+	  *	@param device The device.
+	  *	@param startup True if the device has just (re)started.
+	  *	@return The new command, addressed from the device.*/
+	ClientCommandDeviceInfo *buildDeviceInfo( const DeviceAPI *device, bool startup );
+
+	/** Build the feed commands of a subscription.
+	  *	@param device The device of the subscription.
+	  *	@param subscription The subscription.
+	  *	@param clientCmdList The commands are appended to this list.*/
+	void appendFeedCommands( const proxiedDevice_t &device, ClientSubscription *subscription, QList<ClientCommandBase*> &clientCmdList );
+
+	/** Send the snapshot of the requested variables of a device to a client.
+	  *	The values are sent in snapshot commands of at most `snapshot/maxValuesPerCommand` values, each in its own packet, so a big state table doesn't exceed the packet size.
+	  *	Like in a subscription feed, the uninitialized and invalid variables are left out.
+	  *	@param client The client who requested the snapshot.
+	  *	@param device The device.
+	  *	@param reqCmd The request.*/
+	void sendSnapshot( ClientConnectionManagerBase *client, DeviceAPI *device, const ClientCommandReqSnapshot *reqCmd );
+
+	/** Build a set command of a state variable for a subscription feed.
+	  *	If the last update of the variable was traced, the trace is moved to the command, and the feed stage is stamped.
+	  *	@param stateVar The variable.
+	  *	@return The new command.*/
+	ClientCommandDevice *buildFeedCommand( DeviceStateVariableBase *stateVar );
+
+	QList<proxiedDevice_t> mDevices;	///< The devices, the first is the default one.
 	ConnectionServer *mConnectionServer;	///< Holds the instance of the connection server.
-	ClientSubscriptionManager *mClientSubscriptionManager;	///< Holds the instance of the subscription manager.
 
 	bool mPassThrough;	///< If true, proxy will immediately relay all device commands to all clients (as a ClientCommandDevice)
 
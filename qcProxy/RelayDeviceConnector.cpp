@@ -0,0 +1,285 @@
+#include "RelayDeviceConnector.h"
+#include "ClientConnectionManagerBase.h"
+#include "ClientCommands.h"
+#include "Device.h"
+#include "DeviceStateVariableBase.h"
+#include "LatencyTrace.h"
+#include <QTcpSocket>
+#include <QLocalSocket>
+#include <QEventLoop>
+#include <QDateTime>
+
+using namespace QtuC;
+
+RelayDeviceConnector::RelayDeviceConnector( const Device *device, StateManagerBase *stateManager, QObject *parent ) :
+	DeviceConnectionManagerBase(device, parent),
+	mStateManager(stateManager),
+	mUpstream(0),
+	mOpen(false),
+	mConnecting(false)
+{
+	mReconnectTimer = new QTimer(this);
+	mReconnectTimer->setSingleShot( true );
+	mReconnectTimer->setInterval( deviceSetting("relay/reconnectIntervalMs").toInt() );
+	mUpstreamDevice = deviceSetting("relay/upstreamDevice").toString();
+	connect( mReconnectTimer, SIGNAL(timeout()), this, SLOT(connectUpstream()) );
+}
+
+RelayDeviceConnector::~RelayDeviceConnector()
+{
+	closeDevice();
+}
+
+bool RelayDeviceConnector::sendCommand( DeviceCommand *cmd )
+{
+	if( !cmd )
+		{ return false; }
+
+	// the upstream proxy requests the device streams itself
+	if( cmd->getType() == deviceCmdCall && cmd->getHwInterface() == ":proxy" )
+	{
+		cmd->deleteLater();
+		return true;
+	}
+
+	if( !isUpstreamReady() )
+	{
+		error( QtWarningMsg, "Upstream proxy is not connected, sendCommand failed", "sendCommand()" );
+		cmd->deleteLater();
+		return false;
+	}
+
+	// the greeting of the relay advertises no batched commands, but the upstream proxy takes them one by one anyway
+	QList<DeviceCommand*> cmdList;
+	if( cmd->isBatch() )
+		{ cmdList = DeviceCommand::listFromString( cmd->getCommandString() ); }
+	else
+		{ cmdList.append( cmd ); }
+
+	QList<ClientCommandBase*> clientCmdList;
+	for( int i=0; i<cmdList.size(); ++i )
+	{
+		ClientCommandDevice *clientCmd = new ClientCommandDevice( cmdList.at(i) );
+		clientCmd->setDevice( mUpstreamDevice );
+		// the set holds the raw value of the variable, the upstream proxy takes the user-side one
+		DeviceStateVariableBase *var = mStateManager->getVar( clientCmd->getHwInterface(), clientCmd->getVariable() );
+		if( clientCmd->getType() == deviceCmdSet && var && !mDevice->positiveAck() )
+			{ clientCmd->setArgList( QStringList( var->getValue().toString() ) ); }
+		clientCmdList.append( clientCmd );
+	}
+	if( cmd->isBatch() )
+		{ qDeleteAll( cmdList ); }
+	cmd->deleteLater();
+
+	if( clientCmdList.isEmpty() )
+		{ return false; }
+	return mUpstream->sendCommands( clientCmdList );
+}
+
+void RelayDeviceConnector::closeDevice()
+{
+	mOpen = false;
+	mReconnectTimer->stop();
+	if( mUpstream )
+	{
+		mUpstream->disconnect( this );
+		mUpstream->deleteLater();
+		mUpstream = 0;
+	}
+}
+
+bool RelayDeviceConnector::openDevice()
+{
+	mOpen = true;
+	if( isUpstreamReady() && !mApiString.isEmpty() )
+		{ startMirror(); }
+	else if( !mUpstream && !mConnecting )
+		{ connectUpstream(); }
+	// the mirror starts when the upstream proxy is reached
+	return true;
+}
+
+qint64 RelayDeviceConnector::getPendingByteCount() const
+{
+	if( !mUpstream )
+		{ return 0; }
+	return mUpstream->getPendingByteCount();
+}
+
+QString RelayDeviceConnector::fetchDeviceApi()
+{
+	if( !mApiString.isEmpty() )
+		{ return mApiString; }
+
+	QEventLoop waitLoop;
+	connect( this, SIGNAL(upstreamApiReceived()), &waitLoop, SLOT(quit()) );
+	connect( this, SIGNAL(upstreamLost()), &waitLoop, SLOT(quit()) );
+	QTimer::singleShot( deviceSetting("relay/connectTimeoutMs").toInt(), &waitLoop, SLOT(quit()) );
+	if( !mUpstream && !mConnecting )
+		{ connectUpstream(); }
+	waitLoop.exec();
+
+	if( mApiString.isEmpty() )
+		{ error( QtWarningMsg, "Failed to get the deviceAPI of the upstream proxy", "fetchDeviceApi()" ); }
+	return mApiString;
+}
+
+bool RelayDeviceConnector::isUpstreamReady() const
+{
+	return mUpstream && mUpstream->isReady();
+}
+
+void RelayDeviceConnector::connectUpstream()
+{
+	mConnecting = true;
+	QString localName = deviceSetting("relay/upstreamLocalName").toString();
+	if( !localName.isEmpty() )
+	{
+		QLocalSocket *socket = new QLocalSocket(this);
+		connect( socket, SIGNAL(connected()), this, SLOT(handleConnected()) );
+		connect( socket, SIGNAL(error(QLocalSocket::LocalSocketError)), this, SLOT(handleConnectError()) );
+		debug( debugLevelVerbose, QString("Connect to upstream proxy on local socket %1...").arg(localName), "connectUpstream()" );
+		socket->connectToServer( localName );
+	}
+	else
+	{
+		QTcpSocket *socket = new QTcpSocket(this);
+		connect( socket, SIGNAL(connected()), this, SLOT(handleConnected()) );
+		connect( socket, SIGNAL(error(QAbstractSocket::SocketError)), this, SLOT(handleConnectError()) );
+		debug( debugLevelVerbose, QString("Connect to upstream proxy on %1, port %2...").arg( deviceSetting("relay/upstreamHost").toString(), deviceSetting("relay/upstreamPort").toString() ), "connectUpstream()" );
+		socket->connectToHost( deviceSetting("relay/upstreamHost").toString(), deviceSetting("relay/upstreamPort").toInt() );
+	}
+}
+
+void RelayDeviceConnector::handleConnected()
+{
+	QIODevice *socket = (QIODevice*)sender();
+	disconnect( socket, 0, this, 0 );
+	mConnecting = false;
+
+	mUpstream = new ClientConnectionManagerBase( socket, false, this );
+	socket->setParent( mUpstream );
+	connect( mUpstream, SIGNAL(connectionStateReady()), this, SLOT(handleUpstreamReady()) );
+	connect( mUpstream, SIGNAL(commandReceived(ClientCommandBase*)), this, SLOT(handleUpstreamCommand(ClientCommandBase*)) );
+	connect( mUpstream, SIGNAL(clientDisconnected()), this, SLOT(handleUpstreamDisconnected()) );
+	connect( mUpstream, SIGNAL(connectionStateLost()), this, SLOT(handleUpstreamDisconnected()) );
+	mUpstream->sendHandShake();
+}
+
+void RelayDeviceConnector::handleConnectError()
+{
+	QIODevice *socket = (QIODevice*)sender();
+	errorDetails_t errDet;
+	errDet.insert( "error", socket->errorString() );
+	error( QtWarningMsg, "Failed to connect to upstream proxy", "handleConnectError()", errDet );
+	socket->deleteLater();
+	mConnecting = false;
+	emit upstreamLost();
+	if( mOpen )
+		{ mReconnectTimer->start(); }
+}
+
+void RelayDeviceConnector::handleUpstreamReady()
+{
+	debug( debugLevelInfo, QString("Connected to upstream proxy %1").arg(mUpstream->getID()), "handleUpstreamReady()" );
+	// the deviceAPI is checked on every connection, the upstream proxy may have restarted with an other one
+	ClientCommandReqDeviceApi *reqApiCmd = new ClientCommandReqDeviceApi();
+	reqApiCmd->setDevice( mUpstreamDevice );
+	mUpstream->sendCommand( reqApiCmd );
+}
+
+void RelayDeviceConnector::handleUpstreamDisconnected()
+{
+	if( !mUpstream )
+		{ return; }
+	error( QtWarningMsg, "Upstream proxy disconnected", "handleUpstreamDisconnected()" );
+	mUpstream->disconnect( this );
+	mUpstream->deleteLater();
+	mUpstream = 0;
+	emit upstreamLost();
+	if( mOpen )
+		{ mReconnectTimer->start(); }
+}
+
+void RelayDeviceConnector::handleUpstreamCommand( ClientCommandBase *cmd )
+{
+	// a proxy of more devices sends the commands of the other devices as well (the deviceInfo on greeting)
+	if( !mUpstreamDevice.isEmpty() && cmd->getDevice() != mUpstreamDevice )
+	{
+		cmd->deleteLater();
+		return;
+	}
+
+	if( cmd->getClass() == ClientCommandBase::clientCommandDevice )
+	{
+		// the subscription feed and the replies, as if the device sent them
+		DeviceCommand *deviceCmd = new DeviceCommand( *(ClientCommandDevice*)cmd );
+		// the time of the upstream update in device ticks, 0 (the current time) until the startup time is known
+		if( deviceCmd->hasTimestamp() )
+		{
+			qint64 sinceStartup = (qint64)deviceCmd->getTimestamp() - mDevice->getStartupTime();
+			deviceCmd->setTimestamp( ( mDevice->getStartupTime() && sinceStartup > 0 ) ? (quint64)( sinceStartup * mDevice->getDeviceTimeTicksPerMs() ) : 0 );
+		}
+		emitReceived( QList<DeviceCommand*>() << deviceCmd, LatencyTrace::now() );
+	}
+	else if( cmd->getName() == "deviceInfo" )
+		{ emitGreeting( (ClientCommandDeviceInfo*)cmd ); }
+	else if( cmd->getName() == "deviceAPI" )
+	{
+		ClientCommandDeviceApi *apiCmd = (ClientCommandDeviceApi*)cmd;
+		if( !apiCmd->isDataValid() )
+			{ error( QtWarningMsg, "The deviceAPI of the upstream proxy is corrupted", "handleUpstreamCommand()" ); }
+		else
+		{
+			QString apiString = QString::fromUtf8( QByteArray::fromBase64(apiCmd->getEncodedApi()).data() );
+			if( mApiString.isEmpty() )
+			{
+				mApiString = apiString;
+				emit upstreamApiReceived();
+			}
+			else if( apiString != mApiString )
+				{ error( QtWarningMsg, "The deviceAPI of the upstream proxy has changed, restart the relay to apply it", "handleUpstreamCommand()" ); }
+
+			if( mOpen )
+				{ startMirror(); }
+		}
+	}
+	cmd->deleteLater();
+}
+
+void RelayDeviceConnector::startMirror()
+{
+	if( !isUpstreamReady() )
+		{ return; }
+	QList<ClientCommandBase*> cmdList;
+	cmdList.append( new ClientCommandSubscribe( deviceSetting("relay/feedIntervalMs").toUInt() ) );
+	cmdList.append( new ClientCommandReqDeviceInfo() );
+	for( int i=0; i<cmdList.size(); ++i )
+		{ cmdList.at(i)->setDevice( mUpstreamDevice ); }
+	if( !mUpstream->sendCommands( cmdList ) )
+		{ error( QtWarningMsg, "Failed to subscribe to the upstream proxy", "startMirror()" ); }
+	else
+		{ debug( debugLevelVerbose, QString("Subscribed to all variables of the upstream proxy, interval: %1ms").arg(deviceSetting("relay/feedIntervalMs").toString()), "startMirror()" ); }
+}
+
+void RelayDeviceConnector::emitGreeting( const ClientCommandDeviceInfo *infoCmd )
+{
+	QStringList argList;
+	QHash<QString,QString> infoList = infoCmd->getInfoList();
+	infoList.insert( "batch", "0" );
+	infoList.insert( "binary", "0" );
+	infoList.insert( "rxBuffer", "0" );
+	infoList.insert( "positiveAck", infoCmd->getPositiveAck() ? "true" : "false" );
+	QHash<QString,QString>::const_iterator info = infoList.constBegin();
+	for( ; info != infoList.constEnd(); ++info )
+		{ argList.append( info.key() + ':' + info.value() ); }
+
+	DeviceCommand *greetingCmd = new DeviceCommand();
+	greetingCmd->setType( deviceCmdCall );
+	greetingCmd->setInterface( ":proxy" );
+	greetingCmd->setFunction( "greeting" );
+	greetingCmd->setArgList( argList );
+	if( infoCmd->getStartupTime() > 0 )
+		{ greetingCmd->setTimestamp( (quint64)( ( QDateTime::currentMSecsSinceEpoch() - infoCmd->getStartupTime() ) * mDevice->getDeviceTimeTicksPerMs() ) ); }
+	emitReceived( QList<DeviceCommand*>() << greetingCmd, LatencyTrace::now() );
+}
@@ -0,0 +1,120 @@
+#ifndef RELAYDEVICECONNECTOR_H
+#define RELAYDEVICECONNECTOR_H
+
+#include "DeviceConnectionManagerBase.h"
+#include "StateManagerBase.h"
+#include <QTimer>
+
+namespace QtuC
+{
+
+class ClientConnectionManagerBase;
+class ClientCommandBase;
+class ClientCommandDeviceInfo;
+
+/** Use an other (upstream) qcProxy as the device, to relay it to more clients.
+  *	The relay connects to the upstream proxy as a client, so a tree of proxies can serve many remote clients, while the proxy of the device serves only a few relays.
+  *	  * The deviceAPI is taken from the upstream proxy (see fetchDeviceApi()), so the state table of the relay is the same as the upstream one.
+  *	  * The relay subscribes to all variables of the upstream proxy, and the subscription feed is received as `set` commands from the device, which mirror the state table.
+  *	    The local clients are served from the state table of the relay, with its own subscriptions.
+  *	  * The `get`, `set` and `call` commands to the device are sent to the upstream proxy as client commands. The upstream proxy answers a get from its state table, not the device.
+  *	  * The client commands carry the user-side values (see carriesUserValues()), a `set` of a variable is sent with its user-side value, unless the device uses positive acknowledge,
+  *	    as then the set is not applied to the variable, and the command already holds the value from the client.
+  *	  * The deviceInfo of the upstream proxy is received as a device greeting. The `:proxy` calls (device streams) are not sent, the upstream proxy requests them from the device.
+  *	If the upstream link is lost, the relay connects again periodically.
+  *
+  *	Settings (`relay/` group):
+  *		- `upstreamHost`, `upstreamPort`: Address of the upstream proxy.
+  *		- `upstreamLocalName`: Local socket name of the upstream proxy, if it runs on the same host (see ConnectionServer), empty to connect on TCP.
+  *		- `upstreamDevice`: Id of the relayed device, if the upstream proxy serves more devices, empty for its default device.
+  *		- `feedIntervalMs`: Interval of the subscription to the upstream proxy.
+  *		- `connectTimeoutMs`: Time to wait for the deviceAPI of the upstream proxy on start.
+  *		- `reconnectIntervalMs`: Time between two connection attempts.*/
+class RelayDeviceConnector : public DeviceConnectionManagerBase
+{
+	Q_OBJECT
+public:
+
+	/** Create the relay.
+	  *	@param device The relayed device.
+	  *	@param stateManager The state manager of the deviceAPI, for the user-side values of the variables to set.
+	  *	@param parent Parent object.*/
+	RelayDeviceConnector( const Device *device, StateManagerBase *stateManager, QObject *parent = 0 );
+
+	~RelayDeviceConnector();
+
+	/** @name Inherited from DeviceConnectionManagerBase.
+	  *	@{*/
+	bool sendCommand( DeviceCommand *cmd );
+
+	void closeDevice();		///< Close the upstream link, and stop connecting again.
+
+	/** Start mirroring the upstream proxy, and connect if not yet connected.
+	  *	@return True on success, false otherwise.*/
+	bool openDevice();
+
+	qint64 getPendingByteCount() const;
+
+	/** Connect to the upstream proxy and get its deviceAPI.
+	  *	Blocks until the deviceAPI arrives, at most for `relay/connectTimeoutMs` milliseconds.
+	  *	@return The deviceAPI string, or an empty string if the upstream proxy is not reachable.*/
+	QString fetchDeviceApi();
+
+	bool carriesUserValues() const
+		{ return true; }
+	/// @}
+
+	/// Get whether the upstream link is ready.
+	bool isUpstreamReady() const;
+
+signals:
+
+	/// Emitted when the deviceAPI of the upstream proxy is received for the first time.
+	void upstreamApiReceived();
+
+	/// Emitted when the upstream link fails or is lost.
+	void upstreamLost();
+
+private slots:
+
+	/// Connect to the upstream proxy.
+	void connectUpstream();
+
+	/// Handle the socket connected, make the handshake.
+	void handleConnected();
+
+	/// Handle a failed connection, try again later.
+	void handleConnectError();
+
+	/// Handle the handshake done, request the deviceAPI.
+	void handleUpstreamReady();
+
+	/// Handle the upstream link lost, try again later.
+	void handleUpstreamDisconnected();
+
+	/** Handle a command from the upstream proxy.
+	  *	@param cmd The command.*/
+	void handleUpstreamCommand( ClientCommandBase *cmd );
+
+private:
+
+	/// Subscribe to all variables of the upstream proxy, and request its deviceInfo.
+	void startMirror();
+
+	/** Emit the deviceInfo of the upstream proxy as a device greeting.
+	  *	The startup time is passed as the timestamp of the greeting, in device ticks since the startup.
+	  *	The batch, binary and flow control parameters of the device are not relayed, they belong to the device link of the upstream proxy.
+	  *	@param infoCmd The deviceInfo command.*/
+	void emitGreeting( const ClientCommandDeviceInfo *infoCmd );
+
+	StateManagerBase *mStateManager;
+	ClientConnectionManagerBase *mUpstream;	///< The link to the upstream proxy, 0 if not connected.
+	QTimer *mReconnectTimer;
+	QString mUpstreamDevice;	///< Id of the relayed device on the upstream proxy, empty for its default device.
+	QString mApiString;		///< The deviceAPI of the upstream proxy, empty until received.
+	bool mOpen;				///< True between openDevice() and closeDevice().
+	bool mConnecting;		///< True while the socket connects.
+};
+
+}	//QtuC::
+#endif // RELAYDEVICECONNECTOR_H
@@ -0,0 +1,230 @@
+#include "ReplayDeviceConnector.h"
+#include "DeviceCommandRecorder.h"
+#include "ProxySettingsManager.h"
+#include "Device.h"
+#include "ProxyMetrics.h"
+
+using namespace QtuC;
+
+const int ReplayDeviceConnector::mMaxBatch = 1000;
+
+ReplayDeviceConnector::ReplayDeviceConnector( const Device *device, QObject *parent ) :
+	DeviceConnectionManagerBase(device, parent),
+	mSpeed(1.0),
+	mStartTime(0),
+	mReplayCount(0),
+	mHasNext(false),
+	mNextTime(0),
+	mNextHasTimestamp(false),
+	mNextTimestamp(0)
+{
+	mReplayTimer = new QTimer(this);
+	mReplayTimer->setSingleShot(true);
+	connect( mReplayTimer, SIGNAL(timeout()), this, SLOT(replayNext()) );
+}
+
+ReplayDeviceConnector::~ReplayDeviceConnector()
+{
+	closeDevice();
+}
+
+bool ReplayDeviceConnector::sendCommand( DeviceCommand *cmd )
+{
+	if( !cmd )
+		{ return false; }
+
+	debug( debugLevelVeryVerbose, QString("Replaying, command to device dropped: %1").arg(cmd->getCommandString()), "sendCommand()" );
+	cmd->deleteLater();
+	return true;
+}
+
+void ReplayDeviceConnector::closeDevice()
+{
+	mReplayTimer->stop();
+	if( mLogFile.isOpen() )
+	{
+		mLogStream.setDevice(0);
+		mLogFile.close();
+		debug( debugLevelInfo, QString("Replay stopped, %1 commands replayed").arg(QString::number(mReplayCount)), "closeDevice()" );
+	}
+}
+
+bool ReplayDeviceConnector::openDevice()
+{
+	QString path = ProxySettingsManager::instance()->getDeviceCmdArgValue( mDevice->getId(), ProxySettingsManager::cmdArgReplay ).toString();
+	if( path.isEmpty() )
+		{ path = deviceSetting("deviceReplay/path").toString(); }
+
+	bool ok;
+	mSpeed = ProxySettingsManager::instance()->getDeviceCmdArgValue( mDevice->getId(), ProxySettingsManager::cmdArgReplaySpeed ).toDouble(&ok);
+	if( !ok )
+		{ mSpeed = deviceSetting("deviceReplay/speed").toDouble(&ok); }
+	if( !ok || mSpeed < 0 )
+	{
+		error( QtWarningMsg, "Invalid replay speed, fallback to 1x", "openDevice()" );
+		mSpeed = 1.0;
+	}
+
+	mLogFile.setFileName( path );
+	if( !mLogFile.open( QIODevice::ReadOnly ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "file", path );
+		errDet.insert( "error", mLogFile.errorString() );
+		error( QtCriticalMsg, "Failed to open device command log", "openDevice()", errDet );
+		return false;
+	}
+	mLogStream.setDevice( &mLogFile );
+
+	// check header
+	char magic[sizeof(DeviceCommandRecorder::mLogMagic)-1];
+	quint8 version = 0;
+	qint64 recordingStart = 0;
+	mLogStream.readRawData( magic, sizeof(magic) );
+	mLogStream >> version >> recordingStart;
+	if( qstrncmp( magic, DeviceCommandRecorder::mLogMagic, sizeof(magic) ) != 0 || version != DeviceCommandRecorder::mFormatVersion )
+	{
+		error( QtCriticalMsg, QString("%1 is not a device command log, or its version is not supported").arg(path), "openDevice()" );
+		closeDevice();
+		return false;
+	}
+
+	qint64 dataStart = mLogFile.pos();
+	quint64 startMs = deviceSetting("deviceReplay/startMs").toULongLong();
+	if( startMs && !seek( startMs*1000 ) )
+	{
+		error( QtWarningMsg, "Failed to seek in log, replay from the beginning", "openDevice()" );
+		mLogStream.resetStatus();
+		mLogFile.seek( dataStart );
+	}
+
+	if( !readNext() )
+	{
+		error( QtWarningMsg, "Device command log is empty", "openDevice()" );
+		return true;
+	}
+
+	mStartTime = mNextTime;
+	mReplayCount = 0;
+	mClock.start();
+	mReplayTimer->start(0);
+	debug( debugLevelInfo, QString("Replaying device commands from %1 at %2").arg( path, mSpeed > 0 ? QString("%1x").arg(mSpeed) : QString("max speed") ), "openDevice()" );
+	return true;
+}
+
+void ReplayDeviceConnector::replayNext()
+{
+	int batch = 0;
+	while( mHasNext && batch < mMaxBatch )
+	{
+		if( mSpeed > 0 )
+		{
+			quint64 dueUs = (quint64)( (mNextTime - mStartTime) / mSpeed );
+			quint64 nowUs = mClock.nsecsElapsed() / 1000;
+			if( dueUs > nowUs )
+			{
+				mReplayTimer->start( (dueUs - nowUs) / 1000 );
+				return;
+			}
+		}
+
+		quint64 rxTime = LatencyTrace::now();
+		DeviceCommand *cmd = DeviceCommand::fromString( QString(mNextCmdString) );
+		if( cmd )
+		{
+			if( mNextHasTimestamp )
+				{ cmd->setTimestamp( mNextTimestamp ); }
+			++mReplayCount;
+			traceReceived( cmd, rxTime );
+			emit commandReceived( cmd );
+		}
+		else
+		{
+			error( QtWarningMsg, "Invalid device command in log, command dropped", "replayNext()" );
+			ProxyMetrics::instance()->countParseFailure();
+		}
+
+		++batch;
+		readNext();
+	}
+
+	if( mHasNext )
+		{ mReplayTimer->start(0); }
+	else
+	{
+		debug( debugLevelInfo, QString("End of device command log, %1 commands replayed").arg(QString::number(mReplayCount)), "replayNext()" );
+		emit replayFinished();
+	}
+}
+
+bool ReplayDeviceConnector::readNext()
+{
+	mHasNext = false;
+	if( mLogStream.atEnd() )
+		{ return false; }
+
+	quint8 flags = 0;
+	mLogStream >> mNextTime >> flags;
+	mNextHasTimestamp = flags & DeviceCommandRecorder::recordFlagHasTimestamp;
+	if( mNextHasTimestamp )
+		{ mLogStream >> mNextTimestamp; }
+	mLogStream >> mNextCmdString;
+
+	if( mLogStream.status() != QDataStream::Ok )
+	{
+		error( QtWarningMsg, "Truncated record at the end of device command log", "readNext()" );
+		return false;
+	}
+	mHasNext = true;
+	return true;
+}
+
+bool ReplayDeviceConnector::seek( quint64 timeUs )
+{
+	QFile indexFile( mLogFile.fileName() + ".idx" );
+	if( !indexFile.open( QIODevice::ReadOnly ) )
+	{
+		error( QtWarningMsg, QString("Failed to open log index: %1").arg(indexFile.errorString()), "seek()" );
+		return false;
+	}
+	QDataStream indexStream( &indexFile );
+
+	char magic[sizeof(DeviceCommandRecorder::mIndexMagic)-1];
+	quint8 version = 0;
+	indexStream.readRawData( magic, sizeof(magic) );
+	indexStream >> version;
+	if( qstrncmp( magic, DeviceCommandRecorder::mIndexMagic, sizeof(magic) ) != 0 || version != DeviceCommandRecorder::mFormatVersion )
+	{
+		error( QtWarningMsg, "Invalid log index", "seek()" );
+		return false;
+	}
+
+	// find the last indexed record before the requested time
+	qint64 offset = -1;
+	while( !indexStream.atEnd() )
+	{
+		quint64 entryTime, recordNum;
+		qint64 entryOffset;
+		indexStream >> entryTime >> entryOffset >> recordNum;
+		if( indexStream.status() != QDataStream::Ok || entryTime > timeUs )
+			{ break; }
+		offset = entryOffset;
+	}
+	if( offset < 0 || !mLogFile.seek(offset) )
+		{ return false; }
+
+	// skip the records before the requested time
+	qint64 recordStart = mLogFile.pos();
+	while( readNext() )
+	{
+		if( mNextTime >= timeUs )
+		{
+			// rewind to the start of this record, it will be read again
+			mLogFile.seek( recordStart );
+			mHasNext = false;
+			return true;
+		}
+		recordStart = mLogFile.pos();
+	}
+	return false;
+}
@@ -0,0 +1,76 @@
+#ifndef REPLAYDEVICECONNECTOR_H
+#define REPLAYDEVICECONNECTOR_H
+
+#include "DeviceConnectionManagerBase.h"
+#include <QFile>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QTimer>
+
+namespace QtuC
+{
+
+/** Replay a device command log recorded by DeviceCommandRecorder, as if the commands were received from the device.
+  *	The log path is set in the `deviceReplay/path` setting (or with the --replay command line option), either of them selects this connector.
+  *	The replay speed is set by `deviceReplay/speed`: 1 replays with the original timing, N replays N times faster, 0 replays as fast as possible.
+  *	Replay can start at a later point of the log with `deviceReplay/startMs`, the index file of the log is used to seek there.
+  *	Commands sent to the device are dropped.*/
+class ReplayDeviceConnector : public DeviceConnectionManagerBase
+{
+	Q_OBJECT
+public:
+	explicit ReplayDeviceConnector( const Device *device, QObject *parent = 0 );
+
+	~ReplayDeviceConnector();
+
+	/** @name Inherited from DeviceConnectionManagerBase.
+	  *	@{*/
+	bool sendCommand( DeviceCommand *cmd );
+
+	void closeDevice();		///< Stop replay and close the log.
+
+	/** Open the log and start the replay.
+	  *	@return True on success, false otherwise.*/
+	bool openDevice();
+	/// @}
+
+signals:
+
+	/// Emitted when the end of the log is reached.
+	void replayFinished();
+
+private slots:
+
+	/// Emit all commands which are due, then schedule the next run.
+	void replayNext();
+
+private:
+
+	/** Read the next record from the log into mNext*.
+	  *	@return True on success, false at the end of the log or on error.*/
+	bool readNext();
+
+	/** Seek to a time in the log, using the index file.
+	  *	@param timeUs The time to seek to, in microseconds since recording start.
+	  *	@return True on success, false otherwise.*/
+	bool seek( quint64 timeUs );
+
+	QFile mLogFile;
+	QDataStream mLogStream;
+	QTimer *mReplayTimer;
+	QElapsedTimer mClock;	///< Measures the replay time.
+	double mSpeed;		///< Replay speed multiplier, 0 means as fast as possible.
+	quint64 mStartTime;	///< Log time of the replay start, microseconds.
+	quint64 mReplayCount;
+
+	bool mHasNext;		///< True if the next record has been read.
+	quint64 mNextTime;	///< Receive time of the next record, microseconds since recording start.
+	bool mNextHasTimestamp;
+	quint64 mNextTimestamp;
+	QByteArray mNextCmdString;
+
+	static const int mMaxBatch;	///< Maximum number of commands emitted in one run, so the event loop is not blocked.
+};
+
+}	//QtuC::
+#endif // REPLAYDEVICECONNECTOR_H
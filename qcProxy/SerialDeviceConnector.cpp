@@ -1,13 +1,30 @@
 #include "SerialDeviceConnector.h"
-#include "ProxySettingsManager.h"
+#include "ProxyMetrics.h"
+#include "Device.h"
 
 using namespace QtuC;
 using namespace QtAddOn::SerialPort;
 
-SerialDeviceConnector::SerialDeviceConnector( QObject *parent ) : DeviceConnectionManagerBase( parent )
+SerialDeviceConnector::SerialDeviceConnector( const Device *device, QObject *parent ) :
+	DeviceConnectionManagerBase( device, parent ),
+	mBinaryState(binaryOff),
+	mFlowWindow(0),
+	mFlowSuspended(false),
+	mFlowSentCount(0),
+	mFlowAckedCount(0)
 {
 	mSerialPort = new SerialPort(this);
 	connect(mSerialPort, SIGNAL(readyRead()), this, SLOT(receivePart()));
+
+	mBinaryTimer = new QTimer(this);
+	mBinaryTimer->setSingleShot( true );
+	mBinaryTimer->setInterval( 1000 );
+	connect( mBinaryTimer, SIGNAL(timeout()), this, SLOT(binaryTimeout()) );
+
+	mFlowTimer = new QTimer(this);
+	mFlowTimer->setSingleShot( true );
+	mFlowTimer->setInterval( 1000 );
+	connect( mFlowTimer, SIGNAL(timeout()), this, SLOT(flowControlTimeout()) );
 }
 
 SerialDeviceConnector::~SerialDeviceConnector()
@@ -34,12 +51,24 @@ bool SerialDeviceConnector::sendCommand( DeviceCommand *cmd )
 		return false;
 	}
 
+	// the device switches protocol after the acknowledge, keep the order of the commands
+	if( mBinaryState == binaryRequested )
+	{
+		mHeldCommands.append( cmd );
+		return true;
+	}
+
+	return writeCommand( cmd );
+}
+
+bool SerialDeviceConnector::writeCommand( DeviceCommand *cmd )
+{
 	// get commandString once
-	QByteArray commandString = cmd->getCommandString().toAscii();
-	if( mSerialPort->write( commandString ) <= 0 )
+	QByteArray commandString = ( mBinaryState == binaryOn ) ? cmd->getBinaryFrame( mBinaryVars ) : cmd->getCommandString().toAscii();
+	if( commandString.isEmpty() || !transmit( commandString ) )
 	{
 		errorDetails_t errDet;
-		errDet.insert( "cmdStr", QString(commandString) );
+		errDet.insert( "cmdStr", cmd->getCommandString() );
 		errDet.insert( "serialPort error", mSerialPort->errorString() );
 		error( QtWarningMsg, "Failed to send command to device.", "senmdCommand()", errDet );
 		cmd->deleteLater();
@@ -51,42 +80,280 @@ bool SerialDeviceConnector::sendCommand( DeviceCommand *cmd )
 	return true;
 }
 
+bool SerialDeviceConnector::writeRaw( const QByteArray &data )
+{
+	if( !transmit( data ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "serialPort error", mSerialPort->errorString() );
+		error( QtWarningMsg, "Failed to write to device.", "writeRaw()", errDet );
+		return false;
+	}
+	return true;
+}
+
+bool SerialDeviceConnector::transmit( const QByteArray &data )
+{
+	if( mFlowWindow <= 0 || mFlowSuspended )
+	{
+		// while suspended, the written data is still counted, so a later acknowledge can resume flow control
+		qint64 written = mSerialPort->write( data );
+		if( mFlowWindow > 0 && written > 0 )
+			{ mFlowSentCount += written; }
+		return written > 0;
+	}
+	mTxQueue.append( data );
+	return flushTransmit();
+}
+
+bool SerialDeviceConnector::flushTransmit()
+{
+	while( !mTxQueue.isEmpty() )
+	{
+		qint64 room = mFlowWindow - (qint64)(quint32)( mFlowSentCount - mFlowAckedCount );
+		if( room <= 0 )
+		{
+			if( !mFlowTimer->isActive() )
+				{ mFlowTimer->start(); }
+			return true;
+		}
+		qint64 written = mSerialPort->write( mTxQueue.left( room ) );
+		if( written <= 0 )
+			{ return false; }
+		mTxQueue.remove( 0, written );
+		mFlowSentCount += written;
+	}
+	return true;
+}
+
+bool SerialDeviceConnector::startFlowControl( int windowSize )
+{
+	if( !mSerialPort->isOpen() )
+	{
+		error( QtWarningMsg, "Serial port is closed, cannot start flow control", "startFlowControl()" );
+		return false;
+	}
+
+	// the device counts from the end of the flowControl call, the data queued before it is written without limit
+	mFlowTimer->stop();
+	mFlowWindow = 0;
+	mFlowSuspended = false;
+	QByteArray request = mTxQueue;
+	mTxQueue.clear();
+
+	DeviceCommand cmd;
+	cmd.setType( deviceCmdCall );
+	cmd.setInterface( ":proxy" );
+	cmd.setFunction( "flowControl" );
+	cmd.setArgumentString( "1" );
+	request.append( ( mBinaryState == binaryOn ) ? cmd.getBinaryFrame( mBinaryVars ) : cmd.getCommandString().toAscii() );
+	if( !writeRaw( request ) )
+		{ return false; }
+
+	mFlowSentCount = 0;
+	mFlowAckedCount = 0;
+	mFlowWindow = windowSize;
+	debug( debugLevelVerbose, QString("Flow control started with a window of %1 bytes").arg(QString::number(windowSize)), "startFlowControl()" );
+	return true;
+}
+
+void SerialDeviceConnector::flowControlTimeout()
+{
+	if( mFlowWindow <= 0 || mFlowSuspended )
+		{ return; }
+
+	error( QtWarningMsg, "Device didn't acknowledge the received data, flow control suspended until the next acknowledge", "flowControlTimeout()" );
+	mFlowSuspended = true;
+	QByteArray queue = mTxQueue;
+	mTxQueue.clear();
+	writeRaw( queue );
+}
+
+bool SerialDeviceConnector::receiveFlowAck( const QString &hwInterface, const QString &var, const QString &arg )
+{
+	if( hwInterface != ":proxy" || var != "rxAck" )
+		{ return false; }
+
+	bool ok = false;
+	quint32 count = arg.toUInt( &ok, 16 );
+	if( ok && mFlowWindow > 0 )
+	{
+		mFlowAckedCount = count;
+		mFlowTimer->stop();
+		if( mFlowSuspended )
+		{
+			debug( debugLevelVerbose, "Device acknowledged the received data, flow control resumed", "receiveFlowAck()" );
+			mFlowSuspended = false;
+		}
+		if( !flushTransmit() )
+			{ error( QtWarningMsg, QString("Failed to write to device: %1").arg(mSerialPort->errorString()), "receiveFlowAck()" ); }
+	}
+	return true;
+}
+
+bool SerialDeviceConnector::startBinaryProtocol( const QStringList &varKeyList, const QList<QVariant::Type> &rawTypeList )
+{
+	if( !mSerialPort->isOpen() )
+	{
+		error( QtWarningMsg, "Serial port is closed, cannot start the binary protocol", "startBinaryProtocol()" );
+		return false;
+	}
+
+	// the device may still be in binary mode from an earlier session: the 0 ends its partial frame, and a failed frame with a line end is executed as text
+	QChar sep = DeviceCommand::getSeparator();
+	QByteArray request( 1, '\0' );
+	request.append( QString( "call" + sep + ":proxy" + sep + "binary" + sep + "0\n" ).toAscii() ).append( '\0' );
+	for( int i=0; i<varKeyList.size(); ++i )
+	{
+		QString hwi = varKeyList.at(i).section( '/', 0, 0 );
+		QString var = varKeyList.at(i).section( '/', 1 );
+		request.append( QString( "call" + sep + ":proxy" + sep + "binaryId" + sep + QString::number(i) + sep + hwi + sep + var + '\n' ).toAscii() ).append( '\0' );
+	}
+	request.append( QString( "call" + sep + ":proxy" + sep + "binary" + sep + "1\n" ).toAscii() ).append( '\0' );
+
+	mBinaryState = binaryOff;
+	mBinaryIdList = varKeyList;
+	mBinaryVars.clear();
+	for( int i=0; i<mBinaryIdList.size(); ++i )
+	{
+		DeviceCommand::binaryVar_t binaryVar;
+		binaryVar.id = i;
+		binaryVar.rawType = rawTypeList.value( i, QVariant::String );
+		mBinaryVars.insert( mBinaryIdList.at(i), binaryVar );
+	}
+	if( !writeRaw( request ) )
+		{ return false; }
+
+	mBinaryState = binaryRequested;
+	mBinaryTimer->start();
+	debug( debugLevelVerbose, QString("Binary protocol requested with %1 variable ids").arg(QString::number(varKeyList.size())), "startBinaryProtocol()" );
+	return true;
+}
+
+void SerialDeviceConnector::binaryTimeout()
+{
+	if( mBinaryState != binaryRequested )
+		{ return; }
+
+	error( QtWarningMsg, "Device didn't acknowledge the binary protocol, staying on text", "binaryTimeout()" );
+	mBinaryState = binaryOff;
+	while( !mHeldCommands.isEmpty() )
+		{ writeCommand( mHeldCommands.takeFirst() ); }
+}
+
 void SerialDeviceConnector::receivePart()
 {
-	QByteArray block;
 	char c=0;
-	bool fullCmd = false;
 	while( mSerialPort->getChar(&c) )
 	{
+		if( mBinaryState == binaryOn )
+		{
+			if( !c )
+			{
+				if( !mCmdRxBuffer.isEmpty() )
+				{
+					quint64 rxTime = LatencyTrace::now();
+					QList<DeviceCommand*> cmdList = DeviceCommand::listFromBinaryFrame( mCmdRxBuffer, mBinaryIdList );
+					bool parsed = !cmdList.isEmpty();
+					for( int i=cmdList.size()-1; i>=0; --i )
+					{
+						if( receiveFlowAck( cmdList.at(i)->getHwInterface(), cmdList.at(i)->getVariable(), cmdList.at(i)->getArg() ) )
+							{ cmdList.takeAt(i)->deleteLater(); }
+					}
+					if( !parsed || ( !cmdList.isEmpty() && !emitReceived( cmdList, rxTime ) ) )
+					{
+						error( QtWarningMsg, "Invalid device frame received, dropped", "receivePart()");
+						ProxyMetrics::instance()->countParseFailure();
+					}
+					mCmdRxBuffer.clear();
+				}
+				continue;
+			}
+
+			// a text line (the acknowledge of the switch back to text, or the greeting of a reset device)
+			// the second byte of a frame is the header, which is never printable
+			if( c == '\n' && !mCmdRxBuffer.isEmpty() && QChar(mCmdRxBuffer.at(0)).isLetter() )
+			{
+				bool isText = true;
+				for( int i=0; i<mCmdRxBuffer.size() && isText; ++i )
+					{ isText = ( mCmdRxBuffer.at(i) >= ' ' && mCmdRxBuffer.at(i) < 127 ) || mCmdRxBuffer.at(i) == '\r'; }
+				if( isText )
+				{
+					receiveLine( mCmdRxBuffer, LatencyTrace::now() );
+					mCmdRxBuffer.clear();
+					continue;
+				}
+			}
+			mCmdRxBuffer.append(c);
+			continue;
+		}
+
 		if( c && c != '\n' && c != '\r' )
+			{ mCmdRxBuffer.append(c); }
+		else if( !c )
+			{ mCmdRxBuffer.clear(); }	// a frame of an earlier binary session
+		else if( c == '\n' && !mCmdRxBuffer.isEmpty() )
+		{
+			receiveLine( mCmdRxBuffer, LatencyTrace::now() );
+			mCmdRxBuffer.clear();
+		}
+	}
+}
+
+void SerialDeviceConnector::receiveLine( const QByteArray &line, quint64 rxTime )
+{
+	QString cmdString = QString::fromAscii( line ).remove('\r');
+	debug( debugLevelVeryVerbose, QString("Command received on serial: %1").arg(cmdString), "receivePart()" );
+
+	// the acknowledge of the protocol switch: call [@timestamp] :proxy binary 0|1
+	QStringList parts = cmdString.split( DeviceCommand::getSeparator(), QString::SkipEmptyParts );
+	if( parts.size() >= 4 && parts.at( parts.size()-3 ) == ":proxy" && parts.at( parts.size()-2 ) == "binary" )
+	{
+		if( parts.last() == "1" && mBinaryState == binaryRequested )
 		{
-			block.append(c);
+			mBinaryTimer->stop();
+			mBinaryState = binaryOn;
+			debug( debugLevelInfo, "Device link switched to the binary protocol", "receiveLine()" );
+			while( !mHeldCommands.isEmpty() )
+				{ writeCommand( mHeldCommands.takeFirst() ); }
 		}
-		if( c == '\n' )
+		else if( parts.last() == "0" && mBinaryState == binaryOn )
 		{
-			fullCmd = true;
-			break;
+			mBinaryState = binaryOff;
+			debug( debugLevelInfo, "Device link switched to the text protocol", "receiveLine()" );
 		}
+		return;
 	}
 
-	if( !block.isEmpty() )
-		{ mCmdRxBuffer.append(block); }
+	// the flow control acknowledge: call [@timestamp] :proxy rxAck <count>
+	if( parts.size() >= 4 && receiveFlowAck( parts.at( parts.size()-3 ), parts.at( parts.size()-2 ), parts.last() ) )
+		{ return; }
 
-	if( fullCmd )
+	// a reset device greets in text
+	if( mBinaryState == binaryOn )
 	{
-		debug( debugLevelVeryVerbose, QString("Command received on serial: %1").arg(mCmdRxBuffer), "receivePart()" );
+		mBinaryState = binaryOff;
+		debug( debugLevelInfo, "Text command received on the binary protocol, device link switched to text", "receiveLine()" );
+	}
 
-		DeviceCommand *cmd = DeviceCommand::fromString( mCmdRxBuffer );
-		if( cmd )
-			{ emit commandReceived((DeviceCommand*)cmd); }
-		else
-			{ error( QtWarningMsg, "Invalid device command received, command dropped", "receivePart()"); }
-		mCmdRxBuffer.clear();
+	if( !emitReceived( cmdString, rxTime ) )
+	{
+		error( QtWarningMsg, "Invalid device command received, command dropped", "receivePart()");
+		ProxyMetrics::instance()->countParseFailure();
 	}
 }
 
 void SerialDeviceConnector::closeDevice()
 {
+	mBinaryTimer->stop();
+	mBinaryState = binaryOff;
+	while( !mHeldCommands.isEmpty() )
+		{ mHeldCommands.takeFirst()->deleteLater(); }
+	mFlowTimer->stop();
+	mFlowWindow = 0;
+	mFlowSuspended = false;
+	mTxQueue.clear();
+
 	if( mSerialPort->isOpen() )
 	{
 		mSerialPort->close();
@@ -94,10 +361,15 @@ void SerialDeviceConnector::closeDevice()
 	}
 }
 
+qint64 SerialDeviceConnector::getPendingByteCount() const
+{
+	return mSerialPort->bytesToWrite() + mTxQueue.size();
+}
+
 bool SerialDeviceConnector::openDevice()
 {
-    mSerialPort->setPort( ProxySettingsManager::instance()->value( "devicePort/portName" ).toString() );
-	QString serialBaud = ProxySettingsManager::instance()->value( "devicePort/baudRate" ).toString();
+    mSerialPort->setPort( deviceSetting( "devicePort/portName" ).toString() );
+	QString serialBaud = deviceSetting( "devicePort/baudRate" ).toString();
     if( mSerialPort->open( QIODevice::ReadWrite ) )
 	{
 		if( !mSerialPort->setRate( serialBaud.toInt() ) )
@@ -130,13 +402,20 @@ bool SerialDeviceConnector::openDevice()
 			return false;
 		}
 
-		debug( debugLevelInfo, QString("Serial port %1 opened").arg(ProxySettingsManager::instance()->value( "devicePort/portName" ).toString()), "connectPort()" );
+		debug( debugLevelInfo, QString("Serial port %1 opened").arg(deviceSetting( "devicePort/portName" ).toString()), "connectPort()" );
+
+		// a device left in binary mode by an earlier session would not understand us, switch it back to text (see startBinaryProtocol())
+		if( mDevice->getBinaryIdCount() > 0 )
+		{
+			QChar sep = DeviceCommand::getSeparator();
+			writeRaw( QByteArray( 1, '\0' ).append( QString( "call" + sep + ":proxy" + sep + "binary" + sep + "0\n" ).toAscii() ).append( '\0' ) );
+		}
 	}
 	else
 	{
 		errorDetails_t errDet;
 		errDet.insert( "error message", mSerialPort->errorString() );
-		error( QtCriticalMsg, QString( "Opening serial port %1 failed" ).arg( ProxySettingsManager::instance()->value( "devicePort/portName" ).toString() ), "connectPort()", errDet );
+		error( QtCriticalMsg, QString( "Opening serial port %1 failed" ).arg( deviceSetting( "devicePort/portName" ).toString() ), "connectPort()", errDet );
 		return false;
 	}
 	return true;
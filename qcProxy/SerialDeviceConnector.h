@@ -4,18 +4,26 @@
 #include "DeviceConnectionManagerBase.h"
 #include <serialport.h>
 #include <QFile>
+#include <QTimer>
 
 namespace QtuC
 {
 
-/** Class to connect a device via a serial link.*/
+/** Class to connect a device via a serial link.
+ *	The link starts with the text protocol. If requested with startBinaryProtocol(), the variable ids are sent to the device,
+ *	and after the device acknowledges the switch, commands are sent and received in binary frames (see DeviceCommand::getBinaryFrame()).
+ *	The commands sent while waiting for the acknowledge are held back, and sent after it (or in text, if the device doesn't answer in time).<br>
+ *	With flow control (see startFlowControl()), the data is queued, and written only while the data unacknowledged by the device (`call :proxy rxAck <count>`) fits in the window.
+ *	If the device doesn't acknowledge in time, flow control is suspended, and the data is written without limit, until the next acknowledge resumes it.*/
 class SerialDeviceConnector : public DeviceConnectionManagerBase
 {
 	Q_OBJECT
 public:
 
-	/** Create.*/
-	SerialDeviceConnector( QObject *parent = 0 );
+	/** Create.
+	  *	@param device The device of the link.
+	  *	@param parent Parent object.*/
+	SerialDeviceConnector( const Device *device, QObject *parent = 0 );
 
 	~SerialDeviceConnector();
 
@@ -28,6 +36,15 @@ public:
 	/** Open and initialize serial port.
 	  *	@return True on success, false otherwise.*/
 	bool openDevice();
+
+	qint64 getPendingByteCount() const;	///< Bytes not yet written to the serial port, including the ones held back by flow control.
+
+	bool startBinaryProtocol( const QStringList &varKeyList, const QList<QVariant::Type> &rawTypeList );
+
+	bool startFlowControl( int windowSize );
+
+	bool isBinaryProtocol() const
+		{ return mBinaryState == binaryOn; }
 	/// @}
 
 private slots:
@@ -36,8 +53,68 @@ private slots:
 	 *	Called on readyRead(), reads available data, checks for newline, and emits commandReceived() a full command has been received.*/
 	void receivePart();
 
+	/** The device didn't acknowledge the binary protocol in time.
+	  *	Stay on the text protocol, and send the held commands.*/
+	void binaryTimeout();
+
+	/** The device didn't acknowledge the received data in time.
+	  *	Suspend flow control until the next acknowledge, and write the queued data.*/
+	void flowControlTimeout();
+
 private:
-	QString mCmdRxBuffer;
+	/// State of the binary protocol.
+	enum binaryState_t
+	{
+		binaryOff,			///< Text protocol.
+		binaryRequested,	///< Waiting for the acknowledge of the device.
+		binaryOn			///< Binary frames.
+	};
+
+	/** Handle a received text line.
+	  *	The acknowledge of the binary protocol switch is consumed, everything else is emitted.
+	  *	@param line The line, without the line end.
+	  *	@param rxTime The time the line was received.*/
+	void receiveLine( const QByteArray &line, quint64 rxTime );
+
+	/** Write a command to the serial port, as a line or a binary frame.
+	  *	@param cmd The command, deleted after sending.
+	  *	@return True on success, false otherwise.*/
+	bool writeCommand( DeviceCommand *cmd );
+
+	/** Write raw data to the serial port.
+	  *	@param data The data.
+	  *	@return True on success, false otherwise.*/
+	bool writeRaw( const QByteArray &data );
+
+	/** Write data to the serial port, or queue it if flow control holds it back.
+	  *	@param data The data.
+	  *	@return True on success, false if the serial port failed.*/
+	bool transmit( const QByteArray &data );
+
+	/** Write as much of the queued data as the flow control window allows.
+	  *	If the window is full, the acknowledge timeout is started.
+	  *	@return True on success, false if the serial port failed.*/
+	bool flushTransmit();
+
+	/** Handle a flow control acknowledge of the device.
+	  *	@param hwInterface Interface of the command.
+	  *	@param var Variable of the command.
+	  *	@param arg Argument of the command, the number of bytes the device has taken from its receive buffer, in hex.
+	  *	@return True if this was an acknowledge (handled), false otherwise.*/
+	bool receiveFlowAck( const QString &hwInterface, const QString &var, const QString &arg );
+
+	binaryState_t mBinaryState;
+	QList<DeviceCommand*> mHeldCommands;	///< Commands sent while waiting for the binary acknowledge.
+	QStringList mBinaryIdList;	///< The variables with an id on the binary protocol (`hwInterface/variable`), the id is the index.
+	QHash<QString,DeviceCommand::binaryVar_t> mBinaryVars;	///< The ids and types of the variables, for DeviceCommand::getBinaryFrame().
+	QTimer *mBinaryTimer;		///< Timeout of the binary acknowledge.
+	QByteArray mCmdRxBuffer;	///< The received part of the current line or frame.
+	int mFlowWindow;			///< Size of the flow control window in bytes, 0 if flow control is off.
+	bool mFlowSuspended;		///< Flow control is suspended after an acknowledge timeout, the data is written without limit, but counted.
+	quint32 mFlowSentCount;		///< Bytes written since flow control started, wrapping.
+	quint32 mFlowAckedCount;	///< Bytes acknowledged by the device, wrapping.
+	QByteArray mTxQueue;		///< Data held back by flow control.
+	QTimer *mFlowTimer;			///< Timeout of the acknowledge, while the window is full.
 	QtAddOn::SerialPort::SerialPort *mSerialPort;
 };
 
@@ -0,0 +1,106 @@
+#include "SharedStateServer.h"
+#include "ProxySettingsManager.h"
+#include "DeviceStateVariableBase.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+
+using namespace QtuC;
+
+SharedStateServer::SharedStateServer( QObject *parent ) :
+	ErrorHandlerBase(parent),
+	mTable(0),
+	mUpdateCount(0)
+{
+	mLocalServer = new QLocalServer(this);
+	connect( mLocalServer, SIGNAL(newConnection()), this, SLOT(handleNewConnection()) );
+
+	mNotifyTimer = new QTimer(this);
+	mNotifyTimer->setSingleShot( true );
+	mNotifyTimer->setInterval( 0 );
+	connect( mNotifyTimer, SIGNAL(timeout()), this, SLOT(notifyClients()) );
+}
+
+SharedStateServer::~SharedStateServer()
+{
+	if( mLocalServer->isListening() )
+		{ mLocalServer->close(); }
+}
+
+bool SharedStateServer::start( const QList<DeviceStateVariableBase*> &varList, const QString &apiString )
+{
+	QString key = ProxySettingsManager::instance()->value("sharedState/key").toString();
+	mTable = new SharedStateTable( key, this );
+	if( !mTable->create( varList.size(), SharedStateTable::apiHash( apiString ) ) )
+		{ return false; }
+
+	for( int id=0; id<varList.size(); ++id )
+	{
+		DeviceStateVariableBase *var = varList.at(id);
+		mVarIds.insert( var, id );
+		if( !var->isNull() )
+			{ mTable->write( id, var->getValue(), var->getLastUpdateTime() ); }
+		connect( var, SIGNAL(valueChanged(QVariant)), this, SLOT(handleValueChange()) );
+	}
+
+	// a socket left by a crashed proxy
+	QLocalServer::removeServer( key );
+	if( !mLocalServer->listen( key ) )
+	{
+		errorDetails_t errDet;
+		errDet.insert( "error", mLocalServer->errorString() );
+		error( QtWarningMsg, QString("Failed to listen on local socket %1").arg(key), "start()", errDet );
+		mTable->detach();
+		return false;
+	}
+
+	debug( debugLevelInfo, QString("Sharing %1 variables with local clients in shared memory %2").arg( QString::number(varList.size()), key ), "start()" );
+	return true;
+}
+
+QString SharedStateServer::getKey() const
+{
+	if( !mTable || !mTable->isAttached() )
+		{ return QString(); }
+	return mTable->getKey();
+}
+
+void SharedStateServer::handleValueChange()
+{
+	QHash<QObject*,int>::const_iterator id = mVarIds.constFind( sender() );
+	if( id == mVarIds.constEnd() )
+		{ return; }
+	DeviceStateVariableBase *var = (DeviceStateVariableBase*)sender();
+	mTable->write( id.value(), var->getValue(), var->getLastUpdateTime() );
+	++mUpdateCount;
+	if( !mClients.isEmpty() && !mNotifyTimer->isActive() )
+		{ mNotifyTimer->start(); }
+}
+
+void SharedStateServer::notifyClients()
+{
+	for( int i=0; i<mClients.size(); ++i )
+	{
+		// a client that hasn't read the previous notification will read these values as well
+		if( mClients.at(i)->bytesToWrite() == 0 )
+			{ mClients.at(i)->write( "u", 1 ); }
+	}
+}
+
+void SharedStateServer::handleNewConnection()
+{
+	while( mLocalServer->hasPendingConnections() )
+	{
+		QLocalSocket *client = mLocalServer->nextPendingConnection();
+		mClients.append( client );
+		connect( client, SIGNAL(disconnected()), this, SLOT(handleClientDisconnect()) );
+		debug( debugLevelInfo, QString("New local client of the shared state, %1 in total").arg(mClients.size()), "handleNewConnection()" );
+	}
+}
+
+void SharedStateServer::handleClientDisconnect()
+{
+	QLocalSocket *client = (QLocalSocket*)sender();
+	mClients.removeAll( client );
+	client->deleteLater();
+	debug( debugLevelInfo, QString("Local client of the shared state disconnected, %1 left").arg(mClients.size()), "handleClientDisconnect()" );
+}
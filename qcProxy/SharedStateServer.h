@@ -0,0 +1,73 @@
+#ifndef SHAREDSTATESERVER_H
+#define SHAREDSTATESERVER_H
+
+#include "ErrorHandlerBase.h"
+#include "SharedStateTable.h"
+#include <QHash>
+#include <QList>
+#include <QTimer>
+
+class QLocalServer;
+class QLocalSocket;
+
+namespace QtuC
+{
+
+class DeviceStateVariableBase;
+
+/** Share the values of the state variables with the clients running on the same host, next to the TCP connections.
+  *	The values are written to a SharedStateTable whenever they change, and the local clients are notified on a local socket with the name of the table key:
+  *	a single byte, at most once per event loop pass, no matter how many values changed. The clients then read the changed values from the table.
+  *	The key of the table is advertised in the handshake of the proxy (`sharedState` info), a local client still connects on TCP for the deviceAPI, the sets and the calls.*/
+class SharedStateServer : public ErrorHandlerBase
+{
+	Q_OBJECT
+public:
+
+	explicit SharedStateServer( QObject *parent = 0 );
+
+	~SharedStateServer();
+
+	/** Create the table of the variables, and start listening for the local clients.
+	  *	@param varList The variables, in the order of their ids (see StateManagerBase::getVar(int)).
+	  *	@param apiString The deviceAPI string sent to the clients.
+	  *	@return True on success, false otherwise.*/
+	bool start( const QList<DeviceStateVariableBase*> &varList, const QString &apiString );
+
+	/// Get the key of the table, empty if not started.
+	QString getKey() const;
+
+	/// Get the number of connected local clients.
+	int getClientCount() const
+		{ return mClients.size(); }
+
+	/// Get the number of values written to the table since start.
+	quint64 getUpdateCount() const
+		{ return mUpdateCount; }
+
+private slots:
+
+	/** Write the new value of a variable to the table.
+	  *	Connected to DeviceStateVariableBase::valueChanged(QVariant).*/
+	void handleValueChange();
+
+	/// Notify the local clients of the values written since the last notification.
+	void notifyClients();
+
+	/// Handle a new local client.
+	void handleNewConnection();
+
+	/// Handle a local client closing its socket.
+	void handleClientDisconnect();
+
+private:
+	SharedStateTable *mTable;
+	QLocalServer *mLocalServer;
+	QList<QLocalSocket*> mClients;
+	QHash<QObject*,int> mVarIds;	///< Id of the variables by the variable object.
+	QTimer *mNotifyTimer;			///< Zero timer to notify the clients once per event loop pass.
+	quint64 mUpdateCount;
+};
+
+}	//QtuC::
+#endif // SHAREDSTATESERVER_H
@@ -0,0 +1,313 @@
+#include "SimulatedDeviceConnector.h"
+#include "ProxyMetrics.h"
+#include "Device.h"
+#include <qmath.h>
+
+using namespace QtuC;
+
+const int SimulatedDeviceConnector::mMaxCommandsPerTick = 5000;
+const int SimulatedDeviceConnector::mBatchMaxLength = 79;
+
+SimulatedDeviceConnector::SimulatedDeviceConnector( const Device *device, StateManagerBase *stateManager, QObject *parent ) :
+	DeviceConnectionManagerBase(device, parent),
+	mStateManager(stateManager),
+	mPeriodMs(1000.0),
+	mAmplitude(100.0),
+	mOffset(0.0),
+	mGeneratedCount(0),
+	mNextVar(0),
+	mOpen(false)
+{
+	mTickTimer = new QTimer(this);
+	connect( mTickTimer, SIGNAL(timeout()), this, SLOT(tick()) );
+	mMessageTimer = new QTimer(this);
+	connect( mMessageTimer, SIGNAL(timeout()), this, SLOT(sendStatusMessage()) );
+}
+
+SimulatedDeviceConnector::~SimulatedDeviceConnector()
+{
+	closeDevice();
+}
+
+bool SimulatedDeviceConnector::sendCommand( DeviceCommand *cmd )
+{
+	if( !cmd )
+		{ return false; }
+
+	if( !mOpen )
+	{
+		error( QtWarningMsg, "Simulated device is closed, sendCommand failed", "sendCommand()" );
+		cmd->deleteLater();
+		return false;
+	}
+
+	if( cmd->getType() == deviceCmdGet || cmd->getType() == deviceCmdSet )
+	{
+		QList<DeviceCommand*> cmdList;
+		if( cmd->isBatch() )
+			{ cmdList = DeviceCommand::listFromString( cmd->getCommandString() ); }
+		else
+			{ cmdList.append( cmd ); }
+
+		QList<SimVariable*> replyVars;
+		for( int i=0; i<cmdList.size(); ++i )
+		{
+			SimVariable *var = execVariableCommand( cmdList.at(i) );
+			if( var && ( cmd->getType() == deviceCmdGet || mDevice->positiveAck() ) )
+				{ replyVars.append( var ); }
+		}
+		if( cmd->isBatch() )
+			{ qDeleteAll( cmdList ); }
+
+		if( !replyVars.isEmpty() )
+		{
+			if( mPendingReplies.isEmpty() )
+				{ QTimer::singleShot( 0, this, SLOT(flushReplies()) ); }
+			// the replies to a batch are batched as well, as the device does
+			quint64 nowUs = mClock.nsecsElapsed() / 1000;
+			if( cmd->isBatch() )
+				{ mPendingReplies.append( batchSetCommandString( replyVars, nowUs ) ); }
+			else
+				{ mPendingReplies.append( setCommandString( replyVars.first(), nowUs ) ); }
+		}
+	}
+	else if( cmd->getHwInterface() == ":proxy" && cmd->getVariable() == "stream" && cmd->getArgList().size() >= 2 )
+	{
+		// a device stream changes the rate of the variable, the configured rate applies until then
+		SimVariable *streamVar = mVarsByKey.value( cmd->getArg(0) + "/" + cmd->getArg(1), 0 );
+		if( streamVar )
+		{
+			double periodMs = cmd->getArg(2).toDouble();
+			streamVar->rate = ( periodMs > 0 ) ? 1000.0 / periodMs : 0.0;
+			streamVar->emitted = (quint64)( mClock.nsecsElapsed() / 1000 * streamVar->rate / 1000000.0 );
+		}
+		else
+			{ error( QtWarningMsg, QString("Simulated device has no such variable to stream: %1 %2").arg(cmd->getArg(0), cmd->getArg(1)), "sendCommand()" ); }
+	}
+	else
+		{ debug( debugLevelVerbose, QString("Simulated device ignores call: %1").arg(cmd->getCommandString()), "sendCommand()" ); }
+
+	cmd->deleteLater();
+	return true;
+}
+
+SimulatedDeviceConnector::SimVariable *SimulatedDeviceConnector::execVariableCommand( const DeviceCommand *cmd )
+{
+	SimVariable *var = mVarsByKey.value( cmd->getHwInterface() + "/" + cmd->getVariable(), 0 );
+	if( !var )
+	{
+		error( QtWarningMsg, QString("Simulated device has no such variable: %1 %2").arg(cmd->getHwInterface(), cmd->getVariable()), "execVariableCommand()" );
+		return 0;
+	}
+
+	if( cmd->getType() == deviceCmdSet )
+	{
+		QString arg = cmd->getArg();
+		bool ok;
+		double newVal = arg.toDouble(&ok);
+		if( !ok )
+			{ newVal = ( arg == "true" || arg == "on" || arg == "high" ) ? 1.0 : 0.0; }
+		var->value = newVal;
+		var->waveform = waveformConstant;
+	}
+	return var;
+}
+
+void SimulatedDeviceConnector::closeDevice()
+{
+	if( !mOpen )
+		{ return; }
+
+	mTickTimer->stop();
+	mMessageTimer->stop();
+	mPendingReplies.clear();
+	mVarsByKey.clear();
+	qDeleteAll( mVars );
+	mVars.clear();
+	mOpen = false;
+	debug( debugLevelInfo, QString("Simulated device closed, %1 commands generated").arg(QString::number(mGeneratedCount)), "closeDevice()" );
+}
+
+bool SimulatedDeviceConnector::openDevice()
+{
+	if( mOpen )
+		{ return true; }
+
+	double defaultRate = deviceSetting("simDevice/rate").toDouble();
+	waveform_t defaultWaveform = waveformFromString( deviceSetting("simDevice/waveform").toString() );
+	mPeriodMs = deviceSetting("simDevice/period").toDouble();
+	if( mPeriodMs <= 0 )
+		{ mPeriodMs = 1000.0; }
+	mAmplitude = deviceSetting("simDevice/amplitude").toDouble();
+	mOffset = deviceSetting("simDevice/offset").toDouble();
+
+	QList<DeviceStateVariableBase*> varList = mStateManager->getVarList();
+	for( int i=0; i<varList.size(); ++i )
+	{
+		DeviceStateProxyVariable *stateVar = (DeviceStateProxyVariable*)varList.at(i);
+		SimVariable *var = new SimVariable();
+		var->hwInterface = stateVar->getHwInterface();
+		var->name = stateVar->getName();
+		var->rawType = stateVar->getRawType();
+		var->waveform = defaultWaveform;
+		var->rate = ( stateVar->getAccessMode() & DeviceStateVariableBase::readAccess ) ? defaultRate : 0.0;
+		var->value = mOffset;
+		var->emitted = 0;
+
+		// per-variable override, waveform:rate
+		QString overrideStr = deviceSetting( QString("simDevice/var/%1/%2").arg(var->hwInterface, var->name) ).toString();
+		if( !overrideStr.isEmpty() )
+		{
+			var->waveform = waveformFromString( overrideStr.section(':', 0, 0) );
+			if( !overrideStr.section(':', 1, 1).isEmpty() )
+				{ var->rate = overrideStr.section(':', 1, 1).toDouble(); }
+		}
+
+		mVars.append( var );
+		mVarsByKey.insert( var->hwInterface + "/" + var->name, var );
+	}
+
+	mGeneratedCount = 0;
+	mNextVar = 0;
+	mOpen = true;
+	mClock.start();
+
+	int tickMs = deviceSetting("simDevice/tickMs").toInt();
+	mTickTimer->start( tickMs > 0 ? tickMs : 1 );
+	int messageIntervalMs = deviceSetting("simDevice/messageIntervalMs").toInt();
+	if( messageIntervalMs > 0 )
+		{ mMessageTimer->start( messageIntervalMs ); }
+
+	// as a real device would do after reset
+	QTimer::singleShot( 0, this, SLOT(sendGreeting()) );
+
+	debug( debugLevelInfo, QString("Simulated device opened with %1 variables").arg(QString::number(mVars.size())), "openDevice()" );
+	return true;
+}
+
+SimulatedDeviceConnector::waveform_t SimulatedDeviceConnector::waveformFromString( const QString &waveformStr )
+{
+	if( waveformStr == "sine" ) { return waveformSine; }
+	if( waveformStr == "sawtooth" ) { return waveformSawtooth; }
+	if( waveformStr == "square" ) { return waveformSquare; }
+	if( waveformStr == "random" ) { return waveformRandom; }
+	if( waveformStr == "counter" ) { return waveformCounter; }
+	return waveformConstant;
+}
+
+void SimulatedDeviceConnector::tick()
+{
+	quint64 nowUs = mClock.nsecsElapsed() / 1000;
+	int budget = mMaxCommandsPerTick;
+
+	// round-robin, one command of a variable at a time, until a whole round has nothing due
+	int idleCount = 0;
+	while( budget > 0 && idleCount < mVars.size() )
+	{
+		SimVariable *var = mVars.at(mNextVar);
+		mNextVar = ( mNextVar + 1 ) % mVars.size();
+
+		if( var->rate <= 0 || var->emitted >= (quint64)( nowUs * var->rate / 1000000.0 ) )
+		{
+			++idleCount;
+			continue;
+		}
+
+		quint64 sampleUs = (quint64)( var->emitted * 1000000.0 / var->rate );
+		if( var->waveform != waveformConstant )
+			{ var->value = waveformValue( var, sampleUs ); }
+		emitCommandString( setCommandString( var, sampleUs ) );
+		++var->emitted;
+		--budget;
+		idleCount = 0;
+	}
+
+	if( budget == 0 )
+		{ debug( debugLevelVeryVerbose, "Simulated device can not keep up with the requested rate", "tick()" ); }
+}
+
+void SimulatedDeviceConnector::flushReplies()
+{
+	QStringList replies = mPendingReplies;
+	mPendingReplies.clear();
+	for( int i=0; i<replies.size(); ++i )
+		{ emitCommandString( replies.at(i) ); }
+}
+
+void SimulatedDeviceConnector::sendGreeting()
+{
+	if( !mOpen )
+		{ return; }
+
+	QChar sep = DeviceCommand::getSeparator();
+	QString greeting = QString("call") + sep + "@" + QString::number( (quint64)( mClock.nsecsElapsed() / 1000000.0 * mDevice->getDeviceTimeTicksPerMs() ), 16 ) + sep + ":proxy" + sep + "greeting";
+	greeting += sep + QString("\"msg:Simulated device\"");
+	QHash<QString,QString> infoList = mDevice->getInfoList();
+	infoList.insert( "batch", QString::number(mBatchMaxLength) );
+	QHash<QString,QString>::const_iterator info;
+	for( info = infoList.constBegin(); info != infoList.constEnd(); ++info )
+		{ greeting += sep + QString("\"%1:%2\"").arg( info.key(), info.value() ); }
+	emitCommandString( greeting );
+}
+
+void SimulatedDeviceConnector::sendStatusMessage()
+{
+	QChar sep = DeviceCommand::getSeparator();
+	emitCommandString( QString("call") + sep + ":proxy" + sep + "message" + sep + "inf" + sep + QString("\"Simulated device generated %1 commands\"").arg(QString::number(mGeneratedCount)) );
+}
+
+double SimulatedDeviceConnector::waveformValue( const SimVariable *var, quint64 timeUs ) const
+{
+	double phase = fmod( timeUs / 1000.0, mPeriodMs ) / mPeriodMs;	// [0,1)
+	switch( var->waveform )
+	{
+		case waveformSine: return mOffset + mAmplitude * qSin( 2.0 * M_PI * phase );
+		case waveformSawtooth: return mOffset + mAmplitude * ( 2.0 * phase - 1.0 );
+		case waveformSquare: return mOffset + ( phase < 0.5 ? mAmplitude : -mAmplitude );
+		case waveformRandom: return mOffset + mAmplitude * ( 2.0 * qrand() / (double)RAND_MAX - 1.0 );
+		case waveformCounter: return var->value + 1.0;
+		default: return var->value;
+	}
+}
+
+QString SimulatedDeviceConnector::deviceValueString( const SimVariable *var ) const
+{
+	// as parsed by DeviceStateVariableBase::variantFromString(): integers are hex
+	switch( var->rawType )
+	{
+		case QVariant::Int: return QString::number( qRound(var->value), 16 );
+		case QVariant::UInt: return QString::number( (uint)qAbs(qRound(var->value)), 16 );
+		case QVariant::Double: return QString::number( var->value, 'f', 4 );
+		case QVariant::Bool: return var->value > mOffset ? QString("1") : QString("0");
+		default: return QString::number( var->value );
+	}
+}
+
+QString SimulatedDeviceConnector::setCommandString( const SimVariable *var, quint64 timeUs ) const
+{
+	QChar sep = DeviceCommand::getSeparator();
+	quint64 deviceTime = (quint64)( timeUs / 1000.0 * mDevice->getDeviceTimeTicksPerMs() );
+	return QString("set") + sep + "@" + QString::number( deviceTime, 16 ) + sep + var->hwInterface + sep + var->name + sep + deviceValueString(var);
+}
+
+QString SimulatedDeviceConnector::batchSetCommandString( const QList<SimVariable*> &varList, quint64 timeUs ) const
+{
+	QChar sep = DeviceCommand::getSeparator();
+	quint64 deviceTime = (quint64)( timeUs / 1000.0 * mDevice->getDeviceTimeTicksPerMs() );
+	QString cmdString = QString("mset") + sep + "@" + QString::number( deviceTime, 16 ) + sep + varList.first()->hwInterface;
+	for( int i=0; i<varList.size(); ++i )
+		{ cmdString += sep + varList.at(i)->name + "=" + deviceValueString( varList.at(i) ); }
+	return cmdString;
+}
+
+void SimulatedDeviceConnector::emitCommandString( const QString &cmdString )
+{
+	int count = emitReceived( cmdString, LatencyTrace::now() );
+	if( count )
+		{ mGeneratedCount += count; }
+	else
+	{
+		error( QtWarningMsg, QString("Simulated device built an invalid command: %1").arg(cmdString), "emitCommandString()" );
+		ProxyMetrics::instance()->countParseFailure();
+	}
+}
@@ -0,0 +1,152 @@
+#ifndef SIMULATEDDEVICECONNECTOR_H
+#define SIMULATEDDEVICECONNECTOR_H
+
+#include "DeviceConnectionManagerBase.h"
+#include "StateManagerBase.h"
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QList>
+#include <QHash>
+#include <QStringList>
+
+namespace QtuC
+{
+
+/** Simulate a device, based on the loaded deviceAPI.
+  *	Every readable state variable of the API is driven by a waveform, and `set` commands are generated for it at a given rate, as if a device would push its state.
+  *	`get` commands are answered with the current simulated value, `set` commands from the proxy hold the variable at the received value.
+  *	A `:proxy stream` call sets the rate of the variable to the requested period (see the push mode of the device-side autoUpdate).
+  *	A greeting is sent on open, and periodically a `:proxy` info message with the number of generated commands.
+  *	This gives a repeatable load source to test the proxy and the clients without hardware.
+  *
+  *	Settings (`simDevice/` group):
+  *		- `rate`: Number of `set` commands per second for each variable.
+  *		- `waveform`: One of `sine`, `sawtooth`, `square`, `random`, `counter`.
+  *		- `period`, `amplitude`, `offset`: Waveform parameters, period is in milliseconds.
+  *		- `var/<hwInterface>/<name>`: Per-variable override in the form `waveform:rate`.
+  *		- `tickMs`: Interval of the generator timer, the commands due are emitted in one batch on each tick.
+  *		- `messageIntervalMs`: Interval of the `:proxy` info messages, 0 disables them.*/
+class SimulatedDeviceConnector : public DeviceConnectionManagerBase
+{
+	Q_OBJECT
+public:
+
+	/// Waveforms of the simulated variables.
+	enum waveform_t
+	{
+		waveformConstant,	///< Hold the last value, used after a set from the proxy.
+		waveformSine,
+		waveformSawtooth,
+		waveformSquare,
+		waveformRandom,
+		waveformCounter
+	};
+
+	/** Create the simulator.
+	  *	@param device The simulated device.
+	  *	@param stateManager The state manager of the loaded deviceAPI, the simulated variables are taken from it on openDevice().
+	  *	@param parent Parent object.*/
+	SimulatedDeviceConnector( const Device *device, StateManagerBase *stateManager, QObject *parent = 0 );
+
+	~SimulatedDeviceConnector();
+
+	/** @name Inherited from DeviceConnectionManagerBase.
+	  *	@{*/
+	bool sendCommand( DeviceCommand *cmd );
+
+	void closeDevice();		///< Stop the simulation.
+
+	/** Build the simulated variables from the API and start the simulation.
+	  *	@return True on success, false otherwise.*/
+	bool openDevice();
+	/// @}
+
+	/// Get the number of commands generated since openDevice().
+	quint64 getGeneratedCount() const
+		{ return mGeneratedCount; }
+
+	/** Get waveform from string.
+	  *	@param waveformStr The waveform name.
+	  *	@return The waveform, waveformConstant if the string is invalid.*/
+	static waveform_t waveformFromString( const QString &waveformStr );
+
+private slots:
+
+	/** Generate the commands due since the previous tick.
+	  *	The variables take turns, one command each, so when the per tick limit is reached, all of them fall behind evenly.
+	  *	The next tick continues with the variable after the last served one.*/
+	void tick();
+
+	/// Emit the queued replies.
+	void flushReplies();
+
+	/// Send a greeting to the proxy.
+	void sendGreeting();
+
+	/// Send an info message with statistics.
+	void sendStatusMessage();
+
+private:
+
+	/// A simulated variable.
+	class SimVariable
+	{
+	public:
+		QString hwInterface;
+		QString name;
+		QVariant::Type rawType;
+		waveform_t waveform;
+		double rate;		///< Commands per second.
+		double value;		///< Current value.
+		quint64 emitted;	///< Number of commands emitted since start.
+	};
+
+	/** Calculate the value of a variable at a given time.
+	  *	@param var The variable.
+	  *	@param timeUs Simulation time in microseconds.*/
+	double waveformValue( const SimVariable *var, quint64 timeUs ) const;
+
+	/** Format the value as the device would send it, based on the raw type.
+	  *	@param var The variable.*/
+	QString deviceValueString( const SimVariable *var ) const;
+
+	/** Build a set command string for a variable.
+	  *	@param var The variable.
+	  *	@param timeUs Simulation time in microseconds, used for the device timestamp.*/
+	QString setCommandString( const SimVariable *var, quint64 timeUs ) const;
+
+	/** Build a batched set command string for variables of the same interface.
+	  *	@param varList The variables.
+	  *	@param timeUs Simulation time in microseconds, used for the device timestamp.*/
+	QString batchSetCommandString( const QList<SimVariable*> &varList, quint64 timeUs ) const;
+
+	/** Execute a get or set command on the simulated variable.
+	  *	A set changes the value of the variable, and makes it constant.
+	  *	@param cmd The command, not batched.
+	  *	@return The variable, or 0 if there is no such variable.*/
+	SimVariable *execVariableCommand( const DeviceCommand *cmd );
+
+	/** Parse a command string and emit it, as if it was received from the device.
+	  *	@param cmdString The command string.*/
+	void emitCommandString( const QString &cmdString );
+
+	StateManagerBase *mStateManager;
+	QList<SimVariable*> mVars;
+	QHash<QString, SimVariable*> mVarsByKey;	///< Variables by "hwInterface/name".
+	QTimer *mTickTimer;
+	QTimer *mMessageTimer;
+	QElapsedTimer mClock;
+	QStringList mPendingReplies;	///< Replies to gets, emitted from the event loop, to avoid recursion into the sender.
+	double mPeriodMs;
+	double mAmplitude;
+	double mOffset;
+	quint64 mGeneratedCount;
+	int mNextVar;		///< Index of the variable to serve first on the next tick.
+	bool mOpen;
+
+	static const int mMaxCommandsPerTick;	///< Limit of commands per tick, so the event loop is not blocked.
+	static const int mBatchMaxLength;	///< Maximum length of a batched command, advertised in the greeting. Same as on the qcDevice firmware.
+};
+
+}	//QtuC::
+#endif // SIMULATEDDEVICECONNECTOR_H
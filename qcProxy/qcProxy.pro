@@ -29,7 +29,15 @@ SOURCES += main.cpp \
     ClientSubscription.cpp \
     ClientSubscriptionManager.cpp \
     DeviceStateProxyVariable.cpp \
-    DeviceCommand.cpp
+    DeviceCommand.cpp \
+    DeviceCommandRecorder.cpp \
+    DeviceCommandScheduler.cpp \
+    DeviceRequestTracker.cpp \
+    SharedStateServer.cpp \
+    ReplayDeviceConnector.cpp \
+    SimulatedDeviceConnector.cpp \
+    RelayDeviceConnector.cpp \
+    ProxyMetrics.cpp
 
 HEADERS += \
     SerialDeviceConnector.h \
@@ -45,7 +53,15 @@ HEADERS += \
     ClientSubscription.h \
     ClientSubscriptionManager.h \
     DeviceStateProxyVariable.h \
-    DeviceCommand.h
+    DeviceCommand.h \
+    DeviceCommandRecorder.h \
+    DeviceCommandScheduler.h \
+    DeviceRequestTracker.h \
+    SharedStateServer.h \
+    ReplayDeviceConnector.h \
+    SimulatedDeviceConnector.h \
+    RelayDeviceConnector.h \
+    ProxyMetrics.h
 
 # Config for QtSerialPort.
 # On linux, ld must find the lib (no config), on win, use the one in the QtSerialPort dir
@@ -61,6 +77,8 @@ DEPENDPATH += $$PWD/../QtSerialPort/include
 win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/release -lqcCommon
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../qcCommon/debug -lqcCommon
 else:unix: LIBS += -L$$OUT_PWD/../qcCommon/ -lqcCommon
+# setsockopt() of ClientConnectionManagerBase
+win32: LIBS += -lws2_32
 
 INCLUDEPATH += $$PWD/../qcCommon
 INCLUDEPATH += $$PWD/../qcCommon/clientCommands